@@ -0,0 +1,332 @@
+#ifndef GVU_ASYNC_PIPELINE_COMPILER_H
+#define GVU_ASYNC_PIPELINE_COMPILER_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <unordered_map>
+#include <stdexcept>
+#include "GraphicsPipelineCache.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The AsyncPipelineCompiler class
+ *
+ * Compiles graphics pipelines on a pool of worker threads. Pipelines
+ * are created through a ConcurrentGraphicsPipelineCache, so they all
+ * share the same VkPipelineCache and are only compiled once.
+ *
+ * gvu::ConcurrentGraphicsPipelineCache cache;
+ * cache.init(device, physicalDevice, "pipeline_cache.bin");
+ *
+ * gvu::AsyncPipelineCompiler compiler;
+ * compiler.init(&cache);
+ *
+ * // returns immediately
+ * auto future = compiler.submit(gci);
+ *
+ * // in the render loop, use a placeholder pipeline until the
+ * // real one has been compiled
+ * auto pipeline = compiler.getOrPlaceholder(gci, defaultPipeline);
+ *
+ * compiler.destroy();
+ * cache.destroy();
+ */
+class AsyncPipelineCompiler
+{
+    public:
+        using cache_type      = ConcurrentGraphicsPipelineCache;
+        using createInfo_type = cache_type::createInfo_type;
+        using object_type     = cache_type::object_type;
+        using future_type     = std::shared_future<object_type>;
+
+        AsyncPipelineCompiler() = default;
+        AsyncPipelineCompiler(AsyncPipelineCompiler const &) = delete;
+        AsyncPipelineCompiler & operator=(AsyncPipelineCompiler const &) = delete;
+
+        ~AsyncPipelineCompiler()
+        {
+            destroy();
+        }
+
+        /**
+         * @brief init
+         * @param cache
+         * @param threadCount
+         *
+         * Start the worker threads. If threadCount is 0, one thread per
+         * hardware thread is started, leaving one for the main thread.
+         * Throws std::logic_error if the compiler is already running.
+         */
+        void init(cache_type * cache, uint32_t threadCount = 0)
+        {
+            {
+                std::unique_lock<std::mutex> L(m_queueMutex);
+                if(m_running)
+                    throw std::logic_error("AsyncPipelineCompiler is already initialized");
+                m_running = true;
+                m_stop    = false;
+            }
+            m_cache = cache;
+            if(threadCount == 0)
+            {
+                auto hc = std::thread::hardware_concurrency();
+                threadCount = hc > 1 ? hc - 1 : 1;
+            }
+            for(uint32_t i=0;i<threadCount;i++)
+            {
+                m_workers.emplace_back([this]()
+                {
+                    _workerLoop();
+                });
+            }
+        }
+
+        /**
+         * @brief destroy
+         *
+         * Waits for all the submitted pipelines to be compiled and
+         * stops the worker threads. This must be called before the
+         * pipeline cache is destroyed. submit() throws after this.
+         */
+        void destroy()
+        {
+            {
+                std::unique_lock<std::mutex> L(m_queueMutex);
+                m_stop    = true;
+                m_running = false;
+            }
+            m_queueCV.notify_all();
+            for(auto & t : m_workers)
+                t.join();
+            m_workers.clear();
+
+            std::unique_lock<std::mutex> L(m_futuresMutex);
+            m_futures.clear();
+        }
+
+        /**
+         * @brief submit
+         * @param info
+         * @return
+         *
+         * Queue a pipeline to be compiled and return a future for it.
+         * Submitting a create info which is still being compiled returns
+         * the same future. If the pipeline is already in the cache, a ready
+         * future is returned and nothing is queued.
+         *
+         * Only the pipelines which are queued or compiling are tracked. Once
+         * a pipeline is compiled, it is owned by the cache and can be evicted
+         * like any other pipeline, after which it will be compiled again.
+         * If a pipeline failed to compile, the next submit() returns the
+         * failed future and forgets it, so the submit() after that retries.
+         *
+         * Throws std::logic_error if the compiler is not running.
+         */
+        future_type submit(createInfo_type const & info)
+        {
+            std::unique_lock<std::mutex> FL(m_futuresMutex);
+            auto it = m_futures.find(info);
+            if(it != m_futures.end())
+            {
+                auto f = it->second;
+                if(_isReady(f) && _hasFailed(f))
+                    m_futures.erase(it);
+                return f;
+            }
+
+            if(auto obj = m_cache ? m_cache->find(info) : VK_NULL_HANDLE; obj != VK_NULL_HANDLE)
+            {
+                std::promise<object_type> ready;
+                ready.set_value(obj);
+                return ready.get_future().share();
+            }
+
+            std::promise<object_type> promise;
+            future_type future = promise.get_future().share();
+            {
+                // m_futuresMutex is always locked before m_queueMutex
+                std::unique_lock<std::mutex> L(m_queueMutex);
+                if(!m_running)
+                    throw std::logic_error("AsyncPipelineCompiler is not running");
+                m_queue.push_back( _job{info, std::move(promise)} );
+            }
+            m_futures.emplace(info, future);
+            FL.unlock();
+
+            m_queueCV.notify_one();
+            return future;
+        }
+
+        /**
+         * @brief isReady
+         * @param info
+         * @return
+         *
+         * Returns true if the pipeline has finished compiling and is
+         * in the cache.
+         */
+        bool isReady(createInfo_type const & info) const
+        {
+            std::unique_lock<std::mutex> L(m_futuresMutex);
+            auto it = m_futures.find(info);
+            if(it != m_futures.end())
+                return _isReady(it->second) && !_hasFailed(it->second);
+            return m_cache != nullptr && m_cache->find(info) != VK_NULL_HANDLE;
+        }
+
+        /**
+         * @brief getOrPlaceholder
+         * @param info
+         * @param placeholder
+         * @return
+         *
+         * Returns the pipeline if it has been compiled. Otherwise it is
+         * submitted (if it has not been already) and the placeholder is
+         * returned. This never blocks on compilation.
+         *
+         * If compilation failed, the exception is rethrown, and the
+         * pipeline is compiled again by the next call.
+         */
+        object_type getOrPlaceholder(createInfo_type const & info, object_type placeholder)
+        {
+            auto f = submit(info);
+            if(!_isReady(f))
+                return placeholder;
+
+            auto p = f.get();
+            // the pipeline may have been evicted since it was compiled
+            if(m_cache->touch(p, info.hash()))
+                return p;
+            submit(info);
+            return placeholder;
+        }
+
+        /**
+         * @brief waitIdle
+         *
+         * Block until all submitted pipelines have been compiled.
+         */
+        void waitIdle()
+        {
+            std::unique_lock<std::mutex> L(m_queueMutex);
+            m_idleCV.wait(L, [this]()
+            {
+                return m_queue.empty() && m_active == 0;
+            });
+        }
+
+        /**
+         * @brief pendingCount
+         * @return
+         *
+         * Returns the number of pipelines which are queued or compiling
+         */
+        size_t pendingCount() const
+        {
+            std::unique_lock<std::mutex> L(m_queueMutex);
+            return m_queue.size() + m_active;
+        }
+
+        size_t threadCount() const
+        {
+            return m_workers.size();
+        }
+
+    private:
+        struct _job
+        {
+            createInfo_type           info;
+            std::promise<object_type> promise;
+        };
+
+        static bool _isReady(future_type const & f)
+        {
+            return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+
+        static bool _hasFailed(future_type const & f)
+        {
+            try
+            {
+                f.get();
+                return false;
+            }
+            catch(...)
+            {
+                return true;
+            }
+        }
+
+        void _workerLoop()
+        {
+            while(true)
+            {
+                _job job;
+                {
+                    std::unique_lock<std::mutex> L(m_queueMutex);
+                    m_queueCV.wait(L, [this]()
+                    {
+                        return m_stop || !m_queue.empty();
+                    });
+                    // finish the remaining jobs before stopping
+                    if(m_queue.empty())
+                        return;
+                    job = std::move(m_queue.front());
+                    m_queue.pop_front();
+                    ++m_active;
+                }
+
+                try
+                {
+                    job.promise.set_value( m_cache->create(job.info) );
+
+                    // the pipeline is now owned by the cache. Failed futures
+                    // are kept until submit() has returned them once.
+                    std::unique_lock<std::mutex> L(m_futuresMutex);
+                    m_futures.erase(job.info);
+                }
+                catch(...)
+                {
+                    job.promise.set_exception(std::current_exception());
+                }
+
+                {
+                    std::unique_lock<std::mutex> L(m_queueMutex);
+                    --m_active;
+                }
+                m_idleCV.notify_all();
+            }
+        }
+
+        struct _hasher
+        {
+            std::size_t operator()(const createInfo_type& k) const{
+                return k.hash();
+            }
+        };
+
+        cache_type *                                                m_cache = nullptr;
+        std::vector<std::thread>                                    m_workers;
+
+        mutable std::mutex                                          m_queueMutex;
+        std::condition_variable                                     m_queueCV;
+        std::condition_variable                                     m_idleCV;
+        std::deque<_job>                                            m_queue;
+        size_t                                                      m_active  = 0;
+        bool                                                        m_stop    = false;
+        bool                                                        m_running = false;
+
+        mutable std::mutex                                          m_futuresMutex;
+        std::unordered_map<createInfo_type, future_type, _hasher>   m_futures; // pipelines which are queued or compiling
+};
+
+}
+
+#endif
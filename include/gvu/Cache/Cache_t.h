@@ -3,35 +3,405 @@
 
 #include <vulkan/vulkan.h>
 #include <vector>
+#include <array>
 #include <tuple>
 #include <unordered_map>
 #include <cassert>
+#include <stdexcept>
+#include <mutex>
+#include <shared_mutex>
+#include <future>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include "../Instrumentation.h"
 
 namespace gvu
 {
 
-template<typename gvuCreateInfo>
+/**
+ * @brief The NullMutex struct
+ *
+ * A mutex that does nothing. This is used by the Cache_t
+ * when it is not in concurrent mode so that both modes
+ * can share the same code path.
+ */
+struct NullMutex
+{
+    void lock() {}
+    void unlock() {}
+    void lock_shared() {}
+    void unlock_shared() {}
+};
+
+/**
+ * The Cache_t class
+ *
+ * Holds a map of gvuCreateInfo -> VkObject so that
+ * creating an object twice with the same create info returns
+ * the same object.
+ *
+ * If concurrent == true, the cache can be used from multiple threads
+ * at the same time. The map is split into a number of shards which
+ * are each protected by a shared_mutex. Lookups which hit the cache
+ * only take a shared lock on a single shard.
+ *
+ * When two threads ask for the same create info at the same time,
+ * only one of them will create the vulkan object. The other will
+ * wait for that object to be created. The creation itself happens
+ * outside of the lock, so other lookups are not blocked.
+ *
+ * gvu::Cache_t<gvu::SamplerCreateInfo, true> cache;
+ *
+ * The createInfo must provide hash() and operator==, and two create
+ * infos which compare equal must have the same hash. The cache relies
+ * on operator== to decide if two objects are the same, so it must
+ * compare every member which is passed to vulkan.
+ *
+ * If the createInfo has a seal() function (see gvu::SealedHash), the
+ * keys stored in the cache are sealed so their hash is only computed
+ * once. Sealing the key you look up with avoids hashing it on
+ * every call.
+ *
+ * Eviction:
+ *
+ * By default the cache only grows. Each entry remembers the frame it was
+ * last looked up in, so unused objects can be evicted:
+ *
+ * cache.setBudget(4096);      // at most 4096 objects
+ * cache.setRetireFunction([&](std::function<void()> destroy)
+ * {
+ *     tracker.onSubmittedComplete(std::move(destroy)); // gvu::TimelineTracker
+ * });
+ *
+ * // once per frame
+ * cache.nextFrame();
+ *
+ * nextFrame() evicts the least recently used objects until the cache is
+ * within its budget. Objects used within the last minIdleFrames frames
+ * are never evicted, so hot objects keep hitting. If the createInfo has a
+ * size_t cost() const function (eg: an estimate of the memory used), the
+ * budget is the sum of the costs, otherwise it is the number of objects.
+ *
+ * Evicted objects are removed from the cache right away, but their
+ * destruction is handed to the retire function so it can be deferred
+ * until the GPU has finished with them. Without a retire function they
+ * are destroyed immediately.
+ *
+ * Only lookups through create() count as a use. If you hold on to a
+ * handle and keep using it without looking it up, call touch() every
+ * frame, or pin() it.
+ */
+template<typename gvuCreateInfo, bool concurrent = false>
 class Cache_t
 {
     public:
         using vk_createInfo_type = typename gvuCreateInfo::create_info_type;
         using createInfo_type    = gvuCreateInfo;
         using object_type        = typename gvuCreateInfo::object_type;
+        using mutex_type         = std::conditional_t<concurrent, std::shared_mutex, NullMutex>;
+
+        static constexpr bool   is_concurrent = concurrent;
+        static constexpr size_t shard_count   = concurrent ? 16 : 1;
 
         void init(VkDevice newDevice)
         {
             m_device = newDevice;
         }
 
+        /**
+         * @brief destroy
+         *
+         * Destroys all the objects in the cache. This must not
+         * be called while other threads are creating objects.
+         */
         void destroy()
         {
-            for(auto & l : m_cache)
+            for(auto & S : m_shards)
+            {
+                std::unique_lock<mutex_type> L(S.mutex);
+                for(auto & l : S.map)
+                {
+                    if(l.second.obj != VK_NULL_HANDLE)
+                        createInfo_type::destroy(m_device, l.second.obj);
+                }
+                S.map.clear();
+                S.handles.clear();
+            }
+            for(auto & R : m_reverse)
             {
-                createInfo_type::destroy(m_device, l.second);
+                std::unique_lock<mutex_type> L(R.mutex);
+                R.map.clear();
             }
-            m_cache.clear();
+            m_totalCost.store(0, std::memory_order_relaxed);
         }
 
+        /**
+         * @brief destroy
+         * @param obj
+         * @return
+         *
+         * Destroys a single object and removes it from the cache. Returns
+         * false if the object was not created by this cache.
+         */
+        bool destroy(object_type obj)
+        {
+            auto * S = _findShard(obj);
+            if(S == nullptr)
+                return false;
+            {
+                std::unique_lock<mutex_type> L(S->mutex);
+                auto h = S->handles.find(obj);
+                if(h == S->handles.end())
+                    return false;
+                _eraseEntry(*S, h);
+            }
+            createInfo_type::destroy(m_device, obj);
+            return true;
+        }
+
+        /**
+         * @brief destroyIf
+         * @param p
+         * @return
+         *
+         * Destroys every object whose createInfo satisfies p(createInfo)
+         * and removes it from the cache. Returns the destroyed objects.
+         *
+         * This is used to invalidate objects which refer to another
+         * object which is about to be destroyed, eg: the image views of
+         * an image.
+         */
+        template<typename predicate_t>
+        std::vector<object_type> destroyIf(predicate_t && p)
+        {
+            std::vector<object_type> objs;
+            for(auto & S : m_shards)
+            {
+                std::unique_lock<mutex_type> L(S.mutex);
+                for(auto it = S.map.begin(); it != S.map.end(); )
+                {
+                    if(it->second.obj != VK_NULL_HANDLE && p(it->first))
+                    {
+                        auto obj = it->second.obj;
+                        objs.push_back(obj);
+                        m_totalCost.fetch_sub(it->second.cost, std::memory_order_relaxed);
+                        S.handles.erase(obj);
+                        _eraseReverse(obj);
+                        it = S.map.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+            for(auto obj : objs)
+                createInfo_type::destroy(m_device, obj);
+            return objs;
+        }
+
+        /**
+         * @brief nextFrame
+         *
+         * Starts a new frame and evicts the least recently used objects
+         * if the cache is over its budget.
+         */
+        void nextFrame()
+        {
+            auto frame = m_frame.fetch_add(1, std::memory_order_relaxed) + 1;
+            if(m_totalCost.load(std::memory_order_relaxed) > m_budget && frame >= m_minIdleFrames)
+                _evict(frame - m_minIdleFrames, m_budget);
+        }
+
+        /**
+         * @brief setBudget
+         * @param budget - the maximum number of objects, or the maximum total cost
+         * @param minIdleFrames - objects used within this many frames are never evicted
+         *
+         * The budget is enforced by nextFrame(). It can be exceeded if
+         * every object has been used recently.
+         */
+        void setBudget(size_t budget, uint64_t minIdleFrames = 2)
+        {
+            m_budget        = budget;
+            m_minIdleFrames = std::max<uint64_t>(minIdleFrames, 1);
+        }
+
+        /**
+         * @brief setRetireFunction
+         * @param f
+         *
+         * f is called with a function which destroys an evicted object.
+         * Use this to defer the destruction until the GPU is finished with
+         * it, eg: with TimelineTracker::onSubmittedComplete().
+         */
+        void setRetireFunction(std::function<void(std::function<void()>)> f)
+        {
+            m_retire = std::move(f);
+        }
+
+        /**
+         * @brief evictUnused
+         * @param idleFrames
+         * @return
+         *
+         * Evicts every object which has not been used for more than
+         * idleFrames frames, regardless of the budget. Returns the number
+         * of objects evicted.
+         */
+        size_t evictUnused(uint64_t idleFrames)
+        {
+            auto frame = m_frame.load(std::memory_order_relaxed);
+            if(frame <= idleFrames)
+                return 0;
+            return _evict(frame - idleFrames - 1, 0);
+        }
+
+        /**
+         * @brief touch
+         * @param obj
+         * @return
+         *
+         * Marks the object as used in the current frame. Returns false if
+         * the object is not in the cache (eg: it was evicted).
+         */
+        bool touch(object_type obj) const
+        {
+            return _withEntry(obj, [this](entry_pair_type & e)
+            {
+                _touch(e.second);
+                return true;
+            });
+        }
+
+        /**
+         * @brief touch
+         * @param obj
+         * @param hash
+         * @return
+         *
+         * Same as touch(obj), but only if the object's createInfo has the
+         * given hash. Returns false otherwise. Vulkan can reuse a handle
+         * after the object is evicted, this tells a reused handle apart from
+         * the original object without copying the createInfo.
+         */
+        bool touch(object_type obj, size_t hash) const
+        {
+            return _withEntry(obj, [this, hash](entry_pair_type & e)
+            {
+                if(e.first.hash() != hash)
+                    return false;
+                _touch(e.second);
+                return true;
+            });
+        }
+
+        /**
+         * @brief pin
+         * @param obj
+         * @return
+         *
+         * Pinned objects are never evicted. pin() and unpin() calls nest.
+         */
+        bool pin(object_type obj)
+        {
+            // the shard lock makes this atomic with the check-and-erase in _evict()
+            return _withEntry(obj, [](entry_pair_type & e)
+            {
+                e.second.pins.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            });
+        }
+
+        bool unpin(object_type obj)
+        {
+            return _withEntry(obj, [](entry_pair_type & e)
+            {
+                auto p = e.second.pins.load(std::memory_order_relaxed);
+                do
+                {
+                    if(p == 0)
+                        return false;
+                } while(!e.second.pins.compare_exchange_weak(p, p - 1, std::memory_order_relaxed));
+                return true;
+            });
+        }
+
+        /**
+         * @brief totalCost
+         * @return
+         *
+         * The sum of the costs of every object in the cache. This is the
+         * number of objects if the createInfo has no cost() function.
+         */
+        size_t totalCost() const
+        {
+            return m_totalCost.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief evictionCount
+         * @return
+         *
+         * The number of objects evicted since the cache was created
+         */
+        size_t evictionCount() const
+        {
+            return m_evictions.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief hitCount
+         * @return
+         *
+         * The number of calls to create() which found the object in the
+         * cache. Calls which waited for another thread to finish creating
+         * the object are not counted.
+         */
+        uint64_t hitCount() const
+        {
+            return m_hits.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief missCount
+         * @return
+         *
+         * The number of calls to create() which had to create the object,
+         * including the ones where the creation failed.
+         */
+        uint64_t missCount() const
+        {
+            return m_misses.load(std::memory_order_relaxed);
+        }
+
+        uint64_t frameIndex() const
+        {
+            return m_frame.load(std::memory_order_relaxed);
+        }
+
+#if defined(GVU_ENABLE_INSTRUMENTATION)
+        /**
+         * @brief stats
+         * @return
+         *
+         * The hit/miss counters and the creation times of this cache.
+         * Only available when GVU_ENABLE_INSTRUMENTATION is defined.
+         */
+        instrumentation::CacheStats & stats()
+        {
+            return m_stats;
+        }
+        instrumentation::CacheStats const & stats() const
+        {
+            return m_stats;
+        }
+#endif
+
         /**
          * @brief createDescriptorSetLayout
          * @param info
@@ -41,12 +411,60 @@ class Cache_t
          */
         object_type create(createInfo_type const & info)
         {
-            return _create(info);
+            return _create(info, [this](auto & Ci)
+            {
+                return createInfo_type::create(m_device, Ci);
+            });
+        }
+
+        /**
+         * @brief create
+         * @param info
+         * @param c
+         * @return
+         *
+         * Same as create(info), but the object is created by calling
+         * c(vk_createInfo_type const &) instead of createInfo_type::create().
+         * The callable is only called if the object is not in the cache.
+         *
+         * This is used when creating the object needs more than the device,
+         * eg: a VkPipelineCache.
+         */
+        template<typename callable_t>
+        object_type create(createInfo_type const & info, callable_t && c)
+        {
+            return _create(info, std::forward<callable_t>(c));
+        }
+
+        /**
+         * @brief find
+         * @param info
+         * @return
+         *
+         * Returns the object for the createInfo if it is in the cache, or
+         * VK_NULL_HANDLE. Never creates the object, and never waits for
+         * another thread which is creating it.
+         */
+        object_type find(createInfo_type const & info) const
+        {
+            auto & S = m_shards[_shardIndex(info)];
+            std::shared_lock<mutex_type> L(S.mutex);
+            auto it = S.map.find(info);
+            if(it == S.map.end() || it->second.obj == VK_NULL_HANDLE)
+                return VK_NULL_HANDLE;
+            _touch(it->second);
+            return it->second.obj;
         }
 
         size_t cacheSize() const
         {
-            return m_cache.size();
+            size_t s = 0;
+            for(auto & S : m_shards)
+            {
+                std::shared_lock<mutex_type> L(S.mutex);
+                s += S.map.size();
+            }
+            return s;
         }
         /**
          * @brief getLayoutInfo
@@ -55,40 +473,360 @@ class Cache_t
          *
          * Return the DescriptorSetLayoutCreateInfo for a particular layout. If
          * the layout doesn't exist, it will throw an error
+         *
+         * This is a constant time lookup. A copy is returned because the
+         * entry can be evicted or destroyed by another thread at any time.
          */
-        createInfo_type const & getCreateInfo(object_type l) const
+        createInfo_type getCreateInfo(object_type l) const
         {
-            for(auto & x : m_cache)
+            std::optional<createInfo_type> info;
+            if(!_withEntry(l, [&](entry_pair_type & e)
             {
-                if(x.second == l)
-                {
-                    return x.first;
-                }
+                info.emplace(e.first);
+                return true;
+            }))
+            {
+                throw std::out_of_range("This object was not created in this cache");
             }
-            throw std::out_of_range("This object was not created in this cache");
+            return std::move(*info);
         }
 
     private:
-        object_type _create(createInfo_type const & info)
+        struct _shard;
+        struct _reverseShard;
+        struct _entry;
+        using entry_pair_type = std::pair<const createInfo_type, _entry>;
+
+        _reverseShard & _getReverseShard(object_type obj) const
+        {
+            if constexpr (shard_count == 1)
+            {
+                (void)obj;
+                return m_reverse[0];
+            }
+            else
+            {
+                return m_reverse[ std::hash<object_type>()(obj) % shard_count ];
+            }
+        }
+
+        /**
+         * @brief _findShard
+         * @param obj
+         * @return
+         *
+         * Returns the shard which holds the object, or nullptr if the object
+         * does not belong to this cache. The entry itself must be looked up
+         * in the shard's handle map while holding the shard's lock, since
+         * another thread may erase it at any time.
+         */
+        _shard * _findShard(object_type obj) const
+        {
+            auto & R = _getReverseShard(obj);
+            std::shared_lock<mutex_type> L(R.mutex);
+            auto it = R.map.find(obj);
+            if(it == R.map.end())
+                return nullptr;
+            return &m_shards[it->second];
+        }
+
+        /**
+         * @brief _withEntry
+         * @param obj
+         * @param f - called as f(entry_pair_type &) while the shard is locked
+         * @return
+         *
+         * Returns false if the object is not in the cache, otherwise the
+         * result of f. The shard is locked with a shared lock, so f may
+         * only modify the atomic members of the entry.
+         */
+        template<typename callable_t>
+        bool _withEntry(object_type obj, callable_t && f) const
+        {
+            auto * S = _findShard(obj);
+            if(S == nullptr)
+                return false;
+            std::shared_lock<mutex_type> L(S->mutex);
+            auto h = S->handles.find(obj);
+            if(h == S->handles.end())
+                return false;
+            return f(*h->second);
+        }
+
+        /**
+         * @brief _eraseEntry
+         * @param S
+         * @param h
+         *
+         * Removes an object from the shard and the reverse lookup. S.mutex
+         * must be locked exclusively. The object is not destroyed.
+         */
+        void _eraseEntry(_shard & S, typename _shard::handle_map_type::iterator h)
+        {
+            auto obj = h->first;
+            auto it  = S.map.find(h->second->first);
+            m_totalCost.fetch_sub(it->second.cost, std::memory_order_relaxed);
+            S.handles.erase(h);
+            S.map.erase(it);
+            _eraseReverse(obj);
+        }
+
+        void _eraseReverse(object_type obj)
+        {
+            auto & R = _getReverseShard(obj);
+            std::unique_lock<mutex_type> L(R.mutex);
+            R.map.erase(obj);
+        }
+
+        size_t _shardIndex(createInfo_type const & info) const
+        {
+            if constexpr (shard_count == 1)
+            {
+                (void)info;
+                return 0;
+            }
+            else
+            {
+                auto h = _hasher()(info);
+                // the low bits are used by the unordered_map buckets
+                return (h >> 16) % shard_count;
+            }
+        }
+
+        template<typename callable_t>
+        object_type _create(createInfo_type const & info, callable_t && c)
         {
+            auto   shardIndex = _shardIndex(info);
+            auto & S          = m_shards[shardIndex];
+
+            std::shared_future<object_type> pending;
+            {
+                std::shared_lock<mutex_type> L(S.mutex);
+                auto it = S.map.find(info);
+                if(it != S.map.end())
+                {
+                    if(it->second.obj != VK_NULL_HANDLE)
+                    {
+                        _touch(it->second);
+                        m_hits.fetch_add(1, std::memory_order_relaxed);
+                        GVU_COUNT(m_stats.hits, 1);
+                        return it->second.obj;
+                    }
+                    pending = it->second.pending;
+                }
+            }
+
+            if(pending.valid())
+            {
+                GVU_COUNT(m_stats.pendingWaits, 1);
+                return pending.get();
+            }
+
+            // Not in the cache. Insert a pending entry so that
+            // any other thread asking for the same object waits
+            // for us instead of creating another one. Without
+            // concurrency there is nobody to wait, so the promise
+            // is replaced by a plain token which only marks the
+            // entry as ours.
+            std::conditional_t<concurrent, std::promise<object_type>, char> promise = {};
+            {
+                std::unique_lock<mutex_type> L(S.mutex);
+                auto [it, inserted] = S.map.try_emplace(info);
+                if(!inserted)
+                {
+                    if(it->second.obj != VK_NULL_HANDLE)
+                    {
+                        _touch(it->second);
+                        m_hits.fetch_add(1, std::memory_order_relaxed);
+                        GVU_COUNT(m_stats.hits, 1);
+                        return it->second.obj;
+                    }
+                    if constexpr (!concurrent)
+                        throw std::logic_error("The object is already being created");
+                    pending = it->second.pending;
+                }
+                else
+                {
+                    // the stored key is never modified, so its hash
+                    // only needs to be computed once
+                    _seal(it->first, 0);
+                    if constexpr (concurrent)
+                        it->second.pending = promise.get_future().share();
+                    it->second.creator = &promise;
+                    m_misses.fetch_add(1, std::memory_order_relaxed);
+                    GVU_COUNT(m_stats.misses, 1);
+                }
+            }
+
+            if(pending.valid())
+            {
+                GVU_COUNT(m_stats.pendingWaits, 1);
+                return pending.get();
+            }
+
             object_type obj = VK_NULL_HANDLE;
+            try
+            {
+                GVU_SCOPE_TIMED("gvu::Cache_t::create", m_stats.createTime);
+                info.generateVkCreateInfo([&](auto & Ci)
+                {
+                    obj = c(Ci);
+                });
+            }
+            catch(...)
+            {
+                _erasePending(S, info, &promise);
+                if constexpr (concurrent)
+                    promise.set_exception(std::current_exception());
+                throw;
+            }
+
+            if(obj == VK_NULL_HANDLE)
+            {
+                _erasePending(S, info, &promise);
+                auto e = std::make_exception_ptr(std::runtime_error("Could not create object"));
+                if constexpr (concurrent)
+                    promise.set_exception(e);
+                std::rethrow_exception(e);
+            }
+
+            {
+                std::unique_lock<mutex_type> L(S.mutex);
+                auto it = S.map.find(info);
+                if(it == S.map.end() || it->second.creator != &promise)
+                {
+                    // the pending entry was removed by destroy() or destroyIf()
+                    // while the object was being created
+                    L.unlock();
+                    createInfo_type::destroy(m_device, obj);
+                    auto e = std::make_exception_ptr(std::runtime_error("The object was removed from the cache while it was being created"));
+                    if constexpr (concurrent)
+                        promise.set_exception(e);
+                    std::rethrow_exception(e);
+                }
+                auto & E   = it->second;
+                E.obj      = obj;
+                E.pending  = {};
+                E.creator  = nullptr;
+                E.cost     = _cost(it->first, 0);
+                E.lastUse.store(m_frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                m_totalCost.fetch_add(E.cost, std::memory_order_relaxed);
+                S.handles[obj] = &*it;
+
+                // the shard is always locked before the reverse shard
+                auto & R = _getReverseShard(obj);
+                std::unique_lock<mutex_type> RL(R.mutex);
+                R.map[obj] = shardIndex;
+            }
+            if constexpr (concurrent)
+                promise.set_value(obj);
+            return obj;
+        }
+
+        void _erasePending(_shard & S, createInfo_type const & info, void const * creator)
+        {
+            std::unique_lock<mutex_type> L(S.mutex);
+            auto it = S.map.find(info);
+            if(it != S.map.end() && it->second.creator == creator)
+                S.map.erase(it);
+        }
 
-            auto it = m_cache.find(info);
-            if(it != m_cache.end())
+        /**
+         * @brief _evict
+         * @param maxLastUse - only objects last used in or before this frame are evicted
+         * @param targetCost - stop once the total cost is not more than this
+         * @return
+         *
+         * Evicts the least recently used objects first. Each candidate is
+         * checked again and erased while its shard is locked exclusively, so
+         * a concurrent touch(), pin() or destroy() is never lost.
+         */
+        size_t _evict(uint64_t maxLastUse, size_t targetCost)
+        {
+            std::vector<std::tuple<uint64_t, object_type, size_t>> candidates;
+            for(size_t i=0; i < shard_count; i++)
             {
-                return it->second;
+                auto & S = m_shards[i];
+                std::shared_lock<mutex_type> L(S.mutex);
+                for(auto & e : S.map)
+                {
+                    auto lastUse = e.second.lastUse.load(std::memory_order_relaxed);
+                    if(e.second.obj != VK_NULL_HANDLE && lastUse <= maxLastUse && e.second.pins.load(std::memory_order_relaxed) == 0)
+                        candidates.emplace_back(lastUse, e.second.obj, i);
+                }
             }
-            info.generateVkCreateInfo([&](auto & Ci)
+            std::sort(candidates.begin(), candidates.end(), [](auto & a, auto & b)
             {
-                obj = createInfo_type::create(m_device, Ci);
+                return std::get<0>(a) < std::get<0>(b);
             });
 
-            if(obj != VK_NULL_HANDLE)
+            size_t count = 0;
+            for(auto & [lastUse, obj, shardIndex] : candidates)
+            {
+                (void)lastUse;
+                if(m_totalCost.load(std::memory_order_relaxed) <= targetCost && targetCost != 0)
+                    break;
+                {
+                    auto & S = m_shards[shardIndex];
+                    std::unique_lock<mutex_type> L(S.mutex);
+                    auto h = S.handles.find(obj);
+                    // another thread may have used it since it was picked
+                    if(h == S.handles.end()
+                       || h->second->second.lastUse.load(std::memory_order_relaxed) > maxLastUse
+                       || h->second->second.pins.load(std::memory_order_relaxed) != 0)
+                        continue;
+                    _eraseEntry(S, h);
+                }
+                _retire(obj);
+                ++count;
+            }
+            m_evictions.fetch_add(count, std::memory_order_relaxed);
+            return count;
+        }
+
+        void _retire(object_type obj)
+        {
+            if(m_retire)
+            {
+                m_retire([device = m_device, obj]()
+                {
+                    createInfo_type::destroy(device, obj);
+                });
+            }
+            else
             {
-                m_cache[info] = obj;
-                return obj;
+                createInfo_type::destroy(m_device, obj);
             }
-            throw std::runtime_error("Could not create object");
+        }
+
+        void _touch(_entry const & e) const
+        {
+            // only write when the frame changes so hot entries are not
+            // written to by every thread on every lookup
+            auto frame = m_frame.load(std::memory_order_relaxed);
+            if(e.lastUse.load(std::memory_order_relaxed) != frame)
+                e.lastUse.store(frame, std::memory_order_relaxed);
+        }
+
+        template<typename T>
+        static auto _cost(T const & k, int) -> decltype(size_t(k.cost()))
+        {
+            return k.cost();
+        }
+        template<typename T>
+        static size_t _cost(T const &, long)
+        {
+            return 1;
+        }
+
+        template<typename T>
+        static auto _seal(T const & k, int) -> decltype(k.seal(), void())
+        {
+            k.seal();
+        }
+        template<typename T>
+        static void _seal(T const &, long)
+        {
         }
 
         struct _hasher
@@ -98,8 +836,47 @@ class Cache_t
             }
         };
 
-        std::unordered_map<createInfo_type, object_type, _hasher> m_cache;
+        struct _entry
+        {
+            object_type                     obj = VK_NULL_HANDLE;
+            std::shared_future<object_type> pending; // valid while another thread is creating the object
+            size_t                          cost = 0;
+            mutable std::atomic<uint64_t>   lastUse{0}; // the frame it was last looked up in
+            std::atomic<uint32_t>           pins{0};
+            void const *                    creator = nullptr; // the promise of the thread creating the object
+        };
+
+        struct _shard
+        {
+            using handle_map_type = std::unordered_map<object_type, entry_pair_type*>;
+
+            mutable mutex_type                                        mutex;
+            std::unordered_map<createInfo_type, _entry, _hasher>     map;
+            handle_map_type                                           handles; // handle -> node in map, guarded by mutex
+        };
+
+        // handle -> index of the shard which holds it, used for constant time reverse lookups
+        struct _reverseShard
+        {
+            mutable mutex_type                        mutex;
+            std::unordered_map<object_type, size_t>   map;
+        };
+
+        mutable std::array<_shard, shard_count>        m_shards;
+        mutable std::array<_reverseShard, shard_count> m_reverse;
         VkDevice m_device;
+
+        std::atomic<uint64_t>                         m_frame{0};
+        std::atomic<size_t>                           m_totalCost{0};
+        std::atomic<size_t>                           m_evictions{0};
+        std::atomic<uint64_t>                         m_hits{0};
+        std::atomic<uint64_t>                         m_misses{0};
+        size_t                                        m_budget        = std::numeric_limits<size_t>::max();
+        uint64_t                                      m_minIdleFrames = 2;
+        std::function<void(std::function<void()>)>    m_retire;
+#if defined(GVU_ENABLE_INSTRUMENTATION)
+        instrumentation::CacheStats                   m_stats;
+#endif
 };
 
 }
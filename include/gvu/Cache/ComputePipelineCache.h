@@ -0,0 +1,200 @@
+#ifndef GVU_COMPUTE_PIPELINE_CACHE_H
+#define GVU_COMPUTE_PIPELINE_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <functional>
+#include "Cache_t.h"
+#include "../ComputePipelineCreateInfo.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The ComputePipelineCache_t class
+ *
+ * Caches VkPipelines created from a ComputePipelineCreateInfo.
+ *
+ * The VkPipelineCache is not owned by this class, pass the one owned by
+ * a GraphicsPipelineCache so both kinds of pipelines share the same
+ * driver cache, and its cache file:
+ *
+ * gvu::GraphicsPipelineCache graphicsCache;
+ * graphicsCache.init(device, physicalDevice, "pipeline_cache.bin");
+ *
+ * gvu::ComputePipelineCache computeCache;
+ * computeCache.init(device, graphicsCache.getPipelineCache());
+ *
+ * auto pipeline = computeCache.create(cci);
+ *
+ * computeCache.destroy();
+ * graphicsCache.destroy(); // writes the graphics and compute pipelines to pipeline_cache.bin
+ *
+ * The concurrent version can be used to create pipelines from a thread
+ * recording on the dedicated compute queue.
+ */
+template<bool concurrent=false, typename gvuCreateInfo=ComputePipelineCreateInfo>
+class ComputePipelineCache_t
+{
+    public:
+        using cache_type         = Cache_t<gvuCreateInfo, concurrent>;
+        using createInfo_type    = typename cache_type::createInfo_type;
+        using vk_createInfo_type = typename cache_type::vk_createInfo_type;
+        using object_type        = typename cache_type::object_type;
+
+        /**
+         * @brief init
+         * @param device
+         * @param pipelineCache
+         *
+         * Initialize the cache. All pipelines are created through the
+         * pipelineCache, which must outlive this object. It can be
+         * VK_NULL_HANDLE.
+         */
+        void init(VkDevice device, VkPipelineCache pipelineCache = VK_NULL_HANDLE)
+        {
+            m_device        = device;
+            m_pipelineCache = pipelineCache;
+            m_cache.init(device);
+        }
+
+        /**
+         * @brief destroy
+         *
+         * Destroys all the pipelines. The VkPipelineCache is not destroyed.
+         */
+        void destroy()
+        {
+            m_cache.destroy();
+            m_pipelineCache = VK_NULL_HANDLE;
+        }
+
+        /**
+         * @brief create
+         * @param info
+         * @return
+         *
+         * Returns the pipeline for the create info, creating it through the
+         * VkPipelineCache if it does not exist.
+         */
+        object_type create(createInfo_type const & info)
+        {
+            return m_cache.create(info, [this](vk_createInfo_type const & C)
+            {
+                return createInfo_type::create(m_device, m_pipelineCache, C);
+            });
+        }
+
+        VkPipelineCache getPipelineCache() const
+        {
+            return m_pipelineCache;
+        }
+
+        /**
+         * @brief nextFrame
+         *
+         * See Cache_t::nextFrame()
+         */
+        void nextFrame()
+        {
+            m_cache.nextFrame();
+        }
+
+        void setBudget(size_t budget, uint64_t minIdleFrames = 2)
+        {
+            m_cache.setBudget(budget, minIdleFrames);
+        }
+
+        void setRetireFunction(std::function<void(std::function<void()>)> f)
+        {
+            m_cache.setRetireFunction(std::move(f));
+        }
+
+        size_t evictUnused(uint64_t idleFrames)
+        {
+            return m_cache.evictUnused(idleFrames);
+        }
+
+        bool touch(object_type obj) const
+        {
+            return m_cache.touch(obj);
+        }
+
+        bool pin(object_type obj)
+        {
+            return m_cache.pin(obj);
+        }
+
+        bool unpin(object_type obj)
+        {
+            return m_cache.unpin(obj);
+        }
+
+        size_t evictionCount() const
+        {
+            return m_cache.evictionCount();
+        }
+
+        uint64_t frameIndex() const
+        {
+            return m_cache.frameIndex();
+        }
+
+#if defined(GVU_ENABLE_INSTRUMENTATION)
+        instrumentation::CacheStats & stats()
+        {
+            return m_cache.stats();
+        }
+        instrumentation::CacheStats const & stats() const
+        {
+            return m_cache.stats();
+        }
+#endif
+
+        size_t cacheSize() const
+        {
+            return m_cache.cacheSize();
+        }
+
+        createInfo_type getCreateInfo(object_type p) const
+        {
+            return m_cache.getCreateInfo(p);
+        }
+
+        /**
+         * @brief hitCount
+         * @return
+         *
+         * The number of calls to create() which returned an existing
+         * pipeline, see Cache_t::hitCount()
+         */
+        uint64_t hitCount() const
+        {
+            return m_cache.hitCount();
+        }
+
+        /**
+         * @brief missCount
+         * @return
+         *
+         * The number of calls to create() which had to create a new pipeline
+         */
+        uint64_t missCount() const
+        {
+            return m_cache.missCount();
+        }
+
+    private:
+        cache_type            m_cache;
+        VkDevice              m_device        = VK_NULL_HANDLE;
+        VkPipelineCache       m_pipelineCache = VK_NULL_HANDLE;
+};
+
+using ComputePipelineCache           = ComputePipelineCache_t<false>;
+using ConcurrentComputePipelineCache = ComputePipelineCache_t<true>;
+
+using InlineComputePipelineCache           = ComputePipelineCache_t<false, InlineComputePipelineCreateInfo>;
+using ConcurrentInlineComputePipelineCache = ComputePipelineCache_t<true,  InlineComputePipelineCreateInfo>;
+
+}
+
+#endif
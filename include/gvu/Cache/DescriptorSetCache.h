@@ -0,0 +1,421 @@
+#ifndef GVU_DESCRIPTOR_SET_CACHE_H
+#define GVU_DESCRIPTOR_SET_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <list>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+#include "../Hash.h"
+#include "DescriptorSetLayoutCache.h"
+#include "../Managers/DescriptorPoolManager.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The DescriptorWrite struct
+ *
+ * A single descriptor written to a descriptor set. Only the members which
+ * are relevant for the descriptor type should be set, the rest must be
+ * left at their default values so that identical writes compare equal.
+ *
+ * The struct has no padding so that it can be hashed as a block of memory.
+ */
+struct DescriptorWrite
+{
+    uint32_t         binding         = 0;
+    uint32_t         arrayElement    = 0;
+    VkDescriptorType type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uint32_t         _reserved0      = 0;
+
+    // buffer descriptors
+    VkBuffer         buffer          = VK_NULL_HANDLE;
+    VkDeviceSize     offset          = 0;
+    VkDeviceSize     range           = 0;
+
+    // image and sampler descriptors
+    VkSampler        sampler         = VK_NULL_HANDLE;
+    VkImageView      imageView       = VK_NULL_HANDLE;
+
+    // texel buffer descriptors
+    VkBufferView     texelBufferView = VK_NULL_HANDLE;
+
+    VkImageLayout    imageLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+    uint32_t         _reserved1      = 0;
+};
+
+/**
+ * @brief The DescriptorSetContents struct
+ *
+ * Describes a descriptor set by its layout and all the descriptors
+ * written to it. This is the key used by the DescriptorSetCache.
+ *
+ * gvu::DescriptorSetContents C;
+ * C.layout = layout;
+ * C.setBuffer(0, uniformBuffer);
+ * C.setImage( 1, imageView, sampler);
+ */
+struct DescriptorSetContents : public SealedHash<DescriptorSetContents>
+{
+    VkDescriptorSetLayout        layout = VK_NULL_HANDLE;
+    std::vector<DescriptorWrite> writes;
+
+    DescriptorWrite & setBuffer(uint32_t binding,
+                                VkBuffer buffer,
+                                VkDeviceSize offset = 0,
+                                VkDeviceSize range = VK_WHOLE_SIZE,
+                                VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                uint32_t arrayElement = 0)
+    {
+        auto & w = writes.emplace_back();
+        w.binding      = binding;
+        w.arrayElement = arrayElement;
+        w.type         = type;
+        w.buffer       = buffer;
+        w.offset       = offset;
+        w.range        = range;
+        return w;
+    }
+
+    DescriptorWrite & setImage(uint32_t binding,
+                               VkImageView imageView,
+                               VkSampler sampler = VK_NULL_HANDLE,
+                               VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                               VkDescriptorType type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                               uint32_t arrayElement = 0)
+    {
+        auto & w = writes.emplace_back();
+        w.binding      = binding;
+        w.arrayElement = arrayElement;
+        w.type         = type;
+        w.imageView    = imageView;
+        w.sampler      = sampler;
+        w.imageLayout  = imageLayout;
+        return w;
+    }
+
+    DescriptorWrite & setSampler(uint32_t binding, VkSampler sampler, uint32_t arrayElement = 0)
+    {
+        auto & w = writes.emplace_back();
+        w.binding      = binding;
+        w.arrayElement = arrayElement;
+        w.type         = VK_DESCRIPTOR_TYPE_SAMPLER;
+        w.sampler      = sampler;
+        return w;
+    }
+
+    DescriptorWrite & setTexelBuffer(uint32_t binding,
+                                     VkBufferView view,
+                                     VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,
+                                     uint32_t arrayElement = 0)
+    {
+        auto & w = writes.emplace_back();
+        w.binding         = binding;
+        w.arrayElement    = arrayElement;
+        w.type            = type;
+        w.texelBufferView = view;
+        return w;
+    }
+
+    size_t computeHash() const
+    {
+        size_t h = writes.size();
+        hashCombine(h, layout);
+        hashCombineRange(h, writes);
+        return h;
+    }
+
+    /**
+     * Two contents are equal if they have the same layout and
+     * the same writes in the same order.
+     */
+    bool operator==(DescriptorSetContents const & B) const
+    {
+        if(_sealedHashesDiffer(B))
+            return false;
+        return layout == B.layout
+               && rangeEqual(writes, B.writes);
+    }
+
+    /**
+     * @brief update
+     * @param device
+     * @param set
+     *
+     * Write all the descriptors to the set using a single call to
+     * vkUpdateDescriptorSets
+     */
+    void update(VkDevice device, VkDescriptorSet set) const
+    {
+        std::vector<VkWriteDescriptorSet>   W(writes.size());
+        std::vector<VkDescriptorBufferInfo> bufferInfos(writes.size());
+        std::vector<VkDescriptorImageInfo>  imageInfos(writes.size());
+
+        for(size_t i=0;i<writes.size();i++)
+        {
+            auto & w = writes[i];
+            auto & v = W[i];
+            v = {};
+            v.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            v.dstSet          = set;
+            v.dstBinding      = w.binding;
+            v.dstArrayElement = w.arrayElement;
+            v.descriptorType  = w.type;
+            v.descriptorCount = 1;
+
+            switch(w.type)
+            {
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                    bufferInfos[i] = {w.buffer, w.offset, w.range};
+                    v.pBufferInfo  = &bufferInfos[i];
+                    break;
+                case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+                case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                    v.pTexelBufferView = &w.texelBufferView;
+                    break;
+                default:
+                    imageInfos[i] = {w.sampler, w.imageView, w.imageLayout};
+                    v.pImageInfo  = &imageInfos[i];
+                    break;
+            }
+        }
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(W.size()), W.data(), 0, nullptr);
+    }
+};
+
+/**
+ * @brief The DescriptorSetCache class
+ *
+ * Caches descriptor sets by their contents. Requesting a set with the
+ * same layout and the same writes returns the existing VkDescriptorSet
+ * without allocating or updating a new one.
+ *
+ * The sets are allocated from a DescriptorPoolManager per layout. Sets which
+ * have not been used for maxUnusedFrames frames are released back to their
+ * pool when nextFrame() is called. If the cache holds more than maxSets sets,
+ * the least recently used ones are released as well, but never a set which
+ * was used within the last framesInFlight frames, as the GPU may still be
+ * reading it.
+ *
+ * gvu::DescriptorSetCache cache;
+ * cache.init(device, &layoutCache);
+ *
+ * // every frame
+ * auto set = cache.get(contents);
+ * ...
+ * cache.nextFrame();
+ *
+ * Any buffer, image view or sampler referenced by a cached set must not be
+ * destroyed while the set is in the cache. Call release() on the contents
+ * first.
+ */
+class DescriptorSetCache
+{
+public:
+
+    /**
+     * @brief init
+     * @param device
+     * @param cache - a DescriptorSetLayoutCache or ConcurrentDescriptorSetLayoutCache
+     * @param framesInFlight - the number of frames the GPU may still be using a set
+     * @param maxUnusedFrames - sets not used for this many frames are released
+     * @param maxSets - the most sets the cache will hold, if possible
+     * @param setsPerPool - passed to the DescriptorPoolManagers
+     */
+    template<typename layoutCache_t>
+    void init(VkDevice device,
+              layoutCache_t *cache,
+              uint32_t framesInFlight  = 3,
+              uint32_t maxUnusedFrames = 64,
+              size_t   maxSets         = 4096,
+              uint32_t setsPerPool     = 64)
+    {
+        if(maxUnusedFrames < framesInFlight)
+            throw std::invalid_argument("maxUnusedFrames must be at least framesInFlight");
+
+        m_device          = device;
+        m_framesInFlight  = framesInFlight;
+        m_maxUnusedFrames = maxUnusedFrames;
+        m_maxSets         = maxSets;
+        m_frame           = 0;
+
+        m_initPool = [device, cache, setsPerPool](DescriptorPoolManager & M, VkDescriptorSetLayout layout)
+        {
+            M.init(device, cache, layout, setsPerPool);
+        };
+    }
+
+    /**
+     * @brief destroy
+     *
+     * Destroys all the pools. All sets returned by this cache are invalid.
+     */
+    void destroy()
+    {
+        m_map.clear();
+        m_lru.clear();
+        for(auto & [l, M] : m_pools)
+            M->destroy();
+        m_pools.clear();
+    }
+
+    /**
+     * @brief get
+     * @param contents
+     * @return
+     *
+     * Returns a descriptor set with the contents. If one does not exist
+     * a new set is allocated and written.
+     */
+    VkDescriptorSet get(DescriptorSetContents const & contents)
+    {
+        auto it = m_map.find(contents);
+        if(it != m_map.end())
+        {
+            ++m_hits;
+            auto e = it->second;
+            e->lastUsedFrame = m_frame;
+            m_lru.splice(m_lru.begin(), m_lru, e);
+            return e->set;
+        }
+
+        auto & M = _getPoolManager(contents.layout);
+        auto set = M.allocateDescriptorSet();
+        contents.update(m_device, set);
+
+        m_lru.push_front(_entry{contents, set, m_frame});
+        m_lru.front().contents.seal();
+        m_map.emplace(m_lru.front().contents, m_lru.begin());
+
+        ++m_misses;
+        return set;
+    }
+
+    /**
+     * @brief nextFrame
+     *
+     * Advance the frame counter and release the sets which have not
+     * been used recently.
+     */
+    void nextFrame()
+    {
+        ++m_frame;
+
+        while(!m_lru.empty())
+        {
+            auto & e     = m_lru.back();
+            auto unused  = m_frame - e.lastUsedFrame;
+
+            bool expired = unused > m_maxUnusedFrames;
+            bool evict   = m_lru.size() > m_maxSets && unused > m_framesInFlight;
+            if(!expired && !evict)
+                break;
+            _release(std::prev(m_lru.end()));
+        }
+    }
+
+    /**
+     * @brief release
+     * @param contents
+     * @return
+     *
+     * Remove the set with these contents from the cache. The set must no
+     * longer be in use by the GPU. Returns false if the contents are not cached.
+     */
+    bool release(DescriptorSetContents const & contents)
+    {
+        auto it = m_map.find(contents);
+        if(it == m_map.end())
+            return false;
+        _release(it->second);
+        return true;
+    }
+
+    size_t cacheSize() const
+    {
+        return m_map.size();
+    }
+
+    uint64_t hitCount() const
+    {
+        return m_hits;
+    }
+
+    uint64_t missCount() const
+    {
+        return m_misses;
+    }
+
+    uint64_t currentFrame() const
+    {
+        return m_frame;
+    }
+
+protected:
+    struct _entry
+    {
+        DescriptorSetContents contents;
+        VkDescriptorSet       set           = VK_NULL_HANDLE;
+        uint64_t              lastUsedFrame = 0;
+    };
+    using lru_type = std::list<_entry>;
+
+    struct _refHasher
+    {
+        std::size_t operator()(std::reference_wrapper<DescriptorSetContents const> const & k) const
+        {
+            return k.get().hash();
+        }
+    };
+    struct _refEqual
+    {
+        bool operator()(std::reference_wrapper<DescriptorSetContents const> const & a,
+                        std::reference_wrapper<DescriptorSetContents const> const & b) const
+        {
+            return a.get() == b.get();
+        }
+    };
+
+    DescriptorPoolManager & _getPoolManager(VkDescriptorSetLayout layout)
+    {
+        auto & M = m_pools[layout];
+        if(!M)
+        {
+            M = std::make_unique<DescriptorPoolManager>();
+            m_initPool(*M, layout);
+        }
+        return *M;
+    }
+
+    void _release(lru_type::iterator e)
+    {
+        m_pools.at(e->contents.layout)->releaseToPool(e->set);
+        m_map.erase(e->contents);
+        m_lru.erase(e);
+    }
+
+    VkDevice m_device          = VK_NULL_HANDLE;
+    uint32_t m_framesInFlight  = 3;
+    uint32_t m_maxUnusedFrames = 64;
+    size_t   m_maxSets         = 4096;
+    uint64_t m_frame           = 0;
+    uint64_t m_hits            = 0;
+    uint64_t m_misses          = 0;
+
+    // the keys reference the contents stored in the lru list
+    lru_type m_lru; // front is the most recently used
+    std::unordered_map<std::reference_wrapper<DescriptorSetContents const>, lru_type::iterator, _refHasher, _refEqual> m_map;
+    std::unordered_map<VkDescriptorSetLayout, std::unique_ptr<DescriptorPoolManager>>                               m_pools;
+
+    std::function<void(DescriptorPoolManager&, VkDescriptorSetLayout)> m_initPool;
+};
+
+}
+
+#endif
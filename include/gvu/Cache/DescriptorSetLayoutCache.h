@@ -6,12 +6,14 @@
 #include <tuple>
 #include <unordered_map>
 #include <cassert>
+#include <stdexcept>
 #include "Cache_t.h"
+#include "../Hash.h"
 
 namespace gvu
 {
 
-struct DescriptorSetLayoutCreateInfo
+struct DescriptorSetLayoutCreateInfo : public SealedHash<DescriptorSetLayoutCreateInfo>
 {
     using create_info_type = VkDescriptorSetLayoutCreateInfo;
     using object_type = VkDescriptorSetLayout;
@@ -19,64 +21,141 @@ struct DescriptorSetLayoutCreateInfo
     std::vector<VkDescriptorSetLayoutBinding> bindings;
     VkDescriptorSetLayoutCreateFlags          flags = {};
 
-    size_t hash() const
-    {
-        std::hash<size_t> Hs;
-        auto h = Hs(bindings.size());
-
-        auto hash_combine = [](std::size_t& seed, const auto& v)
-        {
-            std::hash<std::decay_t<decltype(v)> > hasher;
-            seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-        };
+    // Optional. If not empty, it must have one entry per binding and is
+    // passed using VkDescriptorSetLayoutBindingFlagsCreateInfo (descriptor indexing)
+    std::vector<VkDescriptorBindingFlags>     bindingFlags;
 
+    size_t computeHash() const
+    {
+        size_t h = bindings.size();
         for(auto & b : bindings)
         {
-            hash_combine(h, b.descriptorCount);
-            hash_combine(h, static_cast<uint32_t>(b.descriptorType));
-            hash_combine(h, static_cast<uint32_t>(b.stageFlags));
+            hashCombine(h, b.binding);
+            hashCombine(h, b.descriptorType);
+            hashCombine(h, b.descriptorCount);
+            hashCombine(h, b.stageFlags);
+            auto samplers = _immutableSamplers(b);
+            hashCombine(h, samplers != nullptr);
+            if(samplers)
+                hashCombineArray(h, samplers, b.descriptorCount);
         }
-        hash_combine(h, static_cast<uint32_t>(flags));
+        hashCombine(h, flags);
+        hashCombine(h, bindingFlags.size());
+        hashCombineRange(h, bindingFlags);
         return h;
     }
 
+    /**
+     * Two create infos are equal if all their bindings are identical,
+     * in the same order, and the flags and binding flags are the same.
+     *
+     * pImmutableSamplers is compared by the samplers it points to, and is
+     * ignored for descriptor types which do not use samplers. Copies own
+     * their samplers (see the copy constructor), so the array only has to
+     * stay valid until the create info is copied or passed to a cache.
+     */
     bool operator==(DescriptorSetLayoutCreateInfo const & B) const
     {
-        if(bindings.size() == B.bindings.size())
+        if(_sealedHashesDiffer(B))
+            return false;
+        if(flags != B.flags || bindings.size() != B.bindings.size() || !rangeEqual(bindingFlags, B.bindingFlags))
+            return false;
+        for(size_t i=0; i < bindings.size(); i++)
         {
-            return std::equal(bindings.begin(),bindings.end(),B.bindings.begin(),
-                       [](auto const & a, auto const & b)
-            {
-                return std::tie(a.binding,a.descriptorCount,a.descriptorType,a.stageFlags,a.pImmutableSamplers) ==
-                        std::tie(b.binding,b.descriptorCount,b.descriptorType,b.stageFlags,b.pImmutableSamplers);
-            });
+            if(!_bindingEqual(bindings[i], B.bindings[i]))
+                return false;
         }
         return true;
     }
 
+    /**
+     * @brief hasBindingFlag
+     * @param flag
+     * @return
+     *
+     * Returns true if any of the bindings has flag set
+     */
+    bool hasBindingFlag(VkDescriptorBindingFlags flag) const
+    {
+        for(auto f : bindingFlags)
+        {
+            if(f & flag)
+                return true;
+        }
+        return false;
+    }
+
     DescriptorSetLayoutCreateInfo() = default;
+
+    /**
+     * Copies the immutable samplers of every binding into storage owned by
+     * the copy and points pImmutableSamplers at it. The caches store a copy
+     * of the create info, so their keys never refer to the caller's arrays.
+     */
+    DescriptorSetLayoutCreateInfo(DescriptorSetLayoutCreateInfo const & B)
+        : SealedHash<DescriptorSetLayoutCreateInfo>(B),
+          bindings(B.bindings),
+          flags(B.flags),
+          bindingFlags(B.bindingFlags)
+    {
+        _ownImmutableSamplers();
+    }
+
+    DescriptorSetLayoutCreateInfo & operator=(DescriptorSetLayoutCreateInfo const & B)
+    {
+        if(this == &B)
+            return *this;
+        SealedHash<DescriptorSetLayoutCreateInfo>::operator=(B);
+        bindings     = B.bindings;
+        flags        = B.flags;
+        bindingFlags = B.bindingFlags;
+        _ownImmutableSamplers();
+        return *this;
+    }
+
+    // moving keeps the inner vectors, so the pointers stay valid
+    DescriptorSetLayoutCreateInfo(DescriptorSetLayoutCreateInfo &&) = default;
+    DescriptorSetLayoutCreateInfo & operator=(DescriptorSetLayoutCreateInfo &&) = default;
+
     DescriptorSetLayoutCreateInfo(VkDescriptorSetLayoutCreateInfo const & info)
     {
         flags = info.flags;
         for(uint32_t i=0;i<info.bindingCount;i++)
         {
-            if(info.pBindings[i].pImmutableSamplers == nullptr)
+            bindings.push_back(info.pBindings[i]);
+        }
+        auto next = static_cast<VkBaseInStructure const*>(info.pNext);
+        for(; next; next = next->pNext)
+        {
+            if(next->sType == VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO)
             {
-                throw std::runtime_error("Immutable samplers not currently supported");
+                auto F = reinterpret_cast<VkDescriptorSetLayoutBindingFlagsCreateInfo const*>(next);
+                bindingFlags.assign(F->pBindingFlags, F->pBindingFlags + F->bindingCount);
             }
-
-            bindings.push_back(info.pBindings[i]);
         }
+        _ownImmutableSamplers();
     }
 
     template<typename callable_t>
     void generateVkCreateInfo(callable_t && c) const
     {
+        // the bindings of a copy already point at its own samplers
         create_info_type ci = {};
         ci.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         ci.pBindings          = bindings.data();
         ci.bindingCount       = static_cast<uint32_t>(bindings.size());
         ci.flags              = flags;
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo F = {};
+        if(!bindingFlags.empty())
+        {
+            if(bindingFlags.size() != bindings.size())
+                throw std::invalid_argument("bindingFlags must have one entry per binding");
+            F.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+            F.bindingCount  = static_cast<uint32_t>(bindingFlags.size());
+            F.pBindingFlags = bindingFlags.data();
+            ci.pNext        = &F;
+        }
         c(ci);
     }
 
@@ -93,9 +172,52 @@ struct DescriptorSetLayoutCreateInfo
         vkDestroyDescriptorSetLayout(device, c, nullptr);
     }
 
+protected:
+    void _ownImmutableSamplers()
+    {
+        // read everything before m_immutableSamplers is modified, the
+        // bindings may point into it when copying from ourselves
+        std::vector<std::vector<VkSampler>> owned(bindings.size());
+        for(size_t i=0; i < bindings.size(); i++)
+        {
+            if(auto s = _immutableSamplers(bindings[i]))
+                owned[i].assign(s, s + bindings[i].descriptorCount);
+        }
+        m_immutableSamplers = std::move(owned);
+        for(size_t i=0; i < bindings.size(); i++)
+        {
+            if(!m_immutableSamplers[i].empty())
+                bindings[i].pImmutableSamplers = m_immutableSamplers[i].data();
+        }
+    }
+
+    // the immutable samplers of the binding, or null if it has none
+    static VkSampler const * _immutableSamplers(VkDescriptorSetLayoutBinding const & b)
+    {
+        if(b.descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER && b.descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+            return nullptr;
+        if(b.descriptorCount == 0)
+            return nullptr;
+        return b.pImmutableSamplers;
+    }
+
+    static bool _bindingEqual(VkDescriptorSetLayoutBinding const & a, VkDescriptorSetLayoutBinding const & b)
+    {
+        if(a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags)
+            return false;
+        auto sa = _immutableSamplers(a);
+        auto sb = _immutableSamplers(b);
+        if(!sa || !sb)
+            return sa == sb;
+        return podEqual(sa, sb, a.descriptorCount);
+    }
+
+    // indexed by binding, empty if the binding has no immutable samplers
+    std::vector<std::vector<VkSampler>> m_immutableSamplers;
 };
 
 using DescriptorSetLayoutCache = Cache_t<DescriptorSetLayoutCreateInfo>;
+using ConcurrentDescriptorSetLayoutCache = Cache_t<DescriptorSetLayoutCreateInfo, true>;
 
 }
 
@@ -0,0 +1,304 @@
+#ifndef GVU_DESCRIPTOR_UPDATE_TEMPLATE_CACHE_H
+#define GVU_DESCRIPTOR_UPDATE_TEMPLATE_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "Cache_t.h"
+#include "../Hash.h"
+#include "DescriptorSetLayoutCache.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The DescriptorUpdateTemplateCreateInfo struct
+ *
+ * Describes a VkDescriptorUpdateTemplate. Use the constructor taking a
+ * DescriptorSetLayoutCreateInfo to generate the entries for every
+ * binding of the layout. The descriptors are tightly packed in binding
+ * order:
+ *
+ *   uniform/storage buffers       -> VkDescriptorBufferInfo
+ *   samplers/images/input attach. -> VkDescriptorImageInfo
+ *   texel buffers                 -> VkBufferView
+ *
+ * All three are 8 byte aligned and a multiple of 8 bytes in size, so a
+ * C++ struct with one member (or array) per binding in the same order has
+ * exactly the same layout. See spirvPipelineReflector::generateDescriptorStructDeclaration().
+ *
+ * Use DescriptorUpdateData to fill in the data at runtime.
+ */
+struct DescriptorUpdateTemplateCreateInfo : public SealedHash<DescriptorUpdateTemplateCreateInfo>
+{
+    using create_info_type = VkDescriptorUpdateTemplateCreateInfo;
+    using object_type      = VkDescriptorUpdateTemplate;
+
+    VkDescriptorUpdateTemplateCreateFlags        flags               = {};
+    std::vector<VkDescriptorUpdateTemplateEntry> entries;
+    VkDescriptorUpdateTemplateType               templateType        = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+    VkDescriptorSetLayout                        descriptorSetLayout = VK_NULL_HANDLE;
+    VkPipelineBindPoint                          pipelineBindPoint   = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    VkPipelineLayout                             pipelineLayout      = VK_NULL_HANDLE;
+    uint32_t                                     set                 = 0;
+
+    DescriptorUpdateTemplateCreateInfo() = default;
+
+    /**
+     * @brief DescriptorUpdateTemplateCreateInfo
+     * @param layoutInfo
+     * @param layout - the layout created from layoutInfo
+     *
+     * Generates one entry per binding, packed in binding order. The
+     * bindings of the layout do not need to be declared in order.
+     */
+    DescriptorUpdateTemplateCreateInfo(DescriptorSetLayoutCreateInfo const & layoutInfo, VkDescriptorSetLayout layout)
+    {
+        descriptorSetLayout = layout;
+
+        auto bindings = layoutInfo.bindings;
+        std::sort(bindings.begin(), bindings.end(), [](auto & a, auto & b)
+        {
+            return a.binding < b.binding;
+        });
+
+        size_t offset = 0;
+        for(auto & b : bindings)
+        {
+            auto & e           = entries.emplace_back();
+            e.dstBinding       = b.binding;
+            e.dstArrayElement  = 0;
+            e.descriptorCount  = b.descriptorCount;
+            e.descriptorType   = b.descriptorType;
+            e.offset           = offset;
+            e.stride           = descriptorInfoSize(b.descriptorType);
+            offset            += e.stride * b.descriptorCount;
+        }
+    }
+
+    /**
+     * @brief descriptorInfoSize
+     * @param type
+     * @return
+     *
+     * Returns the size of the struct which is used to write a descriptor of this type.
+     */
+    static size_t descriptorInfoSize(VkDescriptorType type)
+    {
+        switch(type)
+        {
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                return sizeof(VkDescriptorBufferInfo);
+            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                return sizeof(VkBufferView);
+            case VK_DESCRIPTOR_TYPE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+                return sizeof(VkDescriptorImageInfo);
+            default:
+                throw std::invalid_argument("Descriptor type is not supported by update templates");
+        }
+    }
+
+    /**
+     * @brief dataSize
+     * @return
+     *
+     * The number of bytes of the data passed to vkUpdateDescriptorSetWithTemplate
+     */
+    size_t dataSize() const
+    {
+        size_t s = 0;
+        for(auto & e : entries)
+            s = std::max(s, e.offset + e.stride * e.descriptorCount);
+        return s;
+    }
+
+    /**
+     * @brief findEntry
+     * @param binding
+     * @return
+     *
+     * Returns the entry for the binding, or nullptr if there is none.
+     */
+    VkDescriptorUpdateTemplateEntry const * findEntry(uint32_t binding) const
+    {
+        for(auto & e : entries)
+        {
+            if(e.dstBinding == binding)
+                return &e;
+        }
+        return nullptr;
+    }
+
+    size_t computeHash() const
+    {
+        // the entries are hashed as a block of memory so
+        // make sure there is no padding
+        static_assert(std::has_unique_object_representations_v<VkDescriptorUpdateTemplateEntry>);
+
+        size_t h = entries.size();
+        hashCombineRange(h, entries);
+        hashCombine(h, flags);
+        hashCombine(h, templateType);
+        hashCombine(h, descriptorSetLayout);
+        hashCombine(h, pipelineBindPoint);
+        hashCombine(h, pipelineLayout);
+        hashCombine(h, set);
+        return h;
+    }
+
+    bool operator==(DescriptorUpdateTemplateCreateInfo const & B) const
+    {
+        if(_sealedHashesDiffer(B))
+            return false;
+        return flags                  == B.flags
+               && templateType        == B.templateType
+               && descriptorSetLayout == B.descriptorSetLayout
+               && pipelineBindPoint   == B.pipelineBindPoint
+               && pipelineLayout      == B.pipelineLayout
+               && set                 == B.set
+               && rangeEqual(entries, B.entries);
+    }
+
+    template<typename callable_t>
+    void generateVkCreateInfo(callable_t && c) const
+    {
+        create_info_type ci = {};
+        ci.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        ci.flags                      = flags;
+        ci.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+        ci.pDescriptorUpdateEntries   = entries.data();
+        ci.templateType               = templateType;
+        ci.descriptorSetLayout        = descriptorSetLayout;
+        ci.pipelineBindPoint          = pipelineBindPoint;
+        ci.pipelineLayout             = pipelineLayout;
+        ci.set                        = set;
+        c(ci);
+    }
+
+    static object_type create(VkDevice device, create_info_type const & C)
+    {
+        object_type obj = VK_NULL_HANDLE;
+        auto result = vkCreateDescriptorUpdateTemplate(device, &C, nullptr, &obj);
+        if( result != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+        return obj;
+    }
+    static void destroy(VkDevice device, object_type c)
+    {
+        vkDestroyDescriptorUpdateTemplate(device, c, nullptr);
+    }
+};
+
+/**
+ * @brief The DescriptorUpdateData struct
+ *
+ * A contiguous block of memory laid out according to a
+ * DescriptorUpdateTemplateCreateInfo. Fill in the descriptors and then
+ * update a set with a single call:
+ *
+ * gvu::DescriptorUpdateData D(templateInfo);
+ * D.setBuffer(0, {buffer, 0, VK_WHOLE_SIZE});
+ * D.setImage( 1, {sampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+ *
+ * D.update(device, set, updateTemplate);
+ *
+ * The template info must outlive this object.
+ */
+struct DescriptorUpdateData
+{
+    DescriptorUpdateData() = default;
+    DescriptorUpdateData(DescriptorUpdateTemplateCreateInfo const & info) : m_info(&info)
+    {
+        m_data.resize( (info.dataSize() + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+    }
+
+    void setBuffer(uint32_t binding, VkDescriptorBufferInfo const & b, uint32_t arrayElement = 0)
+    {
+        _write(binding, arrayElement, &b, sizeof(b), _Kind::buffer);
+    }
+    void setImage(uint32_t binding, VkDescriptorImageInfo const & i, uint32_t arrayElement = 0)
+    {
+        _write(binding, arrayElement, &i, sizeof(i), _Kind::image);
+    }
+    void setTexelBuffer(uint32_t binding, VkBufferView v, uint32_t arrayElement = 0)
+    {
+        _write(binding, arrayElement, &v, sizeof(v), _Kind::texelBuffer);
+    }
+
+    void const * data() const
+    {
+        return m_data.data();
+    }
+    size_t size() const
+    {
+        return m_info ? m_info->dataSize() : 0;
+    }
+
+    /**
+     * @brief update
+     * @param device
+     * @param set
+     * @param updateTemplate - a template created from the same DescriptorUpdateTemplateCreateInfo
+     */
+    void update(VkDevice device, VkDescriptorSet set, VkDescriptorUpdateTemplate updateTemplate) const
+    {
+        vkUpdateDescriptorSetWithTemplate(device, set, updateTemplate, m_data.data());
+    }
+
+protected:
+    enum class _Kind
+    {
+        buffer,
+        image,
+        texelBuffer
+    };
+
+    static _Kind _kind(VkDescriptorType type)
+    {
+        switch(type)
+        {
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                return _Kind::buffer;
+            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                return _Kind::texelBuffer;
+            default:
+                return _Kind::image;
+        }
+    }
+
+    void _write(uint32_t binding, uint32_t arrayElement, void const * src, size_t bytes, _Kind kind)
+    {
+        auto e = m_info ? m_info->findEntry(binding) : nullptr;
+        if(!e || arrayElement >= e->descriptorCount)
+            throw std::out_of_range("Binding is not part of the update template");
+        if(_kind(e->descriptorType) != kind)
+            throw std::invalid_argument("Descriptor info does not match the descriptor type of the binding");
+
+        std::memcpy(reinterpret_cast<uint8_t*>(m_data.data()) + e->offset + e->stride * arrayElement, src, bytes);
+    }
+
+    DescriptorUpdateTemplateCreateInfo const * m_info = nullptr;
+    std::vector<uint64_t>                      m_data; // uint64_t so the data is 8 byte aligned
+};
+
+using DescriptorUpdateTemplateCache           = Cache_t<DescriptorUpdateTemplateCreateInfo>;
+using ConcurrentDescriptorUpdateTemplateCache = Cache_t<DescriptorUpdateTemplateCreateInfo, true>;
+
+}
+
+#endif
@@ -0,0 +1,363 @@
+#ifndef GVU_FRAMEBUFFER_CACHE_H
+#define GVU_FRAMEBUFFER_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "Cache_t.h"
+#include "ImageViewCache.h"
+#include "RenderPassCache.h"
+#include "../Hash.h"
+
+namespace gvu
+{
+
+struct FramebufferCreateInfo : public SealedHash<FramebufferCreateInfo>
+{
+    using create_info_type = VkFramebufferCreateInfo;
+    using object_type      = VkFramebuffer;
+
+    VkFramebufferCreateFlags flags      = {};
+    VkRenderPass             renderPass = VK_NULL_HANDLE;
+    std::vector<VkImageView> attachments;
+    uint32_t                 width      = 0;
+    uint32_t                 height     = 0;
+    uint32_t                 layers     = 1;
+
+    size_t computeHash() const
+    {
+        size_t h = 0x7A3B1C9D5E2F4061u;
+
+        hashCombine(h, flags);
+        hashCombine(h, renderPass);
+        hashCombineRange(h, attachments);
+        hashCombine(h, width);
+        hashCombine(h, height);
+        hashCombine(h, layers);
+
+        return h;
+    }
+
+    bool operator==(FramebufferCreateInfo const & B) const
+    {
+        if(_sealedHashesDiffer(B))
+            return false;
+        return
+        flags           == B.flags
+        && renderPass   == B.renderPass
+        && attachments  == B.attachments
+        && width        == B.width
+        && height       == B.height
+        && layers       == B.layers;
+    }
+
+    FramebufferCreateInfo()
+    {
+    }
+    FramebufferCreateInfo(create_info_type const & info)
+    {
+        flags      = info.flags     ;
+        renderPass = info.renderPass;
+        width      = info.width     ;
+        height     = info.height    ;
+        layers     = info.layers    ;
+        attachments.assign(info.pAttachments, info.pAttachments + info.attachmentCount);
+    }
+
+    /**
+     * @brief createSimpleFramebuffer
+     * @param renderPass
+     * @param attachments
+     * @param extent
+     * @param layers
+     * @return
+     *
+     * The attachments must be in the same order as the attachments of
+     * the render pass.
+     */
+    static FramebufferCreateInfo createSimpleFramebuffer(VkRenderPass renderPass, std::vector<VkImageView> attachments, VkExtent2D extent, uint32_t layers = 1)
+    {
+        FramebufferCreateInfo F;
+        F.renderPass  = renderPass;
+        F.attachments = std::move(attachments);
+        F.width       = extent.width;
+        F.height      = extent.height;
+        F.layers      = layers;
+        return F;
+    }
+
+    bool usesImageView(VkImageView view) const
+    {
+        return std::find(attachments.begin(), attachments.end(), view) != attachments.end();
+    }
+
+    template<typename callable_t>
+    void generateVkCreateInfo(callable_t && c) const
+    {
+        VkFramebufferCreateInfo ci = {};
+        ci.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        ci.flags           = flags     ;
+        ci.renderPass      = renderPass;
+        ci.attachmentCount = static_cast<uint32_t>(attachments.size());
+        ci.pAttachments    = attachments.data();
+        ci.width           = width     ;
+        ci.height          = height    ;
+        ci.layers          = layers    ;
+        c(ci);
+    }
+
+    static object_type create(VkDevice device, create_info_type const & C)
+    {
+        object_type obj = VK_NULL_HANDLE;
+        auto result = vkCreateFramebuffer(device, &C, nullptr, &obj);
+        if( result != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+        return obj;
+    }
+    static void destroy(VkDevice device, object_type c)
+    {
+        vkDestroyFramebuffer(device, c, nullptr);
+    }
+};
+
+/**
+ * @brief The FramebufferCache_t class
+ *
+ * Caches VkFramebuffers, keyed by the render pass, the attachments and
+ * the size. The image views of the attachments are created through an
+ * ImageViewCache, so a framebuffer can be built from a render pass and
+ * its images with a single call:
+ *
+ * gvu::ImageViewCache   viewCache;
+ * gvu::FramebufferCache fbCache;
+ * viewCache.init(device);
+ * fbCache.init(device, &viewCache);
+ *
+ * auto rpInfo = gvu::RenderPassCreateInfo::createSimpleRenderPass({{VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL}},
+ *                                                                 {VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL});
+ * auto renderPass = rpCache.create(rpInfo);
+ *
+ * auto fb = fbCache.create(renderPass, rpInfo, {colorImage, depthImage}, extent);
+ *
+ * Framebuffers and image views refer to other objects, so they must be
+ * invalidated before those objects are destroyed. Before destroying an
+ * image, call invalidateImage(), which destroys its views and every
+ * framebuffer which uses them. An ImageCache can do this automatically:
+ *
+ * imageCache.setImageDestroyedCallback([&](VkImage i){ fbCache.invalidateImage(i); });
+ *
+ * The GPU must have finished using the destroyed objects.
+ */
+template<bool concurrent=false>
+class FramebufferCache_t
+{
+    public:
+        using cache_type          = Cache_t<FramebufferCreateInfo, concurrent>;
+        using imageViewCache_type = Cache_t<ImageViewCreateInfo, concurrent>;
+        using createInfo_type     = typename cache_type::createInfo_type;
+        using object_type         = typename cache_type::object_type;
+
+        /**
+         * @brief init
+         * @param device
+         * @param viewCache
+         *
+         * The viewCache is owned by the caller and is only needed to build
+         * framebuffers from images, or to invalidate images.
+         */
+        void init(VkDevice device, imageViewCache_type * viewCache = nullptr)
+        {
+            m_cache.init(device);
+            m_viewCache = viewCache;
+        }
+
+        /**
+         * @brief destroy
+         *
+         * Destroys all the framebuffers. The image views are owned by the
+         * image view cache.
+         */
+        void destroy()
+        {
+            m_cache.destroy();
+        }
+
+        object_type create(createInfo_type const & info)
+        {
+            return m_cache.create(info);
+        }
+
+        /**
+         * @brief create
+         * @param renderPass
+         * @param renderPassInfo - the create info renderPass was created with
+         * @param images - one image per attachment of the render pass
+         * @param extent
+         * @return
+         *
+         * Creates (or reuses) a view of each image, using the format of the
+         * matching render pass attachment, and returns the framebuffer.
+         */
+        object_type create(VkRenderPass renderPass, RenderPassCreateInfo const & renderPassInfo, std::vector<VkImage> const & images, VkExtent2D extent)
+        {
+            if(m_viewCache == nullptr)
+                throw std::logic_error("An ImageViewCache must be given to init() to create framebuffers from images");
+            if(images.size() != renderPassInfo.attachments.size())
+                throw std::invalid_argument("The number of images does not match the number of attachments in the render pass");
+
+            FramebufferCreateInfo F;
+            F.renderPass = renderPass;
+            F.width      = extent.width;
+            F.height     = extent.height;
+            for(size_t i=0; i < images.size(); i++)
+            {
+                F.attachments.push_back( m_viewCache->create( ImageViewCreateInfo::createSimpleImageView(images[i], renderPassInfo.attachments[i].format) ) );
+            }
+            return m_cache.create(F);
+        }
+
+        /**
+         * @brief invalidateImageView
+         * @param view
+         * @return
+         *
+         * Destroys every framebuffer which uses the view. Returns the number
+         * of framebuffers destroyed.
+         */
+        size_t invalidateImageView(VkImageView view)
+        {
+            return m_cache.destroyIf([view](createInfo_type const & F)
+            {
+                return F.usesImageView(view);
+            }).size();
+        }
+
+        /**
+         * @brief invalidateImage
+         * @param image
+         * @return
+         *
+         * Destroys every view of the image in the image view cache, and
+         * every framebuffer which uses one of those views. Call this before
+         * destroying the image. Returns the number of framebuffers destroyed.
+         */
+        size_t invalidateImage(VkImage image)
+        {
+            if(m_viewCache == nullptr)
+                return 0;
+
+            auto views = m_viewCache->destroyIf([image](ImageViewCreateInfo const & V)
+            {
+                return V.image == image;
+            });
+            if(views.empty())
+                return 0;
+
+            return m_cache.destroyIf([&views](createInfo_type const & F)
+            {
+                for(auto v : views)
+                {
+                    if(F.usesImageView(v))
+                        return true;
+                }
+                return false;
+            }).size();
+        }
+
+        /**
+         * @brief invalidateRenderPass
+         * @param renderPass
+         * @return
+         *
+         * Destroys every framebuffer created with the render pass.
+         */
+        size_t invalidateRenderPass(VkRenderPass renderPass)
+        {
+            return m_cache.destroyIf([renderPass](createInfo_type const & F)
+            {
+                return F.renderPass == renderPass;
+            }).size();
+        }
+
+        /**
+         * @brief nextFrame
+         *
+         * See Cache_t::nextFrame()
+         */
+        void nextFrame()
+        {
+            m_cache.nextFrame();
+        }
+
+        void setBudget(size_t budget, uint64_t minIdleFrames = 2)
+        {
+            m_cache.setBudget(budget, minIdleFrames);
+        }
+
+        void setRetireFunction(std::function<void(std::function<void()>)> f)
+        {
+            m_cache.setRetireFunction(std::move(f));
+        }
+
+        size_t evictUnused(uint64_t idleFrames)
+        {
+            return m_cache.evictUnused(idleFrames);
+        }
+
+        bool touch(object_type obj) const
+        {
+            return m_cache.touch(obj);
+        }
+
+        bool pin(object_type obj)
+        {
+            return m_cache.pin(obj);
+        }
+
+        bool unpin(object_type obj)
+        {
+            return m_cache.unpin(obj);
+        }
+
+        size_t evictionCount() const
+        {
+            return m_cache.evictionCount();
+        }
+
+        uint64_t frameIndex() const
+        {
+            return m_cache.frameIndex();
+        }
+
+#if defined(GVU_ENABLE_INSTRUMENTATION)
+        instrumentation::CacheStats & stats()
+        {
+            return m_cache.stats();
+        }
+        instrumentation::CacheStats const & stats() const
+        {
+            return m_cache.stats();
+        }
+#endif
+
+        size_t cacheSize() const
+        {
+            return m_cache.cacheSize();
+        }
+
+        createInfo_type getCreateInfo(object_type obj) const
+        {
+            return m_cache.getCreateInfo(obj);
+        }
+
+    protected:
+        cache_type            m_cache;
+        imageViewCache_type * m_viewCache = nullptr;
+};
+
+using FramebufferCache           = FramebufferCache_t<false>;
+using ConcurrentFramebufferCache = FramebufferCache_t<true>;
+
+}
+#endif
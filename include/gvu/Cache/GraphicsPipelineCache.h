@@ -0,0 +1,367 @@
+#ifndef GVU_GRAPHICS_PIPELINE_CACHE_H
+#define GVU_GRAPHICS_PIPELINE_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include "Cache_t.h"
+#include "../GraphicsPipelineCreateInfo.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The GraphicsPipelineCache_t class
+ *
+ * Caches VkPipelines created from a GraphicsPipelineCreateInfo. All
+ * pipelines are created through a single VkPipelineCache which is owned
+ * by this class.
+ *
+ * If a path is provided to init(), the VkPipelineCache data is loaded
+ * from that file, and saved back to it when destroy() is called. The
+ * data is only loaded if its header matches the physical device
+ * (vendorID, deviceID and pipelineCacheUUID), otherwise the pipeline
+ * cache starts empty.
+ *
+ * gvu::GraphicsPipelineCache cache;
+ * cache.init(device, physicalDevice, "pipeline_cache.bin");
+ *
+ * auto pipeline = cache.create(gci);
+ *
+ * cache.destroy(); // writes pipeline_cache.bin
+ *
+ * Use InlineGraphicsPipelineCache to cache InlineGraphicsPipelineCreateInfos,
+ * whose keys never allocate memory.
+ */
+template<bool concurrent=false, typename gvuCreateInfo=GraphicsPipelineCreateInfo>
+class GraphicsPipelineCache_t
+{
+    public:
+        using cache_type         = Cache_t<gvuCreateInfo, concurrent>;
+        using createInfo_type    = typename cache_type::createInfo_type;
+        using vk_createInfo_type = typename cache_type::vk_createInfo_type;
+        using object_type        = typename cache_type::object_type;
+
+        /**
+         * @brief init
+         * @param device
+         * @param physicalDevice
+         * @param cacheFile
+         *
+         * Initialize the cache. If cacheFile is not empty and the file
+         * exists, the VkPipelineCache is created with its contents.
+         */
+        void init(VkDevice device, VkPhysicalDevice physicalDevice, guv::fs::path const & cacheFile = {})
+        {
+            m_device    = device;
+            m_cacheFile = cacheFile;
+            m_cache.init(device);
+
+            vkGetPhysicalDeviceProperties(physicalDevice, &m_properties);
+
+            std::vector<uint8_t> data;
+            if(!m_cacheFile.empty())
+            {
+                data = _readFile(m_cacheFile);
+                if(!isCompatible(data, m_properties))
+                    data.clear();
+            }
+
+            VkPipelineCacheCreateInfo ci = {};
+            ci.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            ci.initialDataSize = data.size();
+            ci.pInitialData    = data.empty() ? nullptr : data.data();
+
+            auto result = vkCreatePipelineCache(m_device, &ci, nullptr, &m_pipelineCache);
+            if(result != VK_SUCCESS && !data.empty())
+            {
+                // the driver rejected the data, start with an empty cache
+                ci.initialDataSize = 0;
+                ci.pInitialData    = nullptr;
+                result = vkCreatePipelineCache(m_device, &ci, nullptr, &m_pipelineCache);
+                data.clear();
+            }
+            if(result != VK_SUCCESS)
+                throw std::runtime_error("Could not create the VkPipelineCache");
+
+            m_loadedFromDisk = !data.empty();
+        }
+
+        /**
+         * @brief destroy
+         *
+         * Saves the pipeline cache to disk (if a file was given to init())
+         * and destroys all pipelines and the VkPipelineCache.
+         */
+        void destroy()
+        {
+            if(m_pipelineCache == VK_NULL_HANDLE)
+                return;
+
+            if(!m_cacheFile.empty())
+                save(m_cacheFile);
+
+            m_cache.destroy();
+            vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+            m_pipelineCache = VK_NULL_HANDLE;
+        }
+
+        /**
+         * @brief create
+         * @param info
+         * @return
+         *
+         * Returns the pipeline for the create info, creating it through the
+         * VkPipelineCache if it does not exist.
+         */
+        object_type create(createInfo_type const & info)
+        {
+            return m_cache.create(info, [this](vk_createInfo_type const & C)
+            {
+                return createInfo_type::create(m_device, m_pipelineCache, C);
+            });
+        }
+
+        /**
+         * @brief find
+         * @param info
+         * @return
+         *
+         * Returns the pipeline if it is in the cache, or VK_NULL_HANDLE.
+         * Never creates a pipeline.
+         */
+        object_type find(createInfo_type const & info) const
+        {
+            return m_cache.find(info);
+        }
+
+        /**
+         * @brief save
+         * @param path
+         * @return
+         *
+         * Write the current VkPipelineCache data to a file. The data
+         * is written to a temporary file first and then renamed, so a
+         * crash while writing does not leave a corrupted cache file.
+         */
+        bool save(guv::fs::path const & path) const
+        {
+            auto data = getPipelineCacheData();
+            if(data.empty())
+                return false;
+
+            auto tmp = path;
+            tmp += ".tmp";
+            {
+                std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                if(!out)
+                    return false;
+                out.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+                if(!out)
+                    return false;
+            }
+            std::error_code ec;
+            guv::fs::rename(tmp, path, ec);
+            return !ec;
+        }
+
+        /**
+         * @brief getPipelineCacheData
+         * @return
+         *
+         * Returns the raw data of the VkPipelineCache
+         */
+        std::vector<uint8_t> getPipelineCacheData() const
+        {
+            size_t size = 0;
+            if(vkGetPipelineCacheData(m_device, m_pipelineCache, &size, nullptr) != VK_SUCCESS)
+                return {};
+            std::vector<uint8_t> data(size);
+            if(vkGetPipelineCacheData(m_device, m_pipelineCache, &size, data.data()) != VK_SUCCESS)
+                return {};
+            data.resize(size);
+            return data;
+        }
+
+        /**
+         * @brief isCompatible
+         * @param data
+         * @param properties
+         * @return
+         *
+         * Returns true if the pipeline cache data has a valid
+         * VkPipelineCacheHeaderVersionOne header which was generated by the same
+         * device and driver.
+         */
+        static bool isCompatible(std::vector<uint8_t> const & data, VkPhysicalDeviceProperties const & properties)
+        {
+            constexpr size_t headerSize = 16 + VK_UUID_SIZE;
+            if(data.size() < headerSize)
+                return false;
+
+            uint32_t length, version, vendorID, deviceID;
+            std::memcpy(&length,   data.data() + 0,  4);
+            std::memcpy(&version,  data.data() + 4,  4);
+            std::memcpy(&vendorID, data.data() + 8,  4);
+            std::memcpy(&deviceID, data.data() + 12, 4);
+
+            return length >= headerSize
+                && length <= data.size()
+                && version  == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                && vendorID == properties.vendorID
+                && deviceID == properties.deviceID
+                && std::memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+
+        VkPipelineCache getPipelineCache() const
+        {
+            return m_pipelineCache;
+        }
+
+        /**
+         * @brief loadedFromDisk
+         * @return
+         *
+         * Returns true if the VkPipelineCache was created using the data
+         * from the cache file.
+         */
+        bool loadedFromDisk() const
+        {
+            return m_loadedFromDisk;
+        }
+
+        /**
+         * @brief nextFrame
+         *
+         * See Cache_t::nextFrame()
+         */
+        void nextFrame()
+        {
+            m_cache.nextFrame();
+        }
+
+        void setBudget(size_t budget, uint64_t minIdleFrames = 2)
+        {
+            m_cache.setBudget(budget, minIdleFrames);
+        }
+
+        void setRetireFunction(std::function<void(std::function<void()>)> f)
+        {
+            m_cache.setRetireFunction(std::move(f));
+        }
+
+        size_t evictUnused(uint64_t idleFrames)
+        {
+            return m_cache.evictUnused(idleFrames);
+        }
+
+        bool touch(object_type obj) const
+        {
+            return m_cache.touch(obj);
+        }
+
+        bool touch(object_type obj, size_t hash) const
+        {
+            return m_cache.touch(obj, hash);
+        }
+
+        bool pin(object_type obj)
+        {
+            return m_cache.pin(obj);
+        }
+
+        bool unpin(object_type obj)
+        {
+            return m_cache.unpin(obj);
+        }
+
+        size_t evictionCount() const
+        {
+            return m_cache.evictionCount();
+        }
+
+        uint64_t frameIndex() const
+        {
+            return m_cache.frameIndex();
+        }
+
+#if defined(GVU_ENABLE_INSTRUMENTATION)
+        instrumentation::CacheStats & stats()
+        {
+            return m_cache.stats();
+        }
+        instrumentation::CacheStats const & stats() const
+        {
+            return m_cache.stats();
+        }
+#endif
+
+        size_t cacheSize() const
+        {
+            return m_cache.cacheSize();
+        }
+
+        createInfo_type getCreateInfo(object_type p) const
+        {
+            return m_cache.getCreateInfo(p);
+        }
+
+        /**
+         * @brief hitCount
+         * @return
+         *
+         * The number of calls to create() which returned an existing
+         * pipeline. Failed creations and waits for a pipeline which another
+         * thread is still creating are not hits.
+         */
+        uint64_t hitCount() const
+        {
+            return m_cache.hitCount();
+        }
+
+        /**
+         * @brief missCount
+         * @return
+         *
+         * The number of calls to create() which had to create a new pipeline
+         */
+        uint64_t missCount() const
+        {
+            return m_cache.missCount();
+        }
+
+    private:
+        static std::vector<uint8_t> _readFile(guv::fs::path const & path)
+        {
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if(!in)
+                return {};
+            auto size = in.tellg();
+            if(size <= 0)
+                return {};
+            std::vector<uint8_t> data(static_cast<size_t>(size));
+            in.seekg(0);
+            in.read(reinterpret_cast<char*>(data.data()), size);
+            if(!in)
+                return {};
+            return data;
+        }
+
+        cache_type                 m_cache;
+        VkDevice                   m_device        = VK_NULL_HANDLE;
+        VkPipelineCache            m_pipelineCache = VK_NULL_HANDLE;
+        VkPhysicalDeviceProperties m_properties    = {};
+        guv::fs::path              m_cacheFile;
+        bool                       m_loadedFromDisk = false;
+};
+
+using GraphicsPipelineCache           = GraphicsPipelineCache_t<false>;
+using ConcurrentGraphicsPipelineCache = GraphicsPipelineCache_t<true>;
+
+using InlineGraphicsPipelineCache           = GraphicsPipelineCache_t<false, InlineGraphicsPipelineCreateInfo>;
+using ConcurrentInlineGraphicsPipelineCache = GraphicsPipelineCache_t<true,  InlineGraphicsPipelineCreateInfo>;
+
+}
+
+#endif
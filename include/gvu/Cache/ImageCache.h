@@ -0,0 +1,742 @@
+#ifndef GVU_IMAGE_CACHE_H
+#define GVU_IMAGE_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <vector>
+#include <map>
+#include <functional>
+#include <unordered_map>
+#include <stdexcept>
+#include "../Hash.h"
+
+namespace gvu
+{
+
+struct ImageCreateInfo : public SealedHash<ImageCreateInfo>
+{
+    using create_info_type = VkImageCreateInfo;
+    using object_type      = VkImage;
+
+    VkImageCreateFlags    flags         = {};
+    VkImageType           imageType     = VK_IMAGE_TYPE_2D;
+    VkFormat              format        = VK_FORMAT_UNDEFINED;
+    VkExtent3D            extent        = {1,1,1};
+    uint32_t              mipLevels     = 1;
+    uint32_t              arrayLayers   = 1;
+    VkSampleCountFlagBits samples       = VK_SAMPLE_COUNT_1_BIT;
+    VkImageTiling         tiling        = VK_IMAGE_TILING_OPTIMAL;
+    VkImageUsageFlags     usage         = {};
+    VkSharingMode         sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+    std::vector<uint32_t> queueFamilyIndices;
+    VkImageLayout         initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VmaMemoryUsage        memoryUsage   = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    size_t computeHash() const
+    {
+        size_t h = 0x2545F4914F6CDD1Du;
+
+        hashCombine(h, flags);
+        hashCombine(h, imageType);
+        hashCombine(h, format);
+        hashCombine(h, extent.width);
+        hashCombine(h, extent.height);
+        hashCombine(h, extent.depth);
+        hashCombine(h, mipLevels);
+        hashCombine(h, arrayLayers);
+        hashCombine(h, samples);
+        hashCombine(h, tiling);
+        hashCombine(h, usage);
+        hashCombine(h, sharingMode);
+        hashCombineRange(h, queueFamilyIndices);
+        hashCombine(h, initialLayout);
+        hashCombine(h, memoryUsage);
+
+        return h;
+    }
+
+    bool operator==(ImageCreateInfo const & B) const
+    {
+        if(_sealedHashesDiffer(B))
+            return false;
+        return
+        flags                  == B.flags
+        && imageType           == B.imageType
+        && format              == B.format
+        && extent.width        == B.extent.width
+        && extent.height       == B.extent.height
+        && extent.depth        == B.extent.depth
+        && mipLevels           == B.mipLevels
+        && arrayLayers         == B.arrayLayers
+        && samples             == B.samples
+        && tiling              == B.tiling
+        && usage               == B.usage
+        && sharingMode         == B.sharingMode
+        && rangeEqual(queueFamilyIndices, B.queueFamilyIndices)
+        && initialLayout       == B.initialLayout
+        && memoryUsage         == B.memoryUsage;
+    }
+
+    ImageCreateInfo()
+    {
+    }
+    ImageCreateInfo(create_info_type const & info, VmaMemoryUsage memUsage = VMA_MEMORY_USAGE_GPU_ONLY)
+    {
+        flags         = info.flags        ;
+        imageType     = info.imageType    ;
+        format        = info.format       ;
+        extent        = info.extent       ;
+        mipLevels     = info.mipLevels    ;
+        arrayLayers   = info.arrayLayers  ;
+        samples       = info.samples      ;
+        tiling        = info.tiling       ;
+        usage         = info.usage        ;
+        sharingMode   = info.sharingMode  ;
+        initialLayout = info.initialLayout;
+        memoryUsage   = memUsage;
+        if(info.sharingMode == VK_SHARING_MODE_CONCURRENT)
+            queueFamilyIndices.assign(info.pQueueFamilyIndices, info.pQueueFamilyIndices + info.queueFamilyIndexCount);
+    }
+
+    /**
+     * @brief image2D
+     * @param format
+     * @param extent
+     * @param usage
+     * @param mipLevels
+     * @param arrayLayers
+     * @return
+     *
+     * Convenience function for the most common image: a 2D optimally
+     * tiled image in device local memory.
+     */
+    static ImageCreateInfo image2D(VkFormat format, VkExtent2D extent, VkImageUsageFlags usage, uint32_t mipLevels = 1, uint32_t arrayLayers = 1)
+    {
+        ImageCreateInfo I;
+        I.format      = format;
+        I.extent      = {extent.width, extent.height, 1};
+        I.usage       = usage;
+        I.mipLevels   = mipLevels;
+        I.arrayLayers = arrayLayers;
+        return I;
+    }
+
+    template<typename callable_t>
+    void generateVkCreateInfo(callable_t && c) const
+    {
+        VkImageCreateInfo ci = {};
+        ci.sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        ci.flags                 = flags        ;
+        ci.imageType             = imageType    ;
+        ci.format                = format       ;
+        ci.extent                = extent       ;
+        ci.mipLevels             = mipLevels    ;
+        ci.arrayLayers           = arrayLayers  ;
+        ci.samples               = samples      ;
+        ci.tiling                = tiling       ;
+        ci.usage                 = usage        ;
+        ci.sharingMode           = sharingMode  ;
+        ci.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilyIndices.size());
+        ci.pQueueFamilyIndices   = queueFamilyIndices.data();
+        ci.initialLayout         = initialLayout;
+        c(ci);
+    }
+
+    static object_type create(VkDevice device, create_info_type const & C)
+    {
+        object_type obj = VK_NULL_HANDLE;
+        auto result = vkCreateImage(device, &C, nullptr, &obj);
+        if( result != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+        return obj;
+    }
+    static void destroy(VkDevice device, object_type c)
+    {
+        vkDestroyImage(device, c, nullptr);
+    }
+};
+
+/**
+ * @brief The ImageCache class
+ *
+ * Allocates images with VMA and recycles them, so that render targets
+ * which are created and destroyed often (window resizes, post process
+ * chains) do not go through the driver's memory allocator every time.
+ *
+ * Recycling happens at two levels:
+ *
+ *  1. Returned images are kept in a free list keyed by their create info.
+ *     Allocating an image with the same create info again returns one of
+ *     them without creating anything.
+ *
+ *  2. Images which stay in the free list for more than maxIdleFrames
+ *     calls to nextFrame() are destroyed, but their memory is kept in
+ *     free lists bucketed by size. A new image whose memory requirements
+ *     fit into one of those blocks (at most twice its size) is bound to
+ *     it instead of allocating new memory. Memory is allocated in size
+ *     classes so that blocks can be reused by slightly larger images.
+ *
+ * gvu::ImageCache cache;
+ * cache.init(device, allocator);
+ *
+ * auto info = gvu::ImageCreateInfo::image2D(VK_FORMAT_R16G16B16A16_SFLOAT, extent,
+ *                                           VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+ * info.seal();
+ *
+ * VkImage hdr = cache.allocateImage(info);
+ * ...
+ * cache.returnImage(hdr); // only once the GPU has finished with it
+ *
+ * cache.nextFrame();      // once per frame
+ *
+ * Transient attachments which are only used by a range of passes within
+ * a frame can share memory with each other, see acquireTransientImage().
+ *
+ * The ImageCache is not thread safe. The memory is never mapped by the
+ * cache, images which need host access should set memoryUsage and map
+ * the allocation returned by getAllocation().
+ */
+class ImageCache
+{
+public:
+    void init(VkDevice device, VmaAllocator allocator)
+    {
+        m_device    = device;
+        m_allocator = allocator;
+    }
+
+    /**
+     * @brief destroy
+     *
+     * Destroys every image created by the cache, including images which
+     * have not been returned, and frees all the memory.
+     */
+    void destroy()
+    {
+        for(auto & i : m_images)
+            _destroyImage(i.first);
+        for(auto & i : m_images)
+        {
+            if(!i.second.transient)
+                vmaFreeMemory(m_allocator, i.second.memory.allocation);
+        }
+        for(auto & B : m_aliasBlocks)
+            vmaFreeMemory(m_allocator, B.memory.allocation);
+        for(auto & M : m_freeMemory)
+            vmaFreeMemory(m_allocator, M.second.allocation);
+
+        m_images.clear();
+        m_freeImages.clear();
+        m_freeImageCount = 0;
+        m_freeMemory.clear();
+        m_transients.clear();
+        m_aliasBlocks.clear();
+    }
+
+    /**
+     * @brief allocateImage
+     * @param info
+     * @return
+     *
+     * Returns an image with the create info, reusing a returned image if
+     * one is available. The image must be given back with returnImage().
+     *
+     * Throws std::runtime_error if the image could not be created or its
+     * memory could not be allocated or bound.
+     */
+    VkImage allocateImage(ImageCreateInfo const & info)
+    {
+        auto it = m_freeImages.find(info);
+        if(it != m_freeImages.end() && !it->second.empty())
+        {
+            auto img = it->second.back().image;
+            it->second.pop_back();
+            --m_freeImageCount;
+            ++m_hits;
+            m_images.at(img).free = false;
+            return img;
+        }
+
+        ++m_misses;
+        VkMemoryRequirements req;
+        auto img = _createImage(info, req);
+
+        _Memory M;
+        try
+        {
+            M = _allocateMemory(req, info.memoryUsage);
+        }
+        catch(...)
+        {
+            ImageCreateInfo::destroy(m_device, img);
+            throw;
+        }
+        if(vmaBindImageMemory(m_allocator, M.allocation, img) != VK_SUCCESS)
+        {
+            ImageCreateInfo::destroy(m_device, img);
+            m_freeMemory.emplace(M.info.size, M);
+            throw std::runtime_error("Could not bind image memory");
+        }
+
+        auto & I      = m_images[img];
+        I.info        = info;
+        I.memory      = M;
+        I.info.seal();
+        return img;
+    }
+
+    /**
+     * @brief returnImage
+     * @param image
+     *
+     * Gives the image back to the cache so it can be handed out again. The
+     * GPU must have finished using the image. Its contents are undefined
+     * the next time it is allocated.
+     */
+    void returnImage(VkImage image)
+    {
+        auto it = m_images.find(image);
+        if(it == m_images.end())
+            throw std::out_of_range("This image was not created in this cache");
+        if(it->second.transient)
+            throw std::invalid_argument("Transient images are released with releaseTransientImages()");
+        if(it->second.free)
+            return;
+
+        it->second.free = true;
+        m_freeImages[it->second.info].push_back({image, m_frame});
+        ++m_freeImageCount;
+    }
+
+    /**
+     * @brief nextFrame
+     *
+     * Call once per frame. Images which have been sitting in the free list
+     * for more than maxIdleFrames are destroyed and their memory is kept
+     * for new images. Also starts a new frame for the transient images.
+     */
+    void nextFrame()
+    {
+        ++m_frame;
+
+        for(auto & F : m_freeImages)
+        {
+            auto & list = F.second;
+            size_t j = 0;
+            for(size_t i=0; i < list.size(); i++)
+            {
+                if(m_frame - list[i].frame > m_maxIdleFrames)
+                    _recycle(list[i].image);
+                else
+                    list[j++] = list[i];
+            }
+            m_freeImageCount -= list.size() - j;
+            list.resize(j);
+        }
+    }
+
+    /**
+     * @brief acquireTransientImage
+     * @param info
+     * @param firstPass
+     * @param lastPass
+     * @return
+     *
+     * Returns an image which is only used from pass firstPass to pass
+     * lastPass (inclusive) of the current frame. Transient images whose
+     * pass ranges do not overlap are bound to the same memory, so a chain
+     * of render targets only needs as much memory as the passes which run
+     * at the same time.
+     *
+     * The images are kept: asking for the same images in the same order
+     * every frame returns the same handles without creating anything.
+     * Call nextFrame() before acquiring the images of the next frame.
+     *
+     * Because the memory is shared, the contents of a transient image are
+     * undefined at the start of firstPass. Transition it from
+     * VK_IMAGE_LAYOUT_UNDEFINED (or use a loadOp of CLEAR/DONT_CARE) and
+     * make sure a barrier separates the last use of one image from the
+     * first use of the image aliasing it.
+     */
+    VkImage acquireTransientImage(ImageCreateInfo const & info, uint32_t firstPass, uint32_t lastPass)
+    {
+        if(lastPass < firstPass)
+            throw std::invalid_argument("lastPass must not be less than firstPass");
+
+        size_t h = info.hash();
+        hashCombine(h, firstPass);
+        hashCombine(h, lastPass);
+
+        auto & list = m_transients[h];
+        for(auto & T : list)
+        {
+            if(T.usedFrame != m_frame && T.firstPass == firstPass && T.lastPass == lastPass && m_images.at(T.image).info == info)
+            {
+                T.usedFrame = m_frame;
+                ++m_hits;
+                return T.image;
+            }
+        }
+
+        ++m_misses;
+        VkMemoryRequirements req;
+        auto img = _createImage(info, req);
+
+        _AliasBlock * block    = nullptr;
+        bool          newBlock = false;
+        for(auto & B : m_aliasBlocks)
+        {
+            if(_fits(B.memory, req, info.memoryUsage) && !B.overlaps(firstPass, lastPass))
+            {
+                block = &B;
+                break;
+            }
+        }
+        if(!block)
+        {
+            try
+            {
+                m_aliasBlocks.push_back({_allocateMemory(req, info.memoryUsage), {}});
+            }
+            catch(...)
+            {
+                ImageCreateInfo::destroy(m_device, img);
+                throw;
+            }
+            block    = &m_aliasBlocks.back();
+            newBlock = true;
+        }
+        if(vmaBindImageMemory(m_allocator, block->memory.allocation, img) != VK_SUCCESS)
+        {
+            ImageCreateInfo::destroy(m_device, img);
+            if(newBlock)
+            {
+                m_freeMemory.emplace(block->memory.info.size, block->memory);
+                m_aliasBlocks.pop_back();
+            }
+            throw std::runtime_error("Could not bind image memory");
+        }
+        block->passes.push_back({firstPass, lastPass});
+
+        auto & I      = m_images[img];
+        I.info        = info;
+        I.memory      = block->memory;
+        I.transient   = true;
+        I.info.seal();
+
+        list.push_back({img, firstPass, lastPass, m_frame});
+        return img;
+    }
+
+    /**
+     * @brief releaseTransientImages
+     *
+     * Destroys all the transient images, eg: when the window is resized.
+     * Their memory is kept and reused by the new images. The GPU must have
+     * finished using them.
+     */
+    void releaseTransientImages()
+    {
+        for(auto & L : m_transients)
+        {
+            for(auto & T : L.second)
+            {
+                _destroyImage(T.image);
+                m_images.erase(T.image);
+            }
+        }
+        for(auto & B : m_aliasBlocks)
+            m_freeMemory.emplace(B.memory.info.size, B.memory);
+        m_transients.clear();
+        m_aliasBlocks.clear();
+    }
+
+    /**
+     * @brief trim
+     *
+     * Destroys every image in the free list and frees all memory which is
+     * not bound to a live image.
+     */
+    void trim()
+    {
+        for(auto & F : m_freeImages)
+        {
+            for(auto & i : F.second)
+                _recycle(i.image);
+        }
+        m_freeImages.clear();
+        m_freeImageCount = 0;
+
+        for(auto & M : m_freeMemory)
+            vmaFreeMemory(m_allocator, M.second.allocation);
+        m_freeMemory.clear();
+    }
+
+    /**
+     * @brief getCreateInfo
+     * @param image
+     * @return
+     *
+     * Returns the create info of an image created by this cache.
+     */
+    ImageCreateInfo const & getCreateInfo(VkImage image) const
+    {
+        auto it = m_images.find(image);
+        if(it == m_images.end())
+            throw std::out_of_range("This image was not created in this cache");
+        return it->second.info;
+    }
+
+    /**
+     * @brief getAllocation
+     * @param image
+     * @return
+     *
+     * Returns the memory the image is bound to. Transient images share
+     * their allocation with other transient images.
+     */
+    VmaAllocation getAllocation(VkImage image) const
+    {
+        auto it = m_images.find(image);
+        if(it == m_images.end())
+            throw std::out_of_range("This image was not created in this cache");
+        return it->second.memory.allocation;
+    }
+
+    /**
+     * @brief setImageDestroyedCallback
+     * @param callback
+     *
+     * The callback is called with every image the cache hands out, just
+     * before it is destroyed. Use it to invalidate objects which refer to
+     * the image, eg: FramebufferCache_t::invalidateImage().
+     */
+    void setImageDestroyedCallback(std::function<void(VkImage)> callback)
+    {
+        m_onDestroy = std::move(callback);
+    }
+
+    /**
+     * @brief setMaxIdleFrames
+     * @param frames
+     *
+     * The number of calls to nextFrame() a returned image is kept before
+     * it is destroyed and its memory recycled. Defaults to 3.
+     */
+    void setMaxIdleFrames(uint64_t frames)
+    {
+        m_maxIdleFrames = frames;
+    }
+
+    /**
+     * @brief imageCount
+     * @return
+     *
+     * The number of images owned by the cache, including the free ones
+     */
+    size_t imageCount() const
+    {
+        return m_images.size();
+    }
+
+    size_t freeImageCount() const
+    {
+        return m_freeImageCount;
+    }
+
+    /**
+     * @brief freeMemoryCount
+     * @return
+     *
+     * The number of memory blocks which are not bound to any image
+     */
+    size_t freeMemoryCount() const
+    {
+        return m_freeMemory.size();
+    }
+
+    /**
+     * @brief allocationCount
+     * @return
+     *
+     * The number of times memory was allocated from VMA
+     */
+    size_t allocationCount() const
+    {
+        return m_allocations;
+    }
+
+    size_t hitCount() const
+    {
+        return m_hits;
+    }
+
+    size_t missCount() const
+    {
+        return m_misses;
+    }
+
+protected:
+    struct _Memory
+    {
+        VmaAllocation     allocation = VK_NULL_HANDLE;
+        VmaAllocationInfo info       = {};
+        VmaMemoryUsage    usage      = VMA_MEMORY_USAGE_UNKNOWN;
+    };
+
+    struct _Image
+    {
+        ImageCreateInfo info;
+        _Memory         memory;
+        bool            free       = false;
+        bool            transient  = false;
+    };
+
+    struct _FreeImage
+    {
+        VkImage  image;
+        uint64_t frame;
+    };
+
+    struct _Transient
+    {
+        VkImage  image;
+        uint32_t firstPass;
+        uint32_t lastPass;
+        uint64_t usedFrame;
+    };
+
+    struct _AliasBlock
+    {
+        _Memory                                    memory;
+        std::vector<std::pair<uint32_t, uint32_t>> passes; // pass ranges of the images bound to it
+
+        bool overlaps(uint32_t first, uint32_t last) const
+        {
+            for(auto & p : passes)
+            {
+                if(first <= p.second && p.first <= last)
+                    return true;
+            }
+            return false;
+        }
+    };
+
+    struct _hasher
+    {
+        std::size_t operator()(const ImageCreateInfo& k) const{
+            return k.hash();
+        }
+    };
+
+    VkImage _createImage(ImageCreateInfo const & info, VkMemoryRequirements & req)
+    {
+        VkImage img = VK_NULL_HANDLE;
+        info.generateVkCreateInfo([&](auto & ci)
+        {
+            img = ImageCreateInfo::create(m_device, ci);
+        });
+        if(img == VK_NULL_HANDLE)
+            throw std::runtime_error("Could not create image");
+        vkGetImageMemoryRequirements(m_device, img, &req);
+        return img;
+    }
+
+    static bool _fits(_Memory const & M, VkMemoryRequirements const & req, VmaMemoryUsage usage)
+    {
+        return M.usage == usage
+            && M.info.size >= req.size
+            && (req.memoryTypeBits & (1u << M.info.memoryType))
+            && (req.alignment == 0 || M.info.offset % req.alignment == 0);
+    }
+
+    /**
+     * @brief _sizeClass
+     * @param size
+     * @return
+     *
+     * Rounds the size up to the next eighth of a power of two above it,
+     * wasting at most 25%, so that a block can be reused by images which
+     * are slightly larger.
+     */
+    static VkDeviceSize _sizeClass(VkDeviceSize size)
+    {
+        VkDeviceSize p = 1;
+        while(p < size)
+            p <<= 1;
+        if(p <= 4096)
+            return p;
+        VkDeviceSize step = p / 8;
+        return ((size + step - 1) / step) * step;
+    }
+
+    _Memory _allocateMemory(VkMemoryRequirements req, VmaMemoryUsage usage)
+    {
+        // smallest free block which fits, but not one which would
+        // waste more than half of itself
+        auto last = req.size > (~VkDeviceSize(0) >> 1) ? m_freeMemory.end() : m_freeMemory.upper_bound(req.size * 2);
+        for(auto it = m_freeMemory.lower_bound(req.size); it != last; ++it)
+        {
+            if(_fits(it->second, req, usage))
+            {
+                auto M = it->second;
+                m_freeMemory.erase(it);
+                return M;
+            }
+        }
+
+        req.size = _sizeClass(req.size);
+
+        VmaAllocationCreateInfo ai = {};
+        ai.usage = usage;
+
+        _Memory M;
+        M.usage = usage;
+        if(vmaAllocateMemory(m_allocator, &req, &ai, &M.allocation, &M.info) != VK_SUCCESS)
+            throw std::runtime_error("Could not allocate image memory");
+        ++m_allocations;
+        return M;
+    }
+
+    void _destroyImage(VkImage image)
+    {
+        if(m_onDestroy)
+            m_onDestroy(image);
+        ImageCreateInfo::destroy(m_device, image);
+    }
+
+    /**
+     * @brief _recycle
+     * @param image
+     *
+     * Destroys a free image and keeps its memory
+     */
+    void _recycle(VkImage image)
+    {
+        auto it = m_images.find(image);
+        _destroyImage(image);
+        m_freeMemory.emplace(it->second.memory.info.size, it->second.memory);
+        m_images.erase(it);
+    }
+
+    VkDevice     m_device    = VK_NULL_HANDLE;
+    VmaAllocator m_allocator = VK_NULL_HANDLE;
+
+    std::unordered_map<VkImage, _Image>                                   m_images;
+    std::unordered_map<ImageCreateInfo, std::vector<_FreeImage>, _hasher> m_freeImages;
+    std::multimap<VkDeviceSize, _Memory>                                  m_freeMemory; // by block size
+    std::unordered_map<size_t, std::vector<_Transient>>                   m_transients;
+    std::vector<_AliasBlock>                                              m_aliasBlocks;
+    std::function<void(VkImage)>                                          m_onDestroy;
+
+    size_t   m_freeImageCount = 0;
+    size_t   m_allocations    = 0;
+    size_t   m_hits           = 0;
+    size_t   m_misses         = 0;
+    uint64_t m_frame          = 0;
+    uint64_t m_maxIdleFrames  = 3;
+};
+
+}
+
+#endif
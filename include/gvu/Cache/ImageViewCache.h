@@ -0,0 +1,132 @@
+#ifndef GVU_IMAGE_VIEW_CACHE_H
+#define GVU_IMAGE_VIEW_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include "Cache_t.h"
+#include "../Hash.h"
+#include "../Managers/BarrierBuilder.h"
+
+namespace gvu
+{
+
+struct ImageViewCreateInfo : public SealedHash<ImageViewCreateInfo>
+{
+    using create_info_type = VkImageViewCreateInfo;
+    using object_type      = VkImageView;
+
+    VkImageViewCreateFlags  flags            = {};
+    VkImage                 image            = VK_NULL_HANDLE;
+    VkImageViewType         viewType         = VK_IMAGE_VIEW_TYPE_2D;
+    VkFormat                format           = VK_FORMAT_UNDEFINED;
+    VkComponentMapping      components       = {VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY};
+    VkImageSubresourceRange subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+
+    size_t computeHash() const
+    {
+        size_t h = 0x9E3779B97F4A7C15u;
+
+        hashCombine(h, flags);
+        hashCombine(h, image);
+        hashCombine(h, viewType);
+        hashCombine(h, format);
+        hashCombine(h, components.r);
+        hashCombine(h, components.g);
+        hashCombine(h, components.b);
+        hashCombine(h, components.a);
+        hashCombine(h, subresourceRange.aspectMask);
+        hashCombine(h, subresourceRange.baseMipLevel);
+        hashCombine(h, subresourceRange.levelCount);
+        hashCombine(h, subresourceRange.baseArrayLayer);
+        hashCombine(h, subresourceRange.layerCount);
+
+        return h;
+    }
+
+    bool operator==(ImageViewCreateInfo const & B) const
+    {
+        if(_sealedHashesDiffer(B))
+            return false;
+        return
+        flags                                == B.flags
+        && image                             == B.image
+        && viewType                          == B.viewType
+        && format                            == B.format
+        && components.r                      == B.components.r
+        && components.g                      == B.components.g
+        && components.b                      == B.components.b
+        && components.a                      == B.components.a
+        && subresourceRange.aspectMask       == B.subresourceRange.aspectMask
+        && subresourceRange.baseMipLevel     == B.subresourceRange.baseMipLevel
+        && subresourceRange.levelCount       == B.subresourceRange.levelCount
+        && subresourceRange.baseArrayLayer   == B.subresourceRange.baseArrayLayer
+        && subresourceRange.layerCount       == B.subresourceRange.layerCount;
+    }
+
+    ImageViewCreateInfo()
+    {
+    }
+    ImageViewCreateInfo(create_info_type const & info)
+    {
+        flags            = info.flags           ;
+        image            = info.image           ;
+        viewType         = info.viewType        ;
+        format           = info.format          ;
+        components       = info.components      ;
+        subresourceRange = info.subresourceRange;
+    }
+
+    /**
+     * @brief createSimpleImageView
+     * @param image
+     * @param format
+     * @param viewType
+     * @return
+     *
+     * A view of all the mip levels and array layers of the image. The
+     * aspect mask is inferred from the format.
+     */
+    static ImageViewCreateInfo createSimpleImageView(VkImage image, VkFormat format, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D)
+    {
+        ImageViewCreateInfo I;
+        I.image                       = image;
+        I.format                      = format;
+        I.viewType                    = viewType;
+        I.subresourceRange.aspectMask = BarrierBuilder::aspectMask(format);
+        return I;
+    }
+
+    template<typename callable_t>
+    void generateVkCreateInfo(callable_t && c) const
+    {
+        VkImageViewCreateInfo ci = {};
+        ci.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        ci.flags            = flags           ;
+        ci.image            = image           ;
+        ci.viewType         = viewType        ;
+        ci.format           = format          ;
+        ci.components       = components      ;
+        ci.subresourceRange = subresourceRange;
+        c(ci);
+    }
+
+    static object_type create(VkDevice device, create_info_type const & C)
+    {
+        object_type obj = VK_NULL_HANDLE;
+        auto result = vkCreateImageView(device, &C, nullptr, &obj);
+        if( result != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+        return obj;
+    }
+    static void destroy(VkDevice device, object_type c)
+    {
+        vkDestroyImageView(device, c, nullptr);
+    }
+};
+
+
+using ImageViewCache = Cache_t<ImageViewCreateInfo>;
+using ConcurrentImageViewCache = Cache_t<ImageViewCreateInfo, true>;
+
+}
+#endif
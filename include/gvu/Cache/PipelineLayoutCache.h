@@ -7,11 +7,12 @@
 #include <unordered_map>
 #include <cassert>
 #include "Cache_t.h"
+#include "../Hash.h"
 
 namespace gvu
 {
 
-struct PipelineLayoutCreateInfo
+struct PipelineLayoutCreateInfo : public SealedHash<PipelineLayoutCreateInfo>
 {
     using create_info_type = VkPipelineLayoutCreateInfo;
     using object_type      = VkPipelineLayout;
@@ -20,43 +21,22 @@ struct PipelineLayoutCreateInfo
     std::vector<VkDescriptorSetLayout>   setLayouts;
     std::vector<VkPushConstantRange>     pushConstantRanges;
 
-    size_t hash() const
+    size_t computeHash() const
     {
-        std::hash<size_t> Hs;
-        auto h = Hs(flags);
-
-        auto hash_combine = [](std::size_t& seed, const auto& v)
-        {
-            std::hash<std::decay_t<decltype(v)> > hasher;
-            seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-        };
-
-        for(auto & b : pushConstantRanges)
-        {
-            hash_combine(h, b.stageFlags);
-            hash_combine(h, static_cast<uint32_t>(b.offset));
-            hash_combine(h, static_cast<uint32_t>(b.size));
-        }
-        for(auto & b : setLayouts)
-        {
-            hash_combine(h, b);
-        }
-        hash_combine(h, static_cast<uint32_t>(flags));
+        size_t h = 0;
+        hashCombine(h, flags);
+        hashCombineRange(h, pushConstantRanges);
+        hashCombineRange(h, setLayouts);
         return h;
     }
 
     bool operator==(PipelineLayoutCreateInfo const & B) const
     {
+        if(_sealedHashesDiffer(B))
+            return false;
         return   flags == B.flags
-                 && setLayouts.size() == B.setLayouts.size()
-                 && pushConstantRanges.size() == B.pushConstantRanges.size()
-                 && std::equal(setLayouts.begin(), setLayouts.end(), B.setLayouts.begin())
-                 && std::equal(pushConstantRanges.begin(), pushConstantRanges.end(), B.pushConstantRanges.begin(),[](auto && a, auto && b)
-                    {
-                        return std::tie(a.stageFlags,a.offset,a.size) ==
-                               std::tie(b.stageFlags,b.offset,b.size);
-
-                    });
+                 && rangeEqual(setLayouts, B.setLayouts)
+                 && rangeEqual(pushConstantRanges, B.pushConstantRanges);
     }
 
     PipelineLayoutCreateInfo() = default;
@@ -102,6 +82,7 @@ struct PipelineLayoutCreateInfo
 };
 
 using PipelineLayoutCache = Cache_t<PipelineLayoutCreateInfo>;
+using ConcurrentPipelineLayoutCache = Cache_t<PipelineLayoutCreateInfo, true>;
 
 }
 
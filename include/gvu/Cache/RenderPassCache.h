@@ -8,14 +8,15 @@
 #include <optional>
 #include <cassert>
 #include "Cache_t.h"
+#include "../Hash.h"
 
 namespace gvu
 {
 
 struct SubpassDescription
 {
-    VkSubpassDescriptionFlags          flags;
-    VkPipelineBindPoint                pipelineBindPoint;
+    VkSubpassDescriptionFlags          flags             = {};
+    VkPipelineBindPoint                pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     std::vector<VkAttachmentReference> inputAttachments;
     std::vector<VkAttachmentReference> colorAttachments;
     std::vector<VkAttachmentReference>  resolveAttachments;
@@ -39,7 +40,7 @@ struct SubpassDescription
         {
             for(uint32_t i=0;i<B.colorAttachmentCount;i++)
             {
-                colorAttachments.push_back(B.pResolveAttachments[i]);
+                resolveAttachments.push_back(B.pResolveAttachments[i]);
             }
         }
         if(B.pDepthStencilAttachment)
@@ -54,7 +55,7 @@ struct SubpassDescription
 
     VkSubpassDescription createDescription() const
     {
-        VkSubpassDescription d;
+        VkSubpassDescription d = {};
         d.flags = flags;
         d.pipelineBindPoint = pipelineBindPoint;
 
@@ -64,7 +65,7 @@ struct SubpassDescription
         d.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
         d.pColorAttachments = colorAttachments.data();
 
-        d.pResolveAttachments = resolveAttachments.data();
+        d.pResolveAttachments = resolveAttachments.empty() ? nullptr : resolveAttachments.data();
 
         if(depthStencilAttachment)
         {
@@ -77,61 +78,31 @@ struct SubpassDescription
     }
     size_t hash() const
     {
-        std::hash<size_t> Hs;
-        auto h = Hs(flags);
-
-        auto hash_combine = [](std::size_t& seed, const auto& v)
-        {
-            std::hash<std::decay_t<decltype(v)> > hasher;
-            seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-        };
-
-        hash_combine(h, flags);
-        hash_combine(h, pipelineBindPoint);
-        for(auto & b : inputAttachments)
-        {
-            hash_combine(h, b.attachment);
-            hash_combine(h, b.layout);
-        }
-        for(auto & b : colorAttachments)
-        {
-            hash_combine(h, b.attachment);
-            hash_combine(h, b.layout);
-        }
-        for(auto & b : resolveAttachments)
-        {
-            hash_combine(h, b.attachment);
-            hash_combine(h, b.layout);
-        }
-        hash_combine(h, depthStencilAttachment.has_value());
+        size_t h = 0;
+
+        hashCombine(h, flags);
+        hashCombine(h, pipelineBindPoint);
+        hashCombineRange(h, inputAttachments);
+        hashCombineRange(h, colorAttachments);
+        hashCombineRange(h, resolveAttachments);
+        hashCombine(h, depthStencilAttachment.has_value());
         if(depthStencilAttachment.has_value())
         {
-            hash_combine(h, depthStencilAttachment->attachment);
-            hash_combine(h, depthStencilAttachment->layout);
-        }
-        for(auto & b : preserveAttachments)
-        {
-            hash_combine(h, b);
+            hashCombineArray(h, &depthStencilAttachment.value(), 1);
         }
+        hashCombineRange(h, preserveAttachments);
 
         return h;
     }
 
     bool operator==(SubpassDescription const & B) const
     {
-        auto attachRefEq = [](VkAttachmentReference const & a, VkAttachmentReference const & b)
-        {
-            return std::tie(a.attachment,a.layout) ==
-                   std::tie(b.attachment,b.layout);
-
-        };
-
-        if(depthStencilAttachment.has_value() != depthStencilAttachment.has_value() )
+        if(depthStencilAttachment.has_value() != B.depthStencilAttachment.has_value() )
             return false;
 
         if(depthStencilAttachment.has_value())
         {
-            if(!attachRefEq(*depthStencilAttachment, *B.depthStencilAttachment))
+            if(!podEqual(&*depthStencilAttachment, &*B.depthStencilAttachment, 1))
             {
                 return false;
             }
@@ -139,15 +110,15 @@ struct SubpassDescription
         return
                  flags == B.flags
                  && pipelineBindPoint == B.pipelineBindPoint
-                 && std::equal(preserveAttachments.begin(), preserveAttachments.end(), B.preserveAttachments.begin())
-                 && std::equal(colorAttachments.begin(), colorAttachments.end(), B.colorAttachments.begin(),attachRefEq)
-                 && std::equal(inputAttachments.begin(), inputAttachments.end(), B.inputAttachments.begin(),attachRefEq)
-                 && std::equal(resolveAttachments.begin(), resolveAttachments.end(), B.resolveAttachments.begin(),attachRefEq);
+                 && rangeEqual(preserveAttachments, B.preserveAttachments)
+                 && rangeEqual(colorAttachments,    B.colorAttachments)
+                 && rangeEqual(inputAttachments,    B.inputAttachments)
+                 && rangeEqual(resolveAttachments,  B.resolveAttachments);
     }
 
 };
 
-struct RenderPassCreateInfo
+struct RenderPassCreateInfo : public SealedHash<RenderPassCreateInfo>
 {
     using create_info_type = VkRenderPassCreateInfo;
     using object_type      = VkRenderPass;
@@ -221,96 +192,29 @@ struct RenderPassCreateInfo
 
         return R;
     }
-    size_t hash() const
+    size_t computeHash() const
     {
-        std::hash<size_t> Hs;
-        auto h = Hs(flags);
-
-        auto hash_combine = [](std::size_t& seed, const auto& v)
-        {
-            std::hash<std::decay_t<decltype(v)> > hasher;
-            seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-        };
+        size_t h = 0;
 
-        hash_combine(h, flags);
+        hashCombine(h, flags);
         for(auto & b : subpasses)
         {
-            hash_combine(h, b.hash());
-        }
-        for(auto & b : attachments)
-        {
-            hash_combine(h, b.flags);
-            hash_combine(h, b.format);
-            hash_combine(h, b.samples);
-            hash_combine(h, b.loadOp);
-            hash_combine(h, b.storeOp);
-            hash_combine(h, b.stencilLoadOp);
-            hash_combine(h, b.stencilStoreOp);
-            hash_combine(h, b.initialLayout);
-            hash_combine(h, b.finalLayout);
-        }
-        for(auto & b : dependencies)
-        {
-            hash_combine(h, b.srcSubpass);
-            hash_combine(h, b.dstSubpass);
-            hash_combine(h, b.srcStageMask);
-            hash_combine(h, b.dstStageMask);
-            hash_combine(h, b.srcAccessMask);
-            hash_combine(h, b.dstAccessMask);
-            hash_combine(h, b.dependencyFlags);
+            hashCombine(h, b.hash());
         }
+        hashCombineRange(h, attachments);
+        hashCombineRange(h, dependencies);
 
         return h;
     }
 
     bool operator==(RenderPassCreateInfo const & B) const
     {
+        if(_sealedHashesDiffer(B))
+            return false;
         return   flags == B.flags
-                 && std::equal(attachments.begin(), attachments.end(), B.attachments.begin() ,[](auto && a, auto && b)
-                    {
-                         return std::tie(
-                         a.flags,
-                         a.format,
-                         a.samples,
-                         a.loadOp,
-                         a.storeOp,
-                         a.stencilLoadOp,
-                         a.stencilStoreOp,
-                         a.initialLayout,
-                         a.finalLayout) ==
-                                 std::tie(
-                                 b.flags,
-                                 b.format,
-                                 b.samples,
-                                 b.loadOp,
-                                 b.storeOp,
-                                 b.stencilLoadOp,
-                                 b.stencilStoreOp,
-                                 b.initialLayout,
-                                 b.finalLayout);
-                    })
-                 && std::equal(subpasses.begin(), subpasses.end(), B.subpasses.begin())
-                 && std::equal(dependencies.begin(), dependencies.end(), B.dependencies.begin(),[](auto && a, auto && b)
-                    {
-                        return
-                        std::tie(
-                          a.srcSubpass,
-                          a.dstSubpass,
-                          a.srcStageMask,
-                          a.dstStageMask,
-                          a.srcAccessMask,
-                          a.dstAccessMask,
-                          a.dependencyFlags) ==
-                                std::tie(
-                                  b.srcSubpass,
-                                  b.dstSubpass,
-                                  b.srcStageMask,
-                                  b.dstStageMask,
-                                  b.srcAccessMask,
-                                  b.dstAccessMask,
-                                  b.dependencyFlags);
-
-                    });
+                 && rangeEqual(attachments, B.attachments)
+                 && subpasses == B.subpasses
+                 && rangeEqual(dependencies, B.dependencies);
     }
 
     RenderPassCreateInfo() = default;
@@ -370,6 +274,7 @@ struct RenderPassCreateInfo
 };
 
 using RenderPassCache = Cache_t<RenderPassCreateInfo>;
+using ConcurrentRenderPassCache = Cache_t<RenderPassCreateInfo, true>;
 
 }
 
@@ -7,11 +7,12 @@
 #include <unordered_map>
 #include <cassert>
 #include "Cache_t.h"
+#include "../Hash.h"
 
 namespace gvu
 {
 
-struct SamplerCreateInfo
+struct SamplerCreateInfo : public SealedHash<SamplerCreateInfo>
 {
     using create_info_type = VkSamplerCreateInfo;
     using object_type      = VkSampler;
@@ -33,48 +34,34 @@ struct SamplerCreateInfo
     VkBorderColor        borderColor             = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     VkBool32             unnormalizedCoordinates = VK_FALSE;
 
-    size_t hash() const
+    size_t computeHash() const
     {
         size_t h = 156485465u;
 
-        auto hash_combine = [](std::size_t& seed, const auto& v)
-        {
-            using type = std::decay_t<decltype(v)>;
-            if constexpr (std::is_enum_v<type>)
-            {
-                auto s = static_cast<size_t>(v);
-                std::hash<size_t> hasher;
-                seed ^= hasher(s) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-            }
-            else
-            {
-                std::hash<type> hasher;
-                seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-            }
-        };
-
-        hash_combine(h, flags);
-        hash_combine(h, magFilter);
-        hash_combine(h, minFilter);
-        hash_combine(h, mipmapMode);
-        hash_combine(h, addressModeU);
-        hash_combine(h, addressModeV);
-        hash_combine(h, addressModeW);
-        hash_combine(h, mipLodBias);
-        hash_combine(h, anisotropyEnable);
-        hash_combine(h, maxAnisotropy);
-        hash_combine(h, compareEnable);
-        hash_combine(h, compareOp);
-        hash_combine(h, minLod);
-        hash_combine(h, maxLod);
-        hash_combine(h, borderColor);
-        hash_combine(h, unnormalizedCoordinates);
+        hashCombine(h, flags);
+        hashCombine(h, magFilter);
+        hashCombine(h, minFilter);
+        hashCombine(h, mipmapMode);
+        hashCombine(h, addressModeU);
+        hashCombine(h, addressModeV);
+        hashCombine(h, addressModeW);
+        hashCombine(h, mipLodBias);
+        hashCombine(h, anisotropyEnable);
+        hashCombine(h, maxAnisotropy);
+        hashCombine(h, compareEnable);
+        hashCombine(h, compareOp);
+        hashCombine(h, minLod);
+        hashCombine(h, maxLod);
+        hashCombine(h, borderColor);
+        hashCombine(h, unnormalizedCoordinates);
 
         return h;
     }
 
     bool operator==(SamplerCreateInfo const & B) const
     {
+        if(_sealedHashesDiffer(B))
+            return false;
         return
         flags                       == B.flags
         && magFilter                == B.magFilter
@@ -83,13 +70,13 @@ struct SamplerCreateInfo
         && addressModeU             == B.addressModeU
         && addressModeV             == B.addressModeV
         && addressModeW             == B.addressModeW
-        && mipLodBias               == B.mipLodBias
+        && floatEqual(mipLodBias, B.mipLodBias)
         && anisotropyEnable         == B.anisotropyEnable
-        && maxAnisotropy            == B.maxAnisotropy
+        && floatEqual(maxAnisotropy, B.maxAnisotropy)
         && compareEnable            == B.compareEnable
         && compareOp                == B.compareOp
-        && minLod                   == B.minLod
-        && maxLod                   == B.maxLod
+        && floatEqual(minLod, B.minLod)
+        && floatEqual(maxLod, B.maxLod)
         && borderColor              == B.borderColor
         && unnormalizedCoordinates  == B.unnormalizedCoordinates;
     }
@@ -157,6 +144,7 @@ struct SamplerCreateInfo
 
 
 using SamplerCache = Cache_t<SamplerCreateInfo>;
+using ConcurrentSamplerCache = Cache_t<SamplerCreateInfo, true>;
 
 }
 #endif
@@ -0,0 +1,171 @@
+#ifndef GVU_SHADER_MODULE_CACHE_H
+#define GVU_SHADER_MODULE_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include "Cache_t.h"
+#include "../Hash.h"
+
+// C++17 includes the <filesystem> library, but
+// unfortunately gcc7 does not have a finalized version of it
+// it is in the <experimental/filesystem lib
+// this section includes the proper header
+// depending on whether the header exists and
+// includes that. It also sets the
+// nfcbn::nf namespace
+#if __has_include(<filesystem>)
+
+    #include <filesystem>
+    namespace guv
+    {
+        namespace fs = std::filesystem;
+    }
+
+#elif __has_include(<experimental/filesystem>)
+
+    #include <experimental/filesystem>
+    namespace guv
+    {
+        namespace fs = std::experimental::filesystem;
+    }
+
+#else
+    #error There is no <filesystem> or <experimental/filesystem>
+#endif
+
+
+namespace gvu
+{
+
+/**
+ * @brief The ShaderModuleCreateInfo struct
+ *
+ * Holds the SPIR-V code for a shader module. It is hashed by the
+ * content of the code, so loading the same shader from two
+ * different places returns the same VkShaderModule from the
+ * ShaderModuleCache.
+ *
+ * gvu::ShaderModuleCache cache;
+ * cache.init(device);
+ *
+ * auto mod = cache.create( gvu::ShaderModuleCreateInfo("shader.vert.spv") );
+ *
+ * loadCode() and setCode() seal the hash (see SealedHash) as the code is
+ * usually not modified after being loaded. If you modify the code
+ * directly, call unseal() or seal() again.
+ */
+struct ShaderModuleCreateInfo : public SealedHash<ShaderModuleCreateInfo>
+{
+    using create_info_type = VkShaderModuleCreateInfo;
+    using object_type      = VkShaderModule;
+
+    VkShaderModuleCreateFlags flags = {};
+    std::vector<uint32_t>     code;
+
+    ShaderModuleCreateInfo() = default;
+    ShaderModuleCreateInfo(guv::fs::path const &f)
+    {
+        loadCode(f);
+    }
+    ShaderModuleCreateInfo(create_info_type const & info)
+    {
+        flags = info.flags;
+        setCode(info.pCode, info.codeSize / sizeof(uint32_t));
+    }
+
+    /**
+     * @brief loadCode
+     * @param f
+     *
+     * Load the SPIR-V code from a file. The file is read directly
+     * into the code vector with a single read.
+     */
+    void loadCode(guv::fs::path const & f)
+    {
+        std::ifstream t(f, std::ios::binary | std::ios::ate);
+        if(!t)
+            throw std::runtime_error("Could not open shader file: " + f.string());
+
+        auto size = static_cast<size_t>(t.tellg());
+        if(size % sizeof(uint32_t) != 0)
+            throw std::runtime_error("Invalid SPIR-V file, the size is not a multiple of 4: " + f.string());
+
+        code.resize(size / sizeof(uint32_t));
+        t.seekg(0);
+        t.read(reinterpret_cast<char*>(code.data()), static_cast<std::streamsize>(size));
+        if(!t)
+            throw std::runtime_error("Could not read shader file: " + f.string());
+        seal();
+    }
+
+    /**
+     * @brief setCode
+     * @param data
+     * @param wordCount
+     *
+     * Copy the SPIR-V code from memory, eg: from a shader archive.
+     */
+    void setCode(uint32_t const * data, size_t wordCount)
+    {
+        code.assign(data, data + wordCount);
+        seal();
+    }
+
+    size_t computeHash() const
+    {
+        size_t h = 0;
+        hashCombine(h, flags);
+        hashCombineRange(h, code);
+        return h;
+    }
+
+    bool operator==(ShaderModuleCreateInfo const & B) const
+    {
+        if(_sealedHashesDiffer(B))
+            return false;
+        return flags == B.flags
+            && rangeEqual(code, B.code);
+    }
+
+    template<typename callable_t>
+    auto create(callable_t && C) const
+    {
+        VkShaderModuleCreateInfo ci = {};
+        ci.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        ci.flags = flags;
+        ci.pCode = code.data();
+        ci.codeSize = code.size() * sizeof(uint32_t);
+        return C(ci);
+    }
+
+    template<typename callable_t>
+    void generateVkCreateInfo(callable_t && c) const
+    {
+        create([&](VkShaderModuleCreateInfo & ci)
+        {
+            c(ci);
+        });
+    }
+
+    static object_type create(VkDevice device, create_info_type const & C)
+    {
+        object_type obj = VK_NULL_HANDLE;
+        auto result = vkCreateShaderModule(device, &C, nullptr, &obj);
+        if( result != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+        return obj;
+    }
+    static void destroy(VkDevice device, object_type c)
+    {
+        vkDestroyShaderModule(device, c, nullptr);
+    }
+};
+
+using ShaderModuleCache = Cache_t<ShaderModuleCreateInfo>;
+using ConcurrentShaderModuleCache = Cache_t<ShaderModuleCreateInfo, true>;
+
+}
+
+#endif
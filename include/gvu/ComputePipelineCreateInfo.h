@@ -0,0 +1,134 @@
+#ifndef GVU_COMPUTE_PIPELINE_CREATE_INFO_H
+#define GVU_COMPUTE_PIPELINE_CREATE_INFO_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include "Hash.h"
+#include "StaticVector.h"
+#include "SpecializationConstants.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The ComputePipelineCreateInfo struct
+ *
+ * A hashable create info for a compute pipeline. The specialization
+ * constants are part of the key, so a single shader module can be
+ * used to create the different permutations of a pipeline.
+ *
+ * gvu::ComputePipelineCreateInfo CI;
+ * CI.computeShader  = module;
+ * CI.pipelineLayout = layout;
+ * CI.specialization.set(0, uint32_t(256)); // layout(local_size_x_id = 0) in;
+ *
+ * auto pipeline = CI.create([&](VkComputePipelineCreateInfo & info)
+ * {
+ *     VkPipeline p;
+ *     vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &p);
+ *     return p;
+ * });
+ *
+ * Use ComputePipelineCreateInfo or InlineComputePipelineCreateInfo instead
+ * of using this directly.
+ */
+template<typename storage_t>
+struct ComputePipelineCreateInfo_t : public SealedHash<ComputePipelineCreateInfo_t<storage_t>>
+{
+    using create_info_type = VkComputePipelineCreateInfo;
+    using object_type      = VkPipeline;
+
+    VkPipelineCreateFlags flags          = 0;
+    VkShaderModule        computeShader  = VK_NULL_HANDLE; // must not be null
+    VkPipelineLayout      pipelineLayout = VK_NULL_HANDLE;
+
+    SpecializationConstants_t<storage_t> specialization;
+
+    size_t computeHash() const
+    {
+        size_t h = 0;
+        hashCombine(h, flags);
+        hashCombine(h, computeShader);
+        hashCombine(h, pipelineLayout);
+        hashCombine(h, specialization.hash());
+        return h;
+    }
+
+    bool operator==(ComputePipelineCreateInfo_t const & B) const
+    {
+        if(this->_sealedHashesDiffer(B))
+            return false;
+        return flags          == B.flags
+            && computeShader  == B.computeShader
+            && pipelineLayout == B.pipelineLayout
+            && specialization == B.specialization;
+    }
+
+    /**
+     * @brief create
+     * @param C
+     * @return
+     *
+     * Generates the VkComputePipelineCreateInfo and passes it to the
+     * callable, the return value of the callable is returned.
+     */
+    template<typename callable_t>
+    auto create(callable_t && C) const
+    {
+        auto specInfo = specialization.getVkSpecializationInfo();
+
+        VkComputePipelineCreateInfo info = {};
+        info.sType                     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        info.flags                     = flags;
+        info.stage.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        info.stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+        info.stage.module              = computeShader;
+        info.stage.pName               = "main";
+        info.stage.pSpecializationInfo = specialization.empty() ? nullptr : &specInfo;
+        info.layout                    = pipelineLayout;
+        info.basePipelineHandle        = VK_NULL_HANDLE;
+        info.basePipelineIndex         = -1;
+
+        return C(info);
+    }
+
+    /**
+     * @brief generateVkCreateInfo
+     * @param c
+     *
+     * Used by Cache_t, same as create() but the return value of
+     * the callable is ignored.
+     */
+    template<typename callable_t>
+    void generateVkCreateInfo(callable_t && c) const
+    {
+        create([&](VkComputePipelineCreateInfo & info)
+        {
+            c(info);
+        });
+    }
+
+    static object_type create(VkDevice device, create_info_type const & C)
+    {
+        return create(device, VK_NULL_HANDLE, C);
+    }
+    static object_type create(VkDevice device, VkPipelineCache pipelineCache, create_info_type const & C)
+    {
+        object_type obj = VK_NULL_HANDLE;
+        auto result = vkCreateComputePipelines(device, pipelineCache, 1, &C, nullptr, &obj);
+        if( result != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+        return obj;
+    }
+    static void destroy(VkDevice device, object_type c)
+    {
+        vkDestroyPipeline(device, c, nullptr);
+    }
+};
+
+using ComputePipelineCreateInfo       = ComputePipelineCreateInfo_t<DynamicStorage>;
+using InlineComputePipelineCreateInfo = ComputePipelineCreateInfo_t<InlineStorage>;
+
+}
+
+#endif
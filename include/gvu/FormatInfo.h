@@ -1,6 +1,8 @@
 #ifndef VKB_FORMAT_INFO_H
 #define VKB_FORMAT_INFO_H
 
+#include <cstdint>
+#include <cstddef>
 #include <vulkan/vulkan.h>
 
 namespace gvu
@@ -27,571 +29,352 @@ struct FormatInfo
     uint32_t        minBlocksY;
 };
 
-static inline FormatInfo getFormatInfo( VkFormat format )
+struct _ExtensionFormatInfo
 {
+    VkFormat   format;
     FormatInfo info;
-    auto * pFormatSize = &info;
-    pFormatSize->minBlocksX = pFormatSize->minBlocksY = 1;
-    switch ( format )
+};
+
+/**
+ * The FormatInfo of every core format from VK_FORMAT_UNDEFINED to
+ * VK_FORMAT_ASTC_12x12_SRGB_BLOCK, indexed by the VkFormat value.
+ */
+inline constexpr FormatInfo _coreFormatInfos[] =
+{
+    /* UNDEFINED                                  */ {FORMAT_SIZE_UNKNOWN, 0,   0,  1,  1, 1, 1, 1},
+    /* R4G4_UNORM_PACK8                           */ {FORMAT_SIZE_PACKED_BIT, 0,   8,  1,  1, 1, 1, 1},
+    /* R4G4B4A4_UNORM_PACK16                      */ {FORMAT_SIZE_PACKED_BIT, 0,  16,  1,  1, 1, 1, 1},
+    /* B4G4R4A4_UNORM_PACK16                      */ {FORMAT_SIZE_PACKED_BIT, 0,  16,  1,  1, 1, 1, 1},
+    /* R5G6B5_UNORM_PACK16                        */ {FORMAT_SIZE_PACKED_BIT, 0,  16,  1,  1, 1, 1, 1},
+    /* B5G6R5_UNORM_PACK16                        */ {FORMAT_SIZE_PACKED_BIT, 0,  16,  1,  1, 1, 1, 1},
+    /* R5G5B5A1_UNORM_PACK16                      */ {FORMAT_SIZE_PACKED_BIT, 0,  16,  1,  1, 1, 1, 1},
+    /* B5G5R5A1_UNORM_PACK16                      */ {FORMAT_SIZE_PACKED_BIT, 0,  16,  1,  1, 1, 1, 1},
+    /* A1R5G5B5_UNORM_PACK16                      */ {FORMAT_SIZE_PACKED_BIT, 0,  16,  1,  1, 1, 1, 1},
+    /* R8_UNORM                                   */ {FORMAT_SIZE_UNKNOWN, 0,   8,  1,  1, 1, 1, 1},
+    /* R8_SNORM                                   */ {FORMAT_SIZE_UNKNOWN, 0,   8,  1,  1, 1, 1, 1},
+    /* R8_USCALED                                 */ {FORMAT_SIZE_UNKNOWN, 0,   8,  1,  1, 1, 1, 1},
+    /* R8_SSCALED                                 */ {FORMAT_SIZE_UNKNOWN, 0,   8,  1,  1, 1, 1, 1},
+    /* R8_UINT                                    */ {FORMAT_SIZE_UNKNOWN, 0,   8,  1,  1, 1, 1, 1},
+    /* R8_SINT                                    */ {FORMAT_SIZE_UNKNOWN, 0,   8,  1,  1, 1, 1, 1},
+    /* R8_SRGB                                    */ {FORMAT_SIZE_UNKNOWN, 0,   8,  1,  1, 1, 1, 1},
+    /* R8G8_UNORM                                 */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R8G8_SNORM                                 */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R8G8_USCALED                               */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R8G8_SSCALED                               */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R8G8_UINT                                  */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R8G8_SINT                                  */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R8G8_SRGB                                  */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R8G8B8_UNORM                               */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* R8G8B8_SNORM                               */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* R8G8B8_USCALED                             */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* R8G8B8_SSCALED                             */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* R8G8B8_UINT                                */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* R8G8B8_SINT                                */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* R8G8B8_SRGB                                */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* B8G8R8_UNORM                               */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* B8G8R8_SNORM                               */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* B8G8R8_USCALED                             */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* B8G8R8_SSCALED                             */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* B8G8R8_UINT                                */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* B8G8R8_SINT                                */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* B8G8R8_SRGB                                */ {FORMAT_SIZE_UNKNOWN, 0,  24,  1,  1, 1, 1, 1},
+    /* R8G8B8A8_UNORM                             */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R8G8B8A8_SNORM                             */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R8G8B8A8_USCALED                           */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R8G8B8A8_SSCALED                           */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R8G8B8A8_UINT                              */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R8G8B8A8_SINT                              */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R8G8B8A8_SRGB                              */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* B8G8R8A8_UNORM                             */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* B8G8R8A8_SNORM                             */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* B8G8R8A8_USCALED                           */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* B8G8R8A8_SSCALED                           */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* B8G8R8A8_UINT                              */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* B8G8R8A8_SINT                              */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* B8G8R8A8_SRGB                              */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* A8B8G8R8_UNORM_PACK32                      */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A8B8G8R8_SNORM_PACK32                      */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A8B8G8R8_USCALED_PACK32                    */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A8B8G8R8_SSCALED_PACK32                    */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A8B8G8R8_UINT_PACK32                       */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A8B8G8R8_SINT_PACK32                       */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A8B8G8R8_SRGB_PACK32                       */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2R10G10B10_UNORM_PACK32                   */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2R10G10B10_SNORM_PACK32                   */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2R10G10B10_USCALED_PACK32                 */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2R10G10B10_SSCALED_PACK32                 */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2R10G10B10_UINT_PACK32                    */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2R10G10B10_SINT_PACK32                    */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2B10G10R10_UNORM_PACK32                   */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2B10G10R10_SNORM_PACK32                   */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2B10G10R10_USCALED_PACK32                 */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2B10G10R10_SSCALED_PACK32                 */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2B10G10R10_UINT_PACK32                    */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* A2B10G10R10_SINT_PACK32                    */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* R16_UNORM                                  */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R16_SNORM                                  */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R16_USCALED                                */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R16_SSCALED                                */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R16_UINT                                   */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R16_SINT                                   */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R16_SFLOAT                                 */ {FORMAT_SIZE_UNKNOWN, 0,  16,  1,  1, 1, 1, 1},
+    /* R16G16_UNORM                               */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R16G16_SNORM                               */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R16G16_USCALED                             */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R16G16_SSCALED                             */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R16G16_UINT                                */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R16G16_SINT                                */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R16G16_SFLOAT                              */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R16G16B16_UNORM                            */ {FORMAT_SIZE_UNKNOWN, 0,  48,  1,  1, 1, 1, 1},
+    /* R16G16B16_SNORM                            */ {FORMAT_SIZE_UNKNOWN, 0,  48,  1,  1, 1, 1, 1},
+    /* R16G16B16_USCALED                          */ {FORMAT_SIZE_UNKNOWN, 0,  48,  1,  1, 1, 1, 1},
+    /* R16G16B16_SSCALED                          */ {FORMAT_SIZE_UNKNOWN, 0,  48,  1,  1, 1, 1, 1},
+    /* R16G16B16_UINT                             */ {FORMAT_SIZE_UNKNOWN, 0,  48,  1,  1, 1, 1, 1},
+    /* R16G16B16_SINT                             */ {FORMAT_SIZE_UNKNOWN, 0,  48,  1,  1, 1, 1, 1},
+    /* R16G16B16_SFLOAT                           */ {FORMAT_SIZE_UNKNOWN, 0,  48,  1,  1, 1, 1, 1},
+    /* R16G16B16A16_UNORM                         */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R16G16B16A16_SNORM                         */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R16G16B16A16_USCALED                       */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R16G16B16A16_SSCALED                       */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R16G16B16A16_UINT                          */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R16G16B16A16_SINT                          */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R16G16B16A16_SFLOAT                        */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R32_UINT                                   */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R32_SINT                                   */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R32_SFLOAT                                 */ {FORMAT_SIZE_UNKNOWN, 0,  32,  1,  1, 1, 1, 1},
+    /* R32G32_UINT                                */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R32G32_SINT                                */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R32G32_SFLOAT                              */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R32G32B32_UINT                             */ {FORMAT_SIZE_UNKNOWN, 0,  96,  1,  1, 1, 1, 1},
+    /* R32G32B32_SINT                             */ {FORMAT_SIZE_UNKNOWN, 0,  96,  1,  1, 1, 1, 1},
+    /* R32G32B32_SFLOAT                           */ {FORMAT_SIZE_UNKNOWN, 0,  96,  1,  1, 1, 1, 1},
+    /* R32G32B32A32_UINT                          */ {FORMAT_SIZE_UNKNOWN, 0, 128,  1,  1, 1, 1, 1},
+    /* R32G32B32A32_SINT                          */ {FORMAT_SIZE_UNKNOWN, 0, 128,  1,  1, 1, 1, 1},
+    /* R32G32B32A32_SFLOAT                        */ {FORMAT_SIZE_UNKNOWN, 0, 128,  1,  1, 1, 1, 1},
+    /* R64_UINT                                   */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R64_SINT                                   */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R64_SFLOAT                                 */ {FORMAT_SIZE_UNKNOWN, 0,  64,  1,  1, 1, 1, 1},
+    /* R64G64_UINT                                */ {FORMAT_SIZE_UNKNOWN, 0, 128,  1,  1, 1, 1, 1},
+    /* R64G64_SINT                                */ {FORMAT_SIZE_UNKNOWN, 0, 128,  1,  1, 1, 1, 1},
+    /* R64G64_SFLOAT                              */ {FORMAT_SIZE_UNKNOWN, 0, 128,  1,  1, 1, 1, 1},
+    /* R64G64B64_UINT                             */ {FORMAT_SIZE_UNKNOWN, 0, 192,  1,  1, 1, 1, 1},
+    /* R64G64B64_SINT                             */ {FORMAT_SIZE_UNKNOWN, 0, 192,  1,  1, 1, 1, 1},
+    /* R64G64B64_SFLOAT                           */ {FORMAT_SIZE_UNKNOWN, 0, 192,  1,  1, 1, 1, 1},
+    /* R64G64B64A64_UINT                          */ {FORMAT_SIZE_UNKNOWN, 0, 256,  1,  1, 1, 1, 1},
+    /* R64G64B64A64_SINT                          */ {FORMAT_SIZE_UNKNOWN, 0, 256,  1,  1, 1, 1, 1},
+    /* R64G64B64A64_SFLOAT                        */ {FORMAT_SIZE_UNKNOWN, 0, 256,  1,  1, 1, 1, 1},
+    /* B10G11R11_UFLOAT_PACK32                    */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* E5B9G9R9_UFLOAT_PACK32                     */ {FORMAT_SIZE_PACKED_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* D16_UNORM                                  */ {FORMAT_SIZE_DEPTH_BIT, 0,  16,  1,  1, 1, 1, 1},
+    /* X8_D24_UNORM_PACK32                        */ {FormatSizeFlags(FORMAT_SIZE_PACKED_BIT | FORMAT_SIZE_DEPTH_BIT), 0,  32,  1,  1, 1, 1, 1},
+    /* D32_SFLOAT                                 */ {FORMAT_SIZE_DEPTH_BIT, 0,  32,  1,  1, 1, 1, 1},
+    /* S8_UINT                                    */ {FORMAT_SIZE_STENCIL_BIT, 0,   8,  1,  1, 1, 1, 1},
+    /* D16_UNORM_S8_UINT                          */ {FormatSizeFlags(FORMAT_SIZE_DEPTH_BIT | FORMAT_SIZE_STENCIL_BIT), 0,  24,  1,  1, 1, 1, 1},
+    /* D24_UNORM_S8_UINT                          */ {FormatSizeFlags(FORMAT_SIZE_DEPTH_BIT | FORMAT_SIZE_STENCIL_BIT), 0,  32,  1,  1, 1, 1, 1},
+    /* D32_SFLOAT_S8_UINT                         */ {FormatSizeFlags(FORMAT_SIZE_DEPTH_BIT | FORMAT_SIZE_STENCIL_BIT), 0,  64,  1,  1, 1, 1, 1},
+    /* BC1_RGB_UNORM_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1},
+    /* BC1_RGB_SRGB_BLOCK                         */ {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1},
+    /* BC1_RGBA_UNORM_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1},
+    /* BC1_RGBA_SRGB_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1},
+    /* BC2_UNORM_BLOCK                            */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* BC2_SRGB_BLOCK                             */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* BC3_UNORM_BLOCK                            */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* BC3_SRGB_BLOCK                             */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* BC4_UNORM_BLOCK                            */ {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1},
+    /* BC4_SNORM_BLOCK                            */ {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1},
+    /* BC5_UNORM_BLOCK                            */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* BC5_SNORM_BLOCK                            */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* BC6H_UFLOAT_BLOCK                          */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* BC6H_SFLOAT_BLOCK                          */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* BC7_UNORM_BLOCK                            */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* BC7_SRGB_BLOCK                             */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* ETC2_R8G8B8_UNORM_BLOCK                    */ {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1},
+    /* ETC2_R8G8B8_SRGB_BLOCK                     */ {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1},
+    /* ETC2_R8G8B8A1_UNORM_BLOCK                  */ {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1},
+    /* ETC2_R8G8B8A1_SRGB_BLOCK                   */ {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1},
+    /* ETC2_R8G8B8A8_UNORM_BLOCK                  */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* ETC2_R8G8B8A8_SRGB_BLOCK                   */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* EAC_R11_UNORM_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* EAC_R11_SNORM_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* EAC_R11G11_UNORM_BLOCK                     */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* EAC_R11G11_SNORM_BLOCK                     */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* ASTC_4x4_UNORM_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* ASTC_4x4_SRGB_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1},
+    /* ASTC_5x4_UNORM_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  5,  4, 1, 1, 1},
+    /* ASTC_5x4_SRGB_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  5,  4, 1, 1, 1},
+    /* ASTC_5x5_UNORM_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  5,  5, 1, 1, 1},
+    /* ASTC_5x5_SRGB_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  5,  5, 1, 1, 1},
+    /* ASTC_6x5_UNORM_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  6,  5, 1, 1, 1},
+    /* ASTC_6x5_SRGB_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  6,  5, 1, 1, 1},
+    /* ASTC_6x6_UNORM_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  6,  6, 1, 1, 1},
+    /* ASTC_6x6_SRGB_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  6,  6, 1, 1, 1},
+    /* ASTC_8x5_UNORM_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  8,  5, 1, 1, 1},
+    /* ASTC_8x5_SRGB_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  8,  5, 1, 1, 1},
+    /* ASTC_8x6_UNORM_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  8,  6, 1, 1, 1},
+    /* ASTC_8x6_SRGB_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  8,  6, 1, 1, 1},
+    /* ASTC_8x8_UNORM_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  8,  8, 1, 1, 1},
+    /* ASTC_8x8_SRGB_BLOCK                        */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  8,  8, 1, 1, 1},
+    /* ASTC_10x5_UNORM_BLOCK                      */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10,  5, 1, 1, 1},
+    /* ASTC_10x5_SRGB_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10,  5, 1, 1, 1},
+    /* ASTC_10x6_UNORM_BLOCK                      */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10,  6, 1, 1, 1},
+    /* ASTC_10x6_SRGB_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10,  6, 1, 1, 1},
+    /* ASTC_10x8_UNORM_BLOCK                      */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10,  8, 1, 1, 1},
+    /* ASTC_10x8_SRGB_BLOCK                       */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10,  8, 1, 1, 1},
+    /* ASTC_10x10_UNORM_BLOCK                     */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10, 10, 1, 1, 1},
+    /* ASTC_10x10_SRGB_BLOCK                      */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10, 10, 1, 1, 1},
+    /* ASTC_12x10_UNORM_BLOCK                     */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 12, 10, 1, 1, 1},
+    /* ASTC_12x10_SRGB_BLOCK                      */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 12, 10, 1, 1, 1},
+    /* ASTC_12x12_UNORM_BLOCK                     */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 12, 12, 1, 1, 1},
+    /* ASTC_12x12_SRGB_BLOCK                      */ {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 12, 12, 1, 1, 1},
+};
+
+static_assert(sizeof(_coreFormatInfos) / sizeof(_coreFormatInfos[0]) == VK_FORMAT_ASTC_12x12_SRGB_BLOCK + 1,
+              "The core format table must contain every format up to VK_FORMAT_ASTC_12x12_SRGB_BLOCK");
+
+/**
+ * The FormatInfo of the extension formats, sorted by VkFormat value
+ */
+inline constexpr _ExtensionFormatInfo _extensionFormatInfos[] =
+{
+    {VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG,   {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  8,  4, 1, 2, 2}},
+    {VK_FORMAT_PVRTC1_4BPP_UNORM_BLOCK_IMG,   {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 2, 2}},
+    {VK_FORMAT_PVRTC2_2BPP_UNORM_BLOCK_IMG,   {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  8,  4, 1, 1, 1}},
+    {VK_FORMAT_PVRTC2_4BPP_UNORM_BLOCK_IMG,   {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1}},
+    {VK_FORMAT_PVRTC1_2BPP_SRGB_BLOCK_IMG,    {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  8,  4, 1, 2, 2}},
+    {VK_FORMAT_PVRTC1_4BPP_SRGB_BLOCK_IMG,    {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 2, 2}},
+    {VK_FORMAT_PVRTC2_2BPP_SRGB_BLOCK_IMG,    {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  8,  4, 1, 1, 1}},
+    {VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG,    {FORMAT_SIZE_COMPRESSED_BIT, 0,  64,  4,  4, 1, 1, 1}},
+#if defined(VK_VERSION_1_3)
+    {VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK,         {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  4,  4, 1, 1, 1}},
+    {VK_FORMAT_ASTC_5x4_SFLOAT_BLOCK,         {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  5,  4, 1, 1, 1}},
+    {VK_FORMAT_ASTC_5x5_SFLOAT_BLOCK,         {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  5,  5, 1, 1, 1}},
+    {VK_FORMAT_ASTC_6x5_SFLOAT_BLOCK,         {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  6,  5, 1, 1, 1}},
+    {VK_FORMAT_ASTC_6x6_SFLOAT_BLOCK,         {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  6,  6, 1, 1, 1}},
+    {VK_FORMAT_ASTC_8x5_SFLOAT_BLOCK,         {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  8,  5, 1, 1, 1}},
+    {VK_FORMAT_ASTC_8x6_SFLOAT_BLOCK,         {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  8,  6, 1, 1, 1}},
+    {VK_FORMAT_ASTC_8x8_SFLOAT_BLOCK,         {FORMAT_SIZE_COMPRESSED_BIT, 0, 128,  8,  8, 1, 1, 1}},
+    {VK_FORMAT_ASTC_10x5_SFLOAT_BLOCK,        {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10,  5, 1, 1, 1}},
+    {VK_FORMAT_ASTC_10x6_SFLOAT_BLOCK,        {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10,  6, 1, 1, 1}},
+    {VK_FORMAT_ASTC_10x8_SFLOAT_BLOCK,        {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10,  8, 1, 1, 1}},
+    {VK_FORMAT_ASTC_10x10_SFLOAT_BLOCK,       {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 10, 10, 1, 1, 1}},
+    {VK_FORMAT_ASTC_12x10_SFLOAT_BLOCK,       {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 12, 10, 1, 1, 1}},
+    {VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK,       {FORMAT_SIZE_COMPRESSED_BIT, 0, 128, 12, 12, 1, 1, 1}},
+    {VK_FORMAT_A4R4G4B4_UNORM_PACK16,         {FORMAT_SIZE_PACKED_BIT, 0,  16,  1,  1, 1, 1, 1}},
+    {VK_FORMAT_A4B4G4R4_UNORM_PACK16,         {FORMAT_SIZE_PACKED_BIT, 0,  16,  1,  1, 1, 1, 1}},
+#endif
+};
+
+/**
+ * @brief getFormatInfo
+ * @param format
+ * @return
+ *
+ * Returns the block size information for the format. Core formats are a
+ * single indexed load, extension formats are found with a binary search.
+ * Unknown formats return a block size of 0.
+ *
+ * Can be evaluated at compile time:
+ *
+ * static_assert( gvu::getFormatInfo(VK_FORMAT_R8G8B8A8_UNORM).blockSizeInBits == 32 );
+ */
+constexpr FormatInfo getFormatInfo( VkFormat format )
+{
+    constexpr size_t coreCount = sizeof(_coreFormatInfos) / sizeof(_coreFormatInfos[0]);
+    constexpr size_t extCount  = sizeof(_extensionFormatInfos) / sizeof(_extensionFormatInfos[0]);
+
+    if( static_cast<uint32_t>(format) < coreCount )
+        return _coreFormatInfos[ static_cast<uint32_t>(format) ];
+
+    size_t first = 0;
+    size_t last  = extCount;
+    while(first < last)
     {
-        case VK_FORMAT_R4G4_UNORM_PACK8:
-            pFormatSize->flags = FORMAT_SIZE_PACKED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 1 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R4G4B4A4_UNORM_PACK16:
-        case VK_FORMAT_B4G4R4A4_UNORM_PACK16:
-        case VK_FORMAT_R5G6B5_UNORM_PACK16:
-        case VK_FORMAT_B5G6R5_UNORM_PACK16:
-        case VK_FORMAT_R5G5B5A1_UNORM_PACK16:
-        case VK_FORMAT_B5G5R5A1_UNORM_PACK16:
-        case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
-            pFormatSize->flags = FORMAT_SIZE_PACKED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 2 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R8_UNORM:
-        case VK_FORMAT_R8_SNORM:
-        case VK_FORMAT_R8_USCALED:
-        case VK_FORMAT_R8_SSCALED:
-        case VK_FORMAT_R8_UINT:
-        case VK_FORMAT_R8_SINT:
-        case VK_FORMAT_R8_SRGB:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 1 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R8G8_UNORM:
-        case VK_FORMAT_R8G8_SNORM:
-        case VK_FORMAT_R8G8_USCALED:
-        case VK_FORMAT_R8G8_SSCALED:
-        case VK_FORMAT_R8G8_UINT:
-        case VK_FORMAT_R8G8_SINT:
-        case VK_FORMAT_R8G8_SRGB:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 2 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R8G8B8_UNORM:
-        case VK_FORMAT_R8G8B8_SNORM:
-        case VK_FORMAT_R8G8B8_USCALED:
-        case VK_FORMAT_R8G8B8_SSCALED:
-        case VK_FORMAT_R8G8B8_UINT:
-        case VK_FORMAT_R8G8B8_SINT:
-        case VK_FORMAT_R8G8B8_SRGB:
-        case VK_FORMAT_B8G8R8_UNORM:
-        case VK_FORMAT_B8G8R8_SNORM:
-        case VK_FORMAT_B8G8R8_USCALED:
-        case VK_FORMAT_B8G8R8_SSCALED:
-        case VK_FORMAT_B8G8R8_UINT:
-        case VK_FORMAT_B8G8R8_SINT:
-        case VK_FORMAT_B8G8R8_SRGB:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 3 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R8G8B8A8_UNORM:
-        case VK_FORMAT_R8G8B8A8_SNORM:
-        case VK_FORMAT_R8G8B8A8_USCALED:
-        case VK_FORMAT_R8G8B8A8_SSCALED:
-        case VK_FORMAT_R8G8B8A8_UINT:
-        case VK_FORMAT_R8G8B8A8_SINT:
-        case VK_FORMAT_R8G8B8A8_SRGB:
-        case VK_FORMAT_B8G8R8A8_UNORM:
-        case VK_FORMAT_B8G8R8A8_SNORM:
-        case VK_FORMAT_B8G8R8A8_USCALED:
-        case VK_FORMAT_B8G8R8A8_SSCALED:
-        case VK_FORMAT_B8G8R8A8_UINT:
-        case VK_FORMAT_B8G8R8A8_SINT:
-        case VK_FORMAT_B8G8R8A8_SRGB:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 4 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
-        case VK_FORMAT_A8B8G8R8_SNORM_PACK32:
-        case VK_FORMAT_A8B8G8R8_USCALED_PACK32:
-        case VK_FORMAT_A8B8G8R8_SSCALED_PACK32:
-        case VK_FORMAT_A8B8G8R8_UINT_PACK32:
-        case VK_FORMAT_A8B8G8R8_SINT_PACK32:
-        case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
-            pFormatSize->flags = FORMAT_SIZE_PACKED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 4 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
-        case VK_FORMAT_A2R10G10B10_SNORM_PACK32:
-        case VK_FORMAT_A2R10G10B10_USCALED_PACK32:
-        case VK_FORMAT_A2R10G10B10_SSCALED_PACK32:
-        case VK_FORMAT_A2R10G10B10_UINT_PACK32:
-        case VK_FORMAT_A2R10G10B10_SINT_PACK32:
-        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
-        case VK_FORMAT_A2B10G10R10_SNORM_PACK32:
-        case VK_FORMAT_A2B10G10R10_USCALED_PACK32:
-        case VK_FORMAT_A2B10G10R10_SSCALED_PACK32:
-        case VK_FORMAT_A2B10G10R10_UINT_PACK32:
-        case VK_FORMAT_A2B10G10R10_SINT_PACK32:
-            pFormatSize->flags = FORMAT_SIZE_PACKED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 4 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R16_UNORM:
-        case VK_FORMAT_R16_SNORM:
-        case VK_FORMAT_R16_USCALED:
-        case VK_FORMAT_R16_SSCALED:
-        case VK_FORMAT_R16_UINT:
-        case VK_FORMAT_R16_SINT:
-        case VK_FORMAT_R16_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 2 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R16G16_UNORM:
-        case VK_FORMAT_R16G16_SNORM:
-        case VK_FORMAT_R16G16_USCALED:
-        case VK_FORMAT_R16G16_SSCALED:
-        case VK_FORMAT_R16G16_UINT:
-        case VK_FORMAT_R16G16_SINT:
-        case VK_FORMAT_R16G16_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 4 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R16G16B16_UNORM:
-        case VK_FORMAT_R16G16B16_SNORM:
-        case VK_FORMAT_R16G16B16_USCALED:
-        case VK_FORMAT_R16G16B16_SSCALED:
-        case VK_FORMAT_R16G16B16_UINT:
-        case VK_FORMAT_R16G16B16_SINT:
-        case VK_FORMAT_R16G16B16_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 6 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R16G16B16A16_UNORM:
-        case VK_FORMAT_R16G16B16A16_SNORM:
-        case VK_FORMAT_R16G16B16A16_USCALED:
-        case VK_FORMAT_R16G16B16A16_SSCALED:
-        case VK_FORMAT_R16G16B16A16_UINT:
-        case VK_FORMAT_R16G16B16A16_SINT:
-        case VK_FORMAT_R16G16B16A16_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 8 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R32_UINT:
-        case VK_FORMAT_R32_SINT:
-        case VK_FORMAT_R32_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 4 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R32G32_UINT:
-        case VK_FORMAT_R32G32_SINT:
-        case VK_FORMAT_R32G32_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 8 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R32G32B32_UINT:
-        case VK_FORMAT_R32G32B32_SINT:
-        case VK_FORMAT_R32G32B32_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 12 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R32G32B32A32_UINT:
-        case VK_FORMAT_R32G32B32A32_SINT:
-        case VK_FORMAT_R32G32B32A32_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R64_UINT:
-        case VK_FORMAT_R64_SINT:
-        case VK_FORMAT_R64_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 8 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R64G64_UINT:
-        case VK_FORMAT_R64G64_SINT:
-        case VK_FORMAT_R64G64_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R64G64B64_UINT:
-        case VK_FORMAT_R64G64B64_SINT:
-        case VK_FORMAT_R64G64B64_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 24 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_R64G64B64A64_UINT:
-        case VK_FORMAT_R64G64B64A64_SINT:
-        case VK_FORMAT_R64G64B64A64_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 32 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
-        case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
-            pFormatSize->flags = FORMAT_SIZE_PACKED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 4 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_D16_UNORM:
-            pFormatSize->flags = FORMAT_SIZE_DEPTH_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 2 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_X8_D24_UNORM_PACK32:
-            pFormatSize->flags = static_cast<FormatSizeFlags>(FORMAT_SIZE_PACKED_BIT | FORMAT_SIZE_DEPTH_BIT);
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 4 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_D32_SFLOAT:
-            pFormatSize->flags = FORMAT_SIZE_DEPTH_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 4 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_S8_UINT:
-            pFormatSize->flags = FORMAT_SIZE_STENCIL_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 1 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_D16_UNORM_S8_UINT:
-            pFormatSize->flags = static_cast<FormatSizeFlags>(FORMAT_SIZE_DEPTH_BIT | FORMAT_SIZE_STENCIL_BIT);
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 3 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_D24_UNORM_S8_UINT:
-            pFormatSize->flags = static_cast<FormatSizeFlags>(FORMAT_SIZE_DEPTH_BIT | FORMAT_SIZE_STENCIL_BIT);
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 4 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_D32_SFLOAT_S8_UINT:
-            pFormatSize->flags = static_cast<FormatSizeFlags>(FORMAT_SIZE_DEPTH_BIT | FORMAT_SIZE_STENCIL_BIT);
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 8 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
-        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
-        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
-        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
-        case VK_FORMAT_BC4_UNORM_BLOCK:
-        case VK_FORMAT_BC4_SNORM_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 8 * 8;
-            pFormatSize->blockWidth = 4;
-            pFormatSize->blockHeight = 4;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_BC2_UNORM_BLOCK:
-        case VK_FORMAT_BC2_SRGB_BLOCK:
-        case VK_FORMAT_BC3_UNORM_BLOCK:
-        case VK_FORMAT_BC3_SRGB_BLOCK:
-        case VK_FORMAT_BC5_UNORM_BLOCK:
-        case VK_FORMAT_BC5_SNORM_BLOCK:
-        case VK_FORMAT_BC6H_UFLOAT_BLOCK:
-        case VK_FORMAT_BC6H_SFLOAT_BLOCK:
-        case VK_FORMAT_BC7_UNORM_BLOCK:
-        case VK_FORMAT_BC7_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 4;
-            pFormatSize->blockHeight = 4;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
-        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
-        case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
-        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 8 * 8;
-            pFormatSize->blockWidth = 4;
-            pFormatSize->blockHeight = 4;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
-        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
-        case VK_FORMAT_EAC_R11_UNORM_BLOCK:
-        case VK_FORMAT_EAC_R11_SNORM_BLOCK:
-        case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
-        case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 4;
-            pFormatSize->blockHeight = 4;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_PVRTC1_2BPP_SRGB_BLOCK_IMG:
-        case VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 8 * 8;
-            pFormatSize->blockWidth = 8;
-            pFormatSize->blockHeight = 4;
-            pFormatSize->blockDepth = 1;
-            pFormatSize->minBlocksX = 2;
-            pFormatSize->minBlocksY = 2;
-            break;
-        case VK_FORMAT_PVRTC2_2BPP_SRGB_BLOCK_IMG:
-        case VK_FORMAT_PVRTC2_2BPP_UNORM_BLOCK_IMG:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 8 * 8;
-            pFormatSize->blockWidth = 8;
-            pFormatSize->blockHeight = 4;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_PVRTC1_4BPP_SRGB_BLOCK_IMG:
-        case VK_FORMAT_PVRTC1_4BPP_UNORM_BLOCK_IMG:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 8 * 8;
-            pFormatSize->blockWidth = 4;
-            pFormatSize->blockHeight = 4;
-            pFormatSize->blockDepth = 1;
-            pFormatSize->minBlocksX = 2;
-            pFormatSize->minBlocksY = 2;
-            break;
-        case VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG:
-        case VK_FORMAT_PVRTC2_4BPP_UNORM_BLOCK_IMG:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 8 * 8;
-            pFormatSize->blockWidth = 4;
-            pFormatSize->blockHeight = 4;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 4;
-            pFormatSize->blockHeight = 4;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 5;
-            pFormatSize->blockHeight = 4;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 5;
-            pFormatSize->blockHeight = 5;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 6;
-            pFormatSize->blockHeight = 5;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 6;
-            pFormatSize->blockHeight = 6;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 8;
-            pFormatSize->blockHeight = 5;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 8;
-            pFormatSize->blockHeight = 6;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 8;
-            pFormatSize->blockHeight = 8;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 10;
-            pFormatSize->blockHeight = 5;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 10;
-            pFormatSize->blockHeight = 6;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 10;
-            pFormatSize->blockHeight = 8;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 10;
-            pFormatSize->blockHeight = 10;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_12x10_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 12;
-            pFormatSize->blockHeight = 10;
-            pFormatSize->blockDepth = 1;
-            break;
-        case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:
-        case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
-            pFormatSize->flags = FORMAT_SIZE_COMPRESSED_BIT;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 16 * 8;
-            pFormatSize->blockWidth = 12;
-            pFormatSize->blockHeight = 12;
-            pFormatSize->blockDepth = 1;
-            break;
-        default:
-            pFormatSize->flags = FORMAT_SIZE_UNKNOWN;
-            pFormatSize->paletteSizeInBits = 0;
-            pFormatSize->blockSizeInBits = 0 * 8;
-            pFormatSize->blockWidth = 1;
-            pFormatSize->blockHeight = 1;
-            pFormatSize->blockDepth = 1;
-            break;
+        size_t mid = first + (last - first) / 2;
+        if( _extensionFormatInfos[mid].format < format )
+            first = mid + 1;
+        else
+            last = mid;
     }
-    return info;
+    if(first < extCount && _extensionFormatInfos[first].format == format)
+        return _extensionFormatInfos[first].info;
+
+    return _coreFormatInfos[VK_FORMAT_UNDEFINED];
 }
 
+/**
+ * @brief getMipExtent
+ * @param extent
+ * @param mipLevel
+ * @return
+ *
+ * The size of one dimension of a mip level, which is never less than 1
+ */
+constexpr uint32_t getMipExtent(uint32_t extent, uint32_t mipLevel)
+{
+    uint32_t e = mipLevel < 32 ? (extent >> mipLevel) : 0u;
+    return e == 0 ? 1u : e;
+}
+
+/**
+ * @brief getFormatRowPitch
+ * @param format
+ * @param width
+ * @return
+ *
+ * The number of bytes in one row of blocks of a tightly packed image
+ * which is width texels wide.
+ */
+constexpr VkDeviceSize getFormatRowPitch(VkFormat format, uint32_t width)
+{
+    auto info   = getFormatInfo(format);
+    auto blocks = (width + info.blockWidth - 1) / info.blockWidth;
+    if(blocks < info.minBlocksX)
+        blocks = info.minBlocksX;
+    return VkDeviceSize(blocks) * (info.blockSizeInBits / 8);
+}
+
+/**
+ * @brief getFormatMipLevelSize
+ * @param format
+ * @param extent
+ * @param mipLevel
+ * @return
+ *
+ * The number of bytes of a single layer of a tightly packed mip level
+ */
+constexpr VkDeviceSize getFormatMipLevelSize(VkFormat format, VkExtent3D extent, uint32_t mipLevel = 0)
+{
+    auto info   = getFormatInfo(format);
+    auto width  = getMipExtent(extent.width,  mipLevel);
+    auto height = getMipExtent(extent.height, mipLevel);
+    auto depth  = getMipExtent(extent.depth,  mipLevel);
+
+    auto rows = (height + info.blockHeight - 1) / info.blockHeight;
+    if(rows < info.minBlocksY)
+        rows = info.minBlocksY;
+    auto slices = (depth + info.blockDepth - 1) / info.blockDepth;
+
+    return getFormatRowPitch(format, width) * rows * slices;
+}
+
+/**
+ * @brief getFormatImageSize
+ * @param format
+ * @param extent
+ * @param mipLevels
+ * @param arrayLayers
+ * @return
+ *
+ * The total number of bytes of a tightly packed image with all its mip
+ * levels and array layers.
+ */
+constexpr VkDeviceSize getFormatImageSize(VkFormat format, VkExtent3D extent, uint32_t mipLevels = 1, uint32_t arrayLayers = 1)
+{
+    VkDeviceSize size = 0;
+    for(uint32_t m = 0; m < mipLevels; m++)
+        size += getFormatMipLevelSize(format, extent, m);
+    return size * arrayLayers;
+}
 
 }
 
@@ -10,37 +10,12 @@
 #include <cstring>
 #include <algorithm>
 #include <map>
-#include <streambuf>
-#include <fstream>
+#include <iostream>
 #include "FormatInfo.h"
-
-// C++17 includes the <filesystem> library, but
-// unfortunately gcc7 does not have a finalized version of it
-// it is in the <experimental/filesystem lib
-// this section includes the proper header
-// depending on whether the header exists and
-// includes that. It also sets the
-// nfcbn::nf namespace
-#if __has_include(<filesystem>)
-
-    #include <filesystem>
-    namespace guv
-    {
-        namespace fs = std::filesystem;
-    }
-
-#elif __has_include(<experimental/filesystem>)
-
-    #include <experimental/filesystem>
-    namespace guv
-    {
-        namespace fs = std::experimental::filesystem;
-    }
-
-#else
-    #error There is no <filesystem> or <experimental/filesystem>
-#endif
-
+#include "Hash.h"
+#include "StaticVector.h"
+#include "SpecializationConstants.h"
+#include "Cache/ShaderModuleCache.h"
 
 namespace gvu
 {
@@ -67,35 +42,6 @@ namespace gvu
 }
 #endif
 
-struct ShaderModuleCreateInfo
-{
-    std::vector<uint32_t> code;
-
-    ShaderModuleCreateInfo() = default;
-    ShaderModuleCreateInfo(guv::fs::path const &f)
-    {
-        loadCode(f);
-    }
-    void loadCode(guv::fs::path const & f)
-    {
-        std::ifstream t(f);
-        std::string str((std::istreambuf_iterator<char>(t)),
-                         std::istreambuf_iterator<char>());
-        code.resize(str.size() / sizeof(uint32_t));
-        std::memcpy(code.data(), str.data(), str.size());
-    }
-
-    template<typename callable_t>
-    auto create(callable_t && C) const
-    {
-        VkShaderModuleCreateInfo ci = {};
-        ci.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        ci.pCode = code.data();
-        ci.codeSize = static_cast<uint32_t>(code.size() * 4);
-        return C(ci);
-    }
-};
-
 /**
  * @brief The GraphicsPipelineCreateInfo struct
  *
@@ -114,14 +60,31 @@ struct ShaderModuleCreateInfo
  *  });
  *
  *  This structure can be hashed in an unordered map so that you can
+ *
+ *  The storage_t template parameter decides which container is used for the
+ *  arrays, see DynamicStorage and InlineStorage. Use GraphicsPipelineCreateInfo
+ *  or InlineGraphicsPipelineCreateInfo instead of using this directly.
  */
-struct GraphicsPipelineCreateInfo
+template<typename storage_t>
+struct GraphicsPipelineCreateInfo_t : public SealedHash<GraphicsPipelineCreateInfo_t<storage_t>>
 {
+    using create_info_type = VkGraphicsPipelineCreateInfo;
+    using object_type      = VkPipeline;
+
+    template<typename T, size_t N>
+    using vector_type = typename storage_t::template vector_type<T,N>;
+
+    // Maximums used by the InlineStorage containers.
+    static constexpr size_t maxVertexBindings   = 16;
+    static constexpr size_t maxVertexAttributes = 16;
+    static constexpr size_t maxColorTargets     = 8;
+    static constexpr size_t maxDynamicStates    = 16;
+
     using vertexAttributeLocationIndex_type = uint32_t;
     using vertexAttributeBindingIndex_type = uint32_t;
 
-    std::vector<VkVertexInputBindingDescription>   inputBindings;
-    std::vector<VkVertexInputAttributeDescription> inputVertexAttributes;
+    vector_type<VkVertexInputBindingDescription,   maxVertexBindings>   inputBindings;
+    vector_type<VkVertexInputAttributeDescription, maxVertexAttributes> inputVertexAttributes;
 
 
     VkViewport                  viewport          = {0, 0, 256, 256, 0, 1.f};
@@ -152,67 +115,91 @@ struct GraphicsPipelineCreateInfo
     VkPipelineLayout pipelineLayout    = VK_NULL_HANDLE;
     VkRenderPass     renderPass        = VK_NULL_HANDLE;
 
-    std::vector<VkDynamicState> dynamicStates;
+    vector_type<VkDynamicState, maxDynamicStates> dynamicStates;
 
-    size_t hash() const
-    {
-        std::hash<size_t> Hs;
-        auto h = Hs(inputBindings.size());
-
-        auto hash_combine = [](std::size_t& seed, const auto& v)
-        {
-            std::hash<std::decay_t<decltype(v)> > hasher;
-            seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-        };
-
-        for(auto & a : inputBindings)
-        {
-            hash_combine(h, a.stride);
-            hash_combine(h, a.binding);
-            hash_combine(h, a.inputRate);
-        }
-
-        hash_combine(h, inputVertexAttributes.size());
-        for(auto & a : inputVertexAttributes)
-        {
-            hash_combine(h, a.format);
-            hash_combine(h, a.offset);
-            hash_combine(h, a.binding);
-            hash_combine(h, a.location);
-        }
+    // The specialization constants of each stage, eg:
+    // gci.fragmentSpecialization.set(0, true); // layout(constant_id = 0) const bool USE_FOG = false;
+    // Different values create different pipelines from the same shader modules.
+    SpecializationConstants_t<storage_t> vertexSpecialization;
+    SpecializationConstants_t<storage_t> tessControlSpecialization;
+    SpecializationConstants_t<storage_t> tessEvalSpecialization;
+    SpecializationConstants_t<storage_t> fragmentSpecialization;
 
-        hash_combine(h, viewport.x);
-        hash_combine(h, viewport.y);
-        hash_combine(h, viewport.width);
-        hash_combine(h, viewport.height);
-        hash_combine(h, scissor.extent.width);
-        hash_combine(h, scissor.extent.height);
-        hash_combine(h, scissor.offset.x);
-        hash_combine(h, scissor.offset.y);
-        hash_combine(h, topology                     );
-        hash_combine(h, polygonMode                  );
-        hash_combine(h, cullMode                     );
-        hash_combine(h, frontFace                    );
-        hash_combine(h, enableDepthTest              );
-        hash_combine(h, enableDepthWrite             );
-        hash_combine(h, tesselationPatchControlPoints);
-
-        hash_combine(h, vertexShader      );
-        hash_combine(h, tessEvalShader    );
-        hash_combine(h, tessControlShader );
-        hash_combine(h, fragmentShader    );
-        hash_combine(h, pipelineLayout    );
-        hash_combine(h, renderPass        );
-
-        hash_combine(h, outputColorTargets);
-        hash_combine(h, enableBlending);
-        for(auto & s : dynamicStates)
-        {
-            hash_combine(h, s);
-        }
+    size_t computeHash() const
+    {
+        size_t h = 0;
+
+        hashCombineRange(h, inputBindings);
+        hashCombineRange(h, inputVertexAttributes);
+
+        hashCombine(h, viewport.x);
+        hashCombine(h, viewport.y);
+        hashCombine(h, viewport.width);
+        hashCombine(h, viewport.height);
+        hashCombine(h, viewport.minDepth);
+        hashCombine(h, viewport.maxDepth);
+        hashCombineArray(h, &scissor, 1);
+        hashCombine(h, topology                     );
+        hashCombine(h, polygonMode                  );
+        hashCombine(h, cullMode                     );
+        hashCombine(h, frontFace                    );
+        hashCombine(h, enableDepthTest              );
+        hashCombine(h, enableDepthWrite             );
+        hashCombine(h, tesselationPatchControlPoints);
+
+        hashCombine(h, vertexShader      );
+        hashCombine(h, tessEvalShader    );
+        hashCombine(h, tessControlShader );
+        hashCombine(h, fragmentShader    );
+        hashCombine(h, pipelineLayout    );
+        hashCombine(h, renderPass        );
+
+        hashCombine(h, outputColorTargets);
+        hashCombine(h, enableBlending);
+        hashCombineRange(h, dynamicStates);
+
+        hashCombine(h, vertexSpecialization.hash());
+        hashCombine(h, tessControlSpecialization.hash());
+        hashCombine(h, tessEvalSpecialization.hash());
+        hashCombine(h, fragmentSpecialization.hash());
         return h;
     }
 
+    bool operator==(GraphicsPipelineCreateInfo_t const & B) const
+    {
+        if(this->_sealedHashesDiffer(B))
+            return false;
+        return rangeEqual(inputBindings, B.inputBindings)
+            && rangeEqual(inputVertexAttributes, B.inputVertexAttributes)
+            && floatEqual(viewport.x,        B.viewport.x)
+            && floatEqual(viewport.y,        B.viewport.y)
+            && floatEqual(viewport.width,    B.viewport.width)
+            && floatEqual(viewport.height,   B.viewport.height)
+            && floatEqual(viewport.minDepth, B.viewport.minDepth)
+            && floatEqual(viewport.maxDepth, B.viewport.maxDepth)
+            && podEqual(&scissor, &B.scissor, 1)
+            && topology                      == B.topology
+            && polygonMode                   == B.polygonMode
+            && cullMode                      == B.cullMode
+            && frontFace                     == B.frontFace
+            && enableDepthTest               == B.enableDepthTest
+            && enableDepthWrite              == B.enableDepthWrite
+            && tesselationPatchControlPoints == B.tesselationPatchControlPoints
+            && vertexShader                  == B.vertexShader
+            && tessEvalShader                == B.tessEvalShader
+            && tessControlShader             == B.tessControlShader
+            && fragmentShader                == B.fragmentShader
+            && pipelineLayout                == B.pipelineLayout
+            && renderPass                    == B.renderPass
+            && outputColorTargets            == B.outputColorTargets
+            && enableBlending                == B.enableBlending
+            && rangeEqual(dynamicStates, B.dynamicStates)
+            && vertexSpecialization          == B.vertexSpecialization
+            && tessControlSpecialization     == B.tessControlSpecialization
+            && tessEvalSpecialization        == B.tessEvalSpecialization
+            && fragmentSpecialization        == B.fragmentSpecialization;
+    }
+
 
     /**
      * @brief setVertexInputs
@@ -238,28 +225,15 @@ struct GraphicsPipelineCreateInfo
      * VkDeviceSize offsets[] = {o1,o2,o3};
      * vkCmdBindVertexBuffers(cmd, 0, 3, buffers, offsets);
      */
+    void setVertexInputs(std::initializer_list<VkFormat> formats)
+    {
+        _setVertexInputs(formats.begin(), formats.end());
+    }
     void setVertexInputs(std::vector<VkFormat> const & formats)
     {
-        uint32_t i = 0;
-        constexpr uint32_t bindingBaseIndex = 0;
-        constexpr uint32_t locationBaseIndex = 0;
-        inputVertexAttributes.clear();
-        inputBindings.clear();
-        for(auto const & f : formats)
-        {
-            auto & a = inputVertexAttributes.emplace_back();
-            a.format   = f;
-            a.offset   = 0;
-            a.binding  = bindingBaseIndex + i;
-            a.location = locationBaseIndex + i;
-
-            auto & b    = inputBindings.emplace_back();
-            b.stride    = getFormatInfo(f).blockSizeInBits / 8;
-            b.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-            b.binding   = a.binding;
-            ++i;
-        }
+        _setVertexInputs(formats.begin(), formats.end());
     }
+
     /**
      * @brief setVertexInputs
      * @param locationIndex
@@ -286,26 +260,67 @@ struct GraphicsPipelineCreateInfo
      *
      * vkCmdBindVertexBuffers(cmd, 0, 1, &buffer, &offset);
      */
+    void setVertexInputs(vertexAttributeBindingIndex_type  bindingIndex,
+                         vertexAttributeLocationIndex_type locationBaseIndex,
+                         std::initializer_list<VkFormat> formats,
+                         VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX)
+    {
+        _setVertexInputs(bindingIndex, locationBaseIndex, formats.begin(), formats.end(), inputRate);
+    }
     void setVertexInputs(vertexAttributeBindingIndex_type  bindingIndex,
                          vertexAttributeLocationIndex_type locationBaseIndex,
                          std::vector<VkFormat> const & formats,
                          VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX)
+    {
+        _setVertexInputs(bindingIndex, locationBaseIndex, formats.begin(), formats.end(), inputRate);
+    }
+
+    template<typename iterator_t>
+    void _setVertexInputs(iterator_t first, iterator_t last)
+    {
+        uint32_t i = 0;
+        constexpr uint32_t bindingBaseIndex = 0;
+        constexpr uint32_t locationBaseIndex = 0;
+        inputVertexAttributes.clear();
+        inputBindings.clear();
+        for(; first != last; ++first)
+        {
+            auto f = *first;
+            auto & a = inputVertexAttributes.emplace_back();
+            a.format   = f;
+            a.offset   = 0;
+            a.binding  = bindingBaseIndex + i;
+            a.location = locationBaseIndex + i;
+
+            auto & b    = inputBindings.emplace_back();
+            b.stride    = getFormatInfo(f).blockSizeInBits / 8;
+            b.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+            b.binding   = a.binding;
+            ++i;
+        }
+    }
+    template<typename iterator_t>
+    void _setVertexInputs(vertexAttributeBindingIndex_type  bindingIndex,
+                          vertexAttributeLocationIndex_type locationBaseIndex,
+                          iterator_t first, iterator_t last,
+                          VkVertexInputRate inputRate)
     {
         uint32_t offset = 0;
         uint32_t i = 0;
-        for(auto & f : formats)
+        for(; first != last; ++first)
         {
             VkVertexInputAttributeDescription a;
-            a.format   = f;
+            a.format   = *first;
             a.offset   = offset;
             a.binding  = bindingIndex;
             a.location = locationBaseIndex + i;
-            offset    += getFormatInfo(f).blockSizeInBits / 8;
+            offset    += getFormatInfo(a.format).blockSizeInBits / 8;
             inputVertexAttributes.push_back(a);
             i++;
         }
         auto & b = inputBindings.emplace_back();
-        b.stride = offset;
+        b.binding   = bindingIndex;
+        b.stride    = offset;
         b.inputRate = inputRate;
     }
 
@@ -331,7 +346,15 @@ struct GraphicsPipelineCreateInfo
     template<typename callable_t>
     auto create(callable_t && C) const
     {
-        std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+        // shader stages and blend states are stored on the stack,
+        // so no memory is allocated when generating the create info
+        StaticVector<VkPipelineShaderStageCreateInfo, 4> shaderStages;
+
+        // only referenced by the stages which have constants
+        VkSpecializationInfo vertSpecInfo        = vertexSpecialization.getVkSpecializationInfo();
+        VkSpecializationInfo fragSpecInfo        = fragmentSpecialization.getVkSpecializationInfo();
+        VkSpecializationInfo tessControlSpecInfo = tessControlSpecialization.getVkSpecializationInfo();
+        VkSpecializationInfo tessEvalSpecInfo    = tessEvalSpecialization.getVkSpecializationInfo();
 
         {
             auto & vertShaderStageInfo = shaderStages.emplace_back();
@@ -339,6 +362,7 @@ struct GraphicsPipelineCreateInfo
             vertShaderStageInfo.stage  = VK_SHADER_STAGE_VERTEX_BIT;
             vertShaderStageInfo.module = vertexShader;
             vertShaderStageInfo.pName  = "main";
+            vertShaderStageInfo.pSpecializationInfo = vertexSpecialization.empty() ? nullptr : &vertSpecInfo;
         }
 
         {
@@ -347,6 +371,7 @@ struct GraphicsPipelineCreateInfo
             fragShaderStageInfo.stage  = VK_SHADER_STAGE_FRAGMENT_BIT;
             fragShaderStageInfo.module = fragmentShader;
             fragShaderStageInfo.pName  = "main";
+            fragShaderStageInfo.pSpecializationInfo = fragmentSpecialization.empty() ? nullptr : &fragSpecInfo;
         }
 
         if( tessControlShader != VK_NULL_HANDLE &&  tessEvalShader != VK_NULL_HANDLE )
@@ -357,13 +382,15 @@ struct GraphicsPipelineCreateInfo
                 stageInfo.stage  = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
                 stageInfo.module = tessControlShader;
                 stageInfo.pName  = "main";
+                stageInfo.pSpecializationInfo = tessControlSpecialization.empty() ? nullptr : &tessControlSpecInfo;
             }
             {
                 auto & stageInfo = shaderStages.emplace_back();
                 stageInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-                stageInfo.stage  = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+                stageInfo.stage  = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
                 stageInfo.module = tessEvalShader;
                 stageInfo.pName  = "main";
+                stageInfo.pSpecializationInfo = tessEvalSpecialization.empty() ? nullptr : &tessEvalSpecInfo;
             }
         }
 
@@ -444,13 +471,16 @@ struct GraphicsPipelineCreateInfo
         colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
         colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA; //vk::BlendFactor::eOneMinusDstAlpha;
         colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA;//vk::BlendFactor::eOneMinusDstAlpha;
-        std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments( outputColorTargets, colorBlendAttachment);
+        if(outputColorTargets > maxColorTargets)
+            throw std::length_error("outputColorTargets is larger than maxColorTargets");
+        StaticVector<VkPipelineColorBlendAttachmentState, maxColorTargets> colorBlendAttachments;
+        colorBlendAttachments.resize(outputColorTargets, colorBlendAttachment);
 
         VkPipelineColorBlendStateCreateInfo colorBlending{};
         colorBlending.sType             = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
         colorBlending.logicOpEnable     = VK_FALSE;
         colorBlending.logicOp           = VK_LOGIC_OP_COPY;
-        colorBlending.attachmentCount   = 1;
+        colorBlending.attachmentCount   = static_cast<uint32_t>(colorBlendAttachments.size());
         colorBlending.pAttachments      = colorBlendAttachments.data();
         colorBlending.blendConstants[0] = 0.0f;
         colorBlending.blendConstants[1] = 0.0f;
@@ -498,8 +528,44 @@ struct GraphicsPipelineCreateInfo
 
         return C(pipelineInfo);
     }
+
+    /**
+     * @brief generateVkCreateInfo
+     * @param c
+     *
+     * Used by Cache_t, same as create() but the return value of
+     * the callable is ignored.
+     */
+    template<typename callable_t>
+    void generateVkCreateInfo(callable_t && c) const
+    {
+        create([&](VkGraphicsPipelineCreateInfo & info)
+        {
+            c(info);
+        });
+    }
+
+    static object_type create(VkDevice device, create_info_type const & C)
+    {
+        return create(device, VK_NULL_HANDLE, C);
+    }
+    static object_type create(VkDevice device, VkPipelineCache pipelineCache, create_info_type const & C)
+    {
+        object_type obj = VK_NULL_HANDLE;
+        auto result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &C, nullptr, &obj);
+        if( result != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+        return obj;
+    }
+    static void destroy(VkDevice device, object_type c)
+    {
+        vkDestroyPipeline(device, c, nullptr);
+    }
 };
 
+using GraphicsPipelineCreateInfo       = GraphicsPipelineCreateInfo_t<DynamicStorage>;
+using InlineGraphicsPipelineCreateInfo = GraphicsPipelineCreateInfo_t<InlineStorage>;
+
 }
 
 #endif
@@ -0,0 +1,286 @@
+#ifndef GVU_HASH_H
+#define GVU_HASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <limits>
+
+namespace gvu
+{
+
+/**
+ * @brief hashBytes
+ * @param data
+ * @param len
+ * @param seed
+ * @return
+ *
+ * A fast 64-bit hash of a block of memory (MurmurHash64A). This
+ * reads 8 bytes at a time, so it is much faster than combining
+ * each field of a struct one at a time.
+ */
+inline uint64_t hashBytes(void const * data, size_t len, uint64_t seed = 0)
+{
+    constexpr uint64_t m = 0xc6a4a7935bd1e995ULL;
+    constexpr int      r = 47;
+
+    uint64_t h = seed ^ (len * m);
+
+    auto const * p   = static_cast<unsigned char const*>(data);
+    auto const * end = p + (len & ~size_t(7));
+
+    while(p != end)
+    {
+        uint64_t k;
+        std::memcpy(&k, p, sizeof(k));
+        p += sizeof(k);
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    switch(len & 7)
+    {
+        case 7: h ^= uint64_t(p[6]) << 48; [[fallthrough]];
+        case 6: h ^= uint64_t(p[5]) << 40; [[fallthrough]];
+        case 5: h ^= uint64_t(p[4]) << 32; [[fallthrough]];
+        case 4: h ^= uint64_t(p[3]) << 24; [[fallthrough]];
+        case 3: h ^= uint64_t(p[2]) << 16; [[fallthrough]];
+        case 2: h ^= uint64_t(p[1]) << 8;  [[fallthrough]];
+        case 1: h ^= uint64_t(p[0]);
+                h *= m;
+                break;
+        default:
+                break;
+    };
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+
+    return h;
+}
+
+/**
+ * @brief hashValue
+ * @param v
+ * @return
+ *
+ * Converts a single value (integer, enum, pointer, handle or float)
+ * into a 64-bit value which can be combined using hashCombine.
+ *
+ * Floats are normalized so that -0.0 and 0.0 hash the same and all
+ * NaNs hash the same, to match floatEqual()
+ */
+template<typename T>
+inline uint64_t hashValue(T const & v)
+{
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        T x = v == T(0) ? T(0) : v;
+        if(x != x)
+            x = std::numeric_limits<T>::quiet_NaN();
+        return hashBytes(&x, sizeof(x));
+    }
+    else if constexpr (std::is_enum_v<T>)
+    {
+        return static_cast<uint64_t>(v);
+    }
+    else if constexpr (std::is_pointer_v<T>)
+    {
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(v));
+    }
+    else
+    {
+        static_assert(std::is_integral_v<T>, "Use hashCombineArray for structs");
+        return static_cast<uint64_t>(v);
+    }
+}
+
+/**
+ * @brief hashCombine
+ * @param seed
+ * @param v
+ *
+ * Combine a value into the seed.
+ */
+template<typename T>
+inline void hashCombine(size_t & seed, T const & v)
+{
+    uint64_t h = (static_cast<uint64_t>(seed) ^ hashValue(v)) * 0x9E3779B97F4A7C15ULL;
+    seed = static_cast<size_t>(h ^ (h >> 32));
+}
+
+/**
+ * @brief hashCombineArray
+ * @param seed
+ * @param data
+ * @param count
+ *
+ * Hash an array of POD vulkan structs as a single block of memory.
+ *
+ * The struct must not contain any padding or floating point
+ * values, otherwise two structs which compare equal could generate
+ * different hashes.
+ */
+template<typename T>
+inline void hashCombineArray(size_t & seed, T const * data, size_t count)
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>,
+                  "The type must have no padding and no floating point members");
+    seed = static_cast<size_t>(hashBytes(data, count * sizeof(T), static_cast<uint64_t>(seed) ^ count));
+}
+
+/**
+ * @brief hashCombineRange
+ * @param seed
+ * @param c
+ *
+ * Hash a contiguous container (eg: std::vector) of POD vulkan structs
+ */
+template<typename Container_t>
+inline void hashCombineRange(size_t & seed, Container_t const & c)
+{
+    hashCombineArray(seed, c.data(), c.size());
+}
+
+/**
+ * @brief floatEqual
+ * @param a
+ * @param b
+ * @return
+ *
+ * Equality for floats used by the CreateInfo structs. This is the
+ * same as a==b except that NaN is equal to NaN, otherwise a
+ * create info containing a NaN would never be found in a cache.
+ */
+template<typename T>
+inline bool floatEqual(T a, T b)
+{
+    static_assert(std::is_floating_point_v<T>);
+    return a == b || (a != a && b != b);
+}
+
+/**
+ * @brief podEqual
+ * @param a
+ * @param b
+ * @param count
+ * @return
+ *
+ * Compares two arrays of POD vulkan structs byte for byte. This is
+ * the equality which matches hashCombineArray.
+ */
+template<typename T>
+inline bool podEqual(T const * a, T const * b, size_t count)
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>,
+                  "The type must have no padding and no floating point members");
+    return count == 0 || std::memcmp(a, b, count * sizeof(T)) == 0;
+}
+
+/**
+ * @brief rangeEqual
+ * @param a
+ * @param b
+ * @return
+ *
+ * Compares two contiguous containers of POD vulkan structs. This is
+ * the equality which matches hashCombineRange.
+ */
+template<typename Container_t>
+inline bool rangeEqual(Container_t const & a, Container_t const & b)
+{
+    return a.size() == b.size() && podEqual(a.data(), b.data(), a.size());
+}
+
+/**
+ * @brief The SealedHash struct
+ *
+ * CreateInfo structs inherit from this to be able to store
+ * a precomputed hash. The derived class must provide a
+ * computeHash() function.
+ *
+ * gvu::RenderPassCreateInfo R = ...;
+ * R.seal();  // the hash is computed once and stored.
+ *
+ * cache.create(R); // no hashing is done
+ *
+ * If you modify the struct after it has been sealed, you must call
+ * unseal() or seal() again.
+ *
+ * Copies are not sealed, a copy is usually made to be modified and
+ * would otherwise keep the hash of the original. Moves keep the seal.
+ *
+ * Cache_t seals the copies it stores, so they are only ever hashed once.
+ */
+template<typename Derived_t>
+struct SealedHash
+{
+    SealedHash() = default;
+
+    SealedHash(SealedHash const &)
+    {
+    }
+
+    SealedHash(SealedHash &&) = default;
+
+    SealedHash & operator=(SealedHash const &)
+    {
+        m_sealed = false;
+        return *this;
+    }
+
+    SealedHash & operator=(SealedHash &&) = default;
+
+    size_t hash() const
+    {
+        if(m_sealed)
+            return m_sealedHash;
+        return static_cast<Derived_t const&>(*this).computeHash();
+    }
+
+    void seal() const
+    {
+        m_sealedHash = static_cast<Derived_t const&>(*this).computeHash();
+        m_sealed     = true;
+    }
+
+    void unseal() const
+    {
+        m_sealed = false;
+    }
+
+    bool isSealed() const
+    {
+        return m_sealed;
+    }
+
+protected:
+    /**
+     * @brief _sealedHashesDiffer
+     * @param B
+     * @return
+     *
+     * Returns true if both objects are sealed and have different hashes.
+     * Meaning they cannot be equal. Used as an early out in operator==
+     */
+    bool _sealedHashesDiffer(SealedHash const & B) const
+    {
+        return m_sealed && B.m_sealed && m_sealedHash != B.m_sealedHash;
+    }
+
+private:
+    mutable size_t m_sealedHash = 0;
+    mutable bool   m_sealed     = false;
+};
+
+}
+
+#endif
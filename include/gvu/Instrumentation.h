@@ -0,0 +1,308 @@
+#ifndef GVU_INSTRUMENTATION_H
+#define GVU_INSTRUMENTATION_H
+
+/**
+ * Opt-in statistics and tracing hooks.
+ *
+ * Define GVU_ENABLE_INSTRUMENTATION for the whole program (eg: with the
+ * gvu_ENABLE_INSTRUMENTATION cmake option) to enable them. When it is not
+ * defined, the GVU_SCOPE/GVU_COUNT macros expand to nothing and the stats()
+ * members are not compiled into the caches, so there is no overhead.
+ *
+ * The macro changes the layout of some classes. It must be defined the same
+ * way in every translation unit which includes gvu.
+ */
+#if defined(GVU_ENABLE_INSTRUMENTATION)
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace gvu
+{
+namespace instrumentation
+{
+
+/**
+ * @brief The Counter struct
+ *
+ * A relaxed atomic counter.
+ */
+struct Counter
+{
+    void add(uint64_t n = 1)
+    {
+        m_value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t get() const
+    {
+        return m_value.load(std::memory_order_relaxed);
+    }
+    void reset()
+    {
+        m_value.store(0, std::memory_order_relaxed);
+    }
+protected:
+    std::atomic<uint64_t> m_value{0};
+};
+
+/**
+ * @brief The Histogram struct
+ *
+ * A histogram of durations in nanoseconds with power of two buckets.
+ * Bucket 0 holds durations below 1ns, bucket i holds durations in
+ * [2^(i-1), 2^i) ns. The last bucket also holds everything above it.
+ *
+ * Recording is lock free and can be done from any thread.
+ */
+struct Histogram
+{
+    static constexpr size_t bucket_count = 40; // ~9 minutes
+
+    void record(uint64_t ns)
+    {
+        size_t b = 0;
+        while(b + 1 < bucket_count && ns >= (uint64_t(1) << b))
+            ++b;
+        m_buckets[b].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_total.fetch_add(ns, std::memory_order_relaxed);
+
+        auto m = m_max.load(std::memory_order_relaxed);
+        while(ns > m && !m_max.compare_exchange_weak(m, ns, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void record(std::chrono::steady_clock::duration d)
+    {
+        record( static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()) );
+    }
+
+    uint64_t count() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+    uint64_t totalNs() const
+    {
+        return m_total.load(std::memory_order_relaxed);
+    }
+    uint64_t maxNs() const
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+    uint64_t bucket(size_t i) const
+    {
+        return m_buckets[i].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief bucketUpperBound
+     * @param i
+     * @return
+     *
+     * The (exclusive) upper bound of bucket i, in nanoseconds.
+     */
+    static uint64_t bucketUpperBound(size_t i)
+    {
+        return uint64_t(1) << i;
+    }
+
+    /**
+     * @brief percentile
+     * @param p - in the range [0,1]
+     * @return
+     *
+     * Returns the upper bound of the bucket which contains the p-th
+     * percentile, ie: at least p of the recorded durations are below it.
+     */
+    uint64_t percentile(double p) const
+    {
+        auto c = count();
+        if(c == 0)
+            return 0;
+        auto target = static_cast<uint64_t>(p * static_cast<double>(c) + 0.5);
+        if(target == 0)
+            target = 1;
+        uint64_t s = 0;
+        for(size_t i=0; i < bucket_count; i++)
+        {
+            s += bucket(i);
+            if(s >= target)
+                return bucketUpperBound(i);
+        }
+        return bucketUpperBound(bucket_count-1);
+    }
+
+    void reset()
+    {
+        for(auto & b : m_buckets)
+            b.store(0, std::memory_order_relaxed);
+        m_count.store(0, std::memory_order_relaxed);
+        m_total.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+protected:
+    std::array<std::atomic<uint64_t>, bucket_count> m_buckets = {};
+    std::atomic<uint64_t>                           m_count{0};
+    std::atomic<uint64_t>                           m_total{0};
+    std::atomic<uint64_t>                           m_max{0};
+};
+
+/**
+ * @brief The CacheStats struct
+ *
+ * The statistics of a single Cache_t.
+ */
+struct CacheStats
+{
+    Counter   hits;         // the object was already in the cache
+    Counter   misses;       // the object had to be created
+    Counter   pendingWaits; // another thread was creating the object, and we waited for it
+    Histogram createTime;   // time spent creating the objects of the misses
+
+    void reset()
+    {
+        hits.reset();
+        misses.reset();
+        pendingWaits.reset();
+        createTime.reset();
+    }
+};
+
+/**
+ * @brief The GlobalStats struct
+ *
+ * Statistics shared by all the managers.
+ */
+struct GlobalStats
+{
+    Counter   descriptorSetsAllocated;   // sets allocated by any of the descriptor pool managers/allocators
+    Counter   descriptorAllocateFailures;// vkAllocateDescriptorSets returned out of pool memory/fragmented
+    Counter   descriptorPoolsCreated;
+    Counter   descriptorPoolsReset;
+    Counter   descriptorPoolsDestroyed;
+    Histogram fenceWait;                 // time blocked in vkWaitForFences
+    Histogram semaphoreWait;             // time blocked in vkWaitSemaphores
+    Histogram beginRecording;            // time spent in CommandPoolManager::beginRecording, including the wait
+
+    void reset()
+    {
+        descriptorSetsAllocated.reset();
+        descriptorAllocateFailures.reset();
+        descriptorPoolsCreated.reset();
+        descriptorPoolsReset.reset();
+        descriptorPoolsDestroyed.reset();
+        fenceWait.reset();
+        semaphoreWait.reset();
+        beginRecording.reset();
+    }
+};
+
+inline GlobalStats & globalStats()
+{
+    static GlobalStats S;
+    return S;
+}
+
+using ScopeBeginFunction = void(*)(char const * name, void * userData);
+using ScopeEndFunction   = void(*)(char const * name, void * userData);
+
+struct ScopeCallbacks
+{
+    ScopeBeginFunction begin    = nullptr;
+    ScopeEndFunction   end      = nullptr;
+    void             * userData = nullptr;
+};
+
+inline ScopeCallbacks & _scopeCallbacks()
+{
+    static ScopeCallbacks C;
+    return C;
+}
+
+/**
+ * @brief setScopeCallbacks
+ * @param begin
+ * @param end
+ * @param userData
+ *
+ * Sets the functions called when a gvu scope (eg: beginRecording, a fence
+ * wait or the creation of a cached object) begins and ends.
+ * The names are string literals, so they can be passed to a profiler
+ * without copying them, eg for Perfetto:
+ *
+ * gvu::instrumentation::setScopeCallbacks(
+ *     [](char const * name, void*){ TRACE_EVENT_BEGIN("gvu", perfetto::StaticString{name}); },
+ *     [](char const *     , void*){ TRACE_EVENT_END("gvu"); });
+ *
+ * The callbacks are called on the thread which runs the scope. This must
+ * be called before any other thread uses gvu.
+ */
+inline void setScopeCallbacks(ScopeBeginFunction begin, ScopeEndFunction end, void * userData = nullptr)
+{
+    auto & C    = _scopeCallbacks();
+    C.begin     = begin;
+    C.end       = end;
+    C.userData  = userData;
+}
+
+/**
+ * @brief The Scope class
+ *
+ * Calls the scope callbacks on construction/destruction and, if a
+ * histogram is given, records the duration of the scope in it.
+ */
+class Scope
+{
+public:
+    explicit Scope(char const * name, Histogram * histogram = nullptr) : m_name(name), m_histogram(histogram)
+    {
+        auto & C = _scopeCallbacks();
+        if(C.begin)
+            C.begin(m_name, C.userData);
+        if(m_histogram)
+            m_start = std::chrono::steady_clock::now();
+    }
+    ~Scope()
+    {
+        if(m_histogram)
+            m_histogram->record(std::chrono::steady_clock::now() - m_start);
+        auto & C = _scopeCallbacks();
+        if(C.end)
+            C.end(m_name, C.userData);
+    }
+    Scope(Scope const &) = delete;
+    Scope & operator=(Scope const &) = delete;
+
+protected:
+    char const                            * m_name      = nullptr;
+    Histogram                             * m_histogram = nullptr;
+    std::chrono::steady_clock::time_point   m_start;
+};
+
+}
+}
+
+#define GVU_INSTRUMENTATION_CONCAT_(a, b) a##b
+#define GVU_INSTRUMENTATION_CONCAT(a, b) GVU_INSTRUMENTATION_CONCAT_(a, b)
+
+// A scope reported to the scope callbacks
+#define GVU_SCOPE(name) ::gvu::instrumentation::Scope GVU_INSTRUMENTATION_CONCAT(gvu_scope_, __LINE__)(name)
+// A scope reported to the scope callbacks whose duration is recorded in the histogram
+#define GVU_SCOPE_TIMED(name, histogram) ::gvu::instrumentation::Scope GVU_INSTRUMENTATION_CONCAT(gvu_scope_, __LINE__)(name, &(histogram))
+// Adds n to a counter
+#define GVU_COUNT(counter, n) (counter).add(n)
+
+#else
+
+#define GVU_SCOPE(name)
+#define GVU_SCOPE_TIMED(name, histogram)
+#define GVU_COUNT(counter, n) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,494 @@
+#ifndef GVU_BARRIER_BUILDER_H
+#define GVU_BARRIER_BUILDER_H
+
+#include <vector>
+#include <stdexcept>
+#include <vulkan/vulkan.h>
+#include "../FormatInfo.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The LayoutAccess struct
+ *
+ * The pipeline stages and access types which use an image while it is
+ * in a particular layout.
+ */
+struct LayoutAccess
+{
+    VkPipelineStageFlags stages = 0;
+    VkAccessFlags        access = 0;
+};
+
+/**
+ * @brief The BarrierBuilder class
+ *
+ * Collects image, buffer and memory barriers and records all of them
+ * with a single vkCmdPipelineBarrier.
+ *
+ * The stage and access masks of image barriers are inferred from the
+ * old/new layouts so that a barrier only waits on the stages which could
+ * actually have used the image, instead of ALL_COMMANDS. The aspect mask
+ * is inferred from the format.
+ *
+ * gvu::BarrierBuilder B;
+ *
+ * B.addImageBarrier(colorImage, VK_FORMAT_R8G8B8A8_UNORM,
+ *                   VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+ * B.addImageBarrier(depthImage, VK_FORMAT_D32_SFLOAT,
+ *                   VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+ * B.addBufferBarrier(buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+ *                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,   VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+ *
+ * B.flush(cmd); // one vkCmdPipelineBarrier, the builder is cleared
+ *
+ * The builder keeps its storage between flushes so it can be reused
+ * every frame without allocating.
+ */
+class BarrierBuilder
+{
+public:
+    /**
+     * @brief layoutAccess
+     * @param layout
+     * @return
+     *
+     * Returns the stages/access types which may use an image in the
+     * given layout. Transitions from PRESENT_SRC use the
+     * COLOR_ATTACHMENT_OUTPUT stage so that they chain with the usual
+     * wait stage of the swapchain acquire semaphore.
+     */
+    static LayoutAccess layoutAccess(VkImageLayout layout)
+    {
+        constexpr VkPipelineStageFlags shaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        constexpr VkPipelineStageFlags depthStages  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                                      VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        switch(layout)
+        {
+            case VK_IMAGE_LAYOUT_UNDEFINED:
+                return {VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0};
+            case VK_IMAGE_LAYOUT_PREINITIALIZED:
+                return {VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_WRITE_BIT};
+            case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+                return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT};
+            case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+            case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
+            case VK_IMAGE_LAYOUT_STENCIL_ATTACHMENT_OPTIMAL:
+                return {depthStages,
+                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT};
+            case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_STENCIL_ATTACHMENT_OPTIMAL:
+            case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_STENCIL_READ_ONLY_OPTIMAL:
+                return {depthStages | shaderStages,
+                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT};
+            case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+            case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL:
+            case VK_IMAGE_LAYOUT_STENCIL_READ_ONLY_OPTIMAL:
+                return {depthStages | shaderStages,
+                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT};
+            case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+                return {shaderStages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT};
+            case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+                return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT};
+            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+                return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT};
+            case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+                return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0};
+            case VK_IMAGE_LAYOUT_GENERAL:
+            default:
+                // can be used by anything
+                return {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT};
+        }
+    }
+
+    /**
+     * @brief aspectMask
+     * @param format
+     * @return
+     *
+     * Returns the depth/stencil aspects of a depth/stencil format,
+     * otherwise the color aspect.
+     */
+    static VkImageAspectFlags aspectMask(VkFormat format)
+    {
+        auto flags = getFormatInfo(format).flags;
+        VkImageAspectFlags aspect = 0;
+        if(flags & FORMAT_SIZE_DEPTH_BIT)
+            aspect |= VK_IMAGE_ASPECT_DEPTH_BIT;
+        if(flags & FORMAT_SIZE_STENCIL_BIT)
+            aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+        return aspect == 0 ? VkImageAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT) : aspect;
+    }
+
+    /**
+     * @brief imageBarrier
+     * @param image
+     * @param oldLayout
+     * @param newLayout
+     * @param subresourceRange
+     * @return
+     *
+     * Returns an image barrier whose access masks are inferred from the
+     * layouts. Throws std::invalid_argument if newLayout is UNDEFINED or
+     * PREINITIALIZED.
+     */
+    static VkImageMemoryBarrier imageBarrier(VkImage                 image,
+                                             VkImageLayout           oldLayout,
+                                             VkImageLayout           newLayout,
+                                             VkImageSubresourceRange subresourceRange)
+    {
+        if(newLayout == VK_IMAGE_LAYOUT_UNDEFINED || newLayout == VK_IMAGE_LAYOUT_PREINITIALIZED)
+            throw std::invalid_argument("Images cannot be transitioned to the UNDEFINED or PREINITIALIZED layouts");
+
+        VkImageMemoryBarrier B = {};
+        B.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        B.srcAccessMask       = _writeAccess(layoutAccess(oldLayout).access);
+        B.dstAccessMask       = layoutAccess(newLayout).access;
+        B.oldLayout           = oldLayout;
+        B.newLayout           = newLayout;
+        B.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        B.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        B.image               = image;
+        B.subresourceRange    = subresourceRange;
+        return B;
+    }
+
+    /**
+     * @brief addImageBarrier
+     * @param image
+     * @param format
+     * @param oldLayout
+     * @param newLayout
+     * @param baseMipLevel
+     * @param levelCount
+     * @param baseArrayLayer
+     * @param layerCount
+     *
+     * Transitions the image. The aspect mask is inferred from the format
+     * and the stage/access masks from the layouts.
+     */
+    BarrierBuilder& addImageBarrier(VkImage       image,
+                                    VkFormat      format,
+                                    VkImageLayout oldLayout,
+                                    VkImageLayout newLayout,
+                                    uint32_t      baseMipLevel   = 0,
+                                    uint32_t      levelCount     = VK_REMAINING_MIP_LEVELS,
+                                    uint32_t      baseArrayLayer = 0,
+                                    uint32_t      layerCount     = VK_REMAINING_ARRAY_LAYERS)
+    {
+        return addImageBarrier(image, oldLayout, newLayout, {aspectMask(format), baseMipLevel, levelCount, baseArrayLayer, layerCount});
+    }
+
+    /**
+     * @brief addImageBarrier
+     * @param image
+     * @param oldLayout
+     * @param newLayout
+     * @param subresourceRange
+     *
+     * Transitions a subresource range of the image. The stage/access
+     * masks are inferred from the layouts.
+     */
+    BarrierBuilder& addImageBarrier(VkImage                 image,
+                                    VkImageLayout           oldLayout,
+                                    VkImageLayout           newLayout,
+                                    VkImageSubresourceRange subresourceRange)
+    {
+        return addImageBarrier(imageBarrier(image, oldLayout, newLayout, subresourceRange),
+                               layoutAccess(oldLayout).stages,
+                               layoutAccess(newLayout).stages);
+    }
+
+    /**
+     * @brief addImageBarrier
+     * @param barrier
+     * @param srcStageMask
+     * @param dstStageMask
+     *
+     * Adds a fully specified image barrier, eg: a queue family
+     * ownership transfer.
+     */
+    BarrierBuilder& addImageBarrier(VkImageMemoryBarrier const & barrier,
+                                    VkPipelineStageFlags         srcStageMask,
+                                    VkPipelineStageFlags         dstStageMask)
+    {
+        m_imageBarriers.push_back(barrier);
+        m_imageStages.push_back({srcStageMask, dstStageMask});
+        _addStages(srcStageMask, dstStageMask);
+        return *this;
+    }
+
+    /**
+     * @brief addBufferBarrier
+     * @param buffer
+     * @param srcStageMask
+     * @param srcAccessMask
+     * @param dstStageMask
+     * @param dstAccessMask
+     * @param offset
+     * @param size
+     */
+    BarrierBuilder& addBufferBarrier(VkBuffer             buffer,
+                                     VkPipelineStageFlags srcStageMask,
+                                     VkAccessFlags        srcAccessMask,
+                                     VkPipelineStageFlags dstStageMask,
+                                     VkAccessFlags        dstAccessMask,
+                                     VkDeviceSize         offset = 0,
+                                     VkDeviceSize         size   = VK_WHOLE_SIZE)
+    {
+        VkBufferMemoryBarrier B = {};
+        B.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        B.srcAccessMask       = srcAccessMask;
+        B.dstAccessMask       = dstAccessMask;
+        B.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        B.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        B.buffer              = buffer;
+        B.offset              = offset;
+        B.size                = size;
+        return addBufferBarrier(B, srcStageMask, dstStageMask);
+    }
+
+    /**
+     * @brief addBufferBarrier
+     * @param barrier
+     * @param srcStageMask
+     * @param dstStageMask
+     *
+     * Adds a fully specified buffer barrier.
+     */
+    BarrierBuilder& addBufferBarrier(VkBufferMemoryBarrier const & barrier,
+                                     VkPipelineStageFlags          srcStageMask,
+                                     VkPipelineStageFlags          dstStageMask)
+    {
+        m_bufferBarriers.push_back(barrier);
+        m_bufferStages.push_back({srcStageMask, dstStageMask});
+        _addStages(srcStageMask, dstStageMask);
+        return *this;
+    }
+
+    /**
+     * @brief addMemoryBarrier
+     * @param srcStageMask
+     * @param srcAccessMask
+     * @param dstStageMask
+     * @param dstAccessMask
+     *
+     * Adds a global memory barrier.
+     */
+    BarrierBuilder& addMemoryBarrier(VkPipelineStageFlags srcStageMask,
+                                     VkAccessFlags        srcAccessMask,
+                                     VkPipelineStageFlags dstStageMask,
+                                     VkAccessFlags        dstAccessMask)
+    {
+        VkMemoryBarrier B = {};
+        B.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        B.srcAccessMask = srcAccessMask;
+        B.dstAccessMask = dstAccessMask;
+        m_memoryBarriers.push_back(B);
+        m_memoryStages.push_back({srcStageMask, dstStageMask});
+        _addStages(srcStageMask, dstStageMask);
+        return *this;
+    }
+
+    /**
+     * @brief flush
+     * @param cmd
+     * @param dependencyFlags
+     *
+     * Records every barrier with a single vkCmdPipelineBarrier using the
+     * union of their stage masks and clears the builder. Nothing is
+     * recorded if the builder is empty.
+     */
+    void flush(VkCommandBuffer cmd, VkDependencyFlags dependencyFlags = 0)
+    {
+        if(empty())
+            return;
+
+        vkCmdPipelineBarrier(cmd, m_srcStageMask, m_dstStageMask, dependencyFlags,
+                             static_cast<uint32_t>(m_memoryBarriers.size()), m_memoryBarriers.data(),
+                             static_cast<uint32_t>(m_bufferBarriers.size()), m_bufferBarriers.data(),
+                             static_cast<uint32_t>(m_imageBarriers.size()),  m_imageBarriers.data());
+        clear();
+    }
+
+#if defined(VK_VERSION_1_3)
+    /**
+     * @brief flush2
+     * @param cmd
+     * @param dependencyFlags
+     *
+     * Same as flush() but records a single vkCmdPipelineBarrier2, which
+     * keeps the stage masks of each barrier separate instead of merging
+     * them. Requires the synchronization2 feature.
+     */
+    void flush2(VkCommandBuffer cmd, VkDependencyFlags dependencyFlags = 0)
+    {
+        if(empty())
+            return;
+
+        m_memoryBarriers2.clear();
+        m_bufferBarriers2.clear();
+        m_imageBarriers2.clear();
+
+        for(size_t i=0; i < m_memoryBarriers.size(); i++)
+        {
+            auto & S = m_memoryBarriers[i];
+            auto & B = m_memoryBarriers2.emplace_back();
+            B.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+            B.srcStageMask  = m_memoryStages[i].src;
+            B.srcAccessMask = S.srcAccessMask;
+            B.dstStageMask  = m_memoryStages[i].dst;
+            B.dstAccessMask = S.dstAccessMask;
+        }
+        for(size_t i=0; i < m_bufferBarriers.size(); i++)
+        {
+            auto & S = m_bufferBarriers[i];
+            auto & B = m_bufferBarriers2.emplace_back();
+            B.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+            B.srcStageMask        = m_bufferStages[i].src;
+            B.srcAccessMask       = S.srcAccessMask;
+            B.dstStageMask        = m_bufferStages[i].dst;
+            B.dstAccessMask       = S.dstAccessMask;
+            B.srcQueueFamilyIndex = S.srcQueueFamilyIndex;
+            B.dstQueueFamilyIndex = S.dstQueueFamilyIndex;
+            B.buffer              = S.buffer;
+            B.offset              = S.offset;
+            B.size                = S.size;
+        }
+        for(size_t i=0; i < m_imageBarriers.size(); i++)
+        {
+            auto & S = m_imageBarriers[i];
+            auto & B = m_imageBarriers2.emplace_back();
+            B.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+            B.srcStageMask        = m_imageStages[i].src;
+            B.srcAccessMask       = S.srcAccessMask;
+            B.dstStageMask        = m_imageStages[i].dst;
+            B.dstAccessMask       = S.dstAccessMask;
+            B.oldLayout           = S.oldLayout;
+            B.newLayout           = S.newLayout;
+            B.srcQueueFamilyIndex = S.srcQueueFamilyIndex;
+            B.dstQueueFamilyIndex = S.dstQueueFamilyIndex;
+            B.image               = S.image;
+            B.subresourceRange    = S.subresourceRange;
+        }
+
+        VkDependencyInfo D = {};
+        D.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        D.dependencyFlags          = dependencyFlags;
+        D.memoryBarrierCount       = static_cast<uint32_t>(m_memoryBarriers2.size());
+        D.pMemoryBarriers          = m_memoryBarriers2.data();
+        D.bufferMemoryBarrierCount = static_cast<uint32_t>(m_bufferBarriers2.size());
+        D.pBufferMemoryBarriers    = m_bufferBarriers2.data();
+        D.imageMemoryBarrierCount  = static_cast<uint32_t>(m_imageBarriers2.size());
+        D.pImageMemoryBarriers     = m_imageBarriers2.data();
+        vkCmdPipelineBarrier2(cmd, &D);
+        clear();
+    }
+#endif
+
+    /**
+     * @brief clear
+     *
+     * Removes all the barriers without recording them.
+     */
+    void clear()
+    {
+        m_memoryBarriers.clear();
+        m_bufferBarriers.clear();
+        m_imageBarriers.clear();
+        m_memoryStages.clear();
+        m_bufferStages.clear();
+        m_imageStages.clear();
+        m_srcStageMask = 0;
+        m_dstStageMask = 0;
+    }
+
+    bool empty() const
+    {
+        return m_memoryBarriers.empty() && m_bufferBarriers.empty() && m_imageBarriers.empty();
+    }
+
+    std::vector<VkImageMemoryBarrier> const & imageBarriers() const
+    {
+        return m_imageBarriers;
+    }
+
+    std::vector<VkBufferMemoryBarrier> const & bufferBarriers() const
+    {
+        return m_bufferBarriers;
+    }
+
+    std::vector<VkMemoryBarrier> const & memoryBarriers() const
+    {
+        return m_memoryBarriers;
+    }
+
+    /**
+     * @brief srcStageMask
+     * @return
+     *
+     * The union of the source stages of all the barriers
+     */
+    VkPipelineStageFlags srcStageMask() const
+    {
+        return m_srcStageMask;
+    }
+
+    /**
+     * @brief dstStageMask
+     * @return
+     *
+     * The union of the destination stages of all the barriers
+     */
+    VkPipelineStageFlags dstStageMask() const
+    {
+        return m_dstStageMask;
+    }
+
+protected:
+    // only writes need to be made available, a read followed by a
+    // layout transition only needs the execution dependency
+    static VkAccessFlags _writeAccess(VkAccessFlags access)
+    {
+        return access & ( VK_ACCESS_SHADER_WRITE_BIT |
+                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                          VK_ACCESS_TRANSFER_WRITE_BIT |
+                          VK_ACCESS_HOST_WRITE_BIT |
+                          VK_ACCESS_MEMORY_WRITE_BIT );
+    }
+
+    void _addStages(VkPipelineStageFlags src, VkPipelineStageFlags dst)
+    {
+        m_srcStageMask |= src;
+        m_dstStageMask |= dst;
+    }
+
+    struct _Stages
+    {
+        VkPipelineStageFlags src;
+        VkPipelineStageFlags dst;
+    };
+
+    std::vector<VkMemoryBarrier>       m_memoryBarriers;
+    std::vector<VkBufferMemoryBarrier> m_bufferBarriers;
+    std::vector<VkImageMemoryBarrier>  m_imageBarriers;
+    std::vector<_Stages>               m_memoryStages;
+    std::vector<_Stages>               m_bufferStages;
+    std::vector<_Stages>               m_imageStages;
+    VkPipelineStageFlags               m_srcStageMask = 0;
+    VkPipelineStageFlags               m_dstStageMask = 0;
+
+#if defined(VK_VERSION_1_3)
+    std::vector<VkMemoryBarrier2>       m_memoryBarriers2;
+    std::vector<VkBufferMemoryBarrier2> m_bufferBarriers2;
+    std::vector<VkImageMemoryBarrier2>  m_imageBarriers2;
+#endif
+};
+
+}
+
+#endif
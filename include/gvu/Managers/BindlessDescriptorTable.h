@@ -0,0 +1,371 @@
+#ifndef GVU_BINDLESS_DESCRIPTOR_TABLE_H
+#define GVU_BINDLESS_DESCRIPTOR_TABLE_H
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <vulkan/vulkan.h>
+#include "../Cache/DescriptorSetLayoutCache.h"
+#include "DescriptorPoolManager.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The BindlessDescriptorTable class
+ *
+ * A single, large descriptor set which holds every image, sampler and
+ * storage buffer used by the application. Resources are added to the
+ * table and are given a stable integer slot which the shaders use to
+ * index into the arrays:
+ *
+ *   layout(set=0, binding=0) uniform texture2D      g_images[];
+ *   layout(set=0, binding=1) uniform sampler        g_samplers[];
+ *   layout(set=0, binding=2) buffer  Buffers {...}  g_buffers[];
+ *
+ * The bindings use UPDATE_AFTER_BIND and PARTIALLY_BOUND, and the
+ * last binding has a variable descriptor count, this requires the
+ * descriptorIndexing features to be enabled on the device.
+ *
+ * gvu::BindlessDescriptorTable table;
+ * table.init(device, &layoutCache);
+ *
+ * auto tex = table.addImage(imageView);   // use tex in push constants/material data
+ * table.flush();                          // write the new descriptors
+ *
+ * vkCmdBindDescriptorSets(cmd, ..., 0, 1, &table.getDescriptorSet(), ...); // once per frame
+ *
+ * table.removeImage(tex);                 // the slot is reused after framesInFlight frames
+ * table.nextFrame();
+ *
+ * Removed slots are only reused once nextFrame() has been called
+ * framesInFlight times, so a slot is never overwritten while a command
+ * buffer which may still be executing refers to it.
+ */
+class BindlessDescriptorTable
+{
+public:
+    static constexpr uint32_t imageBinding   = 0;
+    static constexpr uint32_t samplerBinding = 1;
+    static constexpr uint32_t bufferBinding  = 2;
+
+    /**
+     * @brief init
+     * @param device
+     * @param cache - a DescriptorSetLayoutCache or ConcurrentDescriptorSetLayoutCache
+     * @param maxImages
+     * @param maxSamplers
+     * @param maxBuffers
+     * @param framesInFlight
+     */
+    template<typename layoutCache_t>
+    void init(VkDevice device,
+              layoutCache_t * cache,
+              uint32_t maxImages      = 16384,
+              uint32_t maxSamplers    = 256,
+              uint32_t maxBuffers     = 16384,
+              uint32_t framesInFlight = 3)
+    {
+        m_device         = device;
+        m_framesInFlight = framesInFlight;
+        m_frame          = 0;
+
+        m_images   = _SlotAllocator(maxImages);
+        m_samplers = _SlotAllocator(maxSamplers);
+        m_buffers  = _SlotAllocator(maxBuffers);
+
+        auto info = generateLayoutCreateInfo(maxImages, maxSamplers, maxBuffers);
+        m_layout = cache->create(info);
+
+        m_poolManager.init(device, cache, m_layout, 1);
+        m_set = m_poolManager.allocateDescriptorSet();
+    }
+
+    /**
+     * @brief destroy
+     *
+     * Destroys the pool the descriptor set was allocated from.
+     * The layout is owned by the layout cache.
+     */
+    void destroy()
+    {
+        m_poolManager.destroy();
+        m_set = VK_NULL_HANDLE;
+        m_imageWrites.clear();
+        m_samplerWrites.clear();
+        m_bufferWrites.clear();
+    }
+
+    /**
+     * @brief generateLayoutCreateInfo
+     * @param maxImages
+     * @param maxSamplers
+     * @param maxBuffers
+     * @return
+     *
+     * Returns the DescriptorSetLayoutCreateInfo of the bindless set.
+     */
+    static DescriptorSetLayoutCreateInfo generateLayoutCreateInfo(uint32_t maxImages, uint32_t maxSamplers, uint32_t maxBuffers)
+    {
+        DescriptorSetLayoutCreateInfo info;
+        info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        info.bindings.push_back({imageBinding,   VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,  maxImages,   VK_SHADER_STAGE_ALL, nullptr});
+        info.bindings.push_back({samplerBinding, VK_DESCRIPTOR_TYPE_SAMPLER,        maxSamplers, VK_SHADER_STAGE_ALL, nullptr});
+        info.bindings.push_back({bufferBinding,  VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxBuffers,  VK_SHADER_STAGE_ALL, nullptr});
+
+        VkDescriptorBindingFlags f = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+        info.bindingFlags = {f, f, f | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT};
+        return info;
+    }
+
+    /**
+     * @brief addImage
+     * @param view
+     * @param layout
+     * @return
+     *
+     * Adds a sampled image to the table and returns its slot in the
+     * images array. The descriptor is written on the next flush()
+     */
+    uint32_t addImage(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+    {
+        auto slot = m_images.allocate();
+        m_imageWrites.push_back({slot, {VK_NULL_HANDLE, view, layout}});
+        return slot;
+    }
+
+    /**
+     * @brief addSampler
+     * @param sampler
+     * @return
+     *
+     * Adds a sampler to the table and returns its slot in the
+     * samplers array. The descriptor is written on the next flush()
+     */
+    uint32_t addSampler(VkSampler sampler)
+    {
+        auto slot = m_samplers.allocate();
+        m_samplerWrites.push_back({slot, {sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED}});
+        return slot;
+    }
+
+    /**
+     * @brief addBuffer
+     * @param buffer
+     * @param offset
+     * @param range
+     * @return
+     *
+     * Adds a storage buffer to the table and returns its slot in the
+     * buffers array. The descriptor is written on the next flush()
+     */
+    uint32_t addBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE)
+    {
+        auto slot = m_buffers.allocate();
+        m_bufferWrites.push_back({slot, {buffer, offset, range}});
+        return slot;
+    }
+
+    /**
+     * @brief removeImage
+     * @param slot
+     *
+     * Removes the image from the table. The slot is reused once
+     * framesInFlight frames have passed. Throws std::logic_error if the
+     * slot has already been removed.
+     */
+    void removeImage(uint32_t slot)
+    {
+        m_images.release(slot, m_frame);
+    }
+    void removeSampler(uint32_t slot)
+    {
+        m_samplers.release(slot, m_frame);
+    }
+    void removeBuffer(uint32_t slot)
+    {
+        m_buffers.release(slot, m_frame);
+    }
+
+    /**
+     * @brief flush
+     *
+     * Write all the descriptors which have been added since the last
+     * flush using a single vkUpdateDescriptorSets call. This must be
+     * called before submitting any command buffer which uses the new slots.
+     */
+    void flush()
+    {
+        auto count = m_imageWrites.size() + m_samplerWrites.size() + m_bufferWrites.size();
+        if(count == 0)
+            return;
+
+        std::vector<VkWriteDescriptorSet> W;
+        W.reserve(count);
+
+        auto _write = [&](uint32_t binding, uint32_t slot, VkDescriptorType type) -> VkWriteDescriptorSet &
+        {
+            auto & w = W.emplace_back();
+            w = {};
+            w.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            w.dstSet          = m_set;
+            w.dstBinding      = binding;
+            w.dstArrayElement = slot;
+            w.descriptorCount = 1;
+            w.descriptorType  = type;
+            return w;
+        };
+
+        for(auto & [slot, info] : m_imageWrites)
+            _write(imageBinding, slot, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE).pImageInfo = &info;
+        for(auto & [slot, info] : m_samplerWrites)
+            _write(samplerBinding, slot, VK_DESCRIPTOR_TYPE_SAMPLER).pImageInfo = &info;
+        for(auto & [slot, info] : m_bufferWrites)
+            _write(bufferBinding, slot, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER).pBufferInfo = &info;
+
+        vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(W.size()), W.data(), 0, nullptr);
+
+        m_imageWrites.clear();
+        m_samplerWrites.clear();
+        m_bufferWrites.clear();
+    }
+
+    /**
+     * @brief nextFrame
+     *
+     * Flushes the pending writes and advances the frame counter. Slots
+     * which were removed framesInFlight frames ago become available again.
+     */
+    void nextFrame()
+    {
+        flush();
+        ++m_frame;
+        m_images.collect(m_frame, m_framesInFlight);
+        m_samplers.collect(m_frame, m_framesInFlight);
+        m_buffers.collect(m_frame, m_framesInFlight);
+    }
+
+    VkDescriptorSet const & getDescriptorSet() const
+    {
+        return m_set;
+    }
+
+    VkDescriptorSetLayout getLayout() const
+    {
+        return m_layout;
+    }
+
+    /**
+     * @brief imageCount
+     * @return
+     *
+     * The number of image slots in use, including removed slots
+     * which have not been reused yet.
+     */
+    uint32_t imageCount() const
+    {
+        return m_images.used();
+    }
+    uint32_t samplerCount() const
+    {
+        return m_samplers.used();
+    }
+    uint32_t bufferCount() const
+    {
+        return m_buffers.used();
+    }
+
+protected:
+    /**
+     * @brief The _SlotAllocator struct
+     *
+     * Hands out indices in [0, capacity). Released indices are
+     * kept until framesInFlight frames have passed. Releasing a slot
+     * which is not in use throws.
+     */
+    struct _SlotAllocator
+    {
+        _SlotAllocator() = default;
+        _SlotAllocator(uint32_t c) : capacity(c)
+        {
+        }
+
+        uint32_t allocate()
+        {
+            if(!free.empty())
+            {
+                auto s = free.back();
+                free.pop_back();
+                live[s] = true;
+                return s;
+            }
+            if(next == capacity)
+                throw std::length_error("Bindless descriptor table is full");
+            live.push_back(true);
+            return next++;
+        }
+
+        void release(uint32_t slot, uint64_t frame)
+        {
+            if(slot >= next)
+                throw std::out_of_range("Slot was not allocated from this table");
+            if(!live[slot])
+                throw std::logic_error("Slot has already been released");
+            live[slot] = false;
+            retired.push_back({slot, frame});
+        }
+
+        void collect(uint64_t frame, uint32_t framesInFlight)
+        {
+            size_t i=0;
+            // retired is in frame order
+            for(; i < retired.size() && retired[i].frame + framesInFlight <= frame; i++)
+                free.push_back(retired[i].slot);
+            retired.erase(retired.begin(), retired.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+
+        uint32_t used() const
+        {
+            return next - static_cast<uint32_t>(free.size());
+        }
+
+        struct _retired
+        {
+            uint32_t slot;
+            uint64_t frame;
+        };
+
+        uint32_t               capacity = 0;
+        uint32_t               next     = 0;
+        std::vector<bool>      live;    // indexed by slot, false once released
+        std::vector<uint32_t>  free;
+        std::vector<_retired>  retired;
+    };
+
+    template<typename info_t>
+    struct _pendingWrite
+    {
+        uint32_t slot;
+        info_t   info;
+    };
+
+    VkDevice              m_device         = VK_NULL_HANDLE;
+    VkDescriptorSetLayout m_layout         = VK_NULL_HANDLE;
+    VkDescriptorSet       m_set            = VK_NULL_HANDLE;
+    uint32_t              m_framesInFlight = 3;
+    uint64_t              m_frame          = 0;
+
+    DescriptorPoolManager m_poolManager;
+
+    _SlotAllocator        m_images;
+    _SlotAllocator        m_samplers;
+    _SlotAllocator        m_buffers;
+
+    std::vector<_pendingWrite<VkDescriptorImageInfo>>  m_imageWrites;
+    std::vector<_pendingWrite<VkDescriptorImageInfo>>  m_samplerWrites;
+    std::vector<_pendingWrite<VkDescriptorBufferInfo>> m_bufferWrites;
+};
+
+}
+
+#endif
@@ -5,7 +5,13 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
+#include <utility>
+#include <functional>
 #include <vulkan/vulkan.h>
+#include "SubmitBatch.h"
+#include "TimelineTracker.h"
+#include "BarrierBuilder.h"
+#include "../Instrumentation.h"
 
 namespace gvu
 {
@@ -34,6 +40,8 @@ namespace gvu
 #endif
 
 
+struct CommandPoolManager;
+
 struct ScopedFence
 {
     ~ScopedFence()
@@ -51,12 +59,28 @@ struct ScopedFence
     ScopedFence(ScopedFence const &) = delete ;
     ScopedFence& operator = (ScopedFence const&) = delete ;
 
-    ScopedFence(ScopedFence && A) = default;
-    ScopedFence& operator = (ScopedFence && A) = default;
+    ScopedFence(ScopedFence && A)
+    {
+        _swap(A);
+    }
+    ScopedFence& operator = (ScopedFence && A)
+    {
+        if(this != &A)
+        {
+            if( m_fence != VK_NULL_HANDLE)
+            {
+                wait();
+                destroy();
+            }
+            _swap(A);
+        }
+        return *this;
+    }
 
     void wait() const
     {
         LDEBUG("Waiting on fence");
+        GVU_SCOPE_TIMED("gvu::ScopedFence::wait", instrumentation::globalStats().fenceWait);
         GVK_CHECK_RESULT(vkWaitForFences(m_device, 1, &m_fence, VK_TRUE, 100000000000));
         LDEBUG("Waiting finished");
     }
@@ -66,27 +90,30 @@ struct ScopedFence
         return VK_SUCCESS == vkGetFenceStatus(m_device, m_fence);
     }
 
-    void destroy()
-    {
-        if( m_fence != VK_NULL_HANDLE)
-        {
-            vkDestroyFence(m_device, m_fence, nullptr);
-        }
-        if( m_buffer != VK_NULL_HANDLE)
-        {
-            vkFreeCommandBuffers(m_device, m_pool, 1, &m_buffer);
-        }
-
-        m_device = VK_NULL_HANDLE;
-        m_fence = VK_NULL_HANDLE;
-        m_pool= VK_NULL_HANDLE;
-        m_buffer= VK_NULL_HANDLE;
-    }
+    /**
+     * @brief destroy
+     *
+     * If the fence was created by a CommandPoolManager, the fence and
+     * command buffer are returned to the manager to be reused, otherwise
+     * they are destroyed. The fence must have been signalled.
+     */
+    inline void destroy();
 
     VkDevice m_device = VK_NULL_HANDLE;
     VkFence m_fence = VK_NULL_HANDLE;
     VkCommandPool m_pool= VK_NULL_HANDLE;
     VkCommandBuffer m_buffer= VK_NULL_HANDLE;
+    CommandPoolManager * m_manager = nullptr;
+
+protected:
+    void _swap(ScopedFence & A)
+    {
+        std::swap(m_device,  A.m_device);
+        std::swap(m_fence,   A.m_fence);
+        std::swap(m_pool,    A.m_pool);
+        std::swap(m_buffer,  A.m_buffer);
+        std::swap(m_manager, A.m_manager);
+    }
 };
 
 
@@ -102,29 +129,54 @@ struct CommandBuffer
 
     /**
       Transition the image to a different layout. The default values are provided so that
-      the entire image will be transitioned
+      the entire image will be transitioned.
+
+      The access masks are inferred from the layouts. If the stage masks are 0, they are
+      also inferred from the layouts, otherwise the given stages are used.
     **/
     void imageTransitionLayout( VkImage image,
                                 VkImageLayout oldLayout,
                                 VkImageLayout newLayout,
-                                VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                                VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                VkPipelineStageFlags srcStageMask = 0,
+                                VkPipelineStageFlags dstStageMask = 0,
                                 VkImageSubresourceRange subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS})
     {
-        // Image barrier for optimal image (target)
-        // Optimal image will be used as destination for the copy
-        VkImageMemoryBarrier imageMemoryBarrier{};
-        imageMemoryBarrier.sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        imageMemoryBarrier.oldLayout        = oldLayout;
-        imageMemoryBarrier.newLayout        = newLayout;
-        imageMemoryBarrier.srcAccessMask    = 0;
-        imageMemoryBarrier.dstAccessMask    = VK_ACCESS_TRANSFER_WRITE_BIT;
-        imageMemoryBarrier.image            = image;
-        imageMemoryBarrier.subresourceRange = subresourceRange;
+        auto imageMemoryBarrier = BarrierBuilder::imageBarrier(image, oldLayout, newLayout, subresourceRange);
+
+        if(srcStageMask == 0)
+            srcStageMask = BarrierBuilder::layoutAccess(oldLayout).stages;
+        if(dstStageMask == 0)
+            dstStageMask = BarrierBuilder::layoutAccess(newLayout).stages;
 
         vkCmdPipelineBarrier(cmd, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
     }
 
+    /**
+      Transition the entire image to a different layout. The aspect mask is inferred
+      from the format and the stage/access masks from the layouts. Use a BarrierBuilder
+      to transition many images with a single barrier.
+    **/
+    void imageTransitionLayout( VkImage image,
+                                VkFormat format,
+                                VkImageLayout oldLayout,
+                                VkImageLayout newLayout)
+    {
+        imageTransitionLayout(image, oldLayout, newLayout, 0, 0,
+                              {BarrierBuilder::aspectMask(format), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
+    }
+
+    /**
+     * @brief pipelineBarrier
+     * @param barriers
+     *
+     * Records all the barriers in the builder with a single
+     * vkCmdPipelineBarrier and clears the builder.
+     */
+    void pipelineBarrier(BarrierBuilder & barriers)
+    {
+        barriers.flush(cmd);
+    }
+
     /**
      * @brief imageCopyFromBuffer
      * @param _img
@@ -193,6 +245,20 @@ struct CommandPoolManager
 
     void destroy()
     {
+        // wait for everything submitted with submitCommandBufferAsync
+        for(auto & S : m_inFlight)
+        {
+            GVK_CHECK_RESULT(vkWaitForFences(m_device, 1, &S.fence, VK_TRUE, UINT64_MAX));
+            if(S.onComplete)
+                S.onComplete();
+            vkDestroyFence(m_device, S.fence, nullptr);
+        }
+        for(auto f : m_freeFences)
+            vkDestroyFence(m_device, f, nullptr);
+        m_inFlight.clear();
+        m_freeFences.clear();
+        m_freeCommandBuffers.clear(); // freed with the pool
+
         vkDestroyCommandPool(m_device, m_pool, nullptr);
         m_device = VK_NULL_HANDLE;
         m_physicalDevice = VK_NULL_HANDLE;
@@ -219,14 +285,26 @@ struct CommandPoolManager
      */
     VkCommandBuffer allocateCommandBuffer(VkCommandBufferLevel level, bool begin)
     {
-        VkCommandBufferAllocateInfo cmdBufAllocateInfo{};
-        cmdBufAllocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        cmdBufAllocateInfo.commandPool        = m_pool;
-        cmdBufAllocateInfo.level              = level;
-        cmdBufAllocateInfo.commandBufferCount = 1;
-
         VkCommandBuffer cmdBuffer;
-        GVK_CHECK_RESULT(vkAllocateCommandBuffers(m_device, &cmdBufAllocateInfo, &cmdBuffer));
+
+        // primary buffers which have finished executing are reused. The
+        // pool has RESET_COMMAND_BUFFER_BIT so vkBeginCommandBuffer
+        // implicitly resets them.
+        if(level == VK_COMMAND_BUFFER_LEVEL_PRIMARY && !m_freeCommandBuffers.empty())
+        {
+            cmdBuffer = m_freeCommandBuffers.back();
+            m_freeCommandBuffers.pop_back();
+        }
+        else
+        {
+            VkCommandBufferAllocateInfo cmdBufAllocateInfo{};
+            cmdBufAllocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            cmdBufAllocateInfo.commandPool        = m_pool;
+            cmdBufAllocateInfo.level              = level;
+            cmdBufAllocateInfo.commandBufferCount = 1;
+
+            GVK_CHECK_RESULT(vkAllocateCommandBuffers(m_device, &cmdBufAllocateInfo, &cmdBuffer));
+        }
 
         // If requested, also start recording for the new command buffer
         if (begin)
@@ -270,20 +348,17 @@ struct CommandPoolManager
 
         if(generateFence)
         {
-            // Create fence to ensure that the command buffer has finished executing
-            VkFenceCreateInfo fenceInfo{};
-            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            VkFence fence = VK_NULL_HANDLE;
-
-            GVK_CHECK_RESULT(vkCreateFence(m_device, &fenceInfo, nullptr, &fence));
+            // fence to ensure that the command buffer has finished executing
+            VkFence fence = acquireFence();
 
             GVK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, fence));
 
             auto D = std::make_unique<ScopedFence>();
-            D->m_fence  = fence;
-            D->m_device = m_device;
-            D->m_pool   = m_pool;
-            D->m_buffer = commandBuffer;
+            D->m_fence   = fence;
+            D->m_device  = m_device;
+            D->m_pool    = m_pool;
+            D->m_buffer  = commandBuffer;
+            D->m_manager = this;
 
             return D;
         }
@@ -298,6 +373,7 @@ struct CommandPoolManager
     template<typename Callable_t>
     std::unique_ptr<ScopedFence> beginRecording(Callable_t && c, bool returnFence)
     {
+        GVU_SCOPE_TIMED("gvu::CommandPoolManager::beginRecording", instrumentation::globalStats().beginRecording);
         VkCommandBuffer cmd = allocateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
 
         c(cmd);
@@ -307,13 +383,257 @@ struct CommandPoolManager
         return submitCommandBuffer(cmd, m_graphicsQueue, returnFence);
     }
 
+    /**
+     * @brief submitCommandBufferAsync
+     * @param commandBuffer - a primary command buffer allocated from this manager
+     * @param queue
+     * @param onComplete - called from collect() once the command buffer has finished
+     * @return the id of the submission
+     *
+     * Submits the command buffer without returning a fence to wait on.
+     * Call collect() regularly (eg: once per frame) to retire finished
+     * submissions, their fences and command buffers are reused.
+     */
+    uint64_t submitCommandBufferAsync(VkCommandBuffer commandBuffer, VkQueue queue, std::function<void()> onComplete = {})
+    {
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
 
+        VkFence fence = acquireFence();
+        GVK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, fence));
 
+        auto & S      = m_inFlight.emplace_back();
+        S.id          = ++m_lastSubmissionId;
+        S.fence       = fence;
+        S.buffer      = commandBuffer;
+        S.onComplete  = std::move(onComplete);
+        return S.id;
+    }
 
+    /**
+     * @brief submitCommandBuffer
+     * @param commandBuffer - a primary command buffer allocated from this manager
+     * @param queue
+     * @param tracker
+     * @return the timeline value signalled when the command buffer has finished
+     *
+     * Submits the command buffer without a fence. It signals the next
+     * value of the tracker, and the command buffer is recycled when
+     * tracker.update() sees that value.
+     */
+    uint64_t submitCommandBuffer(VkCommandBuffer commandBuffer, VkQueue queue, TimelineTracker & tracker)
+    {
+        SubmitBatch batch;
+        batch.addCommandBuffer(commandBuffer);
+        auto value = tracker.submit(batch, queue);
 
-protected:
+        tracker.onComplete(value, [this, commandBuffer]()
+        {
+            recycle(VK_NULL_HANDLE, commandBuffer);
+        });
+        return value;
+    }
+
+    /**
+     * @brief beginRecording
+     * @param c
+     * @param tracker
+     * @return the timeline value signalled when the command buffer has finished
+     *
+     * Same as beginRecording(c, false), but completion is tracked with
+     * the TimelineTracker instead of a fence.
+     */
+    template<typename Callable_t>
+    uint64_t beginRecording(Callable_t && c, TimelineTracker & tracker)
+    {
+        GVU_SCOPE_TIMED("gvu::CommandPoolManager::beginRecording", instrumentation::globalStats().beginRecording);
+        VkCommandBuffer cmd = allocateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+
+        c(cmd);
+
+        GVK_CHECK_RESULT(vkEndCommandBuffer(cmd));
+
+        return submitCommandBuffer(cmd, m_graphicsQueue, tracker);
+    }
+
+    /**
+     * @brief submitBatchAsync
+     * @param batch
+     * @param queue
+     * @param onComplete - called from collect() once the whole batch has finished
+     * @return the id of the submission
+     *
+     * Flushes the batch with a single vkQueueSubmit using a recycled
+     * fence. The command buffers of the batch are not recycled: if they
+     * were allocated from this manager, pass them to recycle() in onComplete.
+     */
+    uint64_t submitBatchAsync(SubmitBatch & batch, VkQueue queue, std::function<void()> onComplete = {})
+    {
+        VkFence fence = acquireFence();
+        GVK_CHECK_RESULT(batch.flush(queue, fence));
+
+        auto & S      = m_inFlight.emplace_back();
+        S.id          = ++m_lastSubmissionId;
+        S.fence       = fence;
+        S.onComplete  = std::move(onComplete);
+        return S.id;
+    }
+
+    /**
+     * @brief beginRecordingAsync
+     * @param c
+     * @param onComplete
+     * @return the id of the submission
+     *
+     * Same as beginRecording(), but the command buffer is submitted
+     * with submitCommandBufferAsync() so the caller never blocks.
+     */
+    template<typename Callable_t>
+    uint64_t beginRecordingAsync(Callable_t && c, std::function<void()> onComplete = {})
+    {
+        GVU_SCOPE_TIMED("gvu::CommandPoolManager::beginRecordingAsync", instrumentation::globalStats().beginRecording);
+        VkCommandBuffer cmd = allocateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+
+        c(cmd);
+
+        GVK_CHECK_RESULT(vkEndCommandBuffer(cmd));
+
+        return submitCommandBufferAsync(cmd, m_graphicsQueue, std::move(onComplete));
+    }
+
+    /**
+     * @brief poll
+     * @param submissionId
+     * @return
+     *
+     * Returns true if the submission has finished executing. This
+     * never blocks and does not retire the submission, use collect() for that.
+     */
+    bool poll(uint64_t submissionId) const
+    {
+        for(auto & S : m_inFlight)
+        {
+            if(S.id == submissionId)
+                return VK_SUCCESS == vkGetFenceStatus(m_device, S.fence);
+        }
+        // already collected
+        return submissionId <= m_lastSubmissionId;
+    }
+
+    /**
+     * @brief collect
+     * @return
+     *
+     * Retires every submission which has finished executing: the
+     * onComplete callback is called and the fence and command buffer
+     * are returned to the free lists. Never blocks. Returns the number
+     * of submissions which were retired.
+     */
+    size_t collect()
+    {
+        size_t count = 0;
+        for(size_t i=0; i < m_inFlight.size();)
+        {
+            if(VK_SUCCESS != vkGetFenceStatus(m_device, m_inFlight[i].fence))
+            {
+                ++i;
+                continue;
+            }
+            // take the submission out of the list first, the callback
+            // may submit again and reallocate m_inFlight
+            auto S = std::move(m_inFlight[i]);
+            if(i + 1 != m_inFlight.size())
+                m_inFlight[i] = std::move(m_inFlight.back());
+            m_inFlight.pop_back();
+
+            recycle(S.fence, S.buffer);
+            if(S.onComplete)
+                S.onComplete();
+            ++count;
+        }
+        return count;
+    }
 
+    /**
+     * @brief inFlightCount
+     * @return
+     *
+     * The number of async submissions which have not been collected yet
+     */
+    size_t inFlightCount() const
+    {
+        return m_inFlight.size();
+    }
 
+    /**
+     * @brief acquireFence
+     * @return
+     *
+     * Returns an unsignalled fence from the free list, or creates a new one.
+     */
+    VkFence acquireFence()
+    {
+        if(!m_freeFences.empty())
+        {
+            auto f = m_freeFences.back();
+            m_freeFences.pop_back();
+            return f;
+        }
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkFence fence = VK_NULL_HANDLE;
+        GVK_CHECK_RESULT(vkCreateFence(m_device, &fenceInfo, nullptr, &fence));
+        return fence;
+    }
+
+    /**
+     * @brief recycle
+     * @param fence - a signalled fence, or VK_NULL_HANDLE
+     * @param commandBuffer - a primary command buffer which has finished executing, or VK_NULL_HANDLE
+     *
+     * Returns the fence and command buffer to the free lists.
+     */
+    void recycle(VkFence fence, VkCommandBuffer commandBuffer)
+    {
+        if(fence != VK_NULL_HANDLE)
+        {
+            GVK_CHECK_RESULT(vkResetFences(m_device, 1, &fence));
+            m_freeFences.push_back(fence);
+        }
+        if(commandBuffer != VK_NULL_HANDLE)
+        {
+            m_freeCommandBuffers.push_back(commandBuffer);
+        }
+    }
+
+    size_t freeFenceCount() const
+    {
+        return m_freeFences.size();
+    }
+    size_t freeCommandBufferCount() const
+    {
+        return m_freeCommandBuffers.size();
+    }
+
+
+
+
+
+protected:
+    struct _Submission
+    {
+        uint64_t              id     = 0;
+        VkFence               fence  = VK_NULL_HANDLE;
+        VkCommandBuffer       buffer = VK_NULL_HANDLE;
+        std::function<void()> onComplete;
+    };
+
+    std::vector<VkFence>         m_freeFences;
+    std::vector<VkCommandBuffer> m_freeCommandBuffers; // primary buffers only
+    std::vector<_Submission>     m_inFlight;
+    uint64_t                     m_lastSubmissionId = 0;
 
     VkCommandPool createCommandPool( VkQueueFlags queueFlagBits, VkCommandPoolCreateFlags createFlags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
     {
@@ -328,6 +648,17 @@ protected:
         return cmdPool;
     }
 
+public:
+    /**
+     * @brief getQueueFamilyIndex
+     * @param queueFlags
+     * @param physicalDevice
+     * @return
+     *
+     * Returns the index of the first queue family supporting queueFlags.
+     * Compute requests prefer a family without graphics support, and
+     * transfer-only requests prefer a family without graphics or compute.
+     */
     static uint32_t getQueueFamilyIndex(VkQueueFlags queueFlags, VkPhysicalDevice physicalDevice)
     {
         std::vector<VkQueueFamilyProperties> queueFamilyProperties;
@@ -349,6 +680,18 @@ protected:
             }
         }
 
+        // Dedicated queue for transfer
+        // Try to find a queue family index that supports transfer but not graphics or compute
+        if (queueFlags == VK_QUEUE_TRANSFER_BIT)
+        {
+            for (uint32_t i = 0; i < static_cast<uint32_t>(queueFamilyProperties.size()); i++) {
+                if ((queueFamilyProperties[i].queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+                    ((queueFamilyProperties[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0)) {
+                    return i;
+                }
+            }
+        }
+
         // For other queue types or if no separate compute queue is present, return the first one to support the requested flags
         for (uint32_t i = 0; i < static_cast<uint32_t>(queueFamilyProperties.size()); i++) {
             if (queueFamilyProperties[i].queueFlags & queueFlags) {
@@ -362,6 +705,31 @@ protected:
 
 };
 
+void ScopedFence::destroy()
+{
+    if( m_manager )
+    {
+        m_manager->recycle(m_fence, m_buffer);
+    }
+    else
+    {
+        if( m_fence != VK_NULL_HANDLE)
+        {
+            vkDestroyFence(m_device, m_fence, nullptr);
+        }
+        if( m_buffer != VK_NULL_HANDLE)
+        {
+            vkFreeCommandBuffers(m_device, m_pool, 1, &m_buffer);
+        }
+    }
+
+    m_device = VK_NULL_HANDLE;
+    m_fence = VK_NULL_HANDLE;
+    m_pool= VK_NULL_HANDLE;
+    m_buffer= VK_NULL_HANDLE;
+    m_manager = nullptr;
+}
+
 }
 
 
@@ -0,0 +1,410 @@
+#ifndef GVU_DESCRIPTOR_ALLOCATOR_H
+#define GVU_DESCRIPTOR_ALLOCATOR_H
+
+#include <map>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <unordered_set>
+#include <vulkan/vulkan.h>
+#include "../Cache/DescriptorSetLayoutCache.h"
+#include "../Instrumentation.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The DescriptorAllocator class
+ *
+ * A descriptor set allocator which can allocate sets of any layout
+ * from the DescriptorSetLayoutCache it was initialized with.
+ *
+ * All layouts share the same pools. The pool sizes are computed from
+ * the VkDescriptorPoolSizes of every layout allocated so far: each
+ * descriptor type is sized for the average set of those layouts, but
+ * never less than the largest single set, so any set fits in an empty pool.
+ *
+ * Every new pool holds growthFactor times more sets than the previous one,
+ * up to maxSetsPerPool. When a pool runs out of memory
+ * (VK_ERROR_OUT_OF_POOL_MEMORY or VK_ERROR_FRAGMENTED_POOL) it is retired
+ * and the allocation is retried from the next pool.
+ *
+ * Sets cannot be returned individually. resetPools() resets every pool
+ * and makes them available for allocation again. Pools which were created
+ * before a layout with new descriptor types (or larger bindings) was
+ * allocated are destroyed instead, so every ready pool can hold any set.
+ *
+ * Layouts which use descriptor indexing (update-after-bind or variable
+ * descriptor count bindings) are not supported, allocate them with a
+ * DescriptorPoolManager or FrameDescriptorAllocator instead.
+ *
+ * gvu::DescriptorAllocator alloc;
+ * alloc.init(device, &layoutCache);
+ *
+ * auto set1 = alloc.allocateDescriptorSet(layout1);
+ * auto set2 = alloc.allocateDescriptorSet(layout2);
+ *
+ * alloc.resetPools(); // set1 and set2 are no longer valid
+ *
+ * alloc.destroy();
+ */
+class DescriptorAllocator
+{
+public:
+
+    /**
+     * @brief init
+     * @param device
+     * @param cache - a DescriptorSetLayoutCache or ConcurrentDescriptorSetLayoutCache
+     * @param initialSetsPerPool - the number of sets the first pool holds
+     * @param growthFactor - the size of each new pool relative to the previous one
+     * @param maxSetsPerPool - the largest pool that will be created
+     */
+    template<typename layoutCache_t>
+    void init(VkDevice device,
+              layoutCache_t *cache,
+              uint32_t initialSetsPerPool = 16,
+              float    growthFactor       = 2.0f,
+              uint32_t maxSetsPerPool     = 4096)
+    {
+        if(initialSetsPerPool == 0 || maxSetsPerPool < initialSetsPerPool || growthFactor < 1.0f)
+            throw std::invalid_argument("Invalid DescriptorAllocator growth policy");
+
+        m_device         = device;
+        m_setsPerPool    = initialSetsPerPool;
+        m_growthFactor   = growthFactor;
+        m_maxSetsPerPool = maxSetsPerPool;
+
+        m_getLayoutInfo = [cache](VkDescriptorSetLayout l) -> DescriptorSetLayoutCreateInfo
+        {
+            return cache->getCreateInfo(l);
+        };
+    }
+
+    /**
+     * @brief destroy
+     *
+     * Destroy all the pools.
+     */
+    void destroy()
+    {
+        for(auto & P : m_readyPools)
+            vkDestroyDescriptorPool(m_device, P.pool, nullptr);
+        for(auto & P : m_fullPools)
+            vkDestroyDescriptorPool(m_device, P.pool, nullptr);
+        GVU_COUNT(instrumentation::globalStats().descriptorPoolsDestroyed, m_readyPools.size() + m_fullPools.size());
+        m_readyPools.clear();
+        m_fullPools.clear();
+        m_layouts.clear();
+        m_totalSizes.clear();
+        m_maxSizes.clear();
+    }
+
+    /**
+     * @brief allocateDescriptorSet
+     * @param layout
+     * @return
+     *
+     * Allocate a descriptor set with the given layout. The layout must
+     * have been created by the layout cache this allocator was initialized with.
+     *
+     * Throws std::invalid_argument if the layout uses update-after-bind
+     * or variable descriptor count bindings.
+     */
+    VkDescriptorSet allocateDescriptorSet(VkDescriptorSetLayout layout)
+    {
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        allocateDescriptorSets(layout, &set, 1);
+        return set;
+    }
+
+    /**
+     * @brief allocateDescriptorSets
+     * @param layout
+     * @param sets - the array to write the descriptor sets into
+     * @param count - the number of sets to allocate
+     *
+     * Allocate count descriptor sets with the same layout. As many sets
+     * as possible are allocated with a single call to vkAllocateDescriptorSets.
+     */
+    void allocateDescriptorSets(VkDescriptorSetLayout layout, VkDescriptorSet * sets, uint32_t count)
+    {
+        _addLayout(layout);
+
+        VkDescriptorSetAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+
+        // when a bulk allocation runs out of pool memory, the pool may
+        // still have room for some sets, so they are retried one at a time
+        // before the pool is retired.
+        uint32_t maxBatch = count;
+
+        while(count > 0)
+        {
+            auto & P = _currentPool();
+
+            uint32_t n = std::min({count, maxBatch, P.maxSets - P.allocatedSets});
+            if(m_layoutArray.size() < n)
+                m_layoutArray.resize(n);
+            std::fill(m_layoutArray.begin(), m_layoutArray.begin() + n, layout);
+
+            allocInfo.descriptorPool     = P.pool;
+            allocInfo.pSetLayouts        = m_layoutArray.data();
+            allocInfo.descriptorSetCount = n;
+
+            auto result = vkAllocateDescriptorSets(m_device, &allocInfo, sets);
+            switch(result)
+            {
+                case VK_SUCCESS:
+                    GVU_COUNT(instrumentation::globalStats().descriptorSetsAllocated, n);
+                    P.allocatedSets += n;
+                    sets  += n;
+                    count -= n;
+                    if(P.allocatedSets == P.maxSets)
+                        _retireCurrentPool();
+                    break;
+                case VK_ERROR_FRAGMENTED_POOL:
+                case VK_ERROR_OUT_OF_POOL_MEMORY:
+                    GVU_COUNT(instrumentation::globalStats().descriptorAllocateFailures, 1);
+                    if(n > 1)
+                    {
+                        maxBatch = 1;
+                        break;
+                    }
+                    if(P.allocatedSets == 0)
+                    {
+                        if(_fitsAnySet(P))
+                            throw std::runtime_error("Descriptor set does not fit in an empty pool");
+                        // the pool was created before this layout was known
+                        _destroyPool(P);
+                        m_readyPools.pop_back();
+                        maxBatch = count;
+                        break;
+                    }
+                    // retire this pool and allocate from the next one
+                    _retireCurrentPool();
+                    maxBatch = count;
+                    break;
+                default:
+                    throw std::runtime_error("Unrecoverable error");
+            }
+        }
+    }
+
+    /**
+     * @brief resetPools
+     *
+     * Resets every pool. All descriptor sets allocated from this
+     * allocator become invalid.
+     *
+     * Pools whose sizes are stale, ie: they cannot hold a set of every
+     * layout allocated so far, are destroyed. New pools are created with
+     * the current sizes when they are needed.
+     */
+    void resetPools()
+    {
+        auto pools = std::move(m_fullPools);
+        pools.insert(pools.end(), m_readyPools.begin(), m_readyPools.end());
+        m_fullPools.clear();
+        m_readyPools.clear();
+
+        for(auto & P : pools)
+        {
+            if(!_fitsAnySet(P))
+            {
+                _destroyPool(P);
+                continue;
+            }
+            vkResetDescriptorPool(m_device, P.pool, {});
+            GVU_COUNT(instrumentation::globalStats().descriptorPoolsReset, 1);
+            P.allocatedSets = 0;
+            m_readyPools.push_back(P);
+        }
+    }
+
+    /**
+     * @brief allocatedPoolCount
+     * @return
+     *
+     * The number of pools which have been created
+     */
+    size_t allocatedPoolCount() const
+    {
+        return m_readyPools.size() + m_fullPools.size();
+    }
+
+    /**
+     * @brief retiredPoolCount
+     * @return
+     *
+     * The number of pools which are full, or have run out of memory,
+     * since the last reset.
+     */
+    size_t retiredPoolCount() const
+    {
+        return m_fullPools.size();
+    }
+
+    /**
+     * @brief setsPerPool
+     * @return
+     *
+     * The number of sets the next new pool will hold
+     */
+    uint32_t setsPerPool() const
+    {
+        return m_setsPerPool;
+    }
+
+    /**
+     * @brief getPoolSizes
+     * @param maxSets
+     * @return
+     *
+     * Returns the pool sizes used for a new pool which holds maxSets sets
+     */
+    std::vector<VkDescriptorPoolSize> getPoolSizes(uint32_t maxSets) const
+    {
+        std::vector<VkDescriptorPoolSize> sizes;
+        auto layoutCount = static_cast<double>(m_layouts.size());
+        for(auto & [type, total] : m_totalSizes)
+        {
+            auto average = static_cast<double>(total) / layoutCount;
+            auto c       = static_cast<uint32_t>(std::ceil(average * maxSets));
+            auto &s      = sizes.emplace_back();
+            s.type            = type;
+            s.descriptorCount = std::max(c, m_maxSizes.at(type));
+        }
+        return sizes;
+    }
+
+protected:
+    struct PoolInfo
+    {
+        VkDescriptorPool                     pool          = VK_NULL_HANDLE;
+        uint32_t                             allocatedSets = 0;
+        uint32_t                             maxSets       = 0;
+        std::map<VkDescriptorType, uint32_t> sizes; // the descriptor counts the pool was created with
+    };
+
+    /**
+     * @brief _fitsAnySet
+     * @param P
+     * @return
+     *
+     * Returns true if an empty pool P can hold the largest set of
+     * every layout allocated so far.
+     */
+    bool _fitsAnySet(PoolInfo const & P) const
+    {
+        for(auto & [type, c] : m_maxSizes)
+        {
+            auto it = P.sizes.find(type);
+            if(it == P.sizes.end() || it->second < c)
+                return false;
+        }
+        return true;
+    }
+
+    void _destroyPool(PoolInfo const & P)
+    {
+        vkDestroyDescriptorPool(m_device, P.pool, nullptr);
+        GVU_COUNT(instrumentation::globalStats().descriptorPoolsDestroyed, 1);
+    }
+
+    void _addLayout(VkDescriptorSetLayout layout)
+    {
+        if(m_layouts.count(layout))
+            return;
+
+        // the pools are shared by every layout, so they are never
+        // created with the descriptor indexing flags
+        auto info = m_getLayoutInfo(layout);
+        if((info.flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT)
+           || info.hasBindingFlag(VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT))
+            throw std::invalid_argument("DescriptorAllocator does not support descriptor indexing layouts");
+        m_layouts.insert(layout);
+
+        std::map<VkDescriptorType, uint32_t> sizeMap;
+        for(auto & b : info.bindings)
+        {
+            sizeMap[b.descriptorType] += b.descriptorCount;
+        }
+        for(auto & [type, c] : sizeMap)
+        {
+            m_totalSizes[type] += c;
+            auto & m = m_maxSizes[type];
+            m = std::max(m, c);
+        }
+    }
+
+    /**
+     * @brief _currentPool
+     * @return
+     *
+     * Returns the pool sets are allocated from, creating a new one if
+     * there are no pools available.
+     */
+    PoolInfo & _currentPool()
+    {
+        if(m_readyPools.empty())
+        {
+            m_readyPools.push_back(_createNewPool());
+        }
+        return m_readyPools.back();
+    }
+
+    void _retireCurrentPool()
+    {
+        m_fullPools.push_back(m_readyPools.back());
+        m_readyPools.pop_back();
+    }
+
+    PoolInfo _createNewPool()
+    {
+        auto sizes = getPoolSizes(m_setsPerPool);
+
+        VkDescriptorPoolCreateInfo ci = {};
+        ci.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        ci.maxSets       = m_setsPerPool;
+        ci.pPoolSizes    = sizes.data();
+        ci.poolSizeCount = static_cast<uint32_t>(sizes.size());
+
+        PoolInfo P;
+        P.maxSets = m_setsPerPool;
+        for(auto & s : sizes)
+            P.sizes[s.type] = s.descriptorCount;
+        auto result = vkCreateDescriptorPool(m_device, &ci, nullptr, &P.pool);
+        if( result != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error creating Descriptor Pool");
+        }
+        GVU_COUNT(instrumentation::globalStats().descriptorPoolsCreated, 1);
+
+        auto next     = static_cast<double>(m_setsPerPool) * static_cast<double>(m_growthFactor);
+        m_setsPerPool = static_cast<uint32_t>(std::min(next, static_cast<double>(m_maxSetsPerPool)));
+
+        return P;
+    }
+
+    VkDevice                                  m_device         = VK_NULL_HANDLE;
+    uint32_t                                  m_setsPerPool    = 0;
+    float                                     m_growthFactor   = 2.0f;
+    uint32_t                                  m_maxSetsPerPool = 0;
+
+    std::vector<PoolInfo>                     m_readyPools; // pools which can be allocated from, the back is the current pool
+    std::vector<PoolInfo>                     m_fullPools;  // pools which are full or ran out of memory
+
+    std::unordered_set<VkDescriptorSetLayout> m_layouts;      // all layouts which have been allocated
+    std::map<VkDescriptorType, uint32_t>      m_totalSizes;   // sum of the descriptor counts of all layouts
+    std::map<VkDescriptorType, uint32_t>      m_maxSizes;     // the largest descriptor count of any layout
+    std::vector<VkDescriptorSetLayout>        m_layoutArray;  // the layout repeated, used for bulk allocations
+
+    std::function<DescriptorSetLayoutCreateInfo(VkDescriptorSetLayout)> m_getLayoutInfo;
+};
+
+}
+
+#endif
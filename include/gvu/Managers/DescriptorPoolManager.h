@@ -5,10 +5,13 @@
 #include <iostream>
 #include <map>
 #include <cassert>
+#include <algorithm>
 #include <vector>
 #include <vulkan/vulkan.h>
 #include <unordered_set>
 #include "../Cache/DescriptorSetLayoutCache.h"
+#include "TimelineTracker.h"
+#include "../Instrumentation.h"
 
 namespace gvu
 {
@@ -30,20 +33,23 @@ public:
      * @param layout - the layout that this pool will use
      * @param cache
      *
-     * Initialize the descriptor pool queue.
+     * Initialize the descriptor pool queue. The cache can be
+     * either a DescriptorSetLayoutCache or a ConcurrentDescriptorSetLayoutCache
      */
+    template<typename layoutCache_t>
     void init(VkDevice device,
-              DescriptorSetLayoutCache *cache,
+              layoutCache_t *cache,
               VkDescriptorSetLayout layout,
               uint32_t maxSetsPerPool = 10
               )
     {
         m_device                = device;
         m_layout                = layout;
+        m_layouts.clear();
 
         m_createInfo.maxSets = maxSetsPerPool;
 
-        auto & layoutInfo = cache->getCreateInfo(layout);
+        auto layoutInfo = cache->getCreateInfo(layout);
         std::map<VkDescriptorType, uint32_t> sizeMap;
         for(auto x : layoutInfo.bindings)
         {
@@ -57,6 +63,19 @@ public:
             s.type            = x.first;
         }
 
+        // descriptor indexing: update-after-bind layouts need an
+        // update-after-bind pool, and variable sized bindings are
+        // allocated with their maximum count
+        m_createInfo.flags = layoutInfo.hasBindingFlag(VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT) ?
+                                 VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT : 0;
+        m_variableDescriptorCount = 0;
+        for(size_t i=0; i < layoutInfo.bindingFlags.size(); i++)
+        {
+            if(layoutInfo.bindingFlags[i] & VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT)
+                m_variableDescriptorCount = layoutInfo.bindings[i].descriptorCount;
+        }
+        m_variableCounts.clear();
+
         createNewPool();
     }
 
@@ -72,7 +91,9 @@ public:
         {
             vkDestroyDescriptorPool(m_device, p, nullptr);
         }
+        GVU_COUNT(instrumentation::globalStats().descriptorPoolsDestroyed, m_poolInfos.size());
         m_poolInfos.clear();
+        m_availablePools.clear();
     }
 
     /**
@@ -87,55 +108,143 @@ public:
         auto p = m_setToPool.at(set);
         auto & i = m_poolInfos.at(p);
         ++i.returnedSets;
-        if( i.returnedSets == m_createInfo.maxSets )
+        if( i.returnedSets == i.maxSets )
         {
             resetPool(p);
         }
     }
 
+    /**
+     * @brief releaseToPool
+     * @param set
+     * @param tracker
+     * @param value - the timeline value of the last submission using the set
+     *
+     * Release the descriptor set once tracker.update() sees that
+     * value has completed.
+     */
+    void releaseToPool(VkDescriptorSet set, TimelineTracker & tracker, uint64_t value)
+    {
+        tracker.onComplete(value, [this, set]()
+        {
+            releaseToPool(set);
+        });
+    }
+
     /**
      * @brief allocateDescriptorSet
      * @return
      *
-     * Allocate a descriptorSet from this manager. The descriptor set has the
+     * Allocate a descriptorSet from this manager.
      */
     VkDescriptorSet allocateDescriptorSet()
     {
         VkDescriptorSet set = VK_NULL_HANDLE;
+        allocateDescriptorSets(&set, 1);
+        return set;
+    }
 
+    /**
+     * @brief allocateDescriptorSets
+     * @param sets - the array to write the descriptor sets into
+     * @param count - the number of sets to allocate
+     *
+     * Allocate count descriptor sets. As many sets as possible are
+     * allocated from each pool with a single call to vkAllocateDescriptorSets,
+     * so allocating N sets requires roughly N/maxSetsPerPool driver calls.
+     *
+     * If a pool runs out of memory (VK_ERROR_OUT_OF_POOL_MEMORY or
+     * VK_ERROR_FRAGMENTED_POOL) it is retired until all of its sets have
+     * been returned, and the allocation continues from the next pool.
+     */
+    void allocateDescriptorSets(VkDescriptorSet * sets, uint32_t count)
+    {
         VkDescriptorSetAllocateInfo allocInfo = {};
         allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 
-        for(auto & [p, i] : m_poolInfos)
+        // after a bulk allocation fails, the remaining space in the
+        // pool is filled one set at a time before the pool is retired
+        uint32_t maxBatch = count;
+
+        while(count > 0)
         {
+            auto p   = _currentPool();
+            auto & i = m_poolInfos.at(p);
+
+            uint32_t n = std::min({count, maxBatch, i.maxSets - i.allocatedSets});
+            if(m_layouts.size() < n)
+                m_layouts.resize(n, m_layout);
+
             allocInfo.descriptorPool     = p;
-            allocInfo.pSetLayouts        = &m_layout;
-            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts        = m_layouts.data();
+            allocInfo.descriptorSetCount = n;
 
-            if( i.allocatedSets < i.maxSets)
+            VkDescriptorSetVariableDescriptorCountAllocateInfo variableInfo = {};
+            if(m_variableDescriptorCount)
             {
-                auto result = vkAllocateDescriptorSets(m_device, &allocInfo, &set);
-
-                switch (result)
-                {
-                    case VK_SUCCESS:
-                        //all good, return
-                        ++i.allocatedSets;
-                        m_setToPool[set] = p;
-                        i.sets.insert(set);
-                        return set;
-                    case VK_ERROR_FRAGMENTED_POOL:
-                    case VK_ERROR_OUT_OF_POOL_MEMORY:
-                        //reallocate pool
-                    default:
-                        //unrecoverable error
-                        throw std::runtime_error("Unrecoverable error");
-                }
+                if(m_variableCounts.size() < n)
+                    m_variableCounts.resize(n, m_variableDescriptorCount);
+                variableInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+                variableInfo.descriptorSetCount = n;
+                variableInfo.pDescriptorCounts  = m_variableCounts.data();
+                allocInfo.pNext                 = &variableInfo;
             }
+
+            auto result = vkAllocateDescriptorSets(m_device, &allocInfo, sets);
+            switch (result)
+            {
+                case VK_SUCCESS:
+                    GVU_COUNT(instrumentation::globalStats().descriptorSetsAllocated, n);
+                    break;
+                case VK_ERROR_FRAGMENTED_POOL:
+                case VK_ERROR_OUT_OF_POOL_MEMORY:
+                    GVU_COUNT(instrumentation::globalStats().descriptorAllocateFailures, 1);
+                    if(n > 1)
+                    {
+                        maxBatch = 1;
+                        continue;
+                    }
+                    if(i.allocatedSets == 0)
+                        throw std::runtime_error("Descriptor set does not fit in an empty pool");
+                    _retirePool(p);
+                    maxBatch = count;
+                    continue;
+                default:
+                    //unrecoverable error
+                    throw std::runtime_error("Unrecoverable error");
+            }
+
+            i.allocatedSets += n;
+            for(uint32_t j=0;j<n;j++)
+            {
+                m_setToPool[sets[j]] = p;
+                i.sets.insert(sets[j]);
+            }
+
+            if(i.allocatedSets == i.maxSets)
+            {
+                // the pool is full, move the cursor to the next one
+                i.available = false;
+                m_availablePools.pop_back();
+            }
+
+            sets  += n;
+            count -= n;
         }
+    }
 
-        createNewPool();
-        return allocateDescriptorSet();
+    /**
+     * @brief allocateDescriptorSets
+     * @param count
+     * @return
+     *
+     * Allocate count descriptor sets and return them in a vector.
+     */
+    std::vector<VkDescriptorSet> allocateDescriptorSets(uint32_t count)
+    {
+        std::vector<VkDescriptorSet> sets(count, VK_NULL_HANDLE);
+        allocateDescriptorSets(sets.data(), count);
+        return sets;
     }
 
     /**
@@ -172,8 +281,8 @@ public:
 
         for(auto & [p,i] : m_poolInfos)
         {
-            if(i.returnedSets == m_createInfo.maxSets &&
-               i.allocatedSets == m_createInfo.maxSets)
+            if(i.returnedSets == i.maxSets &&
+               i.allocatedSets == i.maxSets)
             {
                 resetPool(p);
             }
@@ -210,9 +319,50 @@ protected:
         }
 
         vkResetDescriptorPool(m_device, p, {});
+        GVU_COUNT(instrumentation::globalStats().descriptorPoolsReset, 1);
         m_poolInfos.at(p).allocatedSets = 0;
         m_poolInfos.at(p).returnedSets = 0;
+        m_poolInfos.at(p).maxSets = m_createInfo.maxSets;
         m_poolInfos.at(p).sets.clear();
+
+        if(!I.available)
+        {
+            I.available = true;
+            m_availablePools.push_back(p);
+        }
+    }
+
+    /**
+     * @brief _retirePool
+     * @param p
+     *
+     * Called when the current pool ran out of memory before reaching
+     * maxSets. The pool's capacity is reduced to the number of sets
+     * allocated from it, so it is reset once they have all been returned.
+     */
+    void _retirePool(VkDescriptorPool p)
+    {
+        auto & i     = m_poolInfos.at(p);
+        i.maxSets    = i.allocatedSets;
+        i.available  = false;
+        m_availablePools.pop_back();
+
+        if(i.returnedSets == i.maxSets)
+            resetPool(p);
+    }
+
+    /**
+     * @brief _currentPool
+     * @return
+     *
+     * Returns the pool which new sets are allocated from. This is the last
+     * pool in m_availablePools, a new pool is created if every pool is full.
+     */
+    VkDescriptorPool _currentPool()
+    {
+        if(m_availablePools.empty())
+            return createNewPool();
+        return m_availablePools.back();
     }
 
     VkDescriptorPool createNewPool()
@@ -227,11 +377,14 @@ protected:
         {
             throw std::runtime_error("Error creating Descriptor Pool");
         }
+        GVU_COUNT(instrumentation::globalStats().descriptorPoolsCreated, 1);
 
         auto & i = m_poolInfos[pool];
         i.pool = pool;
         i.maxSets = m_createInfo.maxSets;
         i.allocatedSets = 0;
+        i.available = true;
+        m_availablePools.push_back(pool);
 
         return pool;
     }
@@ -243,10 +396,15 @@ protected:
         uint32_t allocatedSets=0;
         uint32_t returnedSets=0;
         uint32_t maxSets=0;
+        bool     available=false; // true if the pool is in m_availablePools
         std::unordered_set<VkDescriptorSet> sets;
     };
 
     std::unordered_map<VkDescriptorPool, PoolInfo> m_poolInfos;
+    std::vector<VkDescriptorPool>                  m_availablePools; // pools which are not full, the back is the cursor
+    std::vector<VkDescriptorSetLayout>             m_layouts;        // m_layout repeated, used for bulk allocations
+    std::vector<uint32_t>                          m_variableCounts; // m_variableDescriptorCount repeated
+    uint32_t                                       m_variableDescriptorCount = 0;
 
     VkDevice                          m_device;
     VkDescriptorSetLayout             m_layout;
@@ -0,0 +1,304 @@
+#ifndef GVU_FRAME_DESCRIPTOR_ALLOCATOR_H
+#define GVU_FRAME_DESCRIPTOR_ALLOCATOR_H
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <vulkan/vulkan.h>
+#include "../Cache/DescriptorSetLayoutCache.h"
+#include "../Instrumentation.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The FrameDescriptorAllocator class
+ *
+ * A linear descriptor set allocator for sets which only live for a
+ * single frame. It is a ring of framesInFlight frames, each frame owns a
+ * list of descriptor pools. Sets are allocated from the current pool of
+ * the current frame and are never returned individually, instead all
+ * the pools of a frame are reset with vkResetDescriptorPool when that
+ * frame is started again.
+ *
+ * No per-set bookkeeping is done, use DescriptorPoolManager if sets need
+ * to be released individually.
+ *
+ * gvu::FrameDescriptorAllocator alloc;
+ * alloc.init(device, &layoutCache, layout, 3);
+ *
+ * // every frame
+ * alloc.beginFrame(frameIndex, frameFence); // waits on the fence and resets the frame's pools
+ * auto set = alloc.allocateDescriptorSet();
+ *
+ * alloc.destroy();
+ */
+class FrameDescriptorAllocator
+{
+public:
+
+    /**
+     * @brief init
+     * @param device
+     * @param cache
+     * @param layout - the layout of the sets which will be allocated
+     * @param framesInFlight - the number of frames in the ring
+     * @param maxSetsPerPool - the number of sets each pool can hold
+     *
+     * Initialize the allocator. The cache can be either a
+     * DescriptorSetLayoutCache or a ConcurrentDescriptorSetLayoutCache.
+     * Frame 0 is the current frame after init.
+     */
+    template<typename layoutCache_t>
+    void init(VkDevice device,
+              layoutCache_t *cache,
+              VkDescriptorSetLayout layout,
+              uint32_t framesInFlight,
+              uint32_t maxSetsPerPool = 64)
+    {
+        if(framesInFlight == 0)
+            throw std::invalid_argument("framesInFlight must be greater than 0");
+
+        m_device         = device;
+        m_layout         = layout;
+        m_maxSetsPerPool = maxSetsPerPool;
+        m_layouts.assign(maxSetsPerPool, layout);
+
+        auto layoutInfo = cache->getCreateInfo(layout);
+        std::map<VkDescriptorType, uint32_t> sizeMap;
+        for(auto x : layoutInfo.bindings)
+        {
+            sizeMap[x.descriptorType] += x.descriptorCount;
+        }
+        m_poolSizes.clear();
+        for(auto & x : sizeMap)
+        {
+            auto &s           = m_poolSizes.emplace_back();
+            s.descriptorCount = x.second * maxSetsPerPool;
+            s.type            = x.first;
+        }
+
+        // descriptor indexing, the same as DescriptorPoolManager: update-after-bind
+        // layouts need an update-after-bind pool, and variable sized
+        // bindings are allocated with their maximum count
+        m_poolFlags = layoutInfo.hasBindingFlag(VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT) ?
+                          VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT : 0;
+        m_variableCounts.clear();
+        for(size_t i=0; i < layoutInfo.bindingFlags.size(); i++)
+        {
+            if(layoutInfo.bindingFlags[i] & VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT)
+                m_variableCounts.assign(maxSetsPerPool, layoutInfo.bindings[i].descriptorCount);
+        }
+
+        m_frames.clear();
+        m_frames.resize(framesInFlight);
+        m_currentFrame = 0;
+    }
+
+    /**
+     * @brief destroy
+     *
+     * Destroy all the pools. The device must not be using any of the
+     * sets allocated from this allocator.
+     */
+    void destroy()
+    {
+        for(auto & f : m_frames)
+        {
+            for(auto p : f.pools)
+                vkDestroyDescriptorPool(m_device, p, nullptr);
+            GVU_COUNT(instrumentation::globalStats().descriptorPoolsDestroyed, f.pools.size());
+        }
+        m_frames.clear();
+    }
+
+    /**
+     * @brief beginFrame
+     * @param frameIndex - the frame to begin, taken modulo framesInFlight
+     * @param fence - if not null, this fence is waited on before the pools are reset
+     *
+     * Makes frameIndex the current frame and resets every pool that was
+     * used by it. All sets previously allocated for this frame become
+     * invalid. The caller must make sure the GPU is not using them anymore,
+     * either by passing the fence of the frame's last submission or by
+     * waiting on it beforehand.
+     */
+    void beginFrame(uint32_t frameIndex, VkFence fence = VK_NULL_HANDLE)
+    {
+        if(fence != VK_NULL_HANDLE)
+        {
+            GVU_SCOPE_TIMED("gvu::FrameDescriptorAllocator::beginFrame", instrumentation::globalStats().fenceWait);
+            auto result = vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+            if(result != VK_SUCCESS)
+                throw std::runtime_error("Error waiting for the frame fence");
+        }
+
+        m_currentFrame = frameIndex % static_cast<uint32_t>(m_frames.size());
+
+        auto & f = m_frames[m_currentFrame];
+        // only the pools up to the cursor have been used
+        for(uint32_t i=0; i < f.pools.size() && i <= f.cursor; i++)
+        {
+            vkResetDescriptorPool(m_device, f.pools[i], {});
+            GVU_COUNT(instrumentation::globalStats().descriptorPoolsReset, 1);
+        }
+        f.cursor        = 0;
+        f.allocatedSets = 0;
+    }
+
+    /**
+     * @brief allocateDescriptorSet
+     * @return
+     *
+     * Allocate a descriptor set for the current frame.
+     */
+    VkDescriptorSet allocateDescriptorSet()
+    {
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        allocateDescriptorSets(&set, 1);
+        return set;
+    }
+
+    /**
+     * @brief allocateDescriptorSets
+     * @param sets - the array to write the descriptor sets into
+     * @param count - the number of sets to allocate
+     *
+     * Allocate count descriptor sets for the current frame using as few
+     * calls to vkAllocateDescriptorSets as possible.
+     */
+    void allocateDescriptorSets(VkDescriptorSet * sets, uint32_t count)
+    {
+        auto & f = m_frames[m_currentFrame];
+
+        VkDescriptorSetAllocateInfo allocInfo = {};
+        allocInfo.sType       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.pSetLayouts = m_layouts.data();
+
+        VkDescriptorSetVariableDescriptorCountAllocateInfo variableInfo = {};
+        if(!m_variableCounts.empty())
+        {
+            variableInfo.sType             = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+            variableInfo.pDescriptorCounts = m_variableCounts.data();
+            allocInfo.pNext                = &variableInfo;
+        }
+
+        while(count > 0)
+        {
+            if(f.allocatedSets == m_maxSetsPerPool)
+            {
+                ++f.cursor;
+                f.allocatedSets = 0;
+            }
+            if(f.cursor == f.pools.size())
+            {
+                f.pools.push_back(createNewPool());
+            }
+
+            uint32_t n = std::min(count, m_maxSetsPerPool - f.allocatedSets);
+
+            allocInfo.descriptorPool     = f.pools[f.cursor];
+            allocInfo.descriptorSetCount = n;
+            variableInfo.descriptorSetCount = n;
+
+            auto result = vkAllocateDescriptorSets(m_device, &allocInfo, sets);
+            switch(result)
+            {
+                case VK_SUCCESS:
+                    GVU_COUNT(instrumentation::globalStats().descriptorSetsAllocated, n);
+                    f.allocatedSets += n;
+                    sets  += n;
+                    count -= n;
+                    break;
+                case VK_ERROR_FRAGMENTED_POOL:
+                case VK_ERROR_OUT_OF_POOL_MEMORY:
+                    GVU_COUNT(instrumentation::globalStats().descriptorAllocateFailures, 1);
+                    // the pool cannot hold any more sets, move to the next one
+                    if(f.allocatedSets == 0)
+                        throw std::runtime_error("Descriptor set does not fit in an empty pool");
+                    f.allocatedSets = m_maxSetsPerPool;
+                    break;
+                default:
+                    throw std::runtime_error("Unrecoverable error");
+            }
+        }
+    }
+
+    uint32_t currentFrame() const
+    {
+        return m_currentFrame;
+    }
+
+    uint32_t frameCount() const
+    {
+        return static_cast<uint32_t>(m_frames.size());
+    }
+
+    /**
+     * @brief allocatedPoolCount
+     * @return
+     *
+     * The total number of pools owned by all frames.
+     */
+    size_t allocatedPoolCount() const
+    {
+        size_t c = 0;
+        for(auto & f : m_frames)
+            c += f.pools.size();
+        return c;
+    }
+
+    /**
+     * @brief allocatedPoolCount
+     * @param frameIndex
+     * @return
+     *
+     * The number of pools owned by a specific frame.
+     */
+    size_t allocatedPoolCount(uint32_t frameIndex) const
+    {
+        return m_frames.at(frameIndex).pools.size();
+    }
+
+protected:
+    VkDescriptorPool createNewPool()
+    {
+        VkDescriptorPoolCreateInfo ci = {};
+        ci.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        ci.flags         = m_poolFlags;
+        ci.maxSets       = m_maxSetsPerPool;
+        ci.pPoolSizes    = m_poolSizes.data();
+        ci.poolSizeCount = static_cast<uint32_t>(m_poolSizes.size());
+
+        VkDescriptorPool pool;
+        auto result = vkCreateDescriptorPool(m_device, &ci, nullptr, &pool);
+        if( result != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error creating Descriptor Pool");
+        }
+        GVU_COUNT(instrumentation::globalStats().descriptorPoolsCreated, 1);
+        return pool;
+    }
+
+    struct Frame
+    {
+        std::vector<VkDescriptorPool> pools;
+        uint32_t                      cursor        = 0; // the pool currently being allocated from
+        uint32_t                      allocatedSets = 0; // number of sets allocated from pools[cursor]
+    };
+
+    VkDevice                           m_device         = VK_NULL_HANDLE;
+    VkDescriptorSetLayout              m_layout         = VK_NULL_HANDLE;
+    uint32_t                           m_maxSetsPerPool = 0;
+    uint32_t                           m_currentFrame   = 0;
+    std::vector<Frame>                 m_frames;
+    std::vector<VkDescriptorPoolSize>  m_poolSizes;
+    std::vector<VkDescriptorSetLayout> m_layouts; // m_layout repeated maxSetsPerPool times
+    VkDescriptorPoolCreateFlags        m_poolFlags = 0;
+    std::vector<uint32_t>              m_variableCounts; // the variable descriptor count repeated maxSetsPerPool times, empty if the layout has none
+};
+
+}
+
+#endif
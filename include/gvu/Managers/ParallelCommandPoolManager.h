@@ -0,0 +1,292 @@
+#ifndef GVU_PARALLEL_COMMAND_POOL_MANAGER_H
+#define GVU_PARALLEL_COMMAND_POOL_MANAGER_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <vulkan/vulkan.h>
+#include "CommandPoolManager.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The ParallelCommandPoolManager class
+ *
+ * Command pools are externally synchronized, so recording from several
+ * threads with a single pool requires a lock around every allocation
+ * and vkBegin/EndCommandBuffer call. This manager owns one command pool
+ * per worker thread per frame-in-flight. Each thread only ever touches
+ * its own pool so no locks are needed.
+ *
+ * Command buffers are never freed individually. When a frame is started
+ * again every pool of that frame is reset with vkResetCommandPool and its
+ * command buffers are handed out again.
+ *
+ * gvu::ParallelCommandPoolManager pools;
+ * pools.init(device, physicalDevice, VK_QUEUE_GRAPHICS_BIT, threadCount, 3);
+ *
+ * // main thread, every frame
+ * pools.beginFrame(frameIndex, frameFence);
+ *
+ * // worker thread t
+ * auto cmd = pools.allocateCommandBuffer(t, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+ *
+ * beginFrame() must not be called while workers are recording.
+ */
+class ParallelCommandPoolManager
+{
+public:
+
+    /**
+     * @brief init
+     * @param device
+     * @param queueFamilyIndex - the queue family the command buffers are submitted to
+     * @param threadCount - the number of recording threads
+     * @param framesInFlight
+     * @param createFlags - flags used for every pool
+     *
+     * Frame 0 is the current frame after init.
+     */
+    void init(VkDevice device,
+              uint32_t queueFamilyIndex,
+              uint32_t threadCount,
+              uint32_t framesInFlight,
+              VkCommandPoolCreateFlags createFlags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT)
+    {
+        if(threadCount == 0 || framesInFlight == 0)
+            throw std::invalid_argument("threadCount and framesInFlight must be greater than 0");
+
+        m_device           = device;
+        m_queueFamilyIndex = queueFamilyIndex;
+        m_threadCount      = threadCount;
+        m_frameCount       = framesInFlight;
+        m_currentFrame     = 0;
+
+        VkCommandPoolCreateInfo ci = {};
+        ci.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        ci.flags            = createFlags;
+        ci.queueFamilyIndex = queueFamilyIndex;
+
+        m_pools.clear();
+        m_pools.resize(threadCount * framesInFlight);
+        for(auto & P : m_pools)
+        {
+            auto result = vkCreateCommandPool(m_device, &ci, nullptr, &P.pool);
+            if(result != VK_SUCCESS)
+                throw std::runtime_error("Error creating Command Pool");
+        }
+    }
+
+    /**
+     * @brief init
+     * @param device
+     * @param physicalDevice
+     * @param queueFlags - used to find the queue family index
+     * @param threadCount
+     * @param framesInFlight
+     * @param createFlags
+     */
+    void init(VkDevice device,
+              VkPhysicalDevice physicalDevice,
+              VkQueueFlags queueFlags,
+              uint32_t threadCount,
+              uint32_t framesInFlight,
+              VkCommandPoolCreateFlags createFlags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT)
+    {
+        init(device,
+             CommandPoolManager::getQueueFamilyIndex(queueFlags, physicalDevice),
+             threadCount,
+             framesInFlight,
+             createFlags);
+    }
+
+    /**
+     * @brief destroy
+     *
+     * Destroys all the pools and their command buffers. The device
+     * must not be using any of them.
+     */
+    void destroy()
+    {
+        for(auto & P : m_pools)
+            vkDestroyCommandPool(m_device, P.pool, nullptr);
+        m_pools.clear();
+    }
+
+    /**
+     * @brief beginFrame
+     * @param frameIndex - the frame to begin, taken modulo framesInFlight
+     * @param fence - if not null, this fence is waited on before the pools are reset
+     *
+     * Makes frameIndex the current frame and resets the pool of every
+     * thread for that frame. Command buffers previously allocated for this
+     * frame can no longer be used, they will be handed out again.
+     */
+    void beginFrame(uint32_t frameIndex, VkFence fence = VK_NULL_HANDLE)
+    {
+        if(fence != VK_NULL_HANDLE)
+        {
+            GVU_SCOPE_TIMED("gvu::ParallelCommandPoolManager::beginFrame", instrumentation::globalStats().fenceWait);
+            auto result = vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+            if(result != VK_SUCCESS)
+                throw std::runtime_error("Error waiting for the frame fence");
+        }
+
+        m_currentFrame = frameIndex % m_frameCount;
+
+        for(uint32_t t=0; t < m_threadCount; t++)
+        {
+            auto & P = _pool(t, m_currentFrame);
+
+            // pools which were not used do not need to be reset
+            if(P.primary.cursor == 0 && P.secondary.cursor == 0)
+                continue;
+
+            auto result = vkResetCommandPool(m_device, P.pool, 0);
+            if(result != VK_SUCCESS)
+                throw std::runtime_error("Error resetting Command Pool");
+            P.primary.cursor   = 0;
+            P.secondary.cursor = 0;
+        }
+    }
+
+    /**
+     * @brief allocateCommandBuffer
+     * @param threadIndex - the index of the calling thread, in [0, threadCount)
+     * @param level
+     * @return
+     *
+     * Returns a command buffer in the initial state from the thread's
+     * pool for the current frame. Only the thread with this index may call
+     * this function, or record into the returned buffer.
+     */
+    VkCommandBuffer allocateCommandBuffer(uint32_t threadIndex, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY)
+    {
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+        allocateCommandBuffers(threadIndex, level, &cmd, 1);
+        return cmd;
+    }
+
+    /**
+     * @brief allocateCommandBuffers
+     * @param threadIndex
+     * @param level
+     * @param buffers - the array to write the command buffers into
+     * @param count
+     *
+     * Returns count command buffers from the thread's pool for the current
+     * frame. Buffers from previous uses of the frame are reused first, new
+     * ones are allocated with a single vkAllocateCommandBuffers call.
+     */
+    void allocateCommandBuffers(uint32_t threadIndex, VkCommandBufferLevel level, VkCommandBuffer * buffers, uint32_t count)
+    {
+        if(threadIndex >= m_threadCount)
+            throw std::out_of_range("Thread index is larger than the thread count");
+
+        auto & P = _pool(threadIndex, m_currentFrame);
+        auto & L = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY ? P.primary : P.secondary;
+
+        auto available = static_cast<uint32_t>(L.buffers.size()) - L.cursor;
+        if(available < count)
+        {
+            auto n = count - available;
+
+            VkCommandBufferAllocateInfo ai = {};
+            ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            ai.commandPool        = P.pool;
+            ai.level              = level;
+            ai.commandBufferCount = n;
+
+            L.buffers.resize(L.buffers.size() + n);
+            auto result = vkAllocateCommandBuffers(m_device, &ai, L.buffers.data() + L.buffers.size() - n);
+            if(result != VK_SUCCESS)
+            {
+                L.buffers.resize(L.buffers.size() - n);
+                throw std::runtime_error("Error allocating Command Buffers");
+            }
+        }
+
+        std::copy(L.buffers.begin() + L.cursor, L.buffers.begin() + L.cursor + count, buffers);
+        L.cursor += count;
+    }
+
+    /**
+     * @brief getCommandPool
+     * @param threadIndex
+     * @return
+     *
+     * Returns the thread's pool for the current frame.
+     */
+    VkCommandPool getCommandPool(uint32_t threadIndex) const
+    {
+        return m_pools.at(threadIndex * m_frameCount + m_currentFrame).pool;
+    }
+
+    uint32_t currentFrame() const
+    {
+        return m_currentFrame;
+    }
+
+    uint32_t frameCount() const
+    {
+        return m_frameCount;
+    }
+
+    uint32_t threadCount() const
+    {
+        return m_threadCount;
+    }
+
+    uint32_t queueFamilyIndex() const
+    {
+        return m_queueFamilyIndex;
+    }
+
+    /**
+     * @brief allocatedCommandBufferCount
+     * @param threadIndex
+     * @param frameIndex
+     * @return
+     *
+     * The number of command buffers, of both levels, which have been
+     * allocated from the thread's pool for that frame.
+     */
+    size_t allocatedCommandBufferCount(uint32_t threadIndex, uint32_t frameIndex) const
+    {
+        auto & P = m_pools.at(threadIndex * m_frameCount + frameIndex);
+        return P.primary.buffers.size() + P.secondary.buffers.size();
+    }
+
+protected:
+    struct _Level
+    {
+        std::vector<VkCommandBuffer> buffers;
+        uint32_t                     cursor = 0; // the next buffer to hand out
+    };
+
+    // aligned to a cache line so threads do not write to the same line
+    struct alignas(64) _ThreadPool
+    {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        _Level        primary;
+        _Level        secondary;
+    };
+
+    _ThreadPool & _pool(uint32_t threadIndex, uint32_t frameIndex)
+    {
+        return m_pools[threadIndex * m_frameCount + frameIndex];
+    }
+
+    VkDevice                 m_device           = VK_NULL_HANDLE;
+    uint32_t                 m_queueFamilyIndex = 0;
+    uint32_t                 m_threadCount      = 0;
+    uint32_t                 m_frameCount       = 0;
+    uint32_t                 m_currentFrame     = 0;
+    std::vector<_ThreadPool> m_pools; // indexed by threadIndex * frameCount + frameIndex
+};
+
+}
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef GVU_SUBMIT_BATCH_H
+#define GVU_SUBMIT_BATCH_H
+
+#include <vector>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+namespace gvu
+{
+
+/**
+ * @brief The SubmitBatch class
+ *
+ * Gathers command buffers and semaphores and submits all of them with a
+ * single vkQueueSubmit call.
+ *
+ * A batch is made of one or more VkSubmitInfos. Command buffers and
+ * semaphores are added to the last one. Call nextSubmit() to start a new
+ * VkSubmitInfo when some command buffers must wait on different
+ * semaphores than others.
+ *
+ * Semaphores given a non-zero value are timeline semaphores, and a
+ * VkTimelineSemaphoreSubmitInfo is chained to that submit info.
+ *
+ * gvu::SubmitBatch batch;
+ *
+ * batch.addWaitSemaphore(imageAvailable, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+ * batch.addCommandBuffer(shadowCmd);
+ * batch.addCommandBuffer(mainCmd);
+ * batch.addSignalSemaphore(renderFinished);
+ * batch.addSignalSemaphore(timeline, frameNumber);
+ *
+ * batch.flush(graphicsQueue, frameFence); // one vkQueueSubmit, then the batch is cleared
+ */
+class SubmitBatch
+{
+public:
+    SubmitBatch()
+    {
+        clear();
+    }
+
+    /**
+     * @brief addCommandBuffer
+     * @param cmd
+     *
+     * Adds a command buffer to the current submit info
+     */
+    void addCommandBuffer(VkCommandBuffer cmd)
+    {
+        m_commandBuffers.push_back(cmd);
+        m_submits.back().commandBufferCount++;
+    }
+
+    /**
+     * @brief addWaitSemaphore
+     * @param semaphore
+     * @param stage - the stage which waits on the semaphore
+     * @param value - the value to wait for if the semaphore is a timeline semaphore
+     */
+    void addWaitSemaphore(VkSemaphore semaphore, VkPipelineStageFlags stage, uint64_t value = 0)
+    {
+        m_waitSemaphores.push_back(semaphore);
+        m_waitStages.push_back(stage);
+        m_waitValues.push_back(value);
+        auto & S = m_submits.back();
+        S.waitCount++;
+        S.timeline |= value != 0;
+    }
+
+    /**
+     * @brief addSignalSemaphore
+     * @param semaphore
+     * @param value - the value to signal if the semaphore is a timeline semaphore
+     */
+    void addSignalSemaphore(VkSemaphore semaphore, uint64_t value = 0)
+    {
+        m_signalSemaphores.push_back(semaphore);
+        m_signalValues.push_back(value);
+        auto & S = m_submits.back();
+        S.signalCount++;
+        S.timeline |= value != 0;
+    }
+
+    /**
+     * @brief nextSubmit
+     *
+     * Starts a new VkSubmitInfo. The command buffers and semaphores
+     * added after this call are only ordered against the waits and
+     * signals of the new submit info. Does nothing if the current submit
+     * info is empty.
+     */
+    void nextSubmit()
+    {
+        if(_isEmpty(m_submits.back()))
+            return;
+        m_submits.emplace_back();
+    }
+
+    /**
+     * @brief flush
+     * @param queue
+     * @param fence - signalled when every command buffer of the batch has finished
+     * @return the result of vkQueueSubmit
+     *
+     * Submits the entire batch with a single vkQueueSubmit and clears it.
+     * An empty batch is not submitted unless a fence is given, in which
+     * case the fence is still signalled.
+     */
+    VkResult flush(VkQueue queue, VkFence fence = VK_NULL_HANDLE)
+    {
+        if(empty() && fence == VK_NULL_HANDLE)
+            return VK_SUCCESS;
+
+        // remove the trailing empty submit info, if any
+        if(m_submits.size() > 1 && _isEmpty(m_submits.back()))
+            m_submits.pop_back();
+
+        m_submitInfos.resize(m_submits.size());
+        m_timelineInfos.resize(m_submits.size());
+
+        uint32_t c = 0, w = 0, s = 0;
+        for(size_t i=0; i < m_submits.size(); i++)
+        {
+            auto & S  = m_submits[i];
+            auto & SI = m_submitInfos[i];
+            SI = {};
+            SI.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            SI.commandBufferCount   = S.commandBufferCount;
+            SI.pCommandBuffers      = m_commandBuffers.data() + c;
+            SI.waitSemaphoreCount   = S.waitCount;
+            SI.pWaitSemaphores      = m_waitSemaphores.data() + w;
+            SI.pWaitDstStageMask    = m_waitStages.data() + w;
+            SI.signalSemaphoreCount = S.signalCount;
+            SI.pSignalSemaphores    = m_signalSemaphores.data() + s;
+
+            if(S.timeline)
+            {
+                auto & T = m_timelineInfos[i];
+                T = {};
+                T.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+                T.waitSemaphoreValueCount   = S.waitCount;
+                T.pWaitSemaphoreValues      = m_waitValues.data() + w;
+                T.signalSemaphoreValueCount = S.signalCount;
+                T.pSignalSemaphoreValues    = m_signalValues.data() + s;
+                SI.pNext = &T;
+            }
+
+            c += S.commandBufferCount;
+            w += S.waitCount;
+            s += S.signalCount;
+        }
+
+        auto count  = empty() ? 0u : static_cast<uint32_t>(m_submitInfos.size());
+        auto result = vkQueueSubmit(queue, count, m_submitInfos.data(), fence);
+        clear();
+        return result;
+    }
+
+    /**
+     * @brief clear
+     *
+     * Removes everything from the batch without submitting it.
+     */
+    void clear()
+    {
+        m_commandBuffers.clear();
+        m_waitSemaphores.clear();
+        m_waitStages.clear();
+        m_waitValues.clear();
+        m_signalSemaphores.clear();
+        m_signalValues.clear();
+        m_submits.clear();
+        m_submits.emplace_back();
+    }
+
+    /**
+     * @brief empty
+     * @return
+     *
+     * Returns true if nothing has been added to the batch
+     */
+    bool empty() const
+    {
+        return m_commandBuffers.empty() && m_waitSemaphores.empty() && m_signalSemaphores.empty();
+    }
+
+    size_t commandBufferCount() const
+    {
+        return m_commandBuffers.size();
+    }
+
+    /**
+     * @brief submitCount
+     * @return
+     *
+     * The number of VkSubmitInfos which will be passed to vkQueueSubmit
+     */
+    size_t submitCount() const
+    {
+        if(empty())
+            return 0;
+        return m_submits.size() - (_isEmpty(m_submits.back()) ? 1 : 0);
+    }
+
+protected:
+    struct _Submit
+    {
+        uint32_t commandBufferCount = 0;
+        uint32_t waitCount          = 0;
+        uint32_t signalCount        = 0;
+        bool     timeline           = false;
+    };
+
+    static bool _isEmpty(_Submit const & S)
+    {
+        return S.commandBufferCount == 0 && S.waitCount == 0 && S.signalCount == 0;
+    }
+
+    // the arrays of every submit info are stored contiguously, the
+    // pointers are only generated in flush() so adding never invalidates them.
+    std::vector<VkCommandBuffer>      m_commandBuffers;
+    std::vector<VkSemaphore>          m_waitSemaphores;
+    std::vector<VkPipelineStageFlags> m_waitStages;
+    std::vector<uint64_t>             m_waitValues;
+    std::vector<VkSemaphore>          m_signalSemaphores;
+    std::vector<uint64_t>             m_signalValues;
+    std::vector<_Submit>              m_submits;
+
+    std::vector<VkSubmitInfo>                  m_submitInfos;
+    std::vector<VkTimelineSemaphoreSubmitInfo> m_timelineInfos;
+};
+
+}
+
+#endif
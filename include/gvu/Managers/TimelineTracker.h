@@ -0,0 +1,310 @@
+#ifndef GVU_TIMELINE_TRACKER_H
+#define GVU_TIMELINE_TRACKER_H
+
+#include <deque>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <vulkan/vulkan.h>
+#include "SubmitBatch.h"
+#include "../Instrumentation.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The TimelineTracker class
+ *
+ * Tracks the completion of GPU work with a single timeline semaphore
+ * instead of one fence per submission.
+ *
+ * Every submission signals the semaphore with a new, larger value.
+ * Work which must happen after the GPU is finished with a resource (eg:
+ * recycling a command buffer or descriptor set) is deferred until the
+ * semaphore reaches a value. update() reads the semaphore value once and
+ * runs every deferred function which has completed, so calling it once
+ * per frame retires everything without blocking.
+ *
+ * gvu::TimelineTracker T;
+ * T.init(device);
+ *
+ * gvu::SubmitBatch batch;
+ * batch.addCommandBuffer(cmd);
+ * auto value = T.submit(batch, queue); // flushes the batch, signalling the next value
+ *
+ * T.onComplete(value, [&](){ destroyStagingBuffer(); });
+ *
+ * // once per frame
+ * T.update();
+ *
+ * The device must have the timelineSemaphore feature enabled.
+ * The TimelineTracker is not thread safe.
+ */
+class TimelineTracker
+{
+public:
+    /**
+     * @brief init
+     * @param device
+     * @param initialValue
+     */
+    void init(VkDevice device, uint64_t initialValue = 0)
+    {
+        m_device    = device;
+        m_reserved  = initialValue;
+        m_submitted = initialValue;
+        m_completed = initialValue;
+
+        VkSemaphoreTypeCreateInfo ti = {};
+        ti.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        ti.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        ti.initialValue  = initialValue;
+
+        VkSemaphoreCreateInfo ci = {};
+        ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        ci.pNext = &ti;
+        if(vkCreateSemaphore(device, &ci, nullptr, &m_semaphore) != VK_SUCCESS)
+            throw std::runtime_error("Error creating the timeline semaphore");
+    }
+
+    /**
+     * @brief destroy
+     *
+     * Waits for every submitted value, runs the remaining deferred
+     * functions and destroys the semaphore.
+     */
+    void destroy()
+    {
+        if(m_semaphore == VK_NULL_HANDLE)
+            return;
+        wait(m_submitted);
+        update();
+        vkDestroySemaphore(m_device, m_semaphore, nullptr);
+        m_semaphore = VK_NULL_HANDLE;
+    }
+
+    /**
+     * @brief nextValue
+     * @return
+     *
+     * Reserves the next value. The caller must submit work which
+     * signals the semaphore with it.
+     */
+    uint64_t nextValue()
+    {
+        m_submitted = ++m_reserved;
+        return m_submitted;
+    }
+
+    /**
+     * @brief signal
+     * @param batch
+     * @return the value which will be signalled
+     *
+     * Adds a signal of the next value to the current submit info of the batch.
+     * The value only counts as submitted once markSubmitted() is called
+     * with it, so a batch which fails to submit is never waited for. Use
+     * submit() to do both.
+     */
+    uint64_t signal(SubmitBatch & batch)
+    {
+        auto v = ++m_reserved;
+        batch.addSignalSemaphore(m_semaphore, v);
+        return v;
+    }
+
+    /**
+     * @brief markSubmitted
+     * @param value
+     *
+     * Records that the batch signalling value was submitted successfully.
+     */
+    void markSubmitted(uint64_t value)
+    {
+        m_submitted = std::max(m_submitted, value);
+    }
+
+    /**
+     * @brief submit
+     * @param batch
+     * @param queue
+     * @param fence
+     * @return the value which will be signalled
+     *
+     * Adds a signal of the next value to the batch and flushes it. The
+     * value is only counted as submitted if vkQueueSubmit succeeds,
+     * otherwise this throws.
+     */
+    uint64_t submit(SubmitBatch & batch, VkQueue queue, VkFence fence = VK_NULL_HANDLE)
+    {
+        auto v = signal(batch);
+        if(batch.flush(queue, fence) != VK_SUCCESS)
+            throw std::runtime_error("Error submitting the batch");
+        markSubmitted(v);
+        return v;
+    }
+
+    /**
+     * @brief addWait
+     * @param batch
+     * @param value
+     * @param stage
+     *
+     * Makes the current submit info of the batch wait for the value.
+     */
+    void addWait(SubmitBatch & batch, uint64_t value, VkPipelineStageFlags stage) const
+    {
+        batch.addWaitSemaphore(m_semaphore, stage, value);
+    }
+
+    /**
+     * @brief onComplete
+     * @param value
+     * @param f
+     *
+     * Defers f until the semaphore has reached value. If it
+     * already has, f is called right away.
+     */
+    void onComplete(uint64_t value, std::function<void()> f)
+    {
+        if(value <= m_completed)
+        {
+            f();
+            return;
+        }
+        // values are usually increasing, so this is almost always an append
+        auto it = std::upper_bound(m_deferred.begin(), m_deferred.end(), value, [](uint64_t v, _Deferred const & d)
+        {
+            return v < d.value;
+        });
+        m_deferred.insert(it, {value, std::move(f)});
+    }
+
+    /**
+     * @brief onSubmittedComplete
+     * @param f
+     *
+     * Defers f until all the work submitted so far has completed. Use
+     * this to destroy an object which may still be used by the GPU.
+     */
+    void onSubmittedComplete(std::function<void()> f)
+    {
+        onComplete(m_submitted, std::move(f));
+    }
+
+    /**
+     * @brief update
+     * @return the completed value
+     *
+     * Reads the semaphore value with a single vkGetSemaphoreCounterValue
+     * and runs every deferred function which has completed. Never blocks.
+     */
+    uint64_t update()
+    {
+        uint64_t value = 0;
+        if(vkGetSemaphoreCounterValue(m_device, m_semaphore, &value) != VK_SUCCESS)
+            throw std::runtime_error("Error reading the timeline semaphore");
+        _retire(value);
+        return m_completed;
+    }
+
+    /**
+     * @brief wait
+     * @param value
+     *
+     * Blocks until the semaphore has reached value, then runs the
+     * deferred functions which have completed.
+     */
+    void wait(uint64_t value)
+    {
+        if(value <= m_completed)
+            return;
+
+        VkSemaphoreWaitInfo wi = {};
+        wi.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        wi.semaphoreCount = 1;
+        wi.pSemaphores    = &m_semaphore;
+        wi.pValues        = &value;
+        GVU_SCOPE_TIMED("gvu::TimelineTracker::wait", instrumentation::globalStats().semaphoreWait);
+        if(vkWaitSemaphores(m_device, &wi, UINT64_MAX) != VK_SUCCESS)
+            throw std::runtime_error("Error waiting on the timeline semaphore");
+        _retire(value);
+    }
+
+    /**
+     * @brief isComplete
+     * @param value
+     * @return
+     *
+     * Returns true if value had completed at the last update() or
+     * wait(). This does not query the device.
+     */
+    bool isComplete(uint64_t value) const
+    {
+        return value <= m_completed;
+    }
+
+    VkSemaphore getSemaphore() const
+    {
+        return m_semaphore;
+    }
+
+    /**
+     * @brief lastSubmittedValue
+     * @return
+     *
+     * The last value returned by nextValue() or submitted with
+     * submit() or markSubmitted()
+     */
+    uint64_t lastSubmittedValue() const
+    {
+        return m_submitted;
+    }
+
+    /**
+     * @brief completedValue
+     * @return
+     *
+     * The semaphore value at the last update() or wait()
+     */
+    uint64_t completedValue() const
+    {
+        return m_completed;
+    }
+
+    size_t pendingCount() const
+    {
+        return m_deferred.size();
+    }
+
+protected:
+    void _retire(uint64_t value)
+    {
+        m_completed = std::max(m_completed, value);
+        while(!m_deferred.empty() && m_deferred.front().value <= m_completed)
+        {
+            // pop first, f may defer more work
+            auto f = std::move(m_deferred.front().f);
+            m_deferred.pop_front();
+            f();
+        }
+    }
+
+    struct _Deferred
+    {
+        uint64_t              value;
+        std::function<void()> f;
+    };
+
+    VkDevice              m_device    = VK_NULL_HANDLE;
+    VkSemaphore           m_semaphore = VK_NULL_HANDLE;
+    uint64_t              m_reserved  = 0; // the last value handed out
+    uint64_t              m_submitted = 0; // the last value known to be submitted
+    uint64_t              m_completed = 0;
+    std::deque<_Deferred> m_deferred; // sorted by value
+};
+
+}
+
+#endif
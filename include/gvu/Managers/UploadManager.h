@@ -0,0 +1,793 @@
+#ifndef GVU_UPLOAD_MANAGER_H
+#define GVU_UPLOAD_MANAGER_H
+
+#include <deque>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <numeric>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vulkan/vulkan.h>
+#include "CommandPoolManager.h"
+#include "SubmitBatch.h"
+#include "../FormatInfo.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The UploadManager class
+ *
+ * Uploads buffer and image data from the host through a persistently
+ * mapped staging ring buffer. The copies are recorded on a (preferably
+ * dedicated) transfer queue so they run in parallel with rendering.
+ *
+ * Uploads are only recorded when flush() is called, all the uploads since
+ * the last flush are submitted with a single vkQueueSubmit. flush()
+ * returns a token: the value the internal timeline semaphore reaches once
+ * the copies have finished. The graphics queue should wait on it before
+ * using the resources.
+ *
+ * If the transfer queue is from a different family than the queue which
+ * uses the resources, the resources are released from the transfer family
+ * and an acquire barrier must be recorded on the destination queue with
+ * recordAcquireBarriers().
+ *
+ * gvu::UploadManager U;
+ * U.init(device, physicalDevice, transferQueue, transferFamily, graphicsFamily);
+ *
+ * U.uploadBuffer(vertexBuffer, 0, vertices.data(), bytes);
+ * U.uploadImage(texture, VK_FORMAT_R8G8B8A8_UNORM, {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1}, {0,0,0}, {256,256,1}, pixels, 256*256*4);
+ * auto token = U.flush();
+ *
+ * // on the graphics queue
+ * U.recordAcquireBarriers(graphicsCmd);
+ * U.addWait(batch, token, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+ *
+ * // once per frame, never blocks
+ * U.collect();
+ *
+ * The staging memory of a flush is reused once its token has completed.
+ * If the ring is full, uploading waits for the oldest flush to finish.
+ * The UploadManager is not thread safe.
+ */
+class UploadManager
+{
+public:
+    /**
+     * @brief init
+     * @param device
+     * @param physicalDevice
+     * @param transferQueue - the queue the copies are submitted to
+     * @param transferFamilyIndex - the queue family of transferQueue
+     * @param dstFamilyIndex - the queue family which will use the uploaded resources
+     * @param stagingSize - the size of the staging ring buffer in bytes
+     *
+     * The device must have the timelineSemaphore feature enabled.
+     */
+    void init(VkDevice         device,
+              VkPhysicalDevice physicalDevice,
+              VkQueue          transferQueue,
+              uint32_t         transferFamilyIndex,
+              uint32_t         dstFamilyIndex,
+              VkDeviceSize     stagingSize = 64*1024*1024)
+    {
+        m_device         = device;
+        m_queue          = transferQueue;
+        m_transferFamily = transferFamilyIndex;
+        m_dstFamily      = dstFamilyIndex;
+        m_size           = stagingSize;
+        m_head           = 0;
+        m_tail           = 0;
+        m_lastToken      = 0;
+
+        // staging buffer
+        {
+            VkBufferCreateInfo ci = {};
+            ci.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            ci.size        = stagingSize;
+            ci.usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+            ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            if(vkCreateBuffer(device, &ci, nullptr, &m_buffer) != VK_SUCCESS)
+                throw std::runtime_error("Error creating the staging buffer");
+
+            VkMemoryRequirements req;
+            vkGetBufferMemoryRequirements(device, m_buffer, &req);
+
+            VkMemoryPropertyFlags props = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            auto typeIndex = findMemoryType(physicalDevice, req.memoryTypeBits, props);
+            m_coherent = typeIndex != UINT32_MAX;
+            if(!m_coherent)
+                typeIndex = findMemoryType(physicalDevice, req.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            if(typeIndex == UINT32_MAX)
+                throw std::runtime_error("No host visible memory type for the staging buffer");
+
+            VkMemoryAllocateInfo ai = {};
+            ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            ai.allocationSize  = req.size;
+            ai.memoryTypeIndex = typeIndex;
+            if(vkAllocateMemory(device, &ai, nullptr, &m_memory) != VK_SUCCESS)
+                throw std::runtime_error("Error allocating the staging memory");
+
+            GVK_CHECK_RESULT(vkBindBufferMemory(device, m_buffer, m_memory, 0));
+
+            void * mapped = nullptr;
+            GVK_CHECK_RESULT(vkMapMemory(device, m_memory, 0, stagingSize, 0, &mapped));
+            m_mapped = static_cast<uint8_t*>(mapped);
+        }
+
+        // timeline semaphore
+        {
+            VkSemaphoreTypeCreateInfo ti = {};
+            ti.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            ti.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+            ti.initialValue  = 0;
+
+            VkSemaphoreCreateInfo ci = {};
+            ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            ci.pNext = &ti;
+            if(vkCreateSemaphore(device, &ci, nullptr, &m_timeline) != VK_SUCCESS)
+                throw std::runtime_error("Error creating the timeline semaphore");
+        }
+
+        // command pool on the transfer family
+        {
+            VkCommandPoolCreateInfo ci = {};
+            ci.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            ci.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            ci.queueFamilyIndex = transferFamilyIndex;
+            if(vkCreateCommandPool(device, &ci, nullptr, &m_pool) != VK_SUCCESS)
+                throw std::runtime_error("Error creating Command Pool");
+        }
+    }
+
+    /**
+     * @brief destroy
+     *
+     * Waits for every flushed upload to finish and destroys the staging
+     * buffer. Uploads which have not been flushed are discarded.
+     */
+    void destroy()
+    {
+        if(m_device == VK_NULL_HANDLE)
+            return;
+        wait(m_lastToken);
+
+        vkDestroyCommandPool(m_device, m_pool, nullptr);
+        vkDestroySemaphore(m_device, m_timeline, nullptr);
+        vkUnmapMemory(m_device, m_memory);
+        vkDestroyBuffer(m_device, m_buffer, nullptr);
+        vkFreeMemory(m_device, m_memory, nullptr);
+
+        m_inFlight.clear();
+        m_freeCommandBuffers.clear();
+        m_bufferCopies.clear();
+        m_imageCopies.clear();
+        m_imageLayouts.clear();
+        m_acquireBuffers.clear();
+        m_acquireImages.clear();
+        m_device = VK_NULL_HANDLE;
+    }
+
+    /**
+     * @brief mapBufferUpload
+     * @param dst
+     * @param dstOffset
+     * @param size
+     * @return
+     *
+     * Reserves size bytes of staging memory which will be copied to
+     * dst at dstOffset, and returns a pointer to write the data into.
+     * Write the data before the next upload, a full ring flushes the
+     * pending uploads. size must not be 0.
+     */
+    void * mapBufferUpload(VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size)
+    {
+        if(size == 0)
+            throw std::invalid_argument("Cannot upload 0 bytes");
+        auto offset = _allocate(size, _bufferAlignment);
+
+        auto & C = m_bufferCopies.emplace_back();
+        C.dst              = dst;
+        C.region.srcOffset = offset;
+        C.region.dstOffset = dstOffset;
+        C.region.size      = size;
+        return m_mapped + offset;
+    }
+
+    /**
+     * @brief uploadBuffer
+     * @param dst
+     * @param dstOffset
+     * @param data
+     * @param size
+     *
+     * Copies the data into the staging buffer. It is written to
+     * dst on the next flush().
+     */
+    void uploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, void const * data, VkDeviceSize size)
+    {
+        if(size == 0)
+            return;
+        std::memcpy(mapBufferUpload(dst, dstOffset, size), data, static_cast<size_t>(size));
+    }
+
+    /**
+     * @brief mapImageUpload
+     * @param dst
+     * @param format - the format of dst, the staging offset is aligned to its texel block size
+     * @param subresource - the mip level and array layers to write to
+     * @param offset
+     * @param extent
+     * @param size - the number of bytes of the image data
+     * @param finalLayout - the layout of the subresource after the upload
+     * @param bufferRowLength - see VkBufferImageCopy
+     * @param bufferImageHeight - see VkBufferImageCopy
+     * @return
+     *
+     * Reserves staging memory for an image region and returns a pointer
+     * to write the data into. The previous contents of the subresource are
+     * discarded, so every region of a subresource must be uploaded before
+     * the same flush(). A full ring flushes early, so the regions of one
+     * subresource should fit in the ring together. Write the data before
+     * the next upload.
+     *
+     * Throws std::invalid_argument if the subresource is already being
+     * uploaded with a different finalLayout.
+     */
+    void * mapImageUpload(VkImage                  dst,
+                          VkFormat                 format,
+                          VkImageSubresourceLayers subresource,
+                          VkOffset3D               offset,
+                          VkExtent3D               extent,
+                          VkDeviceSize             size,
+                          VkImageLayout            finalLayout       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          uint32_t                 bufferRowLength   = 0,
+                          uint32_t                 bufferImageHeight = 0)
+    {
+        if(size == 0)
+            throw std::invalid_argument("Cannot upload 0 bytes");
+        for(uint32_t l=0; l < subresource.layerCount; l++)
+        {
+            auto it = m_imageLayouts.find(_subresourceKey(dst, subresource, l));
+            if(it != m_imageLayouts.end() && it->second != finalLayout)
+                throw std::invalid_argument("The subresource is already being uploaded with a different final layout");
+        }
+
+        auto srcOffset = _allocate(size, getImageCopyAlignment(format));
+
+        // the allocation may have flushed, so the layouts are recorded afterwards
+        for(uint32_t l=0; l < subresource.layerCount; l++)
+            m_imageLayouts[_subresourceKey(dst, subresource, l)] = finalLayout;
+
+        auto & C = m_imageCopies.emplace_back();
+        C.dst                      = dst;
+        C.region.bufferOffset      = srcOffset;
+        C.region.bufferRowLength   = bufferRowLength;
+        C.region.bufferImageHeight = bufferImageHeight;
+        C.region.imageSubresource  = subresource;
+        C.region.imageOffset       = offset;
+        C.region.imageExtent       = extent;
+        return m_mapped + srcOffset;
+    }
+
+    /**
+     * @brief uploadImage
+     *
+     * Copies the data into the staging buffer. It is written to the
+     * image on the next flush(). See mapImageUpload() for the parameters.
+     */
+    void uploadImage(VkImage                  dst,
+                     VkFormat                 format,
+                     VkImageSubresourceLayers subresource,
+                     VkOffset3D               offset,
+                     VkExtent3D               extent,
+                     void const *             data,
+                     VkDeviceSize             size,
+                     VkImageLayout            finalLayout       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     uint32_t                 bufferRowLength   = 0,
+                     uint32_t                 bufferImageHeight = 0)
+    {
+        auto p = mapImageUpload(dst, format, subresource, offset, extent, size, finalLayout, bufferRowLength, bufferImageHeight);
+        std::memcpy(p, data, static_cast<size_t>(size));
+    }
+
+    /**
+     * @brief flush
+     * @return the token of the uploads
+     *
+     * Records every upload since the last flush into one command buffer
+     * and submits it to the transfer queue. Returns the value the timeline
+     * semaphore will have once they have finished. If there is nothing to
+     * flush, the token of the previous flush is returned.
+     */
+    uint64_t flush()
+    {
+        if(m_bufferCopies.empty() && m_imageCopies.empty())
+            return m_lastToken;
+
+        if(!m_coherent)
+        {
+            VkMappedMemoryRange range = {};
+            range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range.memory = m_memory;
+            range.offset = 0;
+            range.size   = VK_WHOLE_SIZE;
+            GVK_CHECK_RESULT(vkFlushMappedMemoryRanges(m_device, 1, &range));
+        }
+
+        auto cmd = _getCommandBuffer();
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        GVK_CHECK_RESULT(vkBeginCommandBuffer(cmd, &beginInfo));
+
+        bool     transfer  = requiresOwnershipTransfer();
+        uint32_t srcFamily = transfer ? m_transferFamily : VK_QUEUE_FAMILY_IGNORED;
+        uint32_t dstFamily = transfer ? m_dstFamily      : VK_QUEUE_FAMILY_IGNORED;
+
+        // transition the images so they can be copied to, one barrier
+        // per subresource range no matter how many regions it has
+        _buildImageBarriers();
+        if(!m_imageBarriers.empty())
+        {
+            m_transitionBarriers.assign(m_imageBarriers.begin(), m_imageBarriers.end());
+            for(auto & B : m_transitionBarriers)
+            {
+                B.srcAccessMask = 0;
+                B.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                B.oldLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+                B.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            }
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                                 0, nullptr, 0, nullptr,
+                                 static_cast<uint32_t>(m_transitionBarriers.size()), m_transitionBarriers.data());
+        }
+
+        for(auto & C : m_bufferCopies)
+            vkCmdCopyBuffer(cmd, m_buffer, C.dst, 1, &C.region);
+        for(auto & C : m_imageCopies)
+            vkCmdCopyBufferToImage(cmd, m_buffer, C.dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &C.region);
+
+        // make the writes visible, and release the resources to the
+        // destination family if needed
+        m_bufferBarriers.clear();
+        for(auto & C : m_bufferCopies)
+        {
+            auto & B = m_bufferBarriers.emplace_back();
+            B = {};
+            B.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            B.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+            B.dstAccessMask       = transfer ? 0 : VK_ACCESS_MEMORY_READ_BIT;
+            B.srcQueueFamilyIndex = srcFamily;
+            B.dstQueueFamilyIndex = dstFamily;
+            B.buffer              = C.dst;
+            B.offset              = C.region.dstOffset;
+            B.size                = C.region.size;
+        }
+        for(auto & B : m_imageBarriers)
+        {
+            B.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+            B.dstAccessMask       = transfer ? 0 : VK_ACCESS_MEMORY_READ_BIT;
+            B.srcQueueFamilyIndex = srcFamily;
+            B.dstQueueFamilyIndex = dstFamily;
+        }
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             transfer ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             0, nullptr,
+                             static_cast<uint32_t>(m_bufferBarriers.size()), m_bufferBarriers.data(),
+                             static_cast<uint32_t>(m_imageBarriers.size()), m_imageBarriers.data());
+
+        GVK_CHECK_RESULT(vkEndCommandBuffer(cmd));
+
+        auto token = m_lastToken + 1;
+
+        SubmitBatch batch;
+        batch.addCommandBuffer(cmd);
+        batch.addSignalSemaphore(m_timeline, token);
+        GVK_CHECK_RESULT(batch.flush(m_queue));
+
+        m_lastToken = token;
+        m_inFlight.push_back({token, m_head, cmd});
+
+        // the matching acquire barriers for the destination queue
+        if(transfer)
+        {
+            for(auto & B : m_bufferBarriers)
+            {
+                B.srcAccessMask = 0;
+                m_acquireBuffers.push_back(B);
+            }
+            for(auto & B : m_imageBarriers)
+            {
+                B.srcAccessMask = 0;
+                m_acquireImages.push_back(B);
+            }
+        }
+
+        m_bufferCopies.clear();
+        m_imageCopies.clear();
+        m_imageLayouts.clear();
+        return token;
+    }
+
+    /**
+     * @brief recordAcquireBarriers
+     * @param cmd - a command buffer which will be submitted to the destination queue family
+     * @param dstStage
+     * @param dstAccess
+     * @return the token the submission of cmd must wait on
+     *
+     * Records the queue family ownership acquire barriers for every
+     * resource flushed since the last call. Does nothing if the transfer
+     * and destination families are the same.
+     */
+    uint64_t recordAcquireBarriers(VkCommandBuffer      cmd,
+                                   VkPipelineStageFlags dstStage  = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                   VkAccessFlags        dstAccess = VK_ACCESS_MEMORY_READ_BIT)
+    {
+        if(m_acquireBuffers.empty() && m_acquireImages.empty())
+            return m_lastToken;
+
+        for(auto & B : m_acquireBuffers)
+            B.dstAccessMask = dstAccess;
+        for(auto & B : m_acquireImages)
+            B.dstAccessMask = dstAccess;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStage, 0,
+                             0, nullptr,
+                             static_cast<uint32_t>(m_acquireBuffers.size()), m_acquireBuffers.data(),
+                             static_cast<uint32_t>(m_acquireImages.size()), m_acquireImages.data());
+
+        m_acquireBuffers.clear();
+        m_acquireImages.clear();
+        return m_lastToken;
+    }
+
+    /**
+     * @brief addWait
+     * @param batch
+     * @param token
+     * @param stage - the stages which use the uploaded resources
+     *
+     * Makes the batch wait for the uploads of the token to finish.
+     */
+    void addWait(SubmitBatch & batch, uint64_t token, VkPipelineStageFlags stage) const
+    {
+        batch.addWaitSemaphore(m_timeline, stage, token);
+    }
+
+    /**
+     * @brief isComplete
+     * @param token
+     * @return
+     *
+     * Returns true if the uploads of the token have finished. Never blocks.
+     */
+    bool isComplete(uint64_t token) const
+    {
+        return completedToken() >= token;
+    }
+
+    /**
+     * @brief completedToken
+     * @return
+     *
+     * Returns the current value of the timeline semaphore
+     */
+    uint64_t completedToken() const
+    {
+        uint64_t value = 0;
+        GVK_CHECK_RESULT(vkGetSemaphoreCounterValue(m_device, m_timeline, &value));
+        return value;
+    }
+
+    /**
+     * @brief wait
+     * @param token
+     *
+     * Blocks until the uploads of the token have finished.
+     */
+    void wait(uint64_t token) const
+    {
+        if(token == 0)
+            return;
+        VkSemaphoreWaitInfo wi = {};
+        wi.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        wi.semaphoreCount = 1;
+        wi.pSemaphores    = &m_timeline;
+        wi.pValues        = &token;
+        GVU_SCOPE_TIMED("gvu::UploadManager::wait", instrumentation::globalStats().semaphoreWait);
+        GVK_CHECK_RESULT(vkWaitSemaphores(m_device, &wi, UINT64_MAX));
+    }
+
+    /**
+     * @brief collect
+     * @return
+     *
+     * Frees the staging memory and command buffers of every flush which
+     * has finished. Never blocks. Returns the number of flushes retired.
+     */
+    size_t collect()
+    {
+        if(m_inFlight.empty())
+            return 0;
+
+        auto value = completedToken();
+        size_t count = 0;
+        while(!m_inFlight.empty() && m_inFlight.front().token <= value)
+        {
+            auto & F = m_inFlight.front();
+            m_tail = F.ringEnd;
+            m_freeCommandBuffers.push_back(F.cmd);
+            m_inFlight.pop_front();
+            ++count;
+        }
+        return count;
+    }
+
+    bool requiresOwnershipTransfer() const
+    {
+        return m_transferFamily != m_dstFamily;
+    }
+
+    VkSemaphore getSemaphore() const
+    {
+        return m_timeline;
+    }
+
+    uint64_t lastToken() const
+    {
+        return m_lastToken;
+    }
+
+    VkDeviceSize stagingSize() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief stagingUsed
+     * @return
+     *
+     * The number of bytes of the ring which are in use by pending or
+     * in-flight uploads, including alignment and wrap-around padding.
+     */
+    VkDeviceSize stagingUsed() const
+    {
+        return m_head - m_tail;
+    }
+
+    size_t inFlightCount() const
+    {
+        return m_inFlight.size();
+    }
+
+    /**
+     * @brief pendingAcquireCount
+     * @return
+     *
+     * The number of acquire barriers recordAcquireBarriers() will record
+     */
+    size_t pendingAcquireCount() const
+    {
+        return m_acquireBuffers.size() + m_acquireImages.size();
+    }
+
+    /**
+     * @brief getImageCopyAlignment
+     * @param format
+     * @return
+     *
+     * The alignment of the staging offset of an image region.
+     * vkCmdCopyBufferToImage requires a multiple of the texel block size,
+     * and a multiple of 4. 3 component formats have 3, 6, 12 or 24 byte
+     * texels, so this is their least common multiple.
+     */
+    static VkDeviceSize getImageCopyAlignment(VkFormat format)
+    {
+        VkDeviceSize texelBytes = getFormatInfo(format).blockSizeInBits / 8;
+        if(texelBytes == 0)
+            throw std::invalid_argument("Unknown image format");
+        return std::lcm(texelBytes, VkDeviceSize(4));
+    }
+
+    /**
+     * @brief findMemoryType
+     * @param physicalDevice
+     * @param typeBits
+     * @param properties
+     * @return
+     *
+     * Returns the index of the first memory type in typeBits which has
+     * all the properties, or UINT32_MAX if there is none.
+     */
+    static uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags properties)
+    {
+        VkPhysicalDeviceMemoryProperties P;
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &P);
+        for(uint32_t i=0; i < P.memoryTypeCount; i++)
+        {
+            if( (typeBits & (1u << i)) && (P.memoryTypes[i].propertyFlags & properties) == properties)
+                return i;
+        }
+        return UINT32_MAX;
+    }
+
+protected:
+    // buffer copies have no alignment requirement, this only keeps the
+    // staging writes aligned for the host
+    static constexpr VkDeviceSize _bufferAlignment = 16;
+
+    /**
+     * @brief _allocate
+     * @param size
+     * @param alignment
+     * @return the offset into the staging buffer
+     *
+     * m_head and m_tail are virtual offsets which only increase, the
+     * physical offset is the virtual offset modulo the ring size. An
+     * allocation never wraps around the end of the buffer.
+     */
+    VkDeviceSize _allocate(VkDeviceSize size, VkDeviceSize alignment)
+    {
+        if(size > m_size)
+            throw std::length_error("Upload is larger than the staging buffer");
+
+        while(true)
+        {
+            // nothing is in use, start from the beginning of the buffer
+            if(m_head == m_tail)
+            {
+                m_head = (m_head + m_size - 1) / m_size * m_size;
+                m_tail = m_head;
+            }
+
+            // m_size may not be a multiple of the alignment, so the
+            // physical offset is aligned
+            auto p = m_head % m_size;
+            auto a = m_head - p + (p + alignment - 1) / alignment * alignment;
+            if(a - m_head + p + size > m_size)
+                a = m_head - p + m_size;
+
+            if(a + size - m_tail <= m_size)
+            {
+                m_head = a + size;
+                return a % m_size;
+            }
+
+            // the ring is full
+            if(m_inFlight.empty())
+                flush();
+            else if(collect() == 0)
+            {
+                wait(m_inFlight.front().token);
+                collect();
+            }
+        }
+    }
+
+    VkCommandBuffer _getCommandBuffer()
+    {
+        if(m_freeCommandBuffers.empty())
+            collect();
+        if(!m_freeCommandBuffers.empty())
+        {
+            auto cmd = m_freeCommandBuffers.back();
+            m_freeCommandBuffers.pop_back();
+            return cmd;
+        }
+
+        VkCommandBufferAllocateInfo ai = {};
+        ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        ai.commandPool        = m_pool;
+        ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        ai.commandBufferCount = 1;
+
+        VkCommandBuffer cmd;
+        GVK_CHECK_RESULT(vkAllocateCommandBuffers(m_device, &ai, &cmd));
+        return cmd;
+    }
+
+    struct _BufferCopy
+    {
+        VkBuffer     dst = VK_NULL_HANDLE;
+        VkBufferCopy region = {};
+    };
+    struct _ImageCopy
+    {
+        VkImage           dst = VK_NULL_HANDLE;
+        VkBufferImageCopy region = {};
+    };
+    struct _InFlight
+    {
+        uint64_t        token;
+        uint64_t        ringEnd; // m_head when the uploads were flushed
+        VkCommandBuffer cmd;
+    };
+
+    // image, aspect, mip level, array layer
+    using _SubresourceKey = std::tuple<VkImage, VkImageAspectFlags, uint32_t, uint32_t>;
+
+    static _SubresourceKey _subresourceKey(VkImage image, VkImageSubresourceLayers const & S, uint32_t layer)
+    {
+        return {image, S.aspectMask, S.mipLevel, S.baseArrayLayer + layer};
+    }
+
+    /**
+     * @brief _buildImageBarriers
+     *
+     * Fills m_imageBarriers with one TRANSFER_DST -> finalLayout barrier
+     * per subresource range being uploaded. Regions which write to the same
+     * subresource share a barrier, and consecutive array layers with the
+     * same final layout are merged into a single range.
+     */
+    void _buildImageBarriers()
+    {
+        m_imageBarriers.clear();
+        for(auto & [key, layout] : m_imageLayouts)
+        {
+            auto & [image, aspect, mip, layer] = key;
+            if(!m_imageBarriers.empty())
+            {
+                auto & P = m_imageBarriers.back();
+                if(P.image == image && P.subresourceRange.aspectMask == aspect && P.subresourceRange.baseMipLevel == mip
+                   && P.newLayout == layout && P.subresourceRange.baseArrayLayer + P.subresourceRange.layerCount == layer)
+                {
+                    P.subresourceRange.layerCount++;
+                    continue;
+                }
+            }
+            auto & B = m_imageBarriers.emplace_back();
+            B = {};
+            B.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            B.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            B.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            B.oldLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            B.newLayout                       = layout;
+            B.image                           = image;
+            B.subresourceRange.aspectMask     = aspect;
+            B.subresourceRange.baseMipLevel   = mip;
+            B.subresourceRange.levelCount     = 1;
+            B.subresourceRange.baseArrayLayer = layer;
+            B.subresourceRange.layerCount     = 1;
+        }
+    }
+
+    VkDevice       m_device         = VK_NULL_HANDLE;
+    VkQueue        m_queue          = VK_NULL_HANDLE;
+    uint32_t       m_transferFamily = 0;
+    uint32_t       m_dstFamily      = 0;
+
+    VkBuffer       m_buffer   = VK_NULL_HANDLE;
+    VkDeviceMemory m_memory   = VK_NULL_HANDLE;
+    uint8_t *      m_mapped   = nullptr;
+    bool           m_coherent = true;
+    VkDeviceSize   m_size     = 0;
+    uint64_t       m_head     = 0; // virtual offset of the next allocation
+    uint64_t       m_tail     = 0; // virtual offset of the oldest data in use
+
+    VkSemaphore    m_timeline  = VK_NULL_HANDLE;
+    uint64_t       m_lastToken = 0;
+    VkCommandPool  m_pool      = VK_NULL_HANDLE;
+
+    std::deque<_InFlight>        m_inFlight;
+    std::vector<VkCommandBuffer> m_freeCommandBuffers;
+
+    std::vector<_BufferCopy>     m_bufferCopies;
+    std::vector<_ImageCopy>      m_imageCopies;
+    std::map<_SubresourceKey, VkImageLayout> m_imageLayouts; // the final layout of every subresource being uploaded
+
+    std::vector<VkBufferMemoryBarrier> m_bufferBarriers;
+    std::vector<VkImageMemoryBarrier>  m_imageBarriers;
+    std::vector<VkImageMemoryBarrier>  m_transitionBarriers;
+    std::vector<VkBufferMemoryBarrier> m_acquireBuffers;
+    std::vector<VkImageMemoryBarrier>  m_acquireImages;
+};
+
+}
+
+#endif
@@ -0,0 +1,436 @@
+#ifndef GVU_PIPELINE_BUILDER_H
+#define GVU_PIPELINE_BUILDER_H
+
+#include <vulkan/vulkan.h>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <mutex>
+#include <algorithm>
+#include "Hash.h"
+#include "ShaderReflection.h"
+#include "spirvPipelineReflector.h"
+#include "GraphicsPipelineCreateInfo.h"
+#include "Cache/ShaderModuleCache.h"
+#include "Cache/DescriptorSetLayoutCache.h"
+#include "Cache/PipelineLayoutCache.h"
+#include "Cache/GraphicsPipelineCache.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The ShaderStages struct
+ *
+ * The shader modules used by a graphics pipeline. The tessellation
+ * shaders can be left null.
+ */
+struct ShaderStages
+{
+    ShaderModuleCreateInfo const * vertex      = nullptr;
+    ShaderModuleCreateInfo const * tessControl = nullptr;
+    ShaderModuleCreateInfo const * tessEval    = nullptr;
+    ShaderModuleCreateInfo const * fragment    = nullptr;
+};
+
+/**
+ * @brief The BuiltPipeline struct
+ *
+ * Everything the PipelineBuilder resolved for a pipeline
+ */
+struct BuiltPipeline
+{
+    VkPipeline                         pipeline       = VK_NULL_HANDLE;
+    VkPipelineLayout                   pipelineLayout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSetLayout> setLayouts;      // indexed by set
+};
+
+/**
+ * @brief The PipelineBuilder_t class
+ *
+ * Builds a complete graphics pipeline from a set of shader modules with a
+ * single call. The shaders are reflected (once, through a
+ * ShaderReflectionCache) and the shader modules, descriptor set layouts,
+ * pipeline layout and pipeline are all resolved through the gvu caches.
+ *
+ * The whole chain is memoized: the layouts and vertex inputs by the hash
+ * of the shader set, and the pipeline by the hash of the shader set and
+ * the fixed function state. Building the same material again is a single
+ * hash lookup. Seal the state (see SealedHash) so that its hash is not
+ * recomputed on every call.
+ *
+ * gvu::PipelineBuilder builder;
+ * builder.init(&smCache, &slCache, &plCache, &gpCache);
+ *
+ * gvu::GraphicsPipelineCreateInfo state;
+ * state.renderPass = renderPass;
+ * state.seal();
+ *
+ * auto P = builder.build({&vert, nullptr, nullptr, &frag}, state);
+ * vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, P.pipeline);
+ *
+ * The shader modules, layouts and vertex inputs of the state are filled in
+ * by the builder. If the state already has vertex inputs, they are kept,
+ * otherwise each vertex shader input gets its own binding, with the
+ * binding index equal to its location.
+ *
+ * The caches are owned by the caller. The builder itself is only thread
+ * safe when concurrent is true. Its lock only guards the memoized
+ * results, the shader modules, layouts and pipelines are created outside
+ * of it, so several threads can compile pipelines at the same time.
+ *
+ * The caches may evict objects (see Cache_t::setBudget()). The first time
+ * a memoized pipeline is returned in a frame, its objects are touched so
+ * the caches know they are still in use, and anything which was evicted
+ * is created again.
+ */
+template<bool concurrent=false>
+class PipelineBuilder_t
+{
+public:
+    using shaderModuleCache_type     = Cache_t<ShaderModuleCreateInfo, concurrent>;
+    using setLayoutCache_type        = Cache_t<DescriptorSetLayoutCreateInfo, concurrent>;
+    using pipelineLayoutCache_type   = Cache_t<PipelineLayoutCreateInfo, concurrent>;
+    using graphicsPipelineCache_type = GraphicsPipelineCache_t<concurrent>;
+
+    /**
+     * @brief init
+     * @param smCache
+     * @param slCache
+     * @param plCache
+     * @param gpCache
+     * @param reflectionCache
+     *
+     * If reflectionCache is null, the builder uses its own. Pass one in if
+     * you want to save the reflections to disk.
+     */
+    void init(shaderModuleCache_type     * smCache,
+              setLayoutCache_type        * slCache,
+              pipelineLayoutCache_type   * plCache,
+              graphicsPipelineCache_type * gpCache,
+              ShaderReflectionCache      * reflectionCache = nullptr)
+    {
+        m_smCache         = smCache;
+        m_slCache         = slCache;
+        m_plCache         = plCache;
+        m_gpCache         = gpCache;
+        m_reflectionCache = reflectionCache ? reflectionCache : &m_ownReflections;
+    }
+
+    /**
+     * @brief build
+     * @param shaders
+     * @param state
+     * @return
+     *
+     * Returns the pipeline for the shaders and fixed function state,
+     * creating anything which has not been created yet. The result is
+     * returned by value so it stays valid when another thread builds a
+     * pipeline or calls clear().
+     */
+    BuiltPipeline build(ShaderStages const & shaders, GraphicsPipelineCreateInfo const & state)
+    {
+        auto key = _shaderKey(shaders);
+
+        size_t h = key.hash;
+        hashCombine(h, state.hash());
+
+        {
+            std::unique_lock<std::mutex> L(m_mutex, std::defer_lock);
+            if constexpr (concurrent)
+                L.lock();
+
+            ++m_lookups;
+            auto it = m_pipelines.find(h);
+            if(it != m_pipelines.end() && it->second.key == key && it->second.state == state && _isAlive(it->second))
+                return it->second.result;
+        }
+
+        // The layouts and the pipeline are created without holding the
+        // lock, the caches make sure each object is only created once
+        // when two threads build the same material.
+        auto layout = _getLayout(shaders, key);
+
+        GraphicsPipelineCreateInfo ci = state;
+        ci.vertexShader      = layout.modules[0];
+        ci.tessControlShader = layout.modules[1];
+        ci.tessEvalShader    = layout.modules[2];
+        ci.fragmentShader    = layout.modules[3];
+        ci.pipelineLayout    = layout.result.pipelineLayout;
+        if(ci.inputVertexAttributes.empty() && ci.inputBindings.empty())
+        {
+            ci.inputVertexAttributes = layout.attributes;
+            ci.inputBindings         = layout.bindings;
+        }
+
+        _PipelineEntry P;
+        P.result          = layout.result;
+        P.result.pipeline = m_gpCache->create(ci);
+        P.key             = key;
+        P.state           = state;
+        P.state.seal();
+        P.pipelineHash    = ci.hash();
+        P.layout          = layout.layoutHashes;
+        P.touchedFrame    = m_gpCache->frameIndex();
+
+        std::unique_lock<std::mutex> L(m_mutex, std::defer_lock);
+        if constexpr (concurrent)
+            L.lock();
+        m_pipelines[h] = P;
+        return P.result;
+    }
+
+    /**
+     * @brief buildLayout
+     * @param shaders
+     * @return
+     *
+     * Resolves only the set layouts and pipeline layout of the shaders,
+     * the pipeline member of the result is null.
+     */
+    BuiltPipeline buildLayout(ShaderStages const & shaders)
+    {
+        return _getLayout(shaders, _shaderKey(shaders)).result;
+    }
+
+    /**
+     * @brief clear
+     *
+     * Forgets all the memoized pipelines. The objects themselves are
+     * owned by the caches and are not destroyed.
+     */
+    void clear()
+    {
+        std::unique_lock<std::mutex> L(m_mutex, std::defer_lock);
+        if constexpr (concurrent)
+            L.lock();
+        m_pipelines.clear();
+        m_layouts.clear();
+    }
+
+    size_t pipelineCount() const
+    {
+        std::unique_lock<std::mutex> L(m_mutex, std::defer_lock);
+        if constexpr (concurrent)
+            L.lock();
+        return m_pipelines.size();
+    }
+
+    size_t layoutCount() const
+    {
+        std::unique_lock<std::mutex> L(m_mutex, std::defer_lock);
+        if constexpr (concurrent)
+            L.lock();
+        return m_layouts.size();
+    }
+
+    /**
+     * @brief lookupCount
+     * @return
+     *
+     * The number of calls to build()
+     */
+    size_t lookupCount() const
+    {
+        std::unique_lock<std::mutex> L(m_mutex, std::defer_lock);
+        if constexpr (concurrent)
+            L.lock();
+        return m_lookups;
+    }
+
+protected:
+    struct _ShaderKey
+    {
+        std::array<size_t, 4> stages = {};
+        size_t                hash   = 0;
+
+        bool operator==(_ShaderKey const & B) const
+        {
+            return stages == B.stages;
+        }
+    };
+
+    // the create info hashes of the objects, used to check that a
+    // handle still refers to the same object after an eviction
+    struct _LayoutHashes
+    {
+        size_t              pipelineLayout = 0;
+        std::vector<size_t> setLayouts;
+    };
+
+    struct _LayoutEntry
+    {
+        _ShaderKey                                      key;
+        std::array<VkShaderModule, 4>                   modules = {};
+        std::vector<VkVertexInputAttributeDescription>  attributes;
+        std::vector<VkVertexInputBindingDescription>    bindings;
+        BuiltPipeline                                   result;
+        _LayoutHashes                                   layoutHashes;
+        uint64_t                                        touchedFrame = 0;
+    };
+
+    struct _PipelineEntry
+    {
+        _ShaderKey                 key;
+        GraphicsPipelineCreateInfo state;
+        BuiltPipeline              result;
+        size_t                     pipelineHash = 0;
+        _LayoutHashes              layout;
+        uint64_t                   touchedFrame = 0;
+    };
+
+    template<typename cache_t, typename object_t>
+    static bool _isCached(cache_t * C, object_t obj, size_t hash)
+    {
+        // the handle may have been reused by a new object after an eviction
+        return C->touch(obj, hash);
+    }
+
+    bool _isAlive(BuiltPipeline const & R, _LayoutHashes const & H) const
+    {
+        if(!_isCached(m_plCache, R.pipelineLayout, H.pipelineLayout))
+            return false;
+        for(size_t i=0; i < R.setLayouts.size(); i++)
+        {
+            if(!_isCached(m_slCache, R.setLayouts[i], H.setLayouts[i]))
+                return false;
+        }
+        return true;
+    }
+
+    bool _isAlive(_PipelineEntry & P) const
+    {
+        auto frame = m_gpCache->frameIndex();
+        if(P.touchedFrame == frame)
+            return true;
+        if(!_isCached(m_gpCache, P.result.pipeline, P.pipelineHash) || !_isAlive(P.result, P.layout))
+            return false;
+        P.touchedFrame = frame;
+        return true;
+    }
+
+    bool _isAlive(_LayoutEntry & E) const
+    {
+        auto frame = m_plCache->frameIndex();
+        if(E.touchedFrame == frame)
+            return true;
+        if(!_isAlive(E.result, E.layoutHashes))
+            return false;
+        for(size_t i=0; i < E.modules.size(); i++)
+        {
+            if(E.modules[i] != VK_NULL_HANDLE && !_isCached(m_smCache, E.modules[i], E.key.stages[i]))
+                return false;
+        }
+        E.touchedFrame = frame;
+        return true;
+    }
+
+    static std::array<ShaderModuleCreateInfo const*, 4> _stages(ShaderStages const & S)
+    {
+        return {S.vertex, S.tessControl, S.tessEval, S.fragment};
+    }
+
+    static _ShaderKey _shaderKey(ShaderStages const & shaders)
+    {
+        _ShaderKey K;
+        auto stages = _stages(shaders);
+        for(size_t i=0; i < stages.size(); i++)
+        {
+            // the module hash is the content hash of the code
+            K.stages[i] = stages[i] ? stages[i]->hash() : 0;
+            hashCombine(K.hash, K.stages[i]);
+        }
+        return K;
+    }
+
+    _LayoutEntry _getLayout(ShaderStages const & shaders, _ShaderKey const & key)
+    {
+        {
+            std::unique_lock<std::mutex> L(m_mutex, std::defer_lock);
+            if constexpr (concurrent)
+                L.lock();
+
+            auto it = m_layouts.find(key.hash);
+            if(it != m_layouts.end() && it->second.key == key && _isAlive(it->second))
+                return it->second;
+        }
+
+        constexpr std::array<VkShaderStageFlagBits, 4> stageBits = {VK_SHADER_STAGE_VERTEX_BIT,
+                                                                   VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+                                                                   VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
+                                                                   VK_SHADER_STAGE_FRAGMENT_BIT};
+        _LayoutEntry E;
+        E.key = key;
+
+        spirvPipelineReflector reflector;
+        auto stages = _stages(shaders);
+        for(size_t i=0; i < stages.size(); i++)
+        {
+            if(!stages[i])
+                continue;
+            {
+                // the reflection cache is not thread safe
+                std::unique_lock<std::mutex> L(m_reflectionMutex, std::defer_lock);
+                if constexpr (concurrent)
+                    L.lock();
+                reflector.addReflection(m_reflectionCache->get(stages[i]->code), stageBits[i]);
+            }
+            E.modules[i] = m_smCache->create(*stages[i]);
+        }
+
+        // set layouts and push constant ranges are already sorted and
+        // merged, so identical layouts from different shaders hash the same
+        auto C = reflector.generateCombinedPipelineLayoutCreateInfo();
+
+        PipelineLayoutCreateInfo PLC;
+        PLC.flags              = C.flags;
+        PLC.pushConstantRanges = C.pushConstantRanges;
+        for(auto & D : C.setLayoutInfos)
+        {
+            PLC.setLayouts.push_back(m_slCache->create(D));
+            E.layoutHashes.setLayouts.push_back(D.hash());
+        }
+
+        E.result.setLayouts           = PLC.setLayouts;
+        E.result.pipelineLayout       = m_plCache->create(PLC);
+        E.layoutHashes.pipelineLayout = PLC.hash();
+        E.touchedFrame                = m_plCache->frameIndex();
+
+        auto inputs = reflector.vertex.inputAttributes;
+        std::sort(inputs.begin(), inputs.end(), [](auto & a, auto & b)
+        {
+            return a.location < b.location;
+        });
+        for(auto & a : inputs)
+        {
+            E.attributes.push_back({a.location, a.location, a.format, 0});
+            E.bindings.push_back({a.location, getFormatInfo(a.format).blockSizeInBits / 8, VK_VERTEX_INPUT_RATE_VERTEX});
+        }
+
+        std::unique_lock<std::mutex> L(m_mutex, std::defer_lock);
+        if constexpr (concurrent)
+            L.lock();
+        m_layouts[key.hash] = E;
+        return E;
+    }
+
+    shaderModuleCache_type     * m_smCache         = nullptr;
+    setLayoutCache_type        * m_slCache         = nullptr;
+    pipelineLayoutCache_type   * m_plCache         = nullptr;
+    graphicsPipelineCache_type * m_gpCache         = nullptr;
+    ShaderReflectionCache      * m_reflectionCache = &m_ownReflections;
+    ShaderReflectionCache        m_ownReflections;
+
+    std::unordered_map<size_t, _LayoutEntry>   m_layouts;
+    std::unordered_map<size_t, _PipelineEntry> m_pipelines;
+    size_t                                     m_lookups = 0;
+    mutable std::mutex                         m_mutex;           // guards the maps and m_lookups
+    std::mutex                                 m_reflectionMutex; // guards m_reflectionCache
+};
+
+using PipelineBuilder           = PipelineBuilder_t<false>;
+using ConcurrentPipelineBuilder = PipelineBuilder_t<true>;
+
+}
+
+#endif
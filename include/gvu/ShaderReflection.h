@@ -0,0 +1,648 @@
+#ifndef GVU_SHADER_REFLECTION_H
+#define GVU_SHADER_REFLECTION_H
+
+#include <spirv_cross/spirv_cross.hpp>
+#include <vulkan/vulkan.h>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "Hash.h"
+#include "Cache/ShaderModuleCache.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The ShaderReflection struct
+ *
+ * All the reflection data of a single SPIR-V module, computed in one pass
+ * with spirv-cross. The spirv_cross::Compiler only lives for the duration
+ * of reflect().
+ *
+ * The result only contains flat arrays of PODs and a pool of null
+ * terminated names, so it can be written to a binary blob with serialize()
+ * and read back with deserialize() without touching spirv-cross. The hash
+ * is the hash of the SPIR-V code, which is used as the key by the
+ * ShaderReflectionCache.
+ *
+ * auto R = gvu::ShaderReflection::reflect(code.data(), code.size());
+ *
+ * for(auto & b : R.bindings)
+ *     std::cout << R.getName(b.name) << " " << b.set << " " << b.binding << std::endl;
+ */
+struct ShaderReflection
+{
+    struct Binding
+    {
+        uint32_t         set;
+        uint32_t         binding;
+        uint32_t         descriptorCount; // 0 if unsized
+        VkDescriptorType descriptorType;
+        uint32_t         unsized;         // 1 if this is a runtime sized array
+        uint32_t         name;            // offset into names
+    };
+
+    struct Attribute
+    {
+        uint32_t location;
+        VkFormat format;
+        uint32_t name;                    // offset into names
+    };
+
+    struct PushConstantRange
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct SpecializationConstant
+    {
+        uint32_t constantID;              // layout(constant_id = N)
+        uint32_t size;                    // in bytes, bools are VkBool32
+        VkFormat format;                  // the scalar format, VK_FORMAT_UNDEFINED for bools
+        uint32_t boolean;                 // 1 if this is a bool
+        uint32_t defaultValue;            // the low 32 bits of the default value
+        uint32_t name;                    // offset into names
+    };
+
+    // the specialization constant id used when a value is not set by a specialization constant
+    static constexpr uint32_t noSpecId = ~0u;
+
+    uint64_t                             hash = 0;
+    VkShaderStageFlagBits                stage = VK_SHADER_STAGE_VERTEX_BIT; // from the execution model of the entry point
+
+    // Compute shaders only: the local workgroup size. If a dimension is
+    // set with a specialization constant (local_size_x_id = N), its
+    // constant_id is stored in workgroupSizeSpecIds and workgroupSize
+    // holds the default value of the constant.
+    std::array<uint32_t, 3>              workgroupSize        = {{0, 0, 0}};
+    std::array<uint32_t, 3>              workgroupSizeSpecIds = {{noSpecId, noSpecId, noSpecId}};
+
+    std::vector<Binding>                 bindings;
+    std::vector<Attribute>               inputs;
+    std::vector<Attribute>               outputs;
+    std::vector<PushConstantRange>       pushConstants;
+    std::vector<SpecializationConstant>  specializationConstants; // sorted by constantID
+    std::vector<char>                    names;
+
+    /**
+     * @brief getName
+     * @param offset
+     * @return
+     *
+     * Returns the name stored at the offset of the name pool
+     */
+    char const * getName(uint32_t offset) const
+    {
+        return names.data() + offset;
+    }
+
+    /**
+     * @brief hashCode
+     * @param code
+     * @param wordCount
+     * @return
+     *
+     * The content hash of the SPIR-V code
+     */
+    static uint64_t hashCode(uint32_t const * code, size_t wordCount)
+    {
+        return hashBytes(code, wordCount * sizeof(uint32_t));
+    }
+
+    /**
+     * @brief reflect
+     * @param code
+     * @param wordCount
+     * @return
+     *
+     * Reflects the SPIR-V code. The descriptors are ordered by type:
+     * uniform buffers, storage buffers, combined image samplers, storage
+     * images, samplers and then sampled images.
+     */
+    static ShaderReflection reflect(uint32_t const * code, size_t wordCount)
+    {
+        ShaderReflection R;
+        R.hash = hashCode(code, wordCount);
+
+        spirv_cross::Compiler comp(code, wordCount);
+        auto resources = comp.get_shader_resources();
+
+        R.stage = getStage(comp.get_execution_model());
+        if(R.stage == VK_SHADER_STAGE_COMPUTE_BIT)
+        {
+            spirv_cross::SpecializationConstant S[3] = {};
+            comp.get_work_group_size_specialization_constants(S[0], S[1], S[2]);
+            for(uint32_t i=0; i < 3; i++)
+            {
+                R.workgroupSize[i] = comp.get_execution_mode_argument(spv::ExecutionModeLocalSize, i);
+                if(uint32_t(S[i].id) != 0)
+                {
+                    R.workgroupSize[i]        = comp.get_constant(S[i].id).scalar();
+                    R.workgroupSizeSpecIds[i] = S[i].constant_id;
+                }
+            }
+        }
+
+        auto _handleDescriptorType = [&](spirv_cross::SmallVector<spirv_cross::Resource> const & desc, VkDescriptorType _type)
+        {
+            for (auto &u : desc)
+            {
+                auto & type = comp.get_type(u.type_id);
+                auto & B    = R.bindings.emplace_back();
+
+                B.set             = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
+                B.binding         = comp.get_decoration(u.id, spv::DecorationBinding);
+                B.descriptorCount = type.array.empty() ? 1u : type.array[0];
+                B.descriptorType  = _type;
+                // a literal size of 0 is a runtime sized array
+                B.unsized         = (!type.array.empty() && B.descriptorCount == 0 && type.array_size_literal[0]) ? 1u : 0u;
+                B.name            = R._addName(u.name);
+            }
+        };
+
+        _handleDescriptorType(resources.uniform_buffers,   VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER         );
+        _handleDescriptorType(resources.storage_buffers,   VK_DESCRIPTOR_TYPE_STORAGE_BUFFER         );
+        _handleDescriptorType(resources.sampled_images,    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER );
+        _handleDescriptorType(resources.storage_images,    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE          );
+        _handleDescriptorType(resources.separate_samplers, VK_DESCRIPTOR_TYPE_SAMPLER                );
+        _handleDescriptorType(resources.separate_images,   VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE          );
+
+        for(auto & P : resources.push_constant_buffers)
+        {
+            for(auto & range : comp.get_active_buffer_ranges(P.id))
+            {
+                R.pushConstants.push_back({static_cast<uint32_t>(range.offset), static_cast<uint32_t>(range.range)});
+            }
+        }
+
+        auto _handleAttributes = [&](spirv_cross::SmallVector<spirv_cross::Resource> const & res, std::vector<Attribute> & out)
+        {
+            for(auto & r : res)
+            {
+                auto & type = comp.get_type(r.type_id);
+                auto & A    = out.emplace_back();
+                A.location  = comp.get_decoration(r.id, spv::DecorationLocation);
+                A.format    = getFormat(type.basetype, type.vecsize);
+                A.name      = R._addName(r.name);
+            }
+        };
+        _handleAttributes(resources.stage_inputs,  R.inputs);
+        _handleAttributes(resources.stage_outputs, R.outputs);
+
+        for(auto & S : comp.get_specialization_constants())
+        {
+            auto & c    = comp.get_constant(S.id);
+            auto & type = comp.get_type(c.constant_type);
+            auto & C    = R.specializationConstants.emplace_back();
+            C.constantID   = S.constant_id;
+            C.boolean      = type.basetype == spirv_cross::SPIRType::Boolean ? 1u : 0u;
+            C.size         = C.boolean ? static_cast<uint32_t>(sizeof(VkBool32)) : std::max(1u, type.width / 8);
+            C.format       = getFormat(type.basetype, 1);
+            C.defaultValue = c.scalar();
+            C.name         = R._addName(comp.get_name(S.id));
+        }
+        std::sort(R.specializationConstants.begin(), R.specializationConstants.end(), [](auto & a, auto & b)
+        {
+            return a.constantID < b.constantID;
+        });
+
+        return R;
+    }
+
+    static ShaderReflection reflect(std::vector<uint32_t> const & code)
+    {
+        return reflect(code.data(), code.size());
+    }
+
+    /**
+     * @brief serialize
+     * @param out
+     *
+     * Appends the binary representation of the reflection to out. The
+     * data is only meant to be read back on the same platform.
+     */
+    void serialize(std::vector<uint8_t> & out) const
+    {
+        _Header H;
+        H.magic         = magic;
+        H.version       = version;
+        H.hash          = hash;
+        H.stage         = static_cast<uint32_t>(stage);
+        for(size_t i=0; i < 3; i++)
+        {
+            H.workgroupSize[i]        = workgroupSize[i];
+            H.workgroupSizeSpecIds[i] = workgroupSizeSpecIds[i];
+        }
+        H.bindings      = static_cast<uint32_t>(bindings.size());
+        H.inputs        = static_cast<uint32_t>(inputs.size());
+        H.outputs       = static_cast<uint32_t>(outputs.size());
+        H.pushConstants = static_cast<uint32_t>(pushConstants.size());
+        H.specializationConstants = static_cast<uint32_t>(specializationConstants.size());
+        H.names         = static_cast<uint32_t>(names.size());
+
+        auto start = out.size();
+        _write(out, &H, 1);
+        _write(out, bindings.data(),      bindings.size());
+        _write(out, inputs.data(),        inputs.size());
+        _write(out, outputs.data(),       outputs.size());
+        _write(out, pushConstants.data(), pushConstants.size());
+        _write(out, specializationConstants.data(), specializationConstants.size());
+        _write(out, names.data(),         names.size());
+
+        // the checksum covers everything after the header
+        auto payload = start + sizeof(H);
+        H.checksum = hashBytes(out.data() + payload, out.size() - payload);
+        std::memcpy(out.data() + start, &H, sizeof(H));
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> out;
+        serialize(out);
+        return out;
+    }
+
+    /**
+     * @brief deserialize
+     * @param data
+     * @param size
+     * @return the number of bytes read
+     *
+     * Reads a reflection written by serialize(). Throws std::runtime_error
+     * if the data is truncated, corrupt or was written by a different
+     * version. Nothing is allocated before the counts in the header have
+     * been checked against the size of the data.
+     */
+    size_t deserialize(uint8_t const * data, size_t size)
+    {
+        uint8_t const * p   = data;
+        uint8_t const * end = data + size;
+
+        _Header H;
+        _read(p, end, &H, 1);
+        if(H.magic != magic || H.version != version)
+            throw std::runtime_error("Invalid ShaderReflection data");
+
+        ShaderReflection R;
+        R.hash  = H.hash;
+        R.stage = static_cast<VkShaderStageFlagBits>(H.stage);
+        for(size_t i=0; i < 3; i++)
+        {
+            R.workgroupSize[i]        = H.workgroupSize[i];
+            R.workgroupSizeSpecIds[i] = H.workgroupSizeSpecIds[i];
+        }
+
+        auto payload = p;
+        _readVector(p, end, R.bindings,      H.bindings);
+        _readVector(p, end, R.inputs,        H.inputs);
+        _readVector(p, end, R.outputs,       H.outputs);
+        _readVector(p, end, R.pushConstants, H.pushConstants);
+        _readVector(p, end, R.specializationConstants, H.specializationConstants);
+        _readVector(p, end, R.names,         H.names);
+
+        if(hashBytes(payload, static_cast<size_t>(p - payload)) != H.checksum)
+            throw std::runtime_error("Corrupt ShaderReflection data");
+
+        // every name must start inside the pool, and the pool must end
+        // with a terminator so getName() never reads past it
+        if(!R.names.empty() && R.names.back() != '\0')
+            throw std::runtime_error("Corrupt ShaderReflection data");
+        auto _checkNames = [&](auto const & v)
+        {
+            for(auto & x : v)
+            {
+                if(x.name >= R.names.size())
+                    throw std::runtime_error("Corrupt ShaderReflection data");
+            }
+        };
+        _checkNames(R.bindings);
+        _checkNames(R.inputs);
+        _checkNames(R.outputs);
+        _checkNames(R.specializationConstants);
+
+        *this = std::move(R);
+        return static_cast<size_t>(p - data);
+    }
+
+    static VkShaderStageFlagBits getStage(spv::ExecutionModel model)
+    {
+        switch(model)
+        {
+            case spv::ExecutionModelVertex:                 return VK_SHADER_STAGE_VERTEX_BIT;
+            case spv::ExecutionModelTessellationControl:    return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+            case spv::ExecutionModelTessellationEvaluation: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+            case spv::ExecutionModelGeometry:               return VK_SHADER_STAGE_GEOMETRY_BIT;
+            case spv::ExecutionModelFragment:               return VK_SHADER_STAGE_FRAGMENT_BIT;
+            case spv::ExecutionModelGLCompute:              return VK_SHADER_STAGE_COMPUTE_BIT;
+            default:
+                break;
+        }
+        return VK_SHADER_STAGE_ALL;
+    }
+
+    static VkFormat getFormat(spirv_cross::SPIRType::BaseType baseType, uint32_t vecSize)
+    {
+        if(vecSize < 1 || vecSize > 4)
+            return VK_FORMAT_UNDEFINED;
+
+        switch(baseType)
+        {
+            case spirv_cross::SPIRType::SByte:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R8_SINT, VK_FORMAT_R8G8_SINT, VK_FORMAT_R8G8B8_SINT, VK_FORMAT_R8G8B8A8_SINT}})[vecSize-1];
+            case spirv_cross::SPIRType::UByte:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R8_UINT, VK_FORMAT_R8G8_UINT, VK_FORMAT_R8G8B8_UINT, VK_FORMAT_R8G8B8A8_UINT}})[vecSize-1];
+            case spirv_cross::SPIRType::Short:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R16_SINT, VK_FORMAT_R16G16_SINT, VK_FORMAT_R16G16B16_SINT, VK_FORMAT_R16G16B16A16_SINT}})[vecSize-1];
+            case spirv_cross::SPIRType::UShort:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R16_UINT, VK_FORMAT_R16G16_UINT, VK_FORMAT_R16G16B16_UINT, VK_FORMAT_R16G16B16A16_UINT}})[vecSize-1];
+            case spirv_cross::SPIRType::Int:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT}})[vecSize-1];
+            case spirv_cross::SPIRType::UInt:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT}})[vecSize-1];
+            case spirv_cross::SPIRType::Int64:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R64_SINT, VK_FORMAT_R64G64_SINT, VK_FORMAT_R64G64B64_SINT, VK_FORMAT_R64G64B64A64_SINT}})[vecSize-1];
+            case spirv_cross::SPIRType::UInt64:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R64_UINT, VK_FORMAT_R64G64_UINT, VK_FORMAT_R64G64B64_UINT, VK_FORMAT_R64G64B64A64_UINT}})[vecSize-1];
+            case spirv_cross::SPIRType::Half:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT}})[vecSize-1];
+            case spirv_cross::SPIRType::Float:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT}})[vecSize-1];
+            case spirv_cross::SPIRType::Double:
+                return std::array<VkFormat, 4>({{VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT}})[vecSize-1];
+            default:
+                break;
+        }
+        return VK_FORMAT_UNDEFINED;
+    }
+
+    static constexpr uint32_t magic   = 0x46525647; // "GVRF"
+    static constexpr uint32_t version = 4;
+
+protected:
+    struct _Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t hash;
+        uint32_t stage;
+        uint32_t workgroupSize[3];
+        uint32_t workgroupSizeSpecIds[3];
+        uint32_t bindings;
+        uint32_t inputs;
+        uint32_t outputs;
+        uint32_t pushConstants;
+        uint32_t specializationConstants;
+        uint32_t names;
+        uint32_t reserved = 0;
+        uint64_t checksum = 0;
+    };
+
+    uint32_t _addName(std::string const & name)
+    {
+        auto offset = static_cast<uint32_t>(names.size());
+        names.insert(names.end(), name.begin(), name.end());
+        names.push_back('\0');
+        return offset;
+    }
+
+    template<typename T>
+    static void _write(std::vector<uint8_t> & out, T const * data, size_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only PODs can be serialized");
+        auto bytes = sizeof(T) * count;
+        auto s     = out.size();
+        out.resize(s + bytes);
+        if(bytes)
+            std::memcpy(out.data() + s, data, bytes);
+    }
+
+    template<typename T>
+    static void _read(uint8_t const * & p, uint8_t const * end, T * data, size_t count)
+    {
+        auto bytes = sizeof(T) * count;
+        if(static_cast<size_t>(end - p) < bytes)
+            throw std::runtime_error("Truncated ShaderReflection data");
+        if(bytes)
+            std::memcpy(data, p, bytes);
+        p += bytes;
+    }
+
+    template<typename T>
+    static void _readVector(uint8_t const * & p, uint8_t const * end, std::vector<T> & v, uint32_t count)
+    {
+        // check the count before allocating so a corrupt header cannot
+        // request more memory than the data could possibly hold
+        if(static_cast<size_t>(end - p) / sizeof(T) < count)
+            throw std::runtime_error("Truncated ShaderReflection data");
+        v.resize(count);
+        _read(p, end, v.data(), v.size());
+    }
+};
+
+/**
+ * @brief The ShaderReflectionCache class
+ *
+ * Caches ShaderReflections keyed by the content hash of the SPIR-V code.
+ * The cache can be saved to and loaded from a file, so on a warm start
+ * none of the shaders need to be parsed by spirv-cross.
+ *
+ * gvu::ShaderReflectionCache cache;
+ * cache.load("reflection.bin");
+ *
+ * gvu::spirvPipelineReflector R;
+ * R.addSPIRVCode(vertCode, VK_SHADER_STAGE_VERTEX_BIT,   cache);
+ * R.addSPIRVCode(fragCode, VK_SHADER_STAGE_FRAGMENT_BIT, cache);
+ *
+ * cache.save("reflection.bin");
+ *
+ * The cache is not thread safe.
+ */
+class ShaderReflectionCache
+{
+public:
+    /**
+     * @brief get
+     * @param code
+     * @param wordCount
+     * @return
+     *
+     * Returns the reflection of the code, reflecting it with
+     * spirv-cross if it is not in the cache.
+     */
+    ShaderReflection const & get(uint32_t const * code, size_t wordCount)
+    {
+        auto h = ShaderReflection::hashCode(code, wordCount);
+        auto it = m_reflections.find(h);
+        if(it != m_reflections.end())
+            return it->second;
+
+        ++m_misses;
+        return m_reflections.emplace(h, ShaderReflection::reflect(code, wordCount)).first->second;
+    }
+
+    ShaderReflection const & get(std::vector<uint32_t> const & code)
+    {
+        return get(code.data(), code.size());
+    }
+
+    /**
+     * @brief insert
+     * @param R
+     *
+     * Insert a reflection, eg: one which was generated offline
+     */
+    void insert(ShaderReflection R)
+    {
+        auto h = R.hash;
+        m_reflections[h] = std::move(R);
+    }
+
+    bool contains(uint64_t hash) const
+    {
+        return m_reflections.count(hash) != 0;
+    }
+
+    size_t size() const
+    {
+        return m_reflections.size();
+    }
+
+    /**
+     * @brief misses
+     * @return
+     *
+     * The number of times spirv-cross had to be used
+     */
+    size_t misses() const
+    {
+        return m_misses;
+    }
+
+    void clear()
+    {
+        m_reflections.clear();
+    }
+
+    /**
+     * @brief serialize
+     * @return
+     *
+     * Returns all the reflections as a binary blob
+     */
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> out;
+        uint32_t count = static_cast<uint32_t>(m_reflections.size());
+        out.resize(sizeof(count));
+        std::memcpy(out.data(), &count, sizeof(count));
+        for(auto & [h, R] : m_reflections)
+            R.serialize(out);
+        return out;
+    }
+
+    /**
+     * @brief deserialize
+     * @param data
+     * @param size
+     * @return
+     *
+     * Adds all the reflections in a blob created with serialize(). Returns
+     * false, without adding anything, if the data is invalid.
+     */
+    bool deserialize(uint8_t const * data, size_t size)
+    {
+        uint32_t count = 0;
+        if(size < sizeof(count))
+            return false;
+        std::memcpy(&count, data, sizeof(count));
+
+        // the count is not trusted, so the reflections are only added
+        // once they have been read
+        std::vector<ShaderReflection> loaded;
+        size_t offset = sizeof(count);
+        try
+        {
+            for(uint32_t i=0; i < count; i++)
+            {
+                ShaderReflection R;
+                offset += R.deserialize(data + offset, size - offset);
+                loaded.push_back(std::move(R));
+            }
+        }
+        catch(std::exception &)
+        {
+            return false;
+        }
+        if(offset != size)
+            return false;
+        for(auto & R : loaded)
+            insert(std::move(R));
+        return true;
+    }
+
+    /**
+     * @brief load
+     * @param path
+     * @return
+     *
+     * Loads the reflections from a file written with save(). Returns false
+     * if the file does not exist or is invalid.
+     */
+    bool load(guv::fs::path const & path)
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if(!in)
+            return false;
+        auto size = in.tellg();
+        if(size <= 0)
+            return false;
+        std::vector<uint8_t> data(static_cast<size_t>(size));
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(data.data()), size);
+        if(!in)
+            return false;
+        return deserialize(data.data(), data.size());
+    }
+
+    /**
+     * @brief save
+     * @param path
+     * @return
+     *
+     * Writes all the reflections to a file. The data is written to a
+     * temporary file first and then renamed.
+     */
+    bool save(guv::fs::path const & path) const
+    {
+        auto data = serialize();
+
+        auto tmp = path;
+        tmp += ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if(!out)
+                return false;
+            out.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if(!out)
+                return false;
+        }
+        std::error_code ec;
+        guv::fs::rename(tmp, path, ec);
+        return !ec;
+    }
+
+protected:
+    std::unordered_map<uint64_t, ShaderReflection> m_reflections;
+    size_t                                         m_misses = 0;
+};
+
+}
+
+#endif
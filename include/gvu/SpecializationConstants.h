@@ -0,0 +1,252 @@
+#ifndef GVU_SPECIALIZATION_CONSTANTS_H
+#define GVU_SPECIALIZATION_CONSTANTS_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include "Hash.h"
+#include "StaticVector.h"
+
+namespace gvu
+{
+
+/**
+ * @brief The SpecializationConstants_t struct
+ *
+ * The specialization constant values of a single shader stage, stored
+ * so that they can be hashed and compared as part of a pipeline
+ * create info.
+ *
+ * The map entries are kept sorted by constantID and the data is packed
+ * in the same order, so the order in which the constants are set does
+ * not change the hash.
+ *
+ * // layout(constant_id = 0) const uint  GROUP_SIZE = 64;
+ * // layout(constant_id = 1) const bool  USE_FOG    = false;
+ * gvu::SpecializationConstants S;
+ * S.set(0, uint32_t(128));
+ * S.set(1, true); // bools are stored as VkBool32
+ *
+ * VkSpecializationInfo info = S.getVkSpecializationInfo(); // points into S
+ *
+ * Use SpecializationConstants or InlineSpecializationConstants instead
+ * of using this directly.
+ */
+template<typename storage_t>
+struct SpecializationConstants_t
+{
+    template<typename T, size_t N>
+    using vector_type = typename storage_t::template vector_type<T,N>;
+
+    // Maximums used by the InlineStorage containers.
+    static constexpr size_t maxConstants = 16;
+    static constexpr size_t maxDataSize  = maxConstants * sizeof(uint64_t);
+
+    vector_type<VkSpecializationMapEntry, maxConstants> entries;
+    vector_type<uint8_t, maxDataSize>                   data;
+
+    /**
+     * @brief set
+     * @param constantID
+     * @param value
+     *
+     * Sets the value of the specialization constant with the
+     * given constant_id. The value must be the same size as the
+     * constant in the shader, ie: 4 bytes for int/uint/float/bool
+     * and 8 bytes for 64-bit types.
+     *
+     * Throws std::length_error if an InlineSpecializationConstants
+     * is full, in which case nothing is changed.
+     */
+    template<typename T>
+    void set(uint32_t constantID, T const & value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Specialization constants must be trivially copyable");
+
+        auto it = _find(constantID);
+        bool const replace = it != entries.end() && it->constantID == constantID;
+        if(replace && it->size == sizeof(T))
+        {
+            std::memcpy(data.data() + it->offset, &value, sizeof(T));
+            return;
+        }
+
+        // make sure both containers can grow before anything is
+        // modified, so that running out of InlineStorage throws
+        // and leaves the constants unchanged. A replaced constant
+        // frees its own entry.
+        auto index    = static_cast<size_t>(it - entries.begin());
+        auto dataSize = data.size();
+        data.resize(dataSize + sizeof(T));
+        if(!replace)
+        {
+            try
+            {
+                entries.push_back({});
+            }
+            catch(...)
+            {
+                data.resize(dataSize);
+                throw;
+            }
+            entries.pop_back();
+        }
+        data.resize(dataSize);
+
+        if(replace)
+            _erase(index);
+
+        auto offset = index < entries.size() ? entries[index].offset : static_cast<uint32_t>(data.size());
+
+        // open a gap in the data for the value
+        data.resize(data.size() + sizeof(T));
+        std::rotate(data.begin() + offset, data.end() - sizeof(T), data.end());
+        std::memcpy(data.data() + offset, &value, sizeof(T));
+
+        for(size_t i=index; i < entries.size(); i++)
+            entries[i].offset += static_cast<uint32_t>(sizeof(T));
+
+        entries.push_back({constantID, offset, sizeof(T)});
+        std::rotate(entries.begin() + index, entries.end() - 1, entries.end());
+    }
+
+    void set(uint32_t constantID, bool value)
+    {
+        set<VkBool32>(constantID, value ? VK_TRUE : VK_FALSE);
+    }
+
+    /**
+     * @brief get
+     * @param constantID
+     * @param defaultValue
+     * @return
+     *
+     * Returns the value of the constant, or defaultValue if it
+     * has not been set or was set with a different size.
+     */
+    template<typename T>
+    T get(uint32_t constantID, T defaultValue = T{}) const
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Specialization constants must be trivially copyable");
+        auto it = _find(constantID);
+        if(it == entries.end() || it->constantID != constantID || it->size != sizeof(T))
+            return defaultValue;
+        T v;
+        std::memcpy(&v, data.data() + it->offset, sizeof(T));
+        return v;
+    }
+
+    bool contains(uint32_t constantID) const
+    {
+        auto it = _find(constantID);
+        return it != entries.end() && it->constantID == constantID;
+    }
+
+    /**
+     * @brief erase
+     * @param constantID
+     * @return
+     *
+     * Removes the constant so that the default value in the shader
+     * is used. Returns false if it was not set.
+     */
+    bool erase(uint32_t constantID)
+    {
+        auto it = _find(constantID);
+        if(it == entries.end() || it->constantID != constantID)
+            return false;
+        _erase(static_cast<size_t>(it - entries.begin()));
+        return true;
+    }
+
+    bool empty() const
+    {
+        return entries.empty();
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    void clear()
+    {
+        entries.clear();
+        data.clear();
+    }
+
+    /**
+     * @brief getVkSpecializationInfo
+     * @return
+     *
+     * Returns the vulkan struct, it points to the arrays of this
+     * object so it is only valid as long as this is not modified.
+     */
+    VkSpecializationInfo getVkSpecializationInfo() const
+    {
+        VkSpecializationInfo info = {};
+        info.mapEntryCount = static_cast<uint32_t>(entries.size());
+        info.pMapEntries   = entries.data();
+        info.dataSize      = data.size();
+        info.pData         = data.data();
+        return info;
+    }
+
+    size_t hash() const
+    {
+        size_t h = 0;
+        hashCombineRange(h, entries);
+        hashCombineRange(h, data);
+        return h;
+    }
+
+    bool operator==(SpecializationConstants_t const & B) const
+    {
+        return rangeEqual(entries, B.entries)
+            && rangeEqual(data, B.data);
+    }
+    bool operator!=(SpecializationConstants_t const & B) const
+    {
+        return !(*this == B);
+    }
+
+protected:
+    auto _find(uint32_t constantID) const
+    {
+        return std::lower_bound(entries.begin(), entries.end(), constantID, [](VkSpecializationMapEntry const & e, uint32_t id)
+        {
+            return e.constantID < id;
+        });
+    }
+    auto _find(uint32_t constantID)
+    {
+        return std::lower_bound(entries.begin(), entries.end(), constantID, [](VkSpecializationMapEntry const & e, uint32_t id)
+        {
+            return e.constantID < id;
+        });
+    }
+
+    void _erase(size_t index)
+    {
+        auto offset = entries[index].offset;
+        auto size   = entries[index].size;
+
+        std::rotate(data.begin() + offset, data.begin() + offset + size, data.end());
+        data.resize(data.size() - size);
+
+        std::rotate(entries.begin() + index, entries.begin() + index + 1, entries.end());
+        entries.pop_back();
+
+        for(size_t i=index; i < entries.size(); i++)
+            entries[i].offset -= static_cast<uint32_t>(size);
+    }
+};
+
+using SpecializationConstants       = SpecializationConstants_t<DynamicStorage>;
+using InlineSpecializationConstants = SpecializationConstants_t<InlineStorage>;
+
+}
+
+#endif
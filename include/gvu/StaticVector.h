@@ -0,0 +1,137 @@
+#ifndef GVU_STATIC_VECTOR_H
+#define GVU_STATIC_VECTOR_H
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <initializer_list>
+#include <algorithm>
+#include <vector>
+
+namespace gvu
+{
+
+/**
+ * @brief The StaticVector class
+ *
+ * A vector with a fixed capacity which stores its elements inline. It
+ * never allocates memory, pushing more than Capacity elements throws
+ * std::length_error.
+ *
+ * This is meant for small arrays of POD vulkan structs, all Capacity
+ * elements are default constructed.
+ *
+ * gvu::StaticVector<VkDynamicState, 8> states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+ */
+template<typename T, size_t Capacity>
+class StaticVector
+{
+    public:
+        using value_type     = T;
+        using size_type      = size_t;
+        using iterator       = T*;
+        using const_iterator = T const*;
+
+        StaticVector() = default;
+        StaticVector(std::initializer_list<T> l)
+        {
+            assign(l.begin(), l.end());
+        }
+
+        template<typename iterator_t>
+        void assign(iterator_t first, iterator_t last)
+        {
+            clear();
+            for(; first != last; ++first)
+                push_back(*first);
+        }
+
+        void push_back(T const & v)
+        {
+            _checkCapacity(m_size+1);
+            m_data[m_size++] = v;
+        }
+
+        template<typename... Args>
+        T & emplace_back(Args&&... args)
+        {
+            _checkCapacity(m_size+1);
+            m_data[m_size] = T{std::forward<Args>(args)...};
+            return m_data[m_size++];
+        }
+
+        void pop_back()
+        {
+            --m_size;
+        }
+
+        void resize(size_t s, T const & v = T{})
+        {
+            _checkCapacity(s);
+            for(size_t i=m_size;i<s;i++)
+                m_data[i] = v;
+            m_size = s;
+        }
+
+        void clear()
+        {
+            m_size = 0;
+        }
+
+        T       * data()       { return m_data.data(); }
+        T const * data() const { return m_data.data(); }
+
+        size_t size()  const   { return m_size; }
+        bool   empty() const   { return m_size == 0; }
+        static constexpr size_t capacity() { return Capacity; }
+
+        T       & operator[](size_t i)       { return m_data[i]; }
+        T const & operator[](size_t i) const { return m_data[i]; }
+
+        T       & back()       { return m_data[m_size-1]; }
+        T const & back() const { return m_data[m_size-1]; }
+
+        iterator       begin()       { return data(); }
+        iterator       end()         { return data() + m_size; }
+        const_iterator begin() const { return data(); }
+        const_iterator end()   const { return data() + m_size; }
+
+    private:
+        static void _checkCapacity(size_t s)
+        {
+            if(s > Capacity)
+                throw std::length_error("StaticVector capacity exceeded");
+        }
+
+        std::array<T, Capacity> m_data = {};
+        size_t                  m_size = 0;
+};
+
+/**
+ * @brief The DynamicStorage struct
+ *
+ * Stores the arrays of a CreateInfo in std::vectors
+ */
+struct DynamicStorage
+{
+    template<typename T, size_t N>
+    using vector_type = std::vector<T>;
+};
+
+/**
+ * @brief The InlineStorage struct
+ *
+ * Stores the arrays of a CreateInfo inline using a StaticVector. The
+ * CreateInfo can be copied, hashed, compared and used to generate
+ * the vulkan struct without allocating any memory, but each array
+ * has a maximum size.
+ */
+struct InlineStorage
+{
+    template<typename T, size_t N>
+    using vector_type = StaticVector<T,N>;
+};
+
+}
+
+#endif
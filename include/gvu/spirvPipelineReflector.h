@@ -4,11 +4,17 @@
 #include <spirv_cross/spirv_cross.hpp>
 #include <vulkan/vulkan.h>
 #include <map>
+#include <set>
+#include <array>
 #include <vector>
 #include <cstdint>
 #include <iostream>
+#include <sstream>
+#include <cctype>
 #include "Cache/DescriptorSetLayoutCache.h"
 #include "Cache/PipelineLayoutCache.h"
+#include "Cache/DescriptorUpdateTemplateCache.h"
+#include "ShaderReflection.h"
 
 namespace gvu
 {
@@ -25,10 +31,12 @@ struct CombinedPipelineLayoutCreateInfo
      * @param slCache
      * @return
      *
-     * Create the pipeline layout by passing the pipelinelayout and descriptorsetlayout caches
+     * Create the pipeline layout by passing the pipelinelayout and descriptorsetlayout caches.
+     * Either the regular or the Concurrent versions of the caches can be used.
      *
      */
-    VkPipelineLayout create(PipelineLayoutCache & plCache, DescriptorSetLayoutCache & slCache)
+    template<typename pipelineLayoutCache_t, typename setLayoutCache_t>
+    VkPipelineLayout create(pipelineLayoutCache_t & plCache, setLayoutCache_t & slCache)
     {
         PipelineLayoutCreateInfo PLC;
 
@@ -42,6 +50,29 @@ struct CombinedPipelineLayoutCreateInfo
         return plCache.create(PLC);
     }
 
+    /**
+     * @brief createUpdateTemplates
+     * @param slCache
+     * @param tCache
+     * @return
+     *
+     * Create a VkDescriptorUpdateTemplate for each of the set layouts. The
+     * data passed to vkUpdateDescriptorSetWithTemplate must be laid out as
+     * described in DescriptorUpdateTemplateCreateInfo, a matching struct can
+     * be generated with spirvPipelineReflector::generateDescriptorStructDeclaration()
+     */
+    template<typename setLayoutCache_t, typename templateCache_t>
+    std::vector<VkDescriptorUpdateTemplate> createUpdateTemplates(setLayoutCache_t & slCache, templateCache_t & tCache) const
+    {
+        std::vector<VkDescriptorUpdateTemplate> templates;
+        for(auto & D : setLayoutInfos)
+        {
+            DescriptorUpdateTemplateCreateInfo T(D, slCache.create(D));
+            templates.push_back(tCache.create(T));
+        }
+        return templates;
+    }
+
     /**
      * @brief _fixRanges
      *
@@ -103,6 +134,16 @@ struct spirvPipelineReflector
         std::string name;
     };
 
+    struct SpecializationConstantInfo
+    {
+        uint32_t    constantID;
+        std::string name;
+        uint32_t    size;         // in bytes, bools are VkBool32
+        VkFormat    format;       // VK_FORMAT_UNDEFINED for bools
+        bool        boolean;
+        uint32_t    defaultValue; // the low 32 bits of the default value
+    };
+
     struct ShaderStageInfo
     {
         std::vector< AttributeInfo > inputAttributes;
@@ -110,6 +151,7 @@ struct spirvPipelineReflector
         std::vector< DescriptorInfo > uniformBuffers;
         std::vector< DescriptorInfo > storageBuffers;
         std::vector< DescriptorInfo > imageSamplers;
+        std::vector< SpecializationConstantInfo > specializationConstants;
     };
 
     ShaderStageInfo vertex;
@@ -117,6 +159,23 @@ struct spirvPipelineReflector
     ShaderStageInfo tessEval;
     ShaderStageInfo geometry;
     ShaderStageInfo fragment;
+    ShaderStageInfo compute;
+
+    /**
+     * The local workgroup size of the compute shader. If a dimension
+     * is set by a specialization constant, its constant_id is in
+     * workgroupSizeSpecIds (otherwise ShaderReflection::noSpecId) and
+     * workgroupSize holds the default value of the constant.
+     */
+    std::array<uint32_t, 3> workgroupSize        = {{0, 0, 0}};
+    std::array<uint32_t, 3> workgroupSizeSpecIds = {{ShaderReflection::noSpecId, ShaderReflection::noSpecId, ShaderReflection::noSpecId}};
+
+    /**
+     * The descriptor count used for runtime sized arrays, these
+     * bindings are given the PARTIALLY_BOUND and UPDATE_AFTER_BIND
+     * flags. Set this before calling addSPIRVCode().
+     */
+    uint32_t unsizedArrayCount = 4096;
 
     /**
      * @brief generateDescriptorSetCreateInfos
@@ -131,12 +190,37 @@ struct spirvPipelineReflector
         CombinedPipelineLayoutCreateInfo M;
         for(auto & [set, bindingMap] : setBindings)
         {
+            // sets which are not used by any shader get an empty layout
+            // so that the index of each layout matches its set number
+            while(M.setLayoutInfos.size() < set)
+                M.setLayoutInfos.emplace_back();
+
             auto & BBs = M.setLayoutInfos.emplace_back();
 
             for(auto & [b, binding] : bindingMap)
             {
                 BBs.bindings.push_back(binding);
             }
+
+            // runtime sized arrays (eg: texture2D images[]) are bindless
+            // bindings, they are partially bound and can be updated after
+            // binding. Only the last binding of a set may be variable sized.
+            auto u = m_unsizedBindings.find(set);
+            if(u != m_unsizedBindings.end())
+            {
+                BBs.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+                BBs.bindingFlags.assign(BBs.bindings.size(), 0);
+                for(size_t i=0; i < BBs.bindings.size(); i++)
+                {
+                    if(u->second.count(BBs.bindings[i].binding))
+                    {
+                        BBs.bindingFlags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                              VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+                        if(i+1 == BBs.bindings.size())
+                            BBs.bindingFlags[i] |= VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
+                    }
+                }
+            }
         }
         M.pushConstantRanges = m_pushRangeV;
         M._fixRanges();
@@ -145,12 +229,46 @@ struct spirvPipelineReflector
 
 
 
-    void addSPIRVCode( std::vector<uint32_t> spvCode, VkShaderStageFlagBits stage)
+    /**
+     * @brief addSPIRVCode
+     * @param spvCode
+     * @param stage
+     *
+     * Reflect the SPIR-V code and add it to the pipeline.
+     */
+    void addSPIRVCode( std::vector<uint32_t> const & spvCode, VkShaderStageFlagBits stage)
     {
-        spirv_cross::Compiler comp(move(spvCode));
+        addReflection(ShaderReflection::reflect(spvCode), stage);
+    }
 
-        spirv_cross::ShaderResources resources = comp.get_shader_resources();
+    void addSPIRVCode( uint32_t const * spvCode, size_t wordCount, VkShaderStageFlagBits stage)
+    {
+        addReflection(ShaderReflection::reflect(spvCode, wordCount), stage);
+    }
 
+    /**
+     * @brief addSPIRVCode
+     * @param spvCode
+     * @param stage
+     * @param cache
+     *
+     * Add the SPIR-V code using the reflection stored in the cache. The code
+     * is only parsed by spirv-cross if it is not in the cache yet.
+     */
+    void addSPIRVCode( std::vector<uint32_t> const & spvCode, VkShaderStageFlagBits stage, ShaderReflectionCache & cache)
+    {
+        addReflection(cache.get(spvCode), stage);
+    }
+
+    /**
+     * @brief addReflection
+     * @param R
+     * @param stage
+     *
+     * Add the reflection of a shader stage to the pipeline.
+     */
+    void addReflection( ShaderReflection const & R, VkShaderStageFlagBits stage)
+    {
         ShaderStageInfo * pStage = nullptr;
         if(stage == VK_SHADER_STAGE_VERTEX_BIT)
         {
@@ -172,532 +290,179 @@ struct spirvPipelineReflector
         {
             pStage = &tessEval;
         }
-        auto _handleDescriptorType = [&](spirv_cross::SmallVector<spirv_cross::Resource> & desc, VkDescriptorType _type)
-        {
-            for (auto &u : desc)
-            {
-                uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
-                uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
-                auto arraySize   = comp.get_type(u.type_id).array[0];
-
-                auto & bind          = setBindings[set][binding];
-                bind.binding         = binding;
-                bind.descriptorCount = std::max(1u, arraySize);
-                bind.descriptorType  = _type;
-                bind.stageFlags     |= static_cast<VkShaderStageFlags>(stage);
-
-                if(pStage)
-                {
-                    if( _type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
-                    {
-                        auto &ub = pStage->uniformBuffers.emplace_back();
-                        ub.name = u.name;
-                        ub.set = set;
-                        ub.arraySize = arraySize;
-                        ub.binding = binding;
-                    }
-                    if( _type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
-                    {
-                        auto &ub = pStage->storageBuffers.emplace_back();
-                        ub.name = u.name;
-                        ub.set = set;
-                        ub.arraySize = arraySize;
-                        ub.binding = binding;
-                    }
-                    if( _type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
-                    {
-                        auto &ub = pStage->imageSamplers.emplace_back();
-                        ub.name = u.name;
-                        ub.set = set;
-                        ub.arraySize = arraySize;
-                        ub.binding = binding;
-                    }
-                }
-            }
-        };
-
-        _handleDescriptorType(resources.uniform_buffers,   VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER         );//vk::DescriptorType::eUniformBuffer);
-        _handleDescriptorType(resources.storage_buffers,   VK_DESCRIPTOR_TYPE_STORAGE_BUFFER         );//vk::DescriptorType::eStorageBuffer);
-        _handleDescriptorType(resources.sampled_images,    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER );//vk::DescriptorType::eCombinedImageSampler);
-
-        _handleDescriptorType(resources.storage_images,    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE          );//vk::DescriptorType::eSampledImage);
-
-        _handleDescriptorType(resources.separate_samplers, VK_DESCRIPTOR_TYPE_SAMPLER                );//vk::DescriptorType::eSampler);
-        _handleDescriptorType(resources.separate_images,   VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE          );//vk::DescriptorType::eSampledImage);
-
-
-        uint32_t id = resources.push_constant_buffers[0].id;
-        auto ranges = comp.get_active_buffer_ranges(id);
-
-
-        for (auto &range : ranges)
+        if(stage == VK_SHADER_STAGE_COMPUTE_BIT)
         {
-            auto & R = m_pushRangeV.emplace_back();
-            R.size       = static_cast<uint32_t>(range.range);
-            R.offset     = static_cast<uint32_t>(range.offset);
-            R.stageFlags = stage;
-         //   std::cout << fmt::format("Accessing member #{}, offset {}, size {}\n", range.index, range.offset, range.range);
+            pStage = &compute;
+            workgroupSize        = R.workgroupSize;
+            workgroupSizeSpecIds = R.workgroupSizeSpecIds;
         }
 
-        //========
-        auto xx = [&](ShaderStageInfo & s)
+        for(auto & u : R.bindings)
         {
-            for(auto & res : resources.stage_inputs)
+            uint32_t arraySize = u.descriptorCount;
+            if(u.unsized)
             {
-                uint32_t location = comp.get_decoration(res.id, spv::DecorationLocation);
-                const auto &base_type = comp.get_type(res.base_type_id);
-                const auto &type      = comp.get_type(res.type_id);
-
-                AttributeInfo info;
-                info.name = res.name;
-                info.location = location;
-                info.format = _getFormat(type.basetype, type.vecsize );
-
-                (void) base_type;
-
-                s.inputAttributes.push_back(info);
+                m_unsizedBindings[u.set].insert(u.binding);
+                arraySize = unsizedArrayCount;
             }
-            for(auto & res : resources.stage_outputs)
-            {
-                uint32_t location = comp.get_decoration(res.id, spv::DecorationLocation);
-                const auto &base_type = comp.get_type(res.base_type_id);
-                const auto &type      = comp.get_type(res.type_id);
 
-                AttributeInfo info;
-                info.name = res.name;
-                info.location = location;
-                info.format = _getFormat(type.basetype, type.vecsize );
+            auto & bind          = setBindings[u.set][u.binding];
+            bind.binding         = u.binding;
+            bind.descriptorCount = std::max(1u, arraySize);
+            bind.descriptorType  = u.descriptorType;
+            bind.stageFlags     |= static_cast<VkShaderStageFlags>(stage);
 
-                (void) base_type;
+            auto & name = m_bindingNames[u.set][u.binding];
+            if(name.empty())
+                name = R.getName(u.name);
 
-                s.outputAttributes.push_back(info);
+            if(pStage)
+            {
+                std::vector<DescriptorInfo> * infos = nullptr;
+                if( u.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+                    infos = &pStage->uniformBuffers;
+                if( u.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+                    infos = &pStage->storageBuffers;
+                if( u.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+                    infos = &pStage->imageSamplers;
+
+                if(infos)
+                {
+                    auto &ub = infos->emplace_back();
+                    ub.name = R.getName(u.name);
+                    ub.set = u.set;
+                    ub.arraySize = arraySize;
+                    ub.binding = u.binding;
+                }
             }
-        };
-
-        if(pStage)
-        {
-            xx(*pStage);
         }
 
-        //========
-    }
-
-    static VkFormat _getFormat(spirv_cross::SPIRType::BaseType baseType, uint32_t vecSize)
-    {
-        switch(baseType)
+        for (auto &range : R.pushConstants)
         {
-            case spirv_cross::SPIRType::Unknown:
-                break;
-            case spirv_cross::SPIRType::Void:
-                break;
-            case spirv_cross::SPIRType::Boolean:
-                break;
-            case spirv_cross::SPIRType::SByte:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R8_SINT, VK_FORMAT_R8G8_SINT, VK_FORMAT_R8G8B8_SINT, VK_FORMAT_R8G8B8A8_SINT}})[vecSize-1];
-            case spirv_cross::SPIRType::UByte:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R8_UINT, VK_FORMAT_R8G8_UINT, VK_FORMAT_R8G8B8_UINT, VK_FORMAT_R8G8B8A8_UINT}})[vecSize-1];
-            case spirv_cross::SPIRType::Short:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R16_SINT, VK_FORMAT_R16G16_SINT, VK_FORMAT_R16G16B16_SINT, VK_FORMAT_R16G16B16A16_SINT}})[vecSize-1];
-            case spirv_cross::SPIRType::UShort:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R16_UINT, VK_FORMAT_R16G16_UINT, VK_FORMAT_R16G16B16_UINT, VK_FORMAT_R16G16B16A16_UINT}})[vecSize-1];
-            case spirv_cross::SPIRType::Int:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT}})[vecSize-1];
-            case spirv_cross::SPIRType::UInt:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT}})[vecSize-1];
-            case spirv_cross::SPIRType::Int64:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R64_SINT, VK_FORMAT_R64G64_SINT, VK_FORMAT_R64G64B64_SINT, VK_FORMAT_R64G64B64A64_SINT}})[vecSize-1];
-            case spirv_cross::SPIRType::UInt64:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R64_UINT, VK_FORMAT_R64G64_UINT, VK_FORMAT_R64G64B64_UINT, VK_FORMAT_R64G64B64A64_UINT}})[vecSize-1];
-            case spirv_cross::SPIRType::AtomicCounter:
-                break;
-            case spirv_cross::SPIRType::Half:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT}})[vecSize-1];
-            case spirv_cross::SPIRType::Float:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT}})[vecSize-1];
-            case spirv_cross::SPIRType::Double:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT}})[vecSize-1];
-            case spirv_cross::SPIRType::Struct:
-                break;
-            case spirv_cross::SPIRType::Image:
-                break;
-            case spirv_cross::SPIRType::SampledImage:
-                break;
-            case spirv_cross::SPIRType::Sampler:
-                break;
-            case spirv_cross::SPIRType::AccelerationStructure:
-                break;
-            case spirv_cross::SPIRType::RayQuery:
-                break;
-            case spirv_cross::SPIRType::ControlPointArray:
-                break;
-            case spirv_cross::SPIRType::Interpolant:
-                break;
-            case spirv_cross::SPIRType::Char:
-                break;
-
+            auto & P = m_pushRangeV.emplace_back();
+            P.size       = range.size;
+            P.offset     = range.offset;
+            P.stageFlags = stage;
         }
-        return VK_FORMAT_UNDEFINED;
-    }
-
-protected:
-    std::map< uint32_t , std::map<uint32_t, VkDescriptorSetLayoutBinding> > setBindings;
-    std::vector<VkPushConstantRange> m_pushRangeV;
-};
-
-#if 0
-struct SPIRV_PipelineReflector
-{
-    struct
-    {
-        std::shared_ptr<spirv_cross::Compiler> comp;
-        spirv_cross::ShaderResources res;
-        VkShaderStageFlagBits stage;
-    } vertex, tessControl, tessEval, geometry, fragment;
 
-    SPIRV_PipelineReflector()
-    {
-        vertex.stage      = VK_SHADER_STAGE_VERTEX_BIT;
-        tessControl.stage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
-        tessEval.stage    = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
-        geometry.stage    = VK_SHADER_STAGE_GEOMETRY_BIT;
-        fragment.stage    = VK_SHADER_STAGE_FRAGMENT_BIT;
-    }
-    static std::shared_ptr<spirv_cross::Compiler> _makeCompiler(std::vector<uint32_t> const & spvCode)
-    {
-        return std::make_shared<spirv_cross::Compiler>(spvCode.data(), spvCode.size());
-    }
-    /**
-     * @brief addSPIRVCode
-     * @param spvCode
-     * @param stage
-     *
-     * Your first step:
-     *    Add spirv code to the reflector.
-     *
-     * Some functions require all shader stages to be added,
-     * such as determining descriptor layouts
-     *
-     */
-    void addSPIRVCode( std::vector<uint32_t> const & spvCode, VkShaderStageFlagBits stage)
-    {
-        switch(stage)
+        if(pStage)
         {
-        case VK_SHADER_STAGE_VERTEX_BIT:
-            vertex.comp = _makeCompiler(spvCode);
-            vertex.res  = vertex.comp->get_shader_resources();
-            break;
-        case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
-            tessControl.comp = _makeCompiler(spvCode);
-            tessControl.res  = tessControl.comp->get_shader_resources();
-            break;
-        case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
-            tessEval.comp = _makeCompiler(spvCode);
-            tessEval.res  = tessEval.comp->get_shader_resources();
-            break;
-        case VK_SHADER_STAGE_GEOMETRY_BIT:
-            geometry.comp = _makeCompiler(spvCode);
-            geometry.res  = geometry.comp->get_shader_resources();
-            break;
-        case VK_SHADER_STAGE_FRAGMENT_BIT:
-            fragment.comp = _makeCompiler(spvCode);
-            fragment.res  = fragment.comp->get_shader_resources();
-            break;
-        case VK_SHADER_STAGE_COMPUTE_BIT:
-            break;
-        case VK_SHADER_STAGE_ALL_GRAPHICS:
-            break;
-        case VK_SHADER_STAGE_ALL:
-            break;
-        //case VK_SHADER_STAGE_RAYGEN_BIT_KHR:
-        //    break;
-        //case VK_SHADER_STAGE_ANY_HIT_BIT_KHR:
-        //    break;
-        //case VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR:
-        //    break;
-        //case VK_SHADER_STAGE_MISS_BIT_KHR:
-        //    break;
-        //case VK_SHADER_STAGE_INTERSECTION_BIT_KHR:
-        //    break;
-        //case VK_SHADER_STAGE_CALLABLE_BIT_KHR:
-        //    break;
-        case VK_SHADER_STAGE_TASK_BIT_NV:
-            break;
-        case VK_SHADER_STAGE_MESH_BIT_NV:
-            break;
-        default:
-            break;
-        //case VK_SHADER_STAGE_RAYGEN_BIT_NV:
-        //    break;
-        //case VK_SHADER_STAGE_ANY_HIT_BIT_NV:
-        //    break;
-        //case VK_SHADER_STAGE_CLOSEST_HIT_BIT_NV:
-        //    break;
-        //case VK_SHADER_STAGE_MISS_BIT_NV:
-        //    break;
-        //case VK_SHADER_STAGE_INTERSECTION_BIT_NV:
-        //    break;
-        //case VK_SHADER_STAGE_CALLABLE_BIT_NV:
-        //    break;
-        //case VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM:
-        //    break;
-
+            for(auto & a : R.inputs)
+                pStage->inputAttributes.push_back({a.location, R.getName(a.name), a.format});
+            for(auto & a : R.outputs)
+                pStage->outputAttributes.push_back({a.location, R.getName(a.name), a.format});
+            for(auto & c : R.specializationConstants)
+                pStage->specializationConstants.push_back({c.constantID, R.getName(c.name), c.size, c.format, c.boolean != 0, c.defaultValue});
         }
     }
 
-
     /**
-     * @brief generateBlendStateAttachments
+     * @brief getSpecializationConstantID
+     * @param name
      * @return
      *
-     * Returns a vector of the color blend attachment state.
-     *
-     * The fragment resources must have been created first.
+     * Returns the constant_id of the named specialization constant in
+     * any of the stages, or ShaderReflection::noSpecId if there is none.
+     * Use it to set the constants by name:
      *
-     * This will read the fragment shader's output
-     * and generate default values for each
+     * gci.fragmentSpecialization.set(R.getSpecializationConstantID("USE_FOG"), true);
      */
-    std::vector< VkPipelineColorBlendAttachmentState > generateBlendStateAttachments() const
+    uint32_t getSpecializationConstantID(std::string const & name) const
     {
-        std::vector< VkPipelineColorBlendAttachmentState > attachments;
-        for(auto & res : fragment.res.stage_outputs)
+        for(auto * S : {&vertex, &tessControl, &tessEval, &geometry, &fragment, &compute})
         {
-            (void)res;
-            auto & _blendstate = attachments.emplace_back();
-
-            _blendstate.colorWriteMask      = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-            _blendstate.colorBlendOp        = VK_BLEND_OP_ADD;// vk::BlendOp::eAdd;
-            _blendstate.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;//vk::BlendFactor::eSrcAlpha;
-            _blendstate.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA; //vk::BlendFactor::eSrcAlpha;
-            _blendstate.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA; //vk::BlendFactor::eOneMinusDstAlpha;
-            _blendstate.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA; //vk::BlendFactor::eOneMinusDstAlpha;
+            for(auto & c : S->specializationConstants)
+            {
+                if(c.name == name)
+                    return c.constantID;
+            }
         }
-        return attachments;
+        return ShaderReflection::noSpecId;
     }
 
     /**
-     * @brief generatePushConstantRange
+     * @brief generateDescriptorStructDeclaration
+     * @param set
+     * @param structName
      * @return
      *
-     * Returns a push consts range vector for this pipeline
+     * Returns the C++ declaration of a struct which matches the data layout
+     * of the DescriptorUpdateTemplateCreateInfo generated for this set. Each
+     * binding becomes a member named after the shader variable, eg:
+     *
+     * struct Set0
+     * {
+     *     VkDescriptorBufferInfo camera;      // binding 0, offset 0
+     *     VkDescriptorImageInfo  textures[3]; // binding 1, offset 24
+     * };
+     *
+     * An instance of the struct can be passed directly to vkUpdateDescriptorSetWithTemplate.
      */
-    std::vector<VkPushConstantRange> generatePushConstantRange() const
+    std::string generateDescriptorStructDeclaration(uint32_t set, std::string const & structName) const
     {
-        std::vector<VkPushConstantRange> pushRangeV;
-
-        // stores the offset and size of each variable in the push consts
-        std::map< VkShaderStageFlagBits, std::vector<VkPushConstantRange> > rangePerStage;
+        std::ostringstream out;
+        out << "struct " << structName << "\n{\n";
 
-        // loop through each stage and
-        // add the variable's offset and size to the vector for that stage.
-        for(auto * stage : { &vertex, &tessControl, &tessEval, &geometry, &fragment})
+        auto it = setBindings.find(set);
+        if(it != setBindings.end())
         {
-            if( !stage->comp)
-                continue;
-            auto & comp = *stage->comp;
-            uint32_t id = stage->res.push_constant_buffers[0].id;
-            auto ranges = comp.get_active_buffer_ranges(id);
-
-            for (auto &range : ranges)
+            size_t offset = 0;
+            for(auto & [b, binding] : it->second)
             {
-                auto &R      = rangePerStage[stage->stage].emplace_back();
-                R.size       = static_cast<uint32_t>(range.range);
-                R.offset     = static_cast<uint32_t>(range.offset);
-                R.stageFlags = stage->stage;
+                auto size = DescriptorUpdateTemplateCreateInfo::descriptorInfoSize(binding.descriptorType);
+                char const * typeName = "VkDescriptorImageInfo ";
+                if(size == sizeof(VkBufferView))
+                    typeName = "VkBufferView          ";
+                else if(binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+                        binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
+                        binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+                        binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+                    typeName = "VkDescriptorBufferInfo";
+
+                out << "    " << typeName << " " << _memberName(set, b);
+                if(binding.descriptorCount > 1)
+                    out << "[" << binding.descriptorCount << "]";
+                out << "; // binding " << b << ", offset " << offset << "\n";
+
+                offset += size * binding.descriptorCount;
             }
         }
-
-        // loop through each stage now
-        for(auto & stg : rangePerStage)
-        {
-            // and stort all the variables based on their
-            // offset
-            std::sort( stg.second.begin(),
-                       stg.second.end(),
-                       [](auto & a, auto &b)
-            {
-                return a.offset < b.offset;
-            });
-
-            auto & rg = pushRangeV.emplace_back();
-
-            // create a single range for this stage
-            // starting at the min offset and ending
-            // and the max offset + size
-            rg.stageFlags = stg.first;
-            rg.size = stg.second.back().offset + stg.second.back().size;
-            rg.offset = stg.second.front().offset;
-        }
-
-        return pushRangeV;
+        out << "};\n";
+        return out.str();
     }
 
-    std::map< uint32_t, std::vector<VkDescriptorSetLayoutBinding> > generateDescriptorSetLayoutBindings() const
-    {
-        std::map< uint32_t , std::map<uint32_t, VkDescriptorSetLayoutBinding> > setBindings;
-
-        auto _handleDescriptorType = [&](spirv_cross::SmallVector<spirv_cross::Resource> const& desc,
-                                         spirv_cross::Compiler & comp,
-                                         VkShaderStageFlagBits stage,
-                                         VkDescriptorType _type)
-        {
-            for (auto &u : desc)
-            {
-                uint32_t set     = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
-                uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
-                auto arraySize   = comp.get_type(u.type_id).array[0];
-
-                auto & bind          = setBindings[set][binding];
-                bind.binding         = binding;
-                bind.descriptorCount = std::max(1u, arraySize);
-                bind.descriptorType  = _type;
-                bind.stageFlags     |= static_cast<VkShaderStageFlags>(stage);
-            }
-        };
-
-        for(auto * stage : { &vertex, &tessControl, &tessEval, &geometry, &fragment})
-        {
-            if( !stage->comp)
-                continue;
-            auto & comp = *stage->comp;
-            uint32_t id = stage->res.push_constant_buffers[0].id;
-            auto ranges = comp.get_active_buffer_ranges(id);
-            auto & resources = stage->res;
-
-            _handleDescriptorType(resources.uniform_buffers,   comp, stage->stage, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER         );//vk::DescriptorType::eUniformBuffer);
-            _handleDescriptorType(resources.storage_buffers,   comp, stage->stage, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER         );//vk::DescriptorType::eStorageBuffer);
-            _handleDescriptorType(resources.sampled_images,    comp, stage->stage, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER );//vk::DescriptorType::eCombinedImageSampler);
-            _handleDescriptorType(resources.storage_images,    comp, stage->stage, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE          );//vk::DescriptorType::eSampledImage);
-            _handleDescriptorType(resources.separate_samplers, comp, stage->stage, VK_DESCRIPTOR_TYPE_SAMPLER                );//vk::DescriptorType::eSampler);
-            _handleDescriptorType(resources.separate_images,   comp, stage->stage, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE          );//vk::DescriptorType::eSampledImage);
-        }
-
-        std::map< uint32_t, std::vector<VkDescriptorSetLayoutBinding> > out;
-        for(auto & x : setBindings)
-        {
-            auto & set = out[x.first];
-            for(auto & b : x.second)
-            {
-                set.push_back( b.second );
-            }
-        }
-        return out;
-    }
-
-    /**
-     * @brief generateVertexInputDescriptions
-     * @return
-     *
-     * Returns the vertex input attribute descriptions.
-     * This will assume that the it will set the
-     * offsets as 0 for each attribute
-     */
-    std::vector< VkVertexInputAttributeDescription > generateVertexInputDescriptions() const
+    static VkFormat _getFormat(spirv_cross::SPIRType::BaseType baseType, uint32_t vecSize)
     {
-        std::vector< VkVertexInputAttributeDescription > out;
-        auto & comp = *vertex.comp;
-        for(auto & res : vertex.res.stage_inputs)
-        {
-            //uint32_t set     = comp.get_decoration(i.id, spv::DecorationDescriptorSet);
-            uint32_t binding = comp.get_decoration(res.id, spv::DecorationBinding);
-            uint32_t location = comp.get_decoration(res.id, spv::DecorationLocation);
-            //auto arraySize   = comp.get_type(u.type_id).array[0];
-
-            const auto &base_type = comp.get_type(res.base_type_id);
-            const auto &type      = comp.get_type(res.type_id);
-
-            (void) base_type;
-
-            auto &v    = out.emplace_back();
-
-            (void)binding;
-            v.binding  = location; // set these to the same since binding will always be zero for vertex inputs
-            v.location = location;
-            v.format = _getFormat(type.basetype, type.vecsize );
-        }
-        std::sort(out.begin(), out.end(),[](auto & a, auto & b)
-        {
-            return a.location < b.location;
-        });
-
-        return out;
+        return ShaderReflection::getFormat(baseType, vecSize);
     }
 
-    std::vector< std::string > generateVertexInputNames() const
+protected:
+    std::string _memberName(uint32_t set, uint32_t binding) const
     {
-        std::vector< std::string > names;
-        std::map<uint32_t, std::string> names_map;
-
-        auto & comp = *vertex.comp;
-        for(auto & res : vertex.res.stage_inputs)
+        std::string name;
+        auto s = m_bindingNames.find(set);
+        if(s != m_bindingNames.end())
         {
-            uint32_t location = comp.get_decoration(res.id, spv::DecorationLocation);
-
-            names_map[location] = res.name;
+            auto b = s->second.find(binding);
+            if(b != s->second.end())
+                name = b->second;
         }
-        for(auto & x : names_map)
-            names.push_back(x.second);
-        return names;
-    }
-
-    static VkFormat _getFormat(spirv_cross::SPIRType::BaseType baseType, uint32_t vecSize)
-    {
-        switch(baseType)
+        for(auto & c : name)
         {
-            case spirv_cross::SPIRType::Unknown:
-                break;
-            case spirv_cross::SPIRType::Void:
-                break;
-            case spirv_cross::SPIRType::Boolean:
-                break;
-            case spirv_cross::SPIRType::SByte:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R8_SINT, VK_FORMAT_R8G8_SINT, VK_FORMAT_R8G8B8_SINT, VK_FORMAT_R8G8B8A8_SINT}})[vecSize-1];
-            case spirv_cross::SPIRType::UByte:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R8_UINT, VK_FORMAT_R8G8_UINT, VK_FORMAT_R8G8B8_UINT, VK_FORMAT_R8G8B8A8_UINT}})[vecSize-1];
-            case spirv_cross::SPIRType::Short:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R16_SINT, VK_FORMAT_R16G16_SINT, VK_FORMAT_R16G16B16_SINT, VK_FORMAT_R16G16B16A16_SINT}})[vecSize-1];
-            case spirv_cross::SPIRType::UShort:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R16_UINT, VK_FORMAT_R16G16_UINT, VK_FORMAT_R16G16B16_UINT, VK_FORMAT_R16G16B16A16_UINT}})[vecSize-1];
-            case spirv_cross::SPIRType::Int:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT}})[vecSize-1];
-            case spirv_cross::SPIRType::UInt:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT}})[vecSize-1];
-            case spirv_cross::SPIRType::Int64:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R64_SINT, VK_FORMAT_R64G64_SINT, VK_FORMAT_R64G64B64_SINT, VK_FORMAT_R64G64B64A64_SINT}})[vecSize-1];
-            case spirv_cross::SPIRType::UInt64:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R64_UINT, VK_FORMAT_R64G64_UINT, VK_FORMAT_R64G64B64_UINT, VK_FORMAT_R64G64B64A64_UINT}})[vecSize-1];
-            case spirv_cross::SPIRType::AtomicCounter:
-                break;
-            case spirv_cross::SPIRType::Half:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT}})[vecSize-1];
-            case spirv_cross::SPIRType::Float:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT}})[vecSize-1];
-            case spirv_cross::SPIRType::Double:
-                return std::array<VkFormat, 4>({{VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT}})[vecSize-1];
-            case spirv_cross::SPIRType::Struct:
-                break;
-            case spirv_cross::SPIRType::Image:
-                break;
-            case spirv_cross::SPIRType::SampledImage:
-                break;
-            case spirv_cross::SPIRType::Sampler:
-                break;
-            case spirv_cross::SPIRType::AccelerationStructure:
-                break;
-            case spirv_cross::SPIRType::RayQuery:
-                break;
-            case spirv_cross::SPIRType::ControlPointArray:
-                break;
-            case spirv_cross::SPIRType::Interpolant:
-                break;
-            case spirv_cross::SPIRType::Char:
-                break;
-
+            if(!std::isalnum(static_cast<unsigned char>(c)))
+                c = '_';
         }
-        return VK_FORMAT_UNDEFINED;
+        if(name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+            name = "binding" + std::to_string(binding) + name;
+        return name;
     }
 
+    std::map< uint32_t , std::map<uint32_t, VkDescriptorSetLayoutBinding> > setBindings;
+    std::map< uint32_t , std::map<uint32_t, std::string> >                  m_bindingNames;
+    std::map< uint32_t , std::set<uint32_t> >                               m_unsizedBindings;
+    std::vector<VkPushConstantRange> m_pushRangeV;
 };
-#endif
+
 }
 
 #endif
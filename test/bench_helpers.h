@@ -0,0 +1,212 @@
+#ifndef GVU_BENCH_HELPERS_H
+#define GVU_BENCH_HELPERS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gvu_bench
+{
+
+/**
+ * @brief doNotOptimize
+ * @param v
+ *
+ * Feeds a value into a volatile sink so the compiler cannot
+ * remove the code which computed it.
+ */
+template<typename T>
+inline void doNotOptimize(T const & v)
+{
+    static volatile uint64_t sink = 0;
+    sink = sink + static_cast<uint64_t>(v);
+}
+
+/**
+ * @brief timeNs
+ * @param f
+ * @return
+ *
+ * Returns the time taken to call f() in nanoseconds.
+ */
+template<typename F>
+inline double timeNs(F && f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1-t0).count();
+}
+
+struct Result
+{
+    std::string name;
+    uint64_t    iterations = 0;
+    double      nsPerOp    = 0; // median over the repetitions
+    double      minNsPerOp = 0;
+    std::vector< std::pair<std::string, double> > counters;
+};
+
+/**
+ * @brief The Runner class
+ *
+ * Runs the benchmarks and writes the results as json, in the same
+ * layout as google-benchmark's --benchmark_format=json so the usual
+ * comparison scripts can be used on them.
+ *
+ * Command line:
+ *   --filter=<text>     only run the benchmarks whose name contains text
+ *   --out=<file>        write the json to a file instead of stdout
+ *   --repetitions=<n>   number of times each benchmark is run (default 5)
+ *   --quick             divide the number of iterations by 10
+ */
+class Runner
+{
+public:
+    Runner(int argc, char ** argv)
+    {
+        for(int i=1; i < argc; i++)
+        {
+            std::string a(argv[i]);
+            if(a.rfind("--filter=", 0) == 0)
+                m_filter = a.substr(9);
+            else if(a.rfind("--out=", 0) == 0)
+                m_out = a.substr(6);
+            else if(a.rfind("--repetitions=", 0) == 0)
+                m_repetitions = std::max(1, std::atoi(a.c_str() + 14));
+            else if(a == "--quick")
+                m_quick = true;
+            else
+                throw std::invalid_argument("Unknown argument: " + a);
+        }
+    }
+
+    bool enabled(std::string const & name) const
+    {
+        return m_filter.empty() || name.find(m_filter) != std::string::npos;
+    }
+
+    uint64_t iterations(uint64_t n) const
+    {
+        return m_quick ? std::max<uint64_t>(1, n / 10) : n;
+    }
+
+    /**
+     * @brief run
+     * @param name
+     * @param iterations
+     * @param f - f(iterations) must perform the operation iterations times
+     *            and return the time it took in nanoseconds, so that
+     *            any setup can be excluded from the measurement.
+     * @return the result, counters can be added to it. It is only valid
+     *         until the next call to run(). Null if filtered out.
+     */
+    template<typename F>
+    Result * run(std::string const & name, uint64_t iterations, F && f)
+    {
+        if(!enabled(name))
+            return nullptr;
+
+        iterations = this->iterations(iterations);
+
+        std::vector<double> times;
+        for(int r=0; r < m_repetitions; r++)
+        {
+            times.push_back( f(iterations) / static_cast<double>(iterations) );
+        }
+        std::sort(times.begin(), times.end());
+
+        auto & R      = m_results.emplace_back();
+        R.name        = name;
+        R.iterations  = iterations;
+        R.nsPerOp     = times[times.size()/2];
+        R.minNsPerOp  = times.front();
+
+        std::fprintf(stderr, "%-52s %12.1f ns/op\n", name.c_str(), R.nsPerOp);
+        return &R;
+    }
+
+    void setContext(std::string const & key, std::string const & value)
+    {
+        m_context.emplace_back(key, value);
+    }
+
+    std::string json() const
+    {
+        std::ostringstream o;
+        o << "{\n  \"context\": {\n";
+        o << "    \"library\": \"gvu\",\n";
+        o << "    \"repetitions\": " << m_repetitions;
+        for(auto & [k,v] : m_context)
+            o << ",\n    " << _quote(k) << ": " << _quote(v);
+        o << "\n  },\n  \"benchmarks\": [";
+        for(size_t i=0; i < m_results.size(); i++)
+        {
+            auto & R = m_results[i];
+            o << (i == 0 ? "\n" : ",\n");
+            o << "    {\n";
+            o << "      \"name\": "       << _quote(R.name) << ",\n";
+            o << "      \"iterations\": " << R.iterations << ",\n";
+            o << "      \"real_time\": "  << R.nsPerOp << ",\n";
+            o << "      \"cpu_time\": "   << R.nsPerOp << ",\n";
+            o << "      \"min_time\": "   << R.minNsPerOp << ",\n";
+            for(auto & [k,v] : R.counters)
+                o << "      " << _quote(k) << ": " << v << ",\n";
+            o << "      \"time_unit\": \"ns\"\n";
+            o << "    }";
+        }
+        o << "\n  ]\n}\n";
+        return o.str();
+    }
+
+    /**
+     * @brief finish
+     * @return the exit code of the program
+     */
+    int finish() const
+    {
+        auto j = json();
+        if(m_out.empty())
+        {
+            std::cout << j;
+            return 0;
+        }
+        std::ofstream f(m_out);
+        f << j;
+        return f.good() ? 0 : 1;
+    }
+
+protected:
+    static std::string _quote(std::string const & s)
+    {
+        std::string r = "\"";
+        for(char c : s)
+        {
+            if(c == '"' || c == '\\')
+                r += '\\';
+            r += c;
+        }
+        return r + "\"";
+    }
+
+    std::string          m_filter;
+    std::string          m_out;
+    int                  m_repetitions = 5;
+    bool                 m_quick       = false;
+    std::vector<Result>  m_results;
+    std::vector< std::pair<std::string, std::string> > m_context;
+};
+
+}
+
+#endif
@@ -0,0 +1,661 @@
+// gvu-benchmarks
+//
+// Measures the hot paths of gvu and prints the results as json:
+//
+//   - Cache_t lookups (hits and misses) with 1k to 100k entries
+//   - building, hashing and generating GraphicsPipelineCreateInfo
+//   - create info hashing and lookups, compared with the field-by-field
+//     hash the caches used before gvu/Hash.h
+//   - heap allocations of GraphicsPipelineCreateInfo and
+//     InlineGraphicsPipelineCreateInfo
+//   - DescriptorPoolManager allocate/release throughput
+//   - single vs batched command buffer submission in CommandPoolManager
+//   - SPIR-V reflection
+//
+// The device is created with unit_helpers.h, nothing is presented, so it
+// can be run on a software implementation. eg:
+//
+//   export SDL_VIDEODRIVER=offscreen
+//   export VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json
+//   ./gvu-benchmarks --out=results.json
+//
+// See bench_helpers.h for the command line arguments.
+
+#include "unit_helpers.h"
+#include "bench_helpers.h"
+
+#include <gvu/Cache/Cache_t.h>
+#include <gvu/Cache/DescriptorSetLayoutCache.h>
+#include <gvu/Cache/RenderPassCache.h>
+#include <gvu/Cache/ShaderModuleCache.h>
+#include <gvu/GraphicsPipelineCreateInfo.h>
+#include <gvu/Managers/CommandPoolManager.h>
+#include <gvu/Managers/DescriptorPoolManager.h>
+#include <gvu/ShaderReflection.h>
+#include <gvu/spirvPipelineReflector.h>
+
+#include <array>
+#include <atomic>
+#include <new>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+// count the heap allocations so that the create info
+// benchmarks can report them
+static std::atomic<uint64_t> g_allocations{0};
+
+void * operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void * p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void * p) noexcept
+{
+    std::free(p);
+}
+void operator delete(void * p, size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+
+/**
+ * A create info which does not create a vulkan object. This is used
+ * to measure the cost of the cache itself, without the driver.
+ */
+struct BenchCreateInfo : public gvu::SealedHash<BenchCreateInfo>
+{
+    using create_info_type = BenchCreateInfo;
+    using object_type      = VkSampler;
+
+    // roughly the size of a sampler/render pass create info
+    std::array<uint32_t, 16> words = {};
+
+    size_t computeHash() const
+    {
+        return gvu::hashBytes(words.data(), sizeof(words));
+    }
+
+    bool operator==(BenchCreateInfo const & B) const
+    {
+        if(_sealedHashesDiffer(B))
+            return false;
+        return words == B.words;
+    }
+
+    template<typename callable_t>
+    void generateVkCreateInfo(callable_t && c) const
+    {
+        c(*this);
+    }
+
+    static object_type create(VkDevice, create_info_type const & C)
+    {
+        // any non-null value will do, the handle is never used.
+        // A C-style cast works for both 32 and 64 bit handles.
+        return (object_type)(uintptr_t(C.words[0]) + 1);
+    }
+    static void destroy(VkDevice, object_type)
+    {
+    }
+};
+
+std::vector<BenchCreateInfo> makeKeys(size_t count)
+{
+    std::vector<BenchCreateInfo> keys(count);
+    for(size_t i=0; i < count; i++)
+    {
+        keys[i].words[0] = static_cast<uint32_t>(i);
+        for(size_t j=1; j < keys[i].words.size(); j++)
+            keys[i].words[j] = static_cast<uint32_t>(j * 0x9E3779B9u);
+    }
+    return keys;
+}
+
+template<bool concurrent>
+void benchCache(gvu_bench::Runner & runner, char const * prefix, size_t entries)
+{
+    auto keys    = makeKeys(entries);
+    auto name    = [&](char const * what) { return std::string(prefix) + "/" + what + "/" + std::to_string(entries); };
+
+    runner.run(name("miss"), entries, [&](uint64_t n)
+    {
+        gvu::Cache_t<BenchCreateInfo, concurrent> cache;
+        cache.init(VK_NULL_HANDLE);
+        auto t = gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+                gvu_bench::doNotOptimize( cache.create(keys[i]) != VK_NULL_HANDLE );
+        });
+        cache.destroy();
+        return t;
+    });
+
+    gvu::Cache_t<BenchCreateInfo, concurrent> cache;
+    cache.init(VK_NULL_HANDLE);
+    for(auto & k : keys)
+        cache.create(k);
+
+    // look the keys up in a random order so that the
+    // access pattern is not cache friendly
+    std::vector<uint32_t> order(entries);
+    for(size_t i=0; i < entries; i++)
+        order[i] = static_cast<uint32_t>(i);
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    auto lookups = [&](uint64_t n)
+    {
+        return gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+                gvu_bench::doNotOptimize( cache.create(keys[order[i % entries]]) != VK_NULL_HANDLE );
+        });
+    };
+
+    runner.run(name("hit"), 1000000, lookups);
+
+    for(auto & k : keys)
+        k.seal();
+    runner.run(name("hit_sealed"), 1000000, lookups);
+
+    cache.destroy();
+}
+
+gvu::GraphicsPipelineCreateInfo buildPipelineInfo(uint32_t i)
+{
+    gvu::GraphicsPipelineCreateInfo G;
+    G.setVertexInputs({VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R8G8B8A8_UNORM});
+    G.dynamicStates      = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    G.viewport.width     = static_cast<float>(i);
+    G.outputColorTargets = 1 + i % 4;
+    return G;
+}
+
+void benchPipelineCreateInfo(gvu_bench::Runner & runner)
+{
+    runner.run("GraphicsPipelineCreateInfo/build", 200000, [&](uint64_t n)
+    {
+        return gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+                gvu_bench::doNotOptimize( buildPipelineInfo(static_cast<uint32_t>(i & 255)).outputColorTargets );
+        });
+    });
+
+    std::vector<gvu::GraphicsPipelineCreateInfo> infos;
+    for(uint32_t i=0; i < 256; i++)
+        infos.push_back(buildPipelineInfo(i));
+
+    runner.run("GraphicsPipelineCreateInfo/hash", 1000000, [&](uint64_t n)
+    {
+        return gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+                gvu_bench::doNotOptimize( infos[i & 255].computeHash() );
+        });
+    });
+
+    runner.run("GraphicsPipelineCreateInfo/copy_compare", 200000, [&](uint64_t n)
+    {
+        return gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+            {
+                auto copy = infos[i & 255];
+                gvu_bench::doNotOptimize( copy == infos[i & 255] );
+            }
+        });
+    });
+
+    runner.run("GraphicsPipelineCreateInfo/generate", 200000, [&](uint64_t n)
+    {
+        return gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+            {
+                infos[i & 255].create([&](VkGraphicsPipelineCreateInfo & info)
+                {
+                    gvu_bench::doNotOptimize( info.stageCount + info.pColorBlendState->attachmentCount );
+                });
+            }
+        });
+    });
+}
+
+template<typename CreateInfo_t>
+CreateInfo_t buildFullPipelineInfo(uint32_t i)
+{
+    CreateInfo_t G;
+    G.setVertexInputs({VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R8G8B8A8_UNORM});
+    G.dynamicStates      = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    G.viewport.width     = static_cast<float>(i);
+    G.outputColorTargets = 4;
+    return G;
+}
+
+/**
+ * Builds, copies, hashes, compares and generates the vulkan struct,
+ * reporting the number of heap allocations per iteration.
+ */
+template<typename CreateInfo_t>
+void benchPipelineCreateInfoAllocations(gvu_bench::Runner & runner, char const * name)
+{
+    uint64_t allocations = 0;
+    uint64_t iterations  = 0;
+
+    if(auto R = runner.run(std::string(name) + "/allocations", 200000, [&](uint64_t n)
+    {
+        auto a0 = g_allocations.load();
+        auto t  = gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+            {
+                auto G    = buildFullPipelineInfo<CreateInfo_t>(static_cast<uint32_t>(i & 7));
+                auto copy = G;
+                gvu_bench::doNotOptimize( copy.computeHash() );
+                gvu_bench::doNotOptimize( copy == G );
+                G.create([&](VkGraphicsPipelineCreateInfo & info)
+                {
+                    gvu_bench::doNotOptimize( info.stageCount + info.pColorBlendState->attachmentCount );
+                });
+            }
+        });
+        allocations += g_allocations.load() - a0;
+        iterations  += n;
+        return t;
+    }))
+    {
+        R->counters.emplace_back("allocations_per_op", static_cast<double>(allocations) / static_cast<double>(iterations));
+        R->counters.emplace_back("sizeof", static_cast<double>(sizeof(CreateInfo_t)));
+    }
+}
+
+auto legacy_hash_combine = [](std::size_t& seed, const auto& v)
+{
+    std::hash<std::decay_t<decltype(v)> > hasher;
+    seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+};
+
+// the field-by-field hashes the caches used before gvu/Hash.h,
+// kept as the baseline for the CreateInfoHash benchmarks
+size_t legacyHash(gvu::SubpassDescription const & S)
+{
+    std::hash<size_t> Hs;
+    auto h = Hs(S.flags);
+    legacy_hash_combine(h, S.flags);
+    legacy_hash_combine(h, S.pipelineBindPoint);
+    for(auto & b : S.inputAttachments)   { legacy_hash_combine(h, b.attachment); legacy_hash_combine(h, b.layout); }
+    for(auto & b : S.colorAttachments)   { legacy_hash_combine(h, b.attachment); legacy_hash_combine(h, b.layout); }
+    for(auto & b : S.resolveAttachments) { legacy_hash_combine(h, b.attachment); legacy_hash_combine(h, b.layout); }
+    legacy_hash_combine(h, S.depthStencilAttachment.has_value());
+    if(S.depthStencilAttachment.has_value())
+    {
+        legacy_hash_combine(h, S.depthStencilAttachment->attachment);
+        legacy_hash_combine(h, S.depthStencilAttachment->layout);
+    }
+    for(auto & b : S.preserveAttachments)
+        legacy_hash_combine(h, b);
+    return h;
+}
+
+size_t legacyHash(gvu::RenderPassCreateInfo const & R)
+{
+    std::hash<size_t> Hs;
+    auto h = Hs(R.flags);
+    legacy_hash_combine(h, R.flags);
+    for(auto & b : R.subpasses)
+        legacy_hash_combine(h, legacyHash(b));
+    for(auto & b : R.attachments)
+    {
+        legacy_hash_combine(h, b.flags);
+        legacy_hash_combine(h, b.format);
+        legacy_hash_combine(h, b.samples);
+        legacy_hash_combine(h, b.loadOp);
+        legacy_hash_combine(h, b.storeOp);
+        legacy_hash_combine(h, b.stencilLoadOp);
+        legacy_hash_combine(h, b.stencilStoreOp);
+        legacy_hash_combine(h, b.initialLayout);
+        legacy_hash_combine(h, b.finalLayout);
+    }
+    for(auto & b : R.dependencies)
+    {
+        legacy_hash_combine(h, b.srcSubpass);
+        legacy_hash_combine(h, b.dstSubpass);
+        legacy_hash_combine(h, b.srcStageMask);
+        legacy_hash_combine(h, b.dstStageMask);
+        legacy_hash_combine(h, b.srcAccessMask);
+        legacy_hash_combine(h, b.dstAccessMask);
+        legacy_hash_combine(h, b.dependencyFlags);
+    }
+    return h;
+}
+
+size_t legacyHash(gvu::GraphicsPipelineCreateInfo const & G)
+{
+    std::hash<size_t> Hs;
+    auto h = Hs(G.inputBindings.size());
+    for(auto & a : G.inputBindings)
+    {
+        legacy_hash_combine(h, a.stride);
+        legacy_hash_combine(h, a.binding);
+        legacy_hash_combine(h, a.inputRate);
+    }
+    legacy_hash_combine(h, G.inputVertexAttributes.size());
+    for(auto & a : G.inputVertexAttributes)
+    {
+        legacy_hash_combine(h, a.format);
+        legacy_hash_combine(h, a.offset);
+        legacy_hash_combine(h, a.binding);
+        legacy_hash_combine(h, a.location);
+    }
+    legacy_hash_combine(h, G.viewport.x);
+    legacy_hash_combine(h, G.viewport.y);
+    legacy_hash_combine(h, G.viewport.width);
+    legacy_hash_combine(h, G.viewport.height);
+    legacy_hash_combine(h, G.scissor.extent.width);
+    legacy_hash_combine(h, G.scissor.extent.height);
+    legacy_hash_combine(h, G.scissor.offset.x);
+    legacy_hash_combine(h, G.scissor.offset.y);
+    legacy_hash_combine(h, G.topology);
+    legacy_hash_combine(h, G.polygonMode);
+    legacy_hash_combine(h, G.cullMode);
+    legacy_hash_combine(h, G.frontFace);
+    legacy_hash_combine(h, G.enableDepthTest);
+    legacy_hash_combine(h, G.enableDepthWrite);
+    legacy_hash_combine(h, G.tesselationPatchControlPoints);
+    legacy_hash_combine(h, G.vertexShader);
+    legacy_hash_combine(h, G.tessEvalShader);
+    legacy_hash_combine(h, G.tessControlShader);
+    legacy_hash_combine(h, G.fragmentShader);
+    legacy_hash_combine(h, G.pipelineLayout);
+    legacy_hash_combine(h, G.renderPass);
+    legacy_hash_combine(h, G.outputColorTargets);
+    legacy_hash_combine(h, G.enableBlending);
+    for(auto & s : G.dynamicStates)
+        legacy_hash_combine(h, s);
+    return h;
+}
+
+template<typename T>
+struct LegacyHasher
+{
+    size_t operator()(T const & t) const { return legacyHash(t); }
+};
+
+template<typename T>
+struct Hasher
+{
+    size_t operator()(T const & t) const { return t.hash(); }
+};
+
+std::vector<gvu::RenderPassCreateInfo> makeRenderPasses(size_t count)
+{
+    std::vector<gvu::RenderPassCreateInfo> out;
+    for(size_t i=0; i < count; i++)
+    {
+        std::vector< std::pair<VkFormat,VkImageLayout> > colors;
+        for(size_t j=0; j < 1 + i%4; j++)
+            colors.push_back({static_cast<VkFormat>(VK_FORMAT_R8G8B8A8_UNORM + (i/4 + j) % 32), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+        out.push_back(gvu::RenderPassCreateInfo::createSimpleRenderPass(colors, {VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL}));
+    }
+    return out;
+}
+
+std::vector<gvu::GraphicsPipelineCreateInfo> makePipelines(size_t count)
+{
+    std::vector<gvu::GraphicsPipelineCreateInfo> out;
+    for(size_t i=0; i < count; i++)
+        out.push_back(buildPipelineInfo(static_cast<uint32_t>(i)));
+    return out;
+}
+
+/**
+ * Compares the legacy field-by-field hash with computeHash() and
+ * measures unordered_map lookups with each, and with sealed keys.
+ */
+template<typename Key_t>
+void benchCreateInfoHash(gvu_bench::Runner & runner, char const * name, std::vector<Key_t> keys)
+{
+    auto const count = keys.size();
+    std::unordered_map<Key_t, int, LegacyHasher<Key_t>> legacyMap;
+    std::unordered_map<Key_t, int, Hasher<Key_t>>       newMap;
+    for(auto & k : keys)
+    {
+        legacyMap.emplace(k, 0);
+        newMap.emplace(k, 0);
+    }
+
+    auto hash = [&](auto && f)
+    {
+        return [&, f](uint64_t n)
+        {
+            return gvu_bench::timeNs([&]
+            {
+                for(uint64_t i=0; i < n; i++)
+                    gvu_bench::doNotOptimize( f(keys[i % count]) );
+            });
+        };
+    };
+    auto lookup = [&](auto & map)
+    {
+        return [&](uint64_t n)
+        {
+            return gvu_bench::timeNs([&]
+            {
+                for(uint64_t i=0; i < n; i++)
+                    gvu_bench::doNotOptimize( map.count(keys[i % count]) );
+            });
+        };
+    };
+
+    runner.run(std::string("CreateInfoHash/") + name + "/legacy", 2000000, hash([](Key_t const & k) { return legacyHash(k); }));
+    runner.run(std::string("CreateInfoHash/") + name + "/hash",   2000000, hash([](Key_t const & k) { return k.computeHash(); }));
+
+    runner.run(std::string("CreateInfoLookup/") + name + "/legacy", 2000000, lookup(legacyMap));
+    runner.run(std::string("CreateInfoLookup/") + name + "/hash",   2000000, lookup(newMap));
+    for(auto & k : keys)
+        k.seal();
+    runner.run(std::string("CreateInfoLookup/") + name + "/sealed", 2000000, lookup(newMap));
+}
+
+void benchDescriptorPoolManager(gvu_bench::Runner & runner, VkDevice device)
+{
+    gvu::DescriptorSetLayoutCache layoutCache;
+    layoutCache.init(device);
+
+    gvu::DescriptorSetLayoutCreateInfo dci;
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr});
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr});
+    auto layout = layoutCache.create(dci);
+
+    gvu::DescriptorPoolManager pm;
+    pm.init(device, &layoutCache, layout, 64);
+
+    std::vector<VkDescriptorSet> sets;
+
+    runner.run("DescriptorPoolManager/allocate", 10000, [&](uint64_t n)
+    {
+        sets.resize(n);
+        auto t = gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+                sets[i] = pm.allocateDescriptorSet();
+        });
+        for(auto s : sets)
+            pm.releaseToPool(s);
+        return t;
+    });
+
+    runner.run("DescriptorPoolManager/allocate_batch", 10000, [&](uint64_t n)
+    {
+        sets.resize(n);
+        auto t = gvu_bench::timeNs([&]
+        {
+            pm.allocateDescriptorSets(sets.data(), static_cast<uint32_t>(n));
+        });
+        for(auto s : sets)
+            pm.releaseToPool(s);
+        return t;
+    });
+
+    runner.run("DescriptorPoolManager/release", 10000, [&](uint64_t n)
+    {
+        sets.resize(n);
+        pm.allocateDescriptorSets(sets.data(), static_cast<uint32_t>(n));
+        return gvu_bench::timeNs([&]
+        {
+            for(auto s : sets)
+                pm.releaseToPool(s);
+        });
+    });
+
+    if(auto R = runner.run("DescriptorPoolManager/allocate_release_frame", 1000, [&](uint64_t n)
+    {
+        // a typical frame: 64 sets allocated, used and returned
+        std::array<VkDescriptorSet, 64> frame;
+        return gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+            {
+                pm.allocateDescriptorSets(frame.data(), static_cast<uint32_t>(frame.size()));
+                for(auto s : frame)
+                    pm.releaseToPool(s);
+            }
+        });
+    }))
+    {
+        R->counters.emplace_back("pools", static_cast<double>(pm.allocatedPoolCount()));
+    }
+
+    pm.destroy();
+    layoutCache.destroy();
+}
+
+void benchCommandPoolManager(gvu_bench::Runner & runner, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue)
+{
+    gvu::CommandPoolManager cpm;
+    cpm.init(device, physicalDevice, queue);
+
+    // one submit and one fence wait per command buffer
+    runner.run("CommandPoolManager/submit_single", 1000, [&](uint64_t n)
+    {
+        return gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+            {
+                cpm.beginRecording([](VkCommandBuffer){}, true);
+            }
+        });
+    });
+
+    // the same number of command buffers, one submit and one wait per batch
+    for(uint32_t batchSize : {4u, 16u, 64u})
+    {
+        auto name = "CommandPoolManager/submit_batched/" + std::to_string(batchSize);
+        if(auto R = runner.run(name, 1024, [&](uint64_t n)
+        {
+            std::vector<VkCommandBuffer> cmds(batchSize);
+            gvu::SubmitBatch             batch;
+            return gvu_bench::timeNs([&]
+            {
+                for(uint64_t i=0; i < n; i += batchSize)
+                {
+                    for(auto & cmd : cmds)
+                    {
+                        cmd = cpm.allocateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+                        vkEndCommandBuffer(cmd);
+                        batch.addCommandBuffer(cmd);
+                    }
+                    auto id = cpm.submitBatchAsync(batch, queue, [&cpm, cmds]()
+                    {
+                        for(auto cmd : cmds)
+                            cpm.recycle(VK_NULL_HANDLE, cmd);
+                    });
+                    while(!cpm.poll(id))
+                        std::this_thread::yield();
+                    cpm.collect();
+                }
+            });
+        }))
+        {
+            R->counters.emplace_back("batch_size", batchSize);
+        }
+    }
+
+    cpm.destroy();
+}
+
+void benchReflection(gvu_bench::Runner & runner)
+{
+    gvu::ShaderModuleCreateInfo vert(CMAKE_SOURCE_DIR "/share/shaders/pbr.vert.spv");
+    gvu::ShaderModuleCreateInfo frag(CMAKE_SOURCE_DIR "/share/shaders/pbr.frag.spv");
+    if(vert.code.empty() || frag.code.empty())
+    {
+        std::fprintf(stderr, "share/shaders/pbr.*.spv not found, skipping the reflection benchmarks\n");
+        return;
+    }
+
+    for(auto & [stage, code] : { std::make_pair("vert", &vert.code), std::make_pair("frag", &frag.code) })
+    {
+        runner.run(std::string("ShaderReflection/reflect/pbr.") + stage, 200, [&, code = code](uint64_t n)
+        {
+            return gvu_bench::timeNs([&]
+            {
+                for(uint64_t i=0; i < n; i++)
+                    gvu_bench::doNotOptimize( gvu::ShaderReflection::reflect(*code).bindings.size() );
+            });
+        });
+    }
+
+    runner.run("spirvPipelineReflector/pbr", 200, [&](uint64_t n)
+    {
+        return gvu_bench::timeNs([&]
+        {
+            for(uint64_t i=0; i < n; i++)
+            {
+                gvu::spirvPipelineReflector R;
+                R.addSPIRVCode(vert.code, VK_SHADER_STAGE_VERTEX_BIT);
+                R.addSPIRVCode(frag.code, VK_SHADER_STAGE_FRAGMENT_BIT);
+                gvu_bench::doNotOptimize( R.generateCombinedPipelineLayoutCreateInfo().pushConstantRanges.size() );
+            }
+        });
+    });
+}
+
+}
+
+int main(int argc, char ** argv)
+{
+    gvu_bench::Runner runner(argc, argv);
+
+    for(size_t entries : {1000u, 10000u, 100000u})
+    {
+        benchCache<false>(runner, "Cache_t", entries);
+        benchCache<true>(runner, "ConcurrentCache_t", entries);
+    }
+    benchPipelineCreateInfo(runner);
+    benchPipelineCreateInfoAllocations<gvu::GraphicsPipelineCreateInfo>(runner, "GraphicsPipelineCreateInfo");
+    benchPipelineCreateInfoAllocations<gvu::InlineGraphicsPipelineCreateInfo>(runner, "InlineGraphicsPipelineCreateInfo");
+    benchCreateInfoHash(runner, "RenderPassCreateInfo", makeRenderPasses(256));
+    benchCreateInfoHash(runner, "GraphicsPipelineCreateInfo", makePipelines(256));
+    benchReflection(runner);
+
+    {
+        auto window = createWindow(1024,768);
+
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(window->getPhysicalDevice(), &props);
+        runner.setContext("device", props.deviceName);
+
+        benchDescriptorPoolManager(runner, window->getDevice());
+        benchCommandPoolManager(runner, window->getDevice(), window->getPhysicalDevice(), window->getGraphicsQueue());
+    }
+    SDL_Quit();
+
+    return runner.finish();
+}
@@ -0,0 +1,150 @@
+#include<catch2/catch.hpp>
+#include <fstream>
+#include <set>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/RenderPassCache.h>
+#include <gvu/Cache/PipelineLayoutCache.h>
+#include <gvu/Cache/AsyncPipelineCompiler.h>
+
+SCENARIO( " Scenario 1: Compile pipelines on worker threads" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::RenderPassCache          rpCache;
+    gvu::PipelineLayoutCache      plCache;
+
+    rpCache.init(window->getDevice());
+    plCache.init(window->getDevice());
+
+    gvu::ShaderModuleCreateInfo s_ci1(CMAKE_SOURCE_DIR "/share/shaders/model_attributes_MVP.vert.spv");
+    gvu::ShaderModuleCreateInfo s_ci2(CMAKE_SOURCE_DIR "/share/shaders/model_attributes_MVP.frag.spv");
+
+    auto _createShader = [dev = window->getDevice()](auto & C)
+    {
+        VkShaderModule mod = VK_NULL_HANDLE;
+        auto res = vkCreateShaderModule(dev, &C, nullptr, &mod);
+        assert(res == VK_SUCCESS);
+        (void)res;
+        return mod;
+    };
+
+    auto vert_s = s_ci1.create(_createShader);
+    auto frag_s = s_ci2.create(_createShader);
+
+    gvu::PipelineLayoutCreateInfo pci;
+    pci.pushConstantRanges.push_back(VkPushConstantRange{VK_SHADER_STAGE_VERTEX_BIT,0,128});
+
+    gvu::GraphicsPipelineCreateInfo gci;
+    gci.setVertexInputs({VK_FORMAT_R32G32B32_SFLOAT,VK_FORMAT_R32G32B32_SFLOAT,VK_FORMAT_R8G8B8A8_UNORM});
+    gci.vertexShader   = vert_s;
+    gci.fragmentShader = frag_s;
+    gci.renderPass     = rpCache.create( gvu::RenderPassCreateInfo::createSimpleRenderPass( {{VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}}) );
+    gci.pipelineLayout = plCache.create(pci);
+
+    gvu::ConcurrentGraphicsPipelineCache cache;
+    cache.init(window->getDevice(), window->getPhysicalDevice());
+
+    gvu::AsyncPipelineCompiler compiler;
+    compiler.init(&cache, 4);
+
+    REQUIRE( compiler.threadCount() == 4 );
+
+    constexpr uint32_t pipelineCount = 64;
+
+    std::vector<gvu::GraphicsPipelineCreateInfo> infos;
+    std::vector<gvu::AsyncPipelineCompiler::future_type> futures;
+    for(uint32_t i=0;i<pipelineCount;i++)
+    {
+        auto & c = infos.emplace_back(gci);
+        c.viewport.width = static_cast<float>(i+1);
+        futures.push_back( compiler.submit(c) );
+    }
+
+    // submitting the same pipelines again does not queue them twice
+    for(auto & c : infos)
+        compiler.submit(c);
+
+    compiler.waitIdle();
+
+    THEN("Each pipeline is compiled once")
+    {
+        REQUIRE( compiler.pendingCount() == 0 );
+        REQUIRE( cache.cacheSize() == pipelineCount );
+        REQUIRE( cache.missCount() == pipelineCount );
+
+        std::set<VkPipeline> unique;
+        for(uint32_t i=0;i<pipelineCount;i++)
+        {
+            REQUIRE( compiler.isReady(infos[i]) );
+            auto p = futures[i].get();
+            REQUIRE( p != VK_NULL_HANDLE );
+            REQUIRE( cache.getCreateInfo(p) == infos[i] );
+            unique.insert(p);
+        }
+        REQUIRE( unique.size() == pipelineCount );
+    }
+    THEN("Compiled pipelines are returned instead of the placeholder")
+    {
+        auto placeholder = futures[0].get();
+        REQUIRE( compiler.getOrPlaceholder(infos[5], placeholder) == futures[5].get() );
+    }
+    THEN("Pipelines which are not compiled yet return the placeholder")
+    {
+        auto placeholder = futures[0].get();
+        auto c = gci;
+        c.viewport.width = 1000.0f;
+
+        REQUIRE( !compiler.isReady(c) );
+        auto p = compiler.getOrPlaceholder(c, placeholder);
+
+        compiler.waitIdle();
+        REQUIRE( compiler.isReady(c) );
+
+        auto p2 = compiler.getOrPlaceholder(c, placeholder);
+        REQUIRE( p2 != placeholder );
+        REQUIRE( (p == placeholder || p == p2) );
+    }
+    THEN("Evicted pipelines are compiled again")
+    {
+        cache.nextFrame();
+        cache.nextFrame();
+        REQUIRE( cache.evictUnused(0) == pipelineCount );
+        REQUIRE( !compiler.isReady(infos[5]) );
+
+        compiler.getOrPlaceholder(infos[5], VK_NULL_HANDLE);
+        compiler.waitIdle();
+
+        REQUIRE( compiler.isReady(infos[5]) );
+        auto p = compiler.getOrPlaceholder(infos[5], VK_NULL_HANDLE);
+        REQUIRE( p != VK_NULL_HANDLE );
+        REQUIRE( cache.getCreateInfo(p) == infos[5] );
+    }
+    THEN("Initializing twice throws")
+    {
+        REQUIRE_THROWS_AS( compiler.init(&cache, 1), std::logic_error );
+        REQUIRE( compiler.threadCount() == 4 );
+    }
+    THEN("Submitting after destroy throws")
+    {
+        compiler.destroy();
+        auto c = gci;
+        c.viewport.width = 2000.0f;
+        REQUIRE_THROWS_AS( compiler.submit(c), std::logic_error );
+        compiler.waitIdle();
+    }
+
+    compiler.destroy();
+    cache.destroy();
+
+    vkDestroyShaderModule(window->getDevice(), vert_s, nullptr);
+    vkDestroyShaderModule(window->getDevice(), frag_s, nullptr);
+
+    plCache.destroy();
+    rpCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,95 @@
+#include<catch2/catch.hpp>
+
+#include "unit_helpers.h"
+#include <gvu/Managers/BarrierBuilder.h>
+#include <gvu/Managers/CommandPoolManager.h>
+
+SCENARIO( " Scenario 1: Infer access masks and aspects from layouts and formats" )
+{
+    THEN("The aspect mask is inferred from the format")
+    {
+        REQUIRE( gvu::BarrierBuilder::aspectMask(VK_FORMAT_R8G8B8A8_UNORM) == VK_IMAGE_ASPECT_COLOR_BIT );
+        REQUIRE( gvu::BarrierBuilder::aspectMask(VK_FORMAT_D32_SFLOAT) == VK_IMAGE_ASPECT_DEPTH_BIT );
+        REQUIRE( gvu::BarrierBuilder::aspectMask(VK_FORMAT_S8_UINT) == VK_IMAGE_ASPECT_STENCIL_BIT );
+        REQUIRE( gvu::BarrierBuilder::aspectMask(VK_FORMAT_D24_UNORM_S8_UINT) == (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT) );
+    }
+
+    THEN("An upload transition only waits on the transfer stage")
+    {
+        auto B = gvu::BarrierBuilder::imageBarrier(VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                   {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
+        REQUIRE( B.srcAccessMask == 0 );
+        REQUIRE( B.dstAccessMask == VK_ACCESS_TRANSFER_WRITE_BIT );
+        REQUIRE( gvu::BarrierBuilder::layoutAccess(VK_IMAGE_LAYOUT_UNDEFINED).stages == VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT );
+        REQUIRE( gvu::BarrierBuilder::layoutAccess(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL).stages == VK_PIPELINE_STAGE_TRANSFER_BIT );
+    }
+
+    THEN("Only writes are made available when leaving a layout")
+    {
+        auto B = gvu::BarrierBuilder::imageBarrier(VK_NULL_HANDLE, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                   {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
+        REQUIRE( B.srcAccessMask == VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT );
+        REQUIRE( (B.dstAccessMask & VK_ACCESS_SHADER_READ_BIT) );
+    }
+
+    THEN("Transitioning to the UNDEFINED layout throws")
+    {
+        REQUIRE_THROWS_AS( gvu::BarrierBuilder::imageBarrier(VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_UNDEFINED,
+                                                             {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}), std::invalid_argument );
+    }
+}
+
+SCENARIO( " Scenario 2: Collect many barriers into a single pipeline barrier" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::CommandPoolManager cpm;
+    cpm.init(window->getDevice(), window->getPhysicalDevice(), window->getGraphicsQueue());
+
+    gvu::BarrierBuilder B;
+    REQUIRE( B.empty() );
+
+    B.addImageBarrier(VK_NULL_HANDLE, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    B.addImageBarrier(VK_NULL_HANDLE, VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+    B.addBufferBarrier(VK_NULL_HANDLE, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                       VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,   VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+
+    THEN("The barriers are collected with inferred aspects")
+    {
+        REQUIRE( B.imageBarriers().size() == 2 );
+        REQUIRE( B.bufferBarriers().size() == 1 );
+        REQUIRE( B.imageBarriers()[0].subresourceRange.aspectMask == VK_IMAGE_ASPECT_COLOR_BIT );
+        REQUIRE( B.imageBarriers()[1].subresourceRange.aspectMask == VK_IMAGE_ASPECT_DEPTH_BIT );
+    }
+
+    THEN("The stage masks are the union of the barriers, not ALL_COMMANDS")
+    {
+        REQUIRE( !(B.srcStageMask() & VK_PIPELINE_STAGE_ALL_COMMANDS_BIT) );
+        REQUIRE( (B.srcStageMask() & VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT) );
+        REQUIRE( (B.srcStageMask() & VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT) );
+        REQUIRE( (B.srcStageMask() & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) );
+        REQUIRE( (B.dstStageMask() & VK_PIPELINE_STAGE_VERTEX_INPUT_BIT) );
+    }
+
+    WHEN("The barriers are flushed into a command buffer")
+    {
+        auto cmd = cpm.allocateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+        B.flush(cmd);
+        vkEndCommandBuffer(cmd);
+
+        THEN("The builder is cleared")
+        {
+            REQUIRE( B.empty() );
+            REQUIRE( B.srcStageMask() == 0 );
+            REQUIRE( B.dstStageMask() == 0 );
+        }
+        cpm.freeCommandBuffer(cmd);
+    }
+
+    cpm.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
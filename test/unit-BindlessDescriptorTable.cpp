@@ -0,0 +1,187 @@
+#include<catch2/catch.hpp>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/DescriptorSetLayoutCache.h>
+#include <gvu/Cache/ImageViewCache.h>
+#include <gvu/Cache/SamplerCache.h>
+#include <gvu/Managers/BindlessDescriptorTable.h>
+
+// the table does not enable nullDescriptor, so every
+// descriptor written must refer to a real resource
+struct TestResources
+{
+    VkImage        image        = VK_NULL_HANDLE;
+    VkDeviceMemory imageMemory  = VK_NULL_HANDLE;
+    VkBuffer       buffer       = VK_NULL_HANDLE;
+    VkDeviceMemory bufferMemory = VK_NULL_HANDLE;
+
+    void destroy(VkDevice device)
+    {
+        vkDestroyImage(device, image, nullptr);
+        vkFreeMemory(device, imageMemory, nullptr);
+        vkDestroyBuffer(device, buffer, nullptr);
+        vkFreeMemory(device, bufferMemory, nullptr);
+    }
+};
+
+static VkDeviceMemory allocateMemory(VkDevice device, VkPhysicalDevice physicalDevice, VkMemoryRequirements const & req)
+{
+    VkPhysicalDeviceMemoryProperties props;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &props);
+
+    VkMemoryAllocateInfo ai = {};
+    ai.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    ai.allocationSize = req.size;
+    for(uint32_t i=0; i < props.memoryTypeCount; i++)
+    {
+        if(req.memoryTypeBits & (1u << i))
+        {
+            ai.memoryTypeIndex = i;
+            break;
+        }
+    }
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    vkAllocateMemory(device, &ai, nullptr, &memory);
+    return memory;
+}
+
+static TestResources createResources(VkDevice device, VkPhysicalDevice physicalDevice)
+{
+    TestResources R;
+
+    VkImageCreateInfo ici = {};
+    ici.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    ici.imageType     = VK_IMAGE_TYPE_2D;
+    ici.format        = VK_FORMAT_R8G8B8A8_UNORM;
+    ici.extent        = {4,4,1};
+    ici.mipLevels     = 1;
+    ici.arrayLayers   = 1;
+    ici.samples       = VK_SAMPLE_COUNT_1_BIT;
+    ici.tiling        = VK_IMAGE_TILING_OPTIMAL;
+    ici.usage         = VK_IMAGE_USAGE_SAMPLED_BIT;
+    ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    REQUIRE( vkCreateImage(device, &ici, nullptr, &R.image) == VK_SUCCESS );
+
+    VkMemoryRequirements req;
+    vkGetImageMemoryRequirements(device, R.image, &req);
+    R.imageMemory = allocateMemory(device, physicalDevice, req);
+    vkBindImageMemory(device, R.image, R.imageMemory, 0);
+
+    VkBufferCreateInfo bci = {};
+    bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bci.size  = 256;
+    bci.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    REQUIRE( vkCreateBuffer(device, &bci, nullptr, &R.buffer) == VK_SUCCESS );
+
+    vkGetBufferMemoryRequirements(device, R.buffer, &req);
+    R.bufferMemory = allocateMemory(device, physicalDevice, req);
+    vkBindBufferMemory(device, R.buffer, R.bufferMemory, 0);
+    return R;
+}
+
+SCENARIO( " Scenario 1: Create a bindless descriptor table" )
+{
+    auto window = createWindow(1024,768);
+    auto device = window->getDevice();
+
+    gvu::DescriptorSetLayoutCache dlayoutCache;
+    gvu::ImageViewCache           viewCache;
+    gvu::SamplerCache             samplerCache;
+    dlayoutCache.init(device);
+    viewCache.init(device);
+    samplerCache.init(device);
+
+    auto res     = createResources(device, window->getPhysicalDevice());
+    auto view    = viewCache.create(gvu::ImageViewCreateInfo::createSimpleImageView(res.image, VK_FORMAT_R8G8B8A8_UNORM));
+    auto sampler = samplerCache.create(gvu::SamplerCreateInfo());
+    REQUIRE( view != VK_NULL_HANDLE );
+    REQUIRE( sampler != VK_NULL_HANDLE );
+
+    gvu::BindlessDescriptorTable table;
+    table.init(device, &dlayoutCache, 64, 8, 64, 2);
+
+    REQUIRE( table.getLayout() != VK_NULL_HANDLE );
+    REQUIRE( table.getDescriptorSet() != VK_NULL_HANDLE );
+
+    THEN("The layout uses the descriptor indexing flags")
+    {
+        auto info = dlayoutCache.getCreateInfo(table.getLayout());
+        REQUIRE( info.bindings.size() == 3 );
+        REQUIRE( info.bindingFlags.size() == 3 );
+        REQUIRE( info.hasBindingFlag(VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT) );
+        REQUIRE( (info.bindingFlags[2] & VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT) );
+        REQUIRE( (info.flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT) );
+    }
+
+    WHEN("Resources are added")
+    {
+        auto i0 = table.addImage(view);
+        auto i1 = table.addImage(view);
+        auto s0 = table.addSampler(sampler);
+        auto b0 = table.addBuffer(res.buffer);
+        table.flush();
+
+        THEN("Each array hands out its own slots")
+        {
+            REQUIRE( i0 == 0 );
+            REQUIRE( i1 == 1 );
+            REQUIRE( s0 == 0 );
+            REQUIRE( b0 == 0 );
+            REQUIRE( table.imageCount() == 2 );
+        }
+
+        WHEN("An image is removed")
+        {
+            table.removeImage(i0);
+
+            THEN("The slot is not reused until framesInFlight frames have passed")
+            {
+                table.nextFrame();
+                REQUIRE( table.addImage(view) == 2 );
+
+                table.nextFrame();
+                REQUIRE( table.addImage(view) == i0 );
+            }
+        }
+
+        THEN("Removing a slot that was never allocated throws")
+        {
+            REQUIRE_THROWS_AS( table.removeBuffer(10), std::out_of_range );
+        }
+
+        THEN("Removing a slot twice throws")
+        {
+            table.removeBuffer(b0);
+            REQUIRE_THROWS_AS( table.removeBuffer(b0), std::logic_error );
+
+            // the slot is only freed once
+            table.nextFrame();
+            table.nextFrame();
+            REQUIRE( table.addBuffer(res.buffer) == b0 );
+            REQUIRE( table.addBuffer(res.buffer) == 1 );
+        }
+    }
+
+    WHEN("An array is full")
+    {
+        for(uint32_t i=0; i < 8; i++)
+            table.addSampler(sampler);
+
+        THEN("Adding another resource throws")
+        {
+            REQUIRE_THROWS_AS( table.addSampler(sampler), std::length_error );
+        }
+    }
+
+    table.destroy();
+    samplerCache.destroy();
+    viewCache.destroy();
+    dlayoutCache.destroy();
+    res.destroy(device);
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,189 @@
+#include<catch2/catch.hpp>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/SamplerCache.h>
+#include <gvu/Managers/TimelineTracker.h>
+
+static gvu::SamplerCreateInfo samplerInfo(float lodBias)
+{
+    gvu::SamplerCreateInfo S;
+    S.mipLodBias = lodBias;
+    return S;
+}
+
+SCENARIO( " Scenario 1: Evict the least recently used objects when over budget" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::SamplerCache cache;
+    cache.init(window->getDevice());
+    cache.setBudget(2, 1);
+
+    auto A = cache.create(samplerInfo(0));
+    cache.nextFrame();
+    auto B = cache.create(samplerInfo(1));
+    cache.nextFrame();
+    auto C = cache.create(samplerInfo(2));
+    REQUIRE( cache.cacheSize() == 3 );
+    REQUIRE( cache.totalCost() == 3 );
+
+    WHEN("The next frame starts")
+    {
+        cache.nextFrame();
+
+        THEN("The oldest object is evicted")
+        {
+            REQUIRE( cache.cacheSize() == 2 );
+            REQUIRE( cache.evictionCount() == 1 );
+            REQUIRE( !cache.touch(A) );
+            REQUIRE( cache.touch(B) );
+            REQUIRE( cache.create(samplerInfo(2)) == C );
+        }
+    }
+
+    WHEN("The oldest object is used again before the next frame")
+    {
+        REQUIRE( cache.create(samplerInfo(0)) == A );
+        cache.nextFrame();
+
+        THEN("The next oldest object is evicted instead")
+        {
+            REQUIRE( cache.touch(A) );
+            REQUIRE( !cache.touch(B) );
+        }
+    }
+
+    WHEN("The oldest object is pinned")
+    {
+        REQUIRE( cache.pin(A) );
+        cache.nextFrame();
+
+        THEN("It is not evicted")
+        {
+            REQUIRE( cache.touch(A) );
+            REQUIRE( !cache.touch(B) );
+            REQUIRE( cache.unpin(A) );
+            REQUIRE( !cache.unpin(A) );
+        }
+    }
+
+    WHEN("The create info of an object is read before it is evicted")
+    {
+        auto info = cache.getCreateInfo(A);
+        cache.nextFrame();
+
+        THEN("The copy outlives the object")
+        {
+            REQUIRE( !cache.touch(A) );
+            REQUIRE( info == samplerInfo(0) );
+        }
+        THEN("Objects can be touched only if their create info matches")
+        {
+            REQUIRE( cache.touch(B, samplerInfo(1).hash()) );
+            REQUIRE( !cache.touch(B, samplerInfo(2).hash()) );
+        }
+    }
+
+    cache.destroy();
+    REQUIRE( cache.totalCost() == 0 );
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 2: Recently used objects are never evicted" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::SamplerCache cache;
+    cache.init(window->getDevice());
+    cache.setBudget(1, 2);
+
+    auto hot = cache.create(samplerInfo(0));
+    for(int i=1; i < 10; i++)
+    {
+        cache.create(samplerInfo(float(i)));
+        REQUIRE( cache.create(samplerInfo(0)) == hot );
+        cache.nextFrame();
+    }
+
+    THEN("The hot object is still cached and the cold ones are gone")
+    {
+        REQUIRE( cache.touch(hot) );
+        REQUIRE( cache.cacheSize() <= 3 );
+        REQUIRE( cache.evictionCount() >= 7 );
+    }
+
+    THEN("evictUnused removes everything which has not been used recently")
+    {
+        cache.nextFrame();
+        cache.nextFrame();
+        // the budget has already evicted one of the two objects left
+        REQUIRE( cache.evictUnused(0) == 1 );
+        REQUIRE( cache.cacheSize() == 0 );
+    }
+
+    cache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 3: Defer the destruction of evicted objects until the GPU is done" )
+{
+    auto window = createWindow(1024,768);
+    auto device = window->getDevice();
+
+    gvu::TimelineTracker T;
+    T.init(device);
+
+    gvu::SamplerCache cache;
+    cache.init(device);
+    cache.setRetireFunction([&](std::function<void()> destroy)
+    {
+        T.onSubmittedComplete(std::move(destroy));
+    });
+
+    auto A = cache.create(samplerInfo(0));
+
+    // a submission which uses A
+    auto value = T.nextValue();
+
+    cache.nextFrame();
+    REQUIRE( cache.evictUnused(0) == 1 );
+
+    THEN("The object is removed from the cache but not destroyed yet")
+    {
+        REQUIRE( !cache.touch(A) );
+        REQUIRE( cache.cacheSize() == 0 );
+        REQUIRE( T.pendingCount() == 1 );
+    }
+
+    WHEN("The submission completes")
+    {
+        VkSemaphoreSignalInfo si = {};
+        si.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+        si.semaphore = T.getSemaphore();
+        si.value     = value;
+        vkSignalSemaphore(device, &si);
+        T.update();
+
+        THEN("The object is destroyed")
+        {
+            REQUIRE( T.pendingCount() == 0 );
+        }
+    }
+
+    cache.destroy();
+    T.wait(value);
+    T.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
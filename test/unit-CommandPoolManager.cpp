@@ -0,0 +1,87 @@
+#include<catch2/catch.hpp>
+
+#include "unit_helpers.h"
+#include <gvu/Managers/CommandPoolManager.h>
+
+SCENARIO( " Scenario 1: Fences and command buffers are recycled" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::CommandPoolManager cpm;
+    cpm.init(window->getDevice(), window->getPhysicalDevice(), window->getGraphicsQueue());
+
+    VkCommandBuffer first = VK_NULL_HANDLE;
+    cpm.beginRecording([&](VkCommandBuffer cmd)
+    {
+        first = cmd;
+    }, true);
+
+    // the scoped fence has gone out of scope
+    REQUIRE( cpm.freeFenceCount() == 1 );
+    REQUIRE( cpm.freeCommandBufferCount() == 1 );
+
+    THEN("The next recording reuses them")
+    {
+        VkCommandBuffer second = VK_NULL_HANDLE;
+        auto fence = cpm.beginRecording([&](VkCommandBuffer cmd)
+        {
+            second = cmd;
+        }, true);
+
+        REQUIRE( second == first );
+        REQUIRE( cpm.freeFenceCount() == 0 );
+        REQUIRE( cpm.freeCommandBufferCount() == 0 );
+    }
+
+    WHEN("Work is submitted asynchronously")
+    {
+        int completed = 0;
+        auto id1 = cpm.beginRecordingAsync([](VkCommandBuffer){}, [&](){ ++completed; });
+        auto id2 = cpm.beginRecordingAsync([](VkCommandBuffer){}, [&](){ ++completed; });
+
+        REQUIRE( id2 > id1 );
+        REQUIRE( cpm.inFlightCount() == 2 );
+        REQUIRE( completed == 0 );
+
+        THEN("collect() retires the finished submissions")
+        {
+            vkQueueWaitIdle(window->getGraphicsQueue());
+
+            REQUIRE( cpm.poll(id1) );
+            REQUIRE( cpm.collect() == 2 );
+            REQUIRE( completed == 2 );
+            REQUIRE( cpm.inFlightCount() == 0 );
+            REQUIRE( cpm.freeFenceCount() == 2 );
+            REQUIRE( cpm.freeCommandBufferCount() == 2 );
+            REQUIRE( cpm.poll(id2) );
+        }
+    }
+
+    WHEN("A completion callback submits more work")
+    {
+        int completed = 0;
+        cpm.beginRecordingAsync([](VkCommandBuffer){}, [&]()
+        {
+            ++completed;
+            cpm.beginRecordingAsync([](VkCommandBuffer){}, [&](){ ++completed; });
+        });
+
+        vkQueueWaitIdle(window->getGraphicsQueue());
+        REQUIRE( cpm.collect() >= 1 );
+
+        THEN("The new submission is retired by the next collect()")
+        {
+            vkQueueWaitIdle(window->getGraphicsQueue());
+            cpm.collect();
+            REQUIRE( completed == 2 );
+            REQUIRE( cpm.inFlightCount() == 0 );
+        }
+    }
+
+    cpm.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,250 @@
+#include<catch2/catch.hpp>
+
+#include <cstring>
+#include <string>
+#include "unit_helpers.h"
+#include <gvu/Cache/PipelineLayoutCache.h>
+#include <gvu/Cache/GraphicsPipelineCache.h>
+#include <gvu/Cache/ComputePipelineCache.h>
+#include <gvu/ShaderReflection.h>
+#include <gvu/spirvPipelineReflector.h>
+
+/*
+ * Hand assembled SPIR-V of:
+ *
+ * #version 450
+ * layout(local_size_x_id = 0, local_size_y = 4) in; // x defaults to 64
+ * layout(constant_id = 1) const bool  USE_FOG = false;
+ * layout(constant_id = 2) const float SCALE   = 1.5;
+ * void main() {}
+ */
+static const uint32_t computeCode[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000000f, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0005000f, 0x00000005,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00060010, 0x00000001, 0x00000011,
+    0x00000040, 0x00000004, 0x00000001, 0x00040005, 0x00000001, 0x6e69616d,
+    0x00000000, 0x00040005, 0x0000000b, 0x5f455355, 0x00474f46, 0x00040005,
+    0x0000000d, 0x4c414353, 0x00000045, 0x00040047, 0x00000005, 0x00000001,
+    0x00000000, 0x00040047, 0x00000009, 0x0000000b, 0x00000019, 0x00040047,
+    0x0000000b, 0x00000001, 0x00000001, 0x00040047, 0x0000000d, 0x00000001,
+    0x00000002, 0x00020013, 0x00000002, 0x00030021, 0x00000003, 0x00000002,
+    0x00040015, 0x00000004, 0x00000020, 0x00000000, 0x00040032, 0x00000004,
+    0x00000005, 0x00000040, 0x0004002b, 0x00000004, 0x00000006, 0x00000004,
+    0x0004002b, 0x00000004, 0x00000007, 0x00000001, 0x00040017, 0x00000008,
+    0x00000004, 0x00000003, 0x00060033, 0x00000008, 0x00000009, 0x00000005,
+    0x00000006, 0x00000007, 0x00020014, 0x0000000a, 0x00030031, 0x0000000a,
+    0x0000000b, 0x00030016, 0x0000000c, 0x00000020, 0x00040032, 0x0000000c,
+    0x0000000d, 0x3fc00000, 0x00050036, 0x00000002, 0x00000001, 0x00000000,
+    0x00000003, 0x000200f8, 0x0000000e, 0x000100fd, 0x00010038,
+};
+static const size_t computeCodeSize = sizeof(computeCode) / sizeof(uint32_t);
+
+SCENARIO( " Scenario 1: Reflect the workgroup size of a compute shader" )
+{
+    auto R = gvu::ShaderReflection::reflect(computeCode, computeCodeSize);
+
+    REQUIRE( R.stage == VK_SHADER_STAGE_COMPUTE_BIT );
+    REQUIRE( R.workgroupSize[0] == 64 );
+    REQUIRE( R.workgroupSize[1] == 4 );
+    REQUIRE( R.workgroupSize[2] == 1 );
+    REQUIRE( R.workgroupSizeSpecIds[0] == 0 );
+    REQUIRE( R.workgroupSizeSpecIds[1] == gvu::ShaderReflection::noSpecId );
+    REQUIRE( R.workgroupSizeSpecIds[2] == gvu::ShaderReflection::noSpecId );
+
+    THEN("The specialization constants are reflected")
+    {
+        REQUIRE( R.specializationConstants.size() == 3 );
+
+        auto & X = R.specializationConstants[0];
+        REQUIRE( X.constantID == 0 );
+        REQUIRE( X.size == 4 );
+        REQUIRE( X.format == VK_FORMAT_R32_UINT );
+        REQUIRE( X.defaultValue == 64 );
+
+        auto & F = R.specializationConstants[1];
+        REQUIRE( F.constantID == 1 );
+        REQUIRE( F.boolean == 1 );
+        REQUIRE( F.size == sizeof(VkBool32) );
+        REQUIRE( F.defaultValue == 0 );
+        REQUIRE( std::string(R.getName(F.name)) == "USE_FOG" );
+
+        auto & S = R.specializationConstants[2];
+        REQUIRE( S.constantID == 2 );
+        REQUIRE( S.format == VK_FORMAT_R32_SFLOAT );
+        float scale;
+        std::memcpy(&scale, &S.defaultValue, sizeof(scale));
+        REQUIRE( scale == 1.5f );
+    }
+
+    THEN("The workgroup size and constants are serialized")
+    {
+        auto blob = R.serialize();
+        gvu::ShaderReflection D;
+        D.deserialize(blob.data(), blob.size());
+        REQUIRE( D.stage == VK_SHADER_STAGE_COMPUTE_BIT );
+        REQUIRE( D.workgroupSize == R.workgroupSize );
+        REQUIRE( D.workgroupSizeSpecIds == R.workgroupSizeSpecIds );
+        REQUIRE( D.specializationConstants.size() == 3 );
+    }
+
+    THEN("The pipeline reflector has the compute stage")
+    {
+        gvu::spirvPipelineReflector P;
+        P.addSPIRVCode(computeCode, computeCodeSize, VK_SHADER_STAGE_COMPUTE_BIT);
+        REQUIRE( P.workgroupSize == R.workgroupSize );
+        REQUIRE( P.workgroupSizeSpecIds == R.workgroupSizeSpecIds );
+        REQUIRE( P.compute.specializationConstants.size() == 3 );
+        REQUIRE( P.getSpecializationConstantID("SCALE") == 2 );
+        REQUIRE( P.getSpecializationConstantID("MISSING") == gvu::ShaderReflection::noSpecId );
+    }
+}
+
+SCENARIO( " Scenario 2: Specialization constants do not depend on the order they are set" )
+{
+    gvu::SpecializationConstants A;
+    A.set(2, 1.5f);
+    A.set(0, uint32_t(128));
+    A.set(1, true);
+
+    gvu::InlineSpecializationConstants B;
+    B.set(1, true);
+    B.set(0, uint32_t(128));
+    B.set(2, 1.5f);
+
+    REQUIRE( A.size() == 3 );
+    REQUIRE( A.entries[0].constantID == 0 );
+    REQUIRE( A.entries[2].constantID == 2 );
+    REQUIRE( A.entries[2].offset == 8 );
+    REQUIRE( A.hash() == B.hash() );
+    REQUIRE( A.get<uint32_t>(0) == 128 );
+    REQUIRE( A.get<VkBool32>(1) == VK_TRUE );
+    REQUIRE( A.get<float>(2) == 1.5f );
+    REQUIRE( A.get<uint32_t>(3, 7) == 7 );
+
+    WHEN("A constant is changed")
+    {
+        B.set(0, uint32_t(256));
+        THEN("The hash changes")
+        {
+            REQUIRE( A.hash() != B.hash() );
+            REQUIRE( B.get<uint32_t>(0) == 256 );
+        }
+    }
+
+    WHEN("A constant is set with a different size")
+    {
+        A.set(1, uint64_t(5));
+        THEN("The following constants are moved")
+        {
+            REQUIRE( A.data.size() == 16 );
+            REQUIRE( A.get<uint64_t>(1) == 5 );
+            REQUIRE( A.get<float>(2) == 1.5f );
+            REQUIRE( A.get<uint32_t>(0) == 128 );
+        }
+    }
+
+    WHEN("A constant is erased")
+    {
+        REQUIRE( A.erase(1) );
+        REQUIRE( !A.erase(1) );
+        THEN("The data is compacted")
+        {
+            REQUIRE( A.data.size() == 8 );
+            REQUIRE( A.entries[1].offset == 4 );
+            REQUIRE( A.get<float>(2) == 1.5f );
+        }
+    }
+
+    WHEN("An inline set of constants is full")
+    {
+        for(uint32_t i=3; i < gvu::InlineSpecializationConstants::maxConstants; i++)
+            B.set(i, i);
+        auto h = B.hash();
+
+        THEN("Setting another constant throws and leaves it unchanged")
+        {
+            REQUIRE_THROWS_AS( B.set(16, uint32_t(1)), std::length_error );
+            REQUIRE( B.size() == 16 );
+            REQUIRE( B.data.size() == 16 * sizeof(uint32_t) );
+            REQUIRE( B.hash() == h );
+            REQUIRE( B.get<uint32_t>(15) == 15 );
+            REQUIRE( !B.contains(16) );
+        }
+        THEN("An existing constant can still change size")
+        {
+            B.set(3, uint64_t(9));
+            REQUIRE( B.size() == 16 );
+            REQUIRE( B.get<uint64_t>(3) == 9 );
+            REQUIRE( B.get<uint32_t>(4) == 4 );
+        }
+    }
+}
+
+SCENARIO( " Scenario 3: Create compute pipelines through the graphics VkPipelineCache" )
+{
+    auto window = createWindow(1024,768);
+    auto device = window->getDevice();
+
+    gvu::PipelineLayoutCache plCache;
+    plCache.init(device);
+
+    gvu::ShaderModuleCreateInfo s_ci;
+    s_ci.setCode(computeCode, computeCodeSize);
+    auto shader = s_ci.create([device](auto & C)
+    {
+        VkShaderModule mod = VK_NULL_HANDLE;
+        auto res = vkCreateShaderModule(device, &C, nullptr, &mod);
+        assert(res == VK_SUCCESS);
+        (void)res;
+        return mod;
+    });
+
+    auto layout = plCache.create(gvu::PipelineLayoutCreateInfo{});
+
+    gvu::GraphicsPipelineCache graphicsCache;
+    graphicsCache.init(device, window->getPhysicalDevice());
+
+    gvu::ComputePipelineCache cache;
+    cache.init(device, graphicsCache.getPipelineCache());
+    REQUIRE( cache.getPipelineCache() == graphicsCache.getPipelineCache() );
+
+    gvu::ComputePipelineCreateInfo A;
+    A.computeShader  = shader;
+    A.pipelineLayout = layout;
+    A.specialization.set(0, uint32_t(256));
+
+    auto B = A;
+    B.specialization.set(1, true);
+
+    auto pA = cache.create(A);
+    auto pB = cache.create(B);
+    REQUIRE( pA != VK_NULL_HANDLE );
+    REQUIRE( pA != pB );
+    REQUIRE( cache.create(A) == pA );
+    REQUIRE( cache.cacheSize() == 2 );
+    REQUIRE( cache.missCount() == 2 );
+    REQUIRE( cache.hitCount() == 1 );
+    REQUIRE( cache.getCreateInfo(pB) == B );
+
+    THEN("The generated create info points to the specialization data")
+    {
+        A.create([&](VkComputePipelineCreateInfo const & info)
+        {
+            REQUIRE( info.stage.stage == VK_SHADER_STAGE_COMPUTE_BIT );
+            REQUIRE( info.stage.pSpecializationInfo != nullptr );
+            REQUIRE( info.stage.pSpecializationInfo->mapEntryCount == 1 );
+            REQUIRE( info.stage.pSpecializationInfo->dataSize == sizeof(uint32_t) );
+            return 0;
+        });
+    }
+
+    cache.destroy();
+    graphicsCache.destroy();
+    vkDestroyShaderModule(device, shader, nullptr);
+    plCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,183 @@
+#include<catch2/catch.hpp>
+#include <fstream>
+#include <thread>
+#include <atomic>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/SamplerCache.h>
+#include <gvu/Cache/DescriptorSetLayoutCache.h>
+
+SCENARIO( " Scenario 1: Create the same samplers from multiple threads" )
+{
+    // create a default window and initialize all vulkan
+    // objects.
+    auto window = createWindow(1024,768);
+
+    using CacheType = gvu::ConcurrentSamplerCache;
+
+    CacheType cache;
+    cache.init(window->getDevice());
+
+    constexpr uint32_t threadCount  = 8;
+    constexpr uint32_t samplerCount = 32;
+
+    // each thread will ask for the same set of samplers
+    std::vector< std::vector<VkSampler> > results(threadCount);
+    std::vector< std::thread > threads;
+    std::atomic<bool> start = false;
+
+    for(uint32_t t=0;t<threadCount;t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            while(!start);
+            for(uint32_t i=0;i<samplerCount;i++)
+            {
+                CacheType::createInfo_type ci;
+                ci.maxLod = static_cast<float>(i);
+                results[t].push_back(cache.create(ci));
+            }
+        });
+    }
+    start = true;
+    for(auto & t : threads)
+        t.join();
+
+    THEN("Only one object is created per create info")
+    {
+        REQUIRE( cache.cacheSize() == samplerCount);
+    }
+    THEN("All threads received the same objects")
+    {
+        for(uint32_t t=1;t<threadCount;t++)
+        {
+            REQUIRE( results[t] == results[0] );
+        }
+    }
+    THEN("Objects can be looked up from their handle")
+    {
+        REQUIRE( cache.getCreateInfo(results[0][5]).maxLod == 5.0f );
+    }
+
+    // Destroy the cache
+    cache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+
+}
+
+SCENARIO( " Scenario 2: Concurrent cache behaves like the regular cache on a single thread" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::ConcurrentDescriptorSetLayoutCache cache;
+    cache.init(window->getDevice());
+
+    gvu::DescriptorSetLayoutCreateInfo ci;
+    ci.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3, VK_SHADER_STAGE_VERTEX_BIT|VK_SHADER_STAGE_FRAGMENT_BIT,nullptr});
+
+    auto layout  = cache.create(ci);
+    auto layout2 = cache.create(ci);
+
+    REQUIRE(layout == layout2);
+
+    auto ci2 = ci;
+    ci2.bindings.emplace_back(VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_VERTEX_BIT|VK_SHADER_STAGE_FRAGMENT_BIT,nullptr});
+    auto layout3 = cache.create(ci2);
+
+    REQUIRE(layout != layout3);
+    REQUIRE(cache.cacheSize() == 2);
+    REQUIRE(cache.hitCount() == 1);
+    REQUIRE(cache.missCount() == 2);
+
+    THEN("A failed creation is a miss and not a hit")
+    {
+        auto ci3 = ci2;
+        ci3.flags = 1;
+        REQUIRE_THROWS_AS( cache.create(ci3, [](auto &){ return VkDescriptorSetLayout(VK_NULL_HANDLE); }), std::runtime_error );
+        REQUIRE(cache.hitCount() == 1);
+        REQUIRE(cache.missCount() == 3);
+        REQUIRE(cache.cacheSize() == 2);
+    }
+
+    cache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 3: Handle lookups while other threads destroy objects" )
+{
+    auto window = createWindow(1024,768);
+
+    using CacheType = gvu::ConcurrentSamplerCache;
+
+    CacheType cache;
+    cache.init(window->getDevice());
+
+    constexpr uint32_t threadCount  = 4;
+    constexpr uint32_t samplerCount = 16;
+    constexpr uint32_t iterations   = 200;
+
+    std::vector< std::thread > threads;
+    std::atomic<bool> start = false;
+
+    for(uint32_t t=0;t<threadCount;t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            while(!start);
+            for(uint32_t i=0;i<iterations;i++)
+            {
+                CacheType::createInfo_type ci;
+                ci.maxLod = static_cast<float>((i + t) % samplerCount);
+
+                VkSampler s = VK_NULL_HANDLE;
+                try
+                {
+                    s = cache.create(ci);
+                }
+                catch(std::runtime_error &)
+                {
+                    // removed by destroyIf while it was being created
+                    continue;
+                }
+                cache.touch(s);
+                cache.pin(s);
+                cache.unpin(s);
+                try
+                {
+                    auto info = cache.getCreateInfo(s);
+                    (void)info;
+                }
+                catch(std::out_of_range &)
+                {
+                    // destroyed by another thread
+                }
+                if(t == 0)
+                    cache.destroyIf([](auto const & x){ return x.maxLod < 4.0f; });
+            }
+        });
+    }
+    start = true;
+    for(auto & t : threads)
+        t.join();
+
+    THEN("The cache is still consistent")
+    {
+        REQUIRE( cache.cacheSize() <= samplerCount );
+        REQUIRE( cache.totalCost() == cache.cacheSize() );
+    }
+
+    cache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
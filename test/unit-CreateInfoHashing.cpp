@@ -0,0 +1,472 @@
+#include<catch2/catch.hpp>
+#include <random>
+#include <algorithm>
+#include <map>
+#include <cstring>
+#include <limits>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/SamplerCache.h>
+#include <gvu/Cache/DescriptorSetLayoutCache.h>
+#include <gvu/Cache/PipelineLayoutCache.h>
+#include <gvu/Cache/RenderPassCache.h>
+#include <gvu/ComputePipelineCreateInfo.h>
+
+// Property based tests for the hash/equality contract of the
+// CreateInfo structs.
+//
+// Random create infos are generated from small value domains so that
+// many of them are identical. Each create info is also encoded
+// field-by-field into a vector of integers which acts as the reference,
+// two create infos are the same object if and only if their encodings
+// are the same.
+
+namespace
+{
+
+using encoding_type = std::vector<uint64_t>;
+
+template<typename T>
+T pick(std::mt19937 & rng, std::initializer_list<T> values)
+{
+    std::uniform_int_distribution<size_t> d(0, values.size()-1);
+    return *(values.begin() + d(rng));
+}
+
+uint32_t range(std::mt19937 & rng, uint32_t lo, uint32_t hi)
+{
+    return std::uniform_int_distribution<uint32_t>(lo, hi)(rng);
+}
+
+template<typename T>
+T fakeHandle(uintptr_t i)
+{
+    return reinterpret_cast<T>( (i+1) * 0x100 );
+}
+
+uint64_t encodeFloat(float f)
+{
+    if(f == 0.0f)
+        return 0;
+    if(f != f)
+        return 1;
+    uint32_t b;
+    std::memcpy(&b, &f, sizeof(b));
+    return uint64_t(b) << 1;
+}
+
+//=============================================================================
+// Generators
+//=============================================================================
+// immutable sampler arrays. The first two hold the same samplers at
+// different addresses, so they must be the same layout
+VkSampler const * randomSamplers(std::mt19937 & rng)
+{
+    static VkSampler const arrays[3][2] = {{fakeHandle<VkSampler>(0), fakeHandle<VkSampler>(1)},
+                                           {fakeHandle<VkSampler>(0), fakeHandle<VkSampler>(1)},
+                                           {fakeHandle<VkSampler>(1), fakeHandle<VkSampler>(1)}};
+    return arrays[range(rng, 0, 2)];
+}
+
+gvu::DescriptorSetLayoutCreateInfo randomDescriptorSetLayout(std::mt19937 & rng)
+{
+    gvu::DescriptorSetLayoutCreateInfo ci;
+    ci.flags = range(rng, 0, 1);
+    auto n = range(rng, 0, 3);
+    for(uint32_t i=0;i<n;i++)
+    {
+        VkDescriptorSetLayoutBinding b = {};
+        b.binding            = range(rng, 0, 2);
+        b.descriptorType     = pick(rng, {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER});
+        b.descriptorCount    = range(rng, 1, 2);
+        b.stageFlags         = pick<VkShaderStageFlags>(rng, {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT});
+        b.pImmutableSamplers = range(rng, 0, 3) == 0 ? randomSamplers(rng) : nullptr;
+        ci.bindings.push_back(b);
+    }
+    if(range(rng, 0, 2) == 0)
+    {
+        for(uint32_t i=0;i<n;i++)
+            ci.bindingFlags.push_back( pick<VkDescriptorBindingFlags>(rng, {0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT}) );
+    }
+    return ci;
+}
+
+encoding_type encode(gvu::DescriptorSetLayoutCreateInfo const & ci)
+{
+    encoding_type e{ci.flags, ci.bindings.size()};
+    for(auto & b : ci.bindings)
+    {
+        e.insert(e.end(), {b.binding, uint64_t(b.descriptorType), b.descriptorCount, b.stageFlags});
+        // only sampler descriptors use the immutable samplers
+        bool samplers = b.pImmutableSamplers && b.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        e.push_back(samplers);
+        for(uint32_t i=0; samplers && i < b.descriptorCount; i++)
+            e.push_back(uint64_t(reinterpret_cast<uintptr_t>(b.pImmutableSamplers[i])));
+    }
+    e.push_back(ci.bindingFlags.size());
+    for(auto & f : ci.bindingFlags)
+        e.push_back(f);
+    return e;
+}
+
+gvu::PipelineLayoutCreateInfo randomPipelineLayout(std::mt19937 & rng)
+{
+    gvu::PipelineLayoutCreateInfo ci;
+    auto n = range(rng, 0, 2);
+    for(uint32_t i=0;i<n;i++)
+        ci.setLayouts.push_back( fakeHandle<VkDescriptorSetLayout>(range(rng,0,2)) );
+    auto m = range(rng, 0, 2);
+    for(uint32_t i=0;i<m;i++)
+    {
+        VkPushConstantRange r;
+        r.stageFlags = pick<VkShaderStageFlags>(rng, {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT});
+        r.offset     = pick<uint32_t>(rng, {0, 16});
+        r.size       = pick<uint32_t>(rng, {16, 32});
+        ci.pushConstantRanges.push_back(r);
+    }
+    return ci;
+}
+
+encoding_type encode(gvu::PipelineLayoutCreateInfo const & ci)
+{
+    encoding_type e{ci.flags, ci.setLayouts.size(), ci.pushConstantRanges.size()};
+    for(auto & l : ci.setLayouts)
+        e.push_back(uint64_t(reinterpret_cast<uintptr_t>(l)));
+    for(auto & r : ci.pushConstantRanges)
+        e.insert(e.end(), {r.stageFlags, r.offset, r.size});
+    return e;
+}
+
+VkAttachmentReference randomRef(std::mt19937 & rng)
+{
+    return { range(rng, 0, 1), pick(rng, {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL}) };
+}
+
+gvu::RenderPassCreateInfo randomRenderPass(std::mt19937 & rng)
+{
+    gvu::RenderPassCreateInfo ci;
+    auto n = range(rng, 0, 2);
+    for(uint32_t i=0;i<n;i++)
+    {
+        VkAttachmentDescription a = {};
+        a.format      = pick(rng, {VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_D32_SFLOAT});
+        a.samples     = VK_SAMPLE_COUNT_1_BIT;
+        a.loadOp      = pick(rng, {VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_LOAD_OP_LOAD});
+        a.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        ci.attachments.push_back(a);
+    }
+    auto s = range(rng, 1, 2);
+    for(uint32_t i=0;i<s;i++)
+    {
+        auto & sp = ci.subpasses.emplace_back();
+        auto c = range(rng, 0, 1);
+        for(uint32_t j=0;j<c;j++)
+            sp.colorAttachments.push_back(randomRef(rng));
+        if(range(rng,0,3) == 0)
+            sp.inputAttachments.push_back(randomRef(rng));
+        if(range(rng,0,3) == 0)
+            sp.resolveAttachments.push_back(randomRef(rng));
+        if(range(rng,0,1) == 0)
+            sp.depthStencilAttachment = randomRef(rng);
+        if(range(rng,0,3) == 0)
+            sp.preserveAttachments.push_back(range(rng,0,1));
+    }
+    if(range(rng,0,1) == 0)
+    {
+        VkSubpassDependency d = {};
+        d.srcSubpass   = VK_SUBPASS_EXTERNAL;
+        d.dstSubpass   = 0;
+        d.srcStageMask = pick<VkPipelineStageFlags>(rng, {VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT});
+        d.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        ci.dependencies.push_back(d);
+    }
+    return ci;
+}
+
+void encodeRefs(encoding_type & e, std::vector<VkAttachmentReference> const & refs)
+{
+    e.push_back(refs.size());
+    for(auto & r : refs)
+        e.insert(e.end(), {r.attachment, uint64_t(r.layout)});
+}
+
+encoding_type encode(gvu::RenderPassCreateInfo const & ci)
+{
+    encoding_type e{ci.flags, ci.attachments.size()};
+    for(auto & a : ci.attachments)
+    {
+        e.insert(e.end(), {a.flags, uint64_t(a.format), uint64_t(a.samples), uint64_t(a.loadOp), uint64_t(a.storeOp),
+                           uint64_t(a.stencilLoadOp), uint64_t(a.stencilStoreOp), uint64_t(a.initialLayout), uint64_t(a.finalLayout)});
+    }
+    e.push_back(ci.subpasses.size());
+    for(auto & s : ci.subpasses)
+    {
+        e.insert(e.end(), {s.flags, uint64_t(s.pipelineBindPoint)});
+        encodeRefs(e, s.inputAttachments);
+        encodeRefs(e, s.colorAttachments);
+        encodeRefs(e, s.resolveAttachments);
+        e.push_back(s.depthStencilAttachment.has_value());
+        if(s.depthStencilAttachment)
+            e.insert(e.end(), {s.depthStencilAttachment->attachment, uint64_t(s.depthStencilAttachment->layout)});
+        e.push_back(s.preserveAttachments.size());
+        e.insert(e.end(), s.preserveAttachments.begin(), s.preserveAttachments.end());
+    }
+    e.push_back(ci.dependencies.size());
+    for(auto & d : ci.dependencies)
+    {
+        e.insert(e.end(), {d.srcSubpass, d.dstSubpass, d.srcStageMask, d.dstStageMask, d.srcAccessMask, d.dstAccessMask, d.dependencyFlags});
+    }
+    return e;
+}
+
+gvu::SamplerCreateInfo randomSampler(std::mt19937 & rng)
+{
+    gvu::SamplerCreateInfo ci;
+    ci.magFilter    = pick(rng, {VK_FILTER_LINEAR, VK_FILTER_NEAREST});
+    ci.addressModeU = pick(rng, {VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE});
+    ci.mipLodBias   = pick(rng, {0.0f, -0.0f, 1.0f});
+    ci.maxLod       = pick(rng, {0.0f, 4.0f, VK_LOD_CLAMP_NONE, std::numeric_limits<float>::quiet_NaN()});
+    return ci;
+}
+
+encoding_type encode(gvu::SamplerCreateInfo const & ci)
+{
+    return { ci.flags, uint64_t(ci.magFilter), uint64_t(ci.minFilter), uint64_t(ci.mipmapMode),
+             uint64_t(ci.addressModeU), uint64_t(ci.addressModeV), uint64_t(ci.addressModeW),
+             encodeFloat(ci.mipLodBias), ci.anisotropyEnable, encodeFloat(ci.maxAnisotropy),
+             ci.compareEnable, uint64_t(ci.compareOp), encodeFloat(ci.minLod), encodeFloat(ci.maxLod),
+             uint64_t(ci.borderColor), ci.unnormalizedCoordinates };
+}
+
+gvu::ComputePipelineCreateInfo randomComputePipeline(std::mt19937 & rng)
+{
+    gvu::ComputePipelineCreateInfo ci;
+    ci.computeShader  = fakeHandle<VkShaderModule>(range(rng,0,1));
+    ci.pipelineLayout = fakeHandle<VkPipelineLayout>(range(rng,0,1));
+
+    // the constants are set in a random order, which must not matter
+    std::vector<uint32_t> ids = {0, 1, 4};
+    std::shuffle(ids.begin(), ids.end(), rng);
+    for(auto id : ids)
+    {
+        switch(range(rng, 0, 3))
+        {
+            case 0: break;
+            case 1: ci.specialization.set(id, pick<uint32_t>(rng, {0, 64})); break;
+            case 2: ci.specialization.set(id, pick<uint64_t>(rng, {0, 64})); break;
+            case 3: ci.specialization.set(id, range(rng, 0, 1) == 1); break;
+        }
+    }
+    return ci;
+}
+
+encoding_type encode(gvu::ComputePipelineCreateInfo const & ci)
+{
+    encoding_type e{ci.flags, uint64_t(reinterpret_cast<uintptr_t>(ci.computeShader)), uint64_t(reinterpret_cast<uintptr_t>(ci.pipelineLayout))};
+    for(uint32_t id : {0u, 1u, 4u})
+    {
+        if(!ci.specialization.contains(id))
+            continue;
+        auto v32 = ci.specialization.get<uint32_t>(id, ~0u);
+        auto v64 = ci.specialization.get<uint64_t>(id, ~uint64_t(0));
+        e.insert(e.end(), {id, v32, v64});
+    }
+    return e;
+}
+
+//=============================================================================
+// Properties
+//=============================================================================
+template<typename CreateInfo_t, typename Generator_t>
+std::vector<CreateInfo_t> generate(Generator_t && g, size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<CreateInfo_t> out;
+    for(size_t i=0;i<count;i++)
+        out.push_back(g(rng));
+    return out;
+}
+
+template<typename CreateInfo_t>
+void checkContract(std::vector<CreateInfo_t> const & samples)
+{
+    for(auto & a : samples)
+    {
+        // reflexive, and copies are equal
+        REQUIRE( a == a );
+        auto b = a;
+        REQUIRE( b == a );
+        REQUIRE( b.hash() == a.hash() );
+
+        // sealing does not change the hash or equality
+        b.seal();
+        REQUIRE( b.hash() == a.hash() );
+        REQUIRE( b == a );
+        REQUIRE( a == b );
+    }
+
+    for(size_t i=0;i<samples.size();i++)
+    {
+        for(size_t j=i+1;j<samples.size();j++)
+        {
+            auto & a = samples[i];
+            auto & b = samples[j];
+            bool expected = encode(a) == encode(b);
+
+            REQUIRE( (a == b) == expected );
+            REQUIRE( (b == a) == expected );
+            if(expected)
+            {
+                REQUIRE( a.hash() == b.hash() );
+            }
+        }
+    }
+}
+
+template<typename Cache_t>
+void checkCache(std::vector<typename Cache_t::createInfo_type> const & samples, VkDevice device)
+{
+    Cache_t cache;
+    cache.init(device);
+
+    std::map<encoding_type, typename Cache_t::object_type> expected;
+    for(auto & s : samples)
+    {
+        auto obj = cache.create(s);
+        auto [it, inserted] = expected.emplace(encode(s), obj);
+
+        // the same create info returns the same object
+        REQUIRE( it->second == obj );
+
+        // the stored create info is the one that was used
+        REQUIRE( encode(cache.getCreateInfo(obj)) == it->first );
+    }
+
+    // different create infos always create different objects
+    REQUIRE( cache.cacheSize() == expected.size() );
+
+    cache.destroy();
+}
+
+}
+
+SCENARIO( " Scenario 1: The hash/equality contract holds for random create infos" )
+{
+    constexpr size_t sampleCount = 300;
+
+    auto seed = GENERATE(1u, 2u, 3u);
+
+    WHEN("Generating DescriptorSetLayoutCreateInfos")
+    {
+        checkContract( generate<gvu::DescriptorSetLayoutCreateInfo>(randomDescriptorSetLayout, sampleCount, seed) );
+    }
+    WHEN("Generating PipelineLayoutCreateInfos")
+    {
+        checkContract( generate<gvu::PipelineLayoutCreateInfo>(randomPipelineLayout, sampleCount, seed) );
+    }
+    WHEN("Generating RenderPassCreateInfos")
+    {
+        checkContract( generate<gvu::RenderPassCreateInfo>(randomRenderPass, sampleCount, seed) );
+    }
+    WHEN("Generating SamplerCreateInfos")
+    {
+        checkContract( generate<gvu::SamplerCreateInfo>(randomSampler, sampleCount, seed) );
+    }
+    WHEN("Generating ComputePipelineCreateInfos")
+    {
+        checkContract( generate<gvu::ComputePipelineCreateInfo>(randomComputePipeline, sampleCount, seed) );
+    }
+}
+
+SCENARIO( " Scenario 2: The caches create exactly one object per distinct create info" )
+{
+    auto window = createWindow(1024,768);
+
+    constexpr size_t sampleCount = 1000;
+    constexpr uint32_t seed      = 1234;
+
+    checkCache<gvu::DescriptorSetLayoutCache>( generate<gvu::DescriptorSetLayoutCreateInfo>(randomDescriptorSetLayout, sampleCount, seed), window->getDevice() );
+    checkCache<gvu::PipelineLayoutCache>(      generate<gvu::PipelineLayoutCreateInfo>(randomPipelineLayout, sampleCount, seed),           window->getDevice() );
+    checkCache<gvu::RenderPassCache>(          generate<gvu::RenderPassCreateInfo>(randomRenderPass, sampleCount, seed),                   window->getDevice() );
+    checkCache<gvu::SamplerCache>(             generate<gvu::SamplerCreateInfo>(randomSampler, sampleCount, seed),                         window->getDevice() );
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 3: Known collisions are not treated as equal" )
+{
+    GIVEN("Two descriptor set layouts with a different number of bindings")
+    {
+        gvu::DescriptorSetLayoutCreateInfo a, b;
+        a.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr});
+        b = a;
+        b.bindings.emplace_back(VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr});
+        REQUIRE( !(a == b) );
+    }
+    GIVEN("Two descriptor set layouts with different flags")
+    {
+        gvu::DescriptorSetLayoutCreateInfo a, b;
+        b.flags = 1;
+        REQUIRE( !(a == b) );
+    }
+    GIVEN("Two descriptor set layouts with different binding indices")
+    {
+        gvu::DescriptorSetLayoutCreateInfo a, b;
+        a.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr});
+        b.bindings.emplace_back(VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr});
+        REQUIRE( !(a == b) );
+        REQUIRE( a.hash() != b.hash() );
+    }
+    GIVEN("Two descriptor set layouts with immutable samplers")
+    {
+        VkSampler s0[2] = {fakeHandle<VkSampler>(0), fakeHandle<VkSampler>(1)};
+        VkSampler s1[2] = {fakeHandle<VkSampler>(0), fakeHandle<VkSampler>(1)};
+
+        gvu::DescriptorSetLayoutCreateInfo a, b;
+        a.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_SAMPLER, 2, VK_SHADER_STAGE_FRAGMENT_BIT, s0});
+        b.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_SAMPLER, 2, VK_SHADER_STAGE_FRAGMENT_BIT, s1});
+
+        THEN("They are compared by the samplers, not by the address of the array")
+        {
+            REQUIRE( a == b );
+            REQUIRE( a.hash() == b.hash() );
+
+            s1[1] = fakeHandle<VkSampler>(2);
+            REQUIRE( !(a == b) );
+            REQUIRE( a.hash() != b.hash() );
+        }
+    }
+    GIVEN("Two subpasses where only one has a depth attachment")
+    {
+        gvu::SubpassDescription a, b;
+        b.depthStencilAttachment = VkAttachmentReference{0, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+        REQUIRE( !(a == b) );
+        REQUIRE( !(b == a) );
+    }
+    GIVEN("Two render passes with a different number of attachments")
+    {
+        auto a = gvu::RenderPassCreateInfo::createSimpleRenderPass( {{VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}});
+        auto b = a;
+        b.attachments.push_back(a.attachments[0]);
+        REQUIRE( !(a == b) );
+        REQUIRE( !(b == a) );
+    }
+    GIVEN("A subpass description created from a VkSubpassDescription with resolve attachments")
+    {
+        VkAttachmentReference color   = {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        VkAttachmentReference resolve = {1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        VkSubpassDescription d = {};
+        d.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        d.colorAttachmentCount = 1;
+        d.pColorAttachments    = &color;
+        d.pResolveAttachments  = &resolve;
+
+        gvu::SubpassDescription s(d);
+        REQUIRE( s.colorAttachments.size() == 1 );
+        REQUIRE( s.resolveAttachments.size() == 1 );
+        REQUIRE( s.resolveAttachments[0].attachment == 1 );
+    }
+}
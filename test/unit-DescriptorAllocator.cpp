@@ -0,0 +1,181 @@
+#include<catch2/catch.hpp>
+#include <set>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/DescriptorSetLayoutCache.h>
+#include <gvu/Managers/DescriptorAllocator.h>
+
+SCENARIO( " Scenario 1: Allocate descriptor sets of multiple layouts from shared pools" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::DescriptorSetLayoutCache dlayoutCache;
+    dlayoutCache.init(window->getDevice());
+
+    gvu::DescriptorSetLayoutCreateInfo dci1;
+    dci1.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT,nullptr});
+    auto dLayout1 = dlayoutCache.create(dci1);
+
+    gvu::DescriptorSetLayoutCreateInfo dci2;
+    dci2.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT,nullptr});
+    dci2.bindings.emplace_back(VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, VK_SHADER_STAGE_FRAGMENT_BIT,nullptr});
+    auto dLayout2 = dlayoutCache.create(dci2);
+
+    gvu::DescriptorAllocator alloc;
+    alloc.init(window->getDevice(), &dlayoutCache, 4, 2.0f, 16);
+
+    REQUIRE( alloc.allocatedPoolCount() == 0 );
+    REQUIRE( alloc.setsPerPool() == 4 );
+
+    std::vector<VkDescriptorSet> sets(4);
+    alloc.allocateDescriptorSets(dLayout1, sets.data(), 4);
+    sets.push_back( alloc.allocateDescriptorSet(dLayout2) );
+
+    THEN("The pool sizes are shared between the layouts")
+    {
+        auto sizes = alloc.getPoolSizes(10);
+        REQUIRE( sizes.size() == 2 );
+        for(auto & s : sizes)
+        {
+            if(s.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+                REQUIRE( s.descriptorCount == 10 );
+            if(s.type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+                REQUIRE( s.descriptorCount == 20 );
+        }
+
+        // a single set always fits
+        for(auto & s : alloc.getPoolSizes(1))
+        {
+            if(s.type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+                REQUIRE( s.descriptorCount == 4 );
+        }
+    }
+
+    THEN("Each new pool is larger than the previous one")
+    {
+        // pool 1 holds 4 sets, pool 2 holds 8
+        REQUIRE( alloc.allocatedPoolCount() == 2 );
+        REQUIRE( alloc.setsPerPool() == 16 );
+
+        std::vector<VkDescriptorSet> more(7+16+16);
+        alloc.allocateDescriptorSets(dLayout2, more.data(), static_cast<uint32_t>(more.size()));
+
+        // pool 3 and 4 are capped at 16 sets
+        REQUIRE( alloc.allocatedPoolCount() == 4 );
+        REQUIRE( alloc.setsPerPool() == 16 );
+
+        std::set<VkDescriptorSet> unique(more.begin(), more.end());
+        unique.insert(sets.begin(), sets.end());
+        REQUIRE( unique.size() == more.size() + sets.size() );
+        REQUIRE( unique.count(VK_NULL_HANDLE) == 0 );
+
+        WHEN("The pools are reset")
+        {
+            alloc.resetPools();
+            REQUIRE( alloc.retiredPoolCount() == 0 );
+
+            THEN("They are reused")
+            {
+                std::vector<VkDescriptorSet> again(4+8+16+16);
+                alloc.allocateDescriptorSets(dLayout1, again.data(), static_cast<uint32_t>(again.size()));
+                REQUIRE( alloc.allocatedPoolCount() == 4 );
+            }
+        }
+    }
+
+    alloc.destroy();
+    dlayoutCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 2: Pools created before a new descriptor type are replaced on reset" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::DescriptorSetLayoutCache dlayoutCache;
+    dlayoutCache.init(window->getDevice());
+
+    gvu::DescriptorSetLayoutCreateInfo dci1;
+    dci1.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT,nullptr});
+    auto dLayout1 = dlayoutCache.create(dci1);
+
+    gvu::DescriptorSetLayoutCreateInfo dci2;
+    dci2.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2, VK_SHADER_STAGE_COMPUTE_BIT,nullptr});
+    auto dLayout2 = dlayoutCache.create(dci2);
+
+    gvu::DescriptorAllocator alloc;
+    alloc.init(window->getDevice(), &dlayoutCache, 4, 1.0f, 4);
+
+    // the first pool only has uniform buffers
+    alloc.allocateDescriptorSet(dLayout1);
+    REQUIRE( alloc.allocatedPoolCount() == 1 );
+
+    WHEN("A layout with a new descriptor type is allocated from the same pool")
+    {
+        auto set = alloc.allocateDescriptorSet(dLayout2);
+
+        THEN("The pool is retired and a new pool is created")
+        {
+            REQUIRE( set != VK_NULL_HANDLE );
+            REQUIRE( alloc.allocatedPoolCount() == 2 );
+        }
+    }
+
+    WHEN("The pools are reset before the new layout is allocated")
+    {
+        // register the new layout while the old pool is retired
+        std::vector<VkDescriptorSet> sets(3);
+        alloc.allocateDescriptorSets(dLayout1, sets.data(), 3);
+        alloc.allocateDescriptorSet(dLayout2);
+        REQUIRE( alloc.allocatedPoolCount() == 2 );
+
+        alloc.resetPools();
+
+        THEN("The stale pool is destroyed and every set still fits")
+        {
+            REQUIRE( alloc.allocatedPoolCount() == 1 );
+            REQUIRE( alloc.allocateDescriptorSet(dLayout2) != VK_NULL_HANDLE );
+            REQUIRE( alloc.allocateDescriptorSet(dLayout1) != VK_NULL_HANDLE );
+        }
+    }
+
+    alloc.destroy();
+    dlayoutCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 3: Descriptor indexing layouts are rejected" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::DescriptorSetLayoutCache dlayoutCache;
+    dlayoutCache.init(window->getDevice());
+
+    gvu::DescriptorSetLayoutCreateInfo dci;
+    dci.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 16, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr});
+    dci.bindingFlags = {VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT};
+    auto dLayout = dlayoutCache.create(dci);
+
+    gvu::DescriptorAllocator alloc;
+    alloc.init(window->getDevice(), &dlayoutCache);
+
+    REQUIRE_THROWS_AS( alloc.allocateDescriptorSet(dLayout), std::invalid_argument );
+    REQUIRE( alloc.allocatedPoolCount() == 0 );
+
+    alloc.destroy();
+    dlayoutCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
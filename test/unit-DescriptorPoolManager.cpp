@@ -1,5 +1,6 @@
 #include<catch2/catch.hpp>
 #include <fstream>
+#include <set>
 
 #include "unit_helpers.h"
 #include <gvu/Cache/DescriptorSetLayoutCache.h>
@@ -63,3 +64,61 @@ SCENARIO( " Scenario 1: Create a DescriptorSetLayout" )
 
 }
 
+
+SCENARIO( " Scenario 2: Allocate many descriptor sets at once" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::DescriptorSetLayoutCache dlayoutCache;
+    dlayoutCache.init(window->getDevice());
+
+    gvu::DescriptorSetLayoutCreateInfo dci;
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT,nullptr});
+    auto dLayout1 = dlayoutCache.create(dci);
+
+    gvu::DescriptorPoolManager poolManager;
+    poolManager.init(window->getDevice(), &dlayoutCache, dLayout1, 4);
+
+    // one partially used pool
+    auto s0 = poolManager.allocateDescriptorSet();
+
+    // fills the first pool, then two more pools
+    auto sets = poolManager.allocateDescriptorSets(10);
+
+    REQUIRE( sets.size() == 10 );
+    REQUIRE( poolManager.allocatedPoolCount() == 3 );
+
+    std::set<VkDescriptorSet> unique(sets.begin(), sets.end());
+    unique.insert(s0);
+    REQUIRE( unique.size() == 11 );
+    REQUIRE( unique.count(VK_NULL_HANDLE) == 0 );
+
+    REQUIRE( poolManager.getPool(sets[0]) == poolManager.getPool(s0) );
+    REQUIRE( poolManager.getPool(sets[2]) == poolManager.getPool(s0) );
+    REQUIRE( poolManager.getPool(sets[3]) != poolManager.getPool(s0) );
+    REQUIRE( poolManager.getPool(sets[3]) == poolManager.getPool(sets[6]) );
+    REQUIRE( poolManager.getPool(sets[7]) != poolManager.getPool(sets[6]) );
+
+    WHEN("A full pool is released and reset")
+    {
+        auto p = poolManager.getPool(sets[3]);
+        for(uint32_t i=3;i<7;i++)
+            poolManager.releaseToPool(sets[i]);
+
+        THEN("The pool is reused before a new pool is created")
+        {
+            auto more = poolManager.allocateDescriptorSets(5);
+            REQUIRE( poolManager.allocatedPoolCount() == 3 );
+            REQUIRE( poolManager.getPool(more[0]) == p );
+            REQUIRE( poolManager.getPool(more[3]) == p );
+        }
+    }
+
+    poolManager.destroy();
+    dlayoutCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
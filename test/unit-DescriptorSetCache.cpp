@@ -0,0 +1,129 @@
+#include<catch2/catch.hpp>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/DescriptorSetLayoutCache.h>
+#include <gvu/Cache/SamplerCache.h>
+#include <gvu/Cache/DescriptorSetCache.h>
+
+SCENARIO( " Scenario 1: Cache descriptor sets by their contents" )
+{
+    auto window = createWindow(1024,768);
+    auto device = window->getDevice();
+
+    gvu::DescriptorSetLayoutCache dlayoutCache;
+    gvu::SamplerCache             samplerCache;
+    dlayoutCache.init(device);
+    samplerCache.init(device);
+
+    gvu::DescriptorSetLayoutCreateInfo dci;
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT,nullptr});
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT,nullptr});
+    auto layout = dlayoutCache.create(dci);
+
+    gvu::SamplerCreateInfo sci;
+    auto sampler1 = samplerCache.create(sci);
+    sci.magFilter = VK_FILTER_NEAREST;
+    auto sampler2 = samplerCache.create(sci);
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+    {
+        VkBufferCreateInfo bci = {};
+        bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bci.size  = 1024;
+        bci.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        REQUIRE( vkCreateBuffer(device, &bci, nullptr, &buffer) == VK_SUCCESS );
+    }
+
+    gvu::DescriptorSetCache cache;
+    cache.init(device, &dlayoutCache, 2, 4, 8);
+
+    gvu::DescriptorSetContents C1;
+    C1.layout = layout;
+    C1.setBuffer(0, buffer, 0, 256);
+    C1.setSampler(1, sampler1);
+
+    auto C2 = C1;
+    C2.writes[1].sampler = sampler2;
+
+    auto s1 = cache.get(C1);
+    auto s2 = cache.get(C2);
+
+    REQUIRE( s1 != VK_NULL_HANDLE );
+    REQUIRE( s1 != s2 );
+    REQUIRE( cache.missCount() == 2 );
+
+    THEN("Identical contents return the same set")
+    {
+        auto C3 = C1;
+        REQUIRE( cache.get(C3) == s1 );
+        REQUIRE( cache.hitCount() == 1 );
+        REQUIRE( cache.cacheSize() == 2 );
+    }
+
+    THEN("Different buffer ranges return different sets")
+    {
+        auto C3 = C1;
+        C3.writes[0].offset = 256;
+        REQUIRE( cache.get(C3) != s1 );
+        REQUIRE( cache.cacheSize() == 3 );
+    }
+
+    THEN("Sets which are not used are released")
+    {
+        for(uint32_t i=0;i<4;i++)
+        {
+            cache.get(C1);
+            cache.nextFrame();
+        }
+        REQUIRE( cache.cacheSize() == 2 );
+
+        cache.get(C1);
+        cache.nextFrame();
+
+        // C2 has not been used for 5 frames
+        REQUIRE( cache.cacheSize() == 1 );
+        REQUIRE( cache.get(C1) == s1 );
+        cache.get(C2);
+        REQUIRE( cache.missCount() == 3 );
+    }
+
+    THEN("The least recently used sets are released when the cache is full")
+    {
+        std::vector<gvu::DescriptorSetContents> contents;
+        for(uint32_t i=0;i<10;i++)
+        {
+            auto & C = contents.emplace_back(C1);
+            C.writes[0].offset = 256 * (i+1);
+            cache.get(C);
+        }
+        REQUIRE( cache.cacheSize() == 12 );
+
+        // nothing can be released while it may still be in use
+        cache.nextFrame();
+        cache.nextFrame();
+        REQUIRE( cache.cacheSize() == 12 );
+
+        cache.get(C1);
+        cache.nextFrame();
+        REQUIRE( cache.cacheSize() == 8 );
+        REQUIRE( cache.get(C1) == s1 );
+    }
+
+    THEN("Contents can be released manually")
+    {
+        REQUIRE( cache.release(C1) );
+        REQUIRE( !cache.release(C1) );
+        REQUIRE( cache.cacheSize() == 1 );
+    }
+
+    cache.destroy();
+    vkDestroyBuffer(device, buffer, nullptr);
+
+    samplerCache.destroy();
+    dlayoutCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -1,8 +1,10 @@
 #include<catch2/catch.hpp>
 #include <fstream>
+#include <memory>
 
 #include "unit_helpers.h"
 #include <gvu/Cache/DescriptorSetLayoutCache.h>
+#include <gvu/Cache/SamplerCache.h>
 
 SCENARIO( " Scenario 1: Create a DescriptorSetLayout" )
 {
@@ -37,6 +39,11 @@ SCENARIO( " Scenario 1: Create a DescriptorSetLayout" )
 
     REQUIRE(layout != layout3);
 
+    // reverse lookups return the create info that was used
+    REQUIRE(cache.getCreateInfo(layout3).bindings.size() == 2);
+    REQUIRE(cache.getCreateInfo(layout).bindings.size() == 1);
+    REQUIRE_THROWS(cache.getCreateInfo(VK_NULL_HANDLE));
+
     // destroy the pools
     cache.destroy();
 
@@ -47,3 +54,57 @@ SCENARIO( " Scenario 1: Create a DescriptorSetLayout" )
 
 }
 
+
+SCENARIO( " Scenario 2: Immutable samplers are owned by the cache" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::SamplerCache samplerCache;
+    samplerCache.init(window->getDevice());
+
+    gvu::SamplerCreateInfo sci;
+    auto s0 = samplerCache.create(sci);
+    sci.magFilter = VK_FILTER_NEAREST;
+    auto s1 = samplerCache.create(sci);
+
+    gvu::DescriptorSetLayoutCache cache;
+    cache.init(window->getDevice());
+
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    {
+        auto samplers = std::make_unique<VkSampler[]>(2);
+        samplers[0] = s0;
+        samplers[1] = s1;
+
+        gvu::DescriptorSetLayoutCreateInfo ci;
+        ci.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_SAMPLER, 2, VK_SHADER_STAGE_FRAGMENT_BIT, samplers.get()});
+        layout = cache.create(ci);
+        REQUIRE( layout != VK_NULL_HANDLE );
+    }
+
+    WHEN("The same samplers are used from a different array after the first one was freed")
+    {
+        std::vector<VkSampler> samplers = {s0, s1};
+
+        gvu::DescriptorSetLayoutCreateInfo ci;
+        ci.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_SAMPLER, 2, VK_SHADER_STAGE_FRAGMENT_BIT, samplers.data()});
+
+        THEN("The same layout is returned")
+        {
+            REQUIRE( cache.create(ci) == layout );
+            REQUIRE( cache.cacheSize() == 1 );
+
+            auto stored = cache.getCreateInfo(layout);
+            REQUIRE( stored.bindings[0].pImmutableSamplers != samplers.data() );
+            REQUIRE( stored.bindings[0].pImmutableSamplers[1] == s1 );
+        }
+    }
+
+    cache.destroy();
+    samplerCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,102 @@
+#include<catch2/catch.hpp>
+#include <cstring>
+#include <cstddef>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/DescriptorSetLayoutCache.h>
+#include <gvu/Cache/DescriptorUpdateTemplateCache.h>
+
+namespace
+{
+// matches the layout of the template generated for dci below
+struct Set0
+{
+    VkDescriptorBufferInfo camera;      // binding 0, offset 0
+    VkDescriptorImageInfo  textures[2]; // binding 1, offset 24
+    VkBufferView           texels;      // binding 2, offset 72
+};
+}
+
+SCENARIO( " Scenario 1: Create descriptor update templates from a set layout" )
+{
+    auto window = createWindow(1024,768);
+    auto device = window->getDevice();
+
+    gvu::DescriptorSetLayoutCache       dlayoutCache;
+    gvu::DescriptorUpdateTemplateCache  templateCache;
+    dlayoutCache.init(device);
+    templateCache.init(device);
+
+    gvu::DescriptorSetLayoutCreateInfo dci;
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         1, VK_SHADER_STAGE_VERTEX_BIT,  nullptr});
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, VK_SHADER_STAGE_FRAGMENT_BIT,nullptr});
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{2, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,   1, VK_SHADER_STAGE_FRAGMENT_BIT,nullptr});
+    auto layout = dlayoutCache.create(dci);
+
+    gvu::DescriptorUpdateTemplateCreateInfo T(dci, layout);
+
+    THEN("The entries are packed in binding order")
+    {
+        REQUIRE( T.entries.size() == 3 );
+        REQUIRE( T.entries[0].offset == offsetof(Set0, camera) );
+        REQUIRE( T.entries[1].offset == offsetof(Set0, textures) );
+        REQUIRE( T.entries[1].stride == sizeof(VkDescriptorImageInfo) );
+        REQUIRE( T.entries[1].descriptorCount == 2 );
+        REQUIRE( T.entries[2].offset == offsetof(Set0, texels) );
+        REQUIRE( T.dataSize() == sizeof(Set0) );
+    }
+
+    THEN("Bindings declared out of order are still packed in binding order")
+    {
+        gvu::DescriptorSetLayoutCreateInfo reversed;
+        reversed.bindings.assign(dci.bindings.rbegin(), dci.bindings.rend());
+        auto layout2 = dlayoutCache.create(reversed);
+
+        gvu::DescriptorUpdateTemplateCreateInfo R(reversed, layout2);
+        REQUIRE( R.entries.size() == 3 );
+        REQUIRE( R.findEntry(0)->offset == offsetof(Set0, camera) );
+        REQUIRE( R.findEntry(1)->offset == offsetof(Set0, textures) );
+        REQUIRE( R.findEntry(2)->offset == offsetof(Set0, texels) );
+        REQUIRE( R.dataSize() == sizeof(Set0) );
+    }
+
+    THEN("The template is cached")
+    {
+        auto t1 = templateCache.create(T);
+        auto T2 = T;
+        REQUIRE( t1 != VK_NULL_HANDLE );
+        REQUIRE( templateCache.create(T2) == t1 );
+
+        T2.entries[1].descriptorCount = 1;
+        REQUIRE( templateCache.create(T2) != t1 );
+        REQUIRE( templateCache.cacheSize() == 2 );
+    }
+
+    THEN("DescriptorUpdateData writes to the same offsets as the struct")
+    {
+        Set0 S = {};
+        S.camera      = {VK_NULL_HANDLE, 16, 256};
+        S.textures[1] = {VK_NULL_HANDLE, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        S.texels      = VK_NULL_HANDLE;
+
+        gvu::DescriptorUpdateData D(T);
+        D.setBuffer(0, S.camera);
+        D.setImage(1, S.textures[1], 1);
+        D.setTexelBuffer(2, S.texels);
+
+        REQUIRE( D.size() == sizeof(S) );
+        REQUIRE( std::memcmp(D.data(), &S, sizeof(S)) == 0 );
+
+        REQUIRE_THROWS( D.setImage(0, S.textures[0]) );
+        REQUIRE_THROWS( D.setImage(1, S.textures[0], 2) );
+        REQUIRE_THROWS( D.setBuffer(3, S.camera) );
+    }
+
+    templateCache.destroy();
+    dlayoutCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,58 @@
+#include<catch2/catch.hpp>
+
+#include <gvu/FormatInfo.h>
+
+static_assert( gvu::getFormatInfo(VK_FORMAT_R8G8B8A8_UNORM).blockSizeInBits == 32, "getFormatInfo must be constexpr" );
+static_assert( gvu::getFormatImageSize(VK_FORMAT_R8G8B8A8_UNORM, {4,4,1}, 3) == 64 + 16 + 4, "getFormatImageSize must be constexpr" );
+
+SCENARIO( " Scenario 1: Look up the format info of core and extension formats" )
+{
+    THEN("Core formats are found")
+    {
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_R8_UNORM).blockSizeInBits == 8 );
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_R32G32B32_SFLOAT).blockSizeInBits == 96 );
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_D24_UNORM_S8_UINT).flags == (gvu::FORMAT_SIZE_DEPTH_BIT | gvu::FORMAT_SIZE_STENCIL_BIT) );
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_BC1_RGB_UNORM_BLOCK).blockWidth == 4 );
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_ASTC_12x12_SRGB_BLOCK).blockHeight == 12 );
+    }
+
+    THEN("Extension formats are found")
+    {
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG).blockWidth == 8 );
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG).minBlocksX == 2 );
+#if defined(VK_VERSION_1_3)
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_ASTC_10x8_SFLOAT_BLOCK).blockWidth == 10 );
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_ASTC_10x8_SFLOAT_BLOCK).blockHeight == 8 );
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_A4B4G4R4_UNORM_PACK16).blockSizeInBits == 16 );
+#endif
+    }
+
+    THEN("Unknown formats have a block size of 0")
+    {
+        REQUIRE( gvu::getFormatInfo(VK_FORMAT_UNDEFINED).blockSizeInBits == 0 );
+        REQUIRE( gvu::getFormatInfo(static_cast<VkFormat>(999999)).blockSizeInBits == 0 );
+        REQUIRE( gvu::getFormatImageSize(static_cast<VkFormat>(999999), {16,16,1}) == 0 );
+    }
+}
+
+SCENARIO( " Scenario 2: Compute the size of images" )
+{
+    THEN("Block compressed rows are rounded up to whole blocks")
+    {
+        REQUIRE( gvu::getFormatRowPitch(VK_FORMAT_BC1_RGB_UNORM_BLOCK, 1) == 8 );
+        REQUIRE( gvu::getFormatRowPitch(VK_FORMAT_BC1_RGB_UNORM_BLOCK, 5) == 16 );
+        REQUIRE( gvu::getFormatMipLevelSize(VK_FORMAT_BC7_UNORM_BLOCK, {16,16,1}) == 16 * 16 );
+    }
+
+    THEN("Mip levels are never smaller than one block")
+    {
+        REQUIRE( gvu::getFormatMipLevelSize(VK_FORMAT_BC1_RGB_UNORM_BLOCK, {8,8,1}, 3) == 8 );
+        REQUIRE( gvu::getFormatMipLevelSize(VK_FORMAT_PVRTC1_4BPP_UNORM_BLOCK_IMG, {4,4,1}) == 2 * 2 * 8 );
+    }
+
+    THEN("Array layers and mip chains are included")
+    {
+        REQUIRE( gvu::getFormatImageSize(VK_FORMAT_R8G8B8A8_UNORM, {256,256,1}, 9, 6) == 6u * 4u * (65536 + 16384 + 4096 + 1024 + 256 + 64 + 16 + 4 + 1) );
+        REQUIRE( gvu::getFormatImageSize(VK_FORMAT_R16_SFLOAT, {8,8,8}, 2) == 8*8*8*2 + 4*4*4*2 );
+    }
+}
@@ -0,0 +1,105 @@
+#include<catch2/catch.hpp>
+#include <set>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/DescriptorSetLayoutCache.h>
+#include <gvu/Managers/FrameDescriptorAllocator.h>
+#include <gvu/Managers/BindlessDescriptorTable.h>
+
+SCENARIO( " Scenario 1: Allocate per-frame descriptor sets" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::DescriptorSetLayoutCache dlayoutCache;
+    dlayoutCache.init(window->getDevice());
+
+    gvu::DescriptorSetLayoutCreateInfo dci;
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT,nullptr});
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, VK_SHADER_STAGE_FRAGMENT_BIT,nullptr});
+    auto dLayout1 = dlayoutCache.create(dci);
+
+    gvu::FrameDescriptorAllocator alloc;
+    alloc.init(window->getDevice(), &dlayoutCache, dLayout1, 2, 8);
+
+    REQUIRE( alloc.frameCount() == 2 );
+    REQUIRE( alloc.currentFrame() == 0 );
+    REQUIRE( alloc.allocatedPoolCount() == 0 );
+
+    alloc.beginFrame(0);
+
+    std::vector<VkDescriptorSet> sets(20);
+    alloc.allocateDescriptorSets(sets.data(), 20);
+
+    std::set<VkDescriptorSet> unique(sets.begin(), sets.end());
+    REQUIRE( unique.size() == 20 );
+    REQUIRE( unique.count(VK_NULL_HANDLE) == 0 );
+    REQUIRE( alloc.allocatedPoolCount(0) == 3 );
+
+    WHEN("The next frame is started")
+    {
+        alloc.beginFrame(1);
+        REQUIRE( alloc.currentFrame() == 1 );
+
+        THEN("It uses its own pools")
+        {
+            alloc.allocateDescriptorSet();
+            REQUIRE( alloc.allocatedPoolCount(0) == 3 );
+            REQUIRE( alloc.allocatedPoolCount(1) == 1 );
+        }
+    }
+
+    WHEN("The frame is started again")
+    {
+        alloc.beginFrame(2);
+        REQUIRE( alloc.currentFrame() == 0 );
+
+        THEN("The pools are reused")
+        {
+            alloc.allocateDescriptorSets(sets.data(), 20);
+            REQUIRE( alloc.allocatedPoolCount(0) == 3 );
+            REQUIRE( alloc.allocatedPoolCount() == 3 );
+        }
+    }
+
+    alloc.destroy();
+    dlayoutCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 2: Allocate descriptor indexing sets" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::DescriptorSetLayoutCache dlayoutCache;
+    dlayoutCache.init(window->getDevice());
+
+    // update-after-bind bindings, the last one has a variable count
+    auto dLayout = dlayoutCache.create(gvu::BindlessDescriptorTable::generateLayoutCreateInfo(64, 8, 64));
+
+    gvu::FrameDescriptorAllocator alloc;
+    alloc.init(window->getDevice(), &dlayoutCache, dLayout, 2, 4);
+    alloc.beginFrame(0);
+
+    THEN("Sets are allocated from update-after-bind pools")
+    {
+        std::vector<VkDescriptorSet> sets(6);
+        alloc.allocateDescriptorSets(sets.data(), 6);
+
+        std::set<VkDescriptorSet> unique(sets.begin(), sets.end());
+        REQUIRE( unique.size() == 6 );
+        REQUIRE( unique.count(VK_NULL_HANDLE) == 0 );
+        REQUIRE( alloc.allocatedPoolCount(0) == 2 );
+    }
+
+    alloc.destroy();
+    dlayoutCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,156 @@
+#include<catch2/catch.hpp>
+
+#define VMA_IMPLEMENTATION
+#include <vk_mem_alloc.h>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/ImageCache.h>
+#include <gvu/Cache/ImageViewCache.h>
+#include <gvu/Cache/FramebufferCache.h>
+#include <gvu/Cache/RenderPassCache.h>
+
+SCENARIO( " Scenario 1: Cache image views and destroy single objects" )
+{
+    auto window = createWindow(1024,768);
+
+    VmaAllocatorCreateInfo ai = {};
+    ai.instance       = window->getInstance();
+    ai.physicalDevice = window->getPhysicalDevice();
+    ai.device         = window->getDevice();
+    VmaAllocator allocator = VK_NULL_HANDLE;
+    vmaCreateAllocator(&ai, &allocator);
+
+    gvu::ImageCache     imageCache;
+    gvu::ImageViewCache viewCache;
+    imageCache.init(window->getDevice(), allocator);
+    viewCache.init(window->getDevice());
+
+    auto image = imageCache.allocateImage(gvu::ImageCreateInfo::image2D(VK_FORMAT_D32_SFLOAT, {1024,768}, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT));
+
+    auto info = gvu::ImageViewCreateInfo::createSimpleImageView(image, VK_FORMAT_D32_SFLOAT);
+    REQUIRE( info.subresourceRange.aspectMask == VK_IMAGE_ASPECT_DEPTH_BIT );
+
+    auto view = viewCache.create(info);
+    REQUIRE( viewCache.create(info) == view );
+    REQUIRE( viewCache.cacheSize() == 1 );
+
+    WHEN("The view is destroyed")
+    {
+        REQUIRE( viewCache.destroy(view) );
+
+        THEN("It is removed from the cache")
+        {
+            REQUIRE( viewCache.cacheSize() == 0 );
+            REQUIRE_THROWS_AS( viewCache.getCreateInfo(view), std::out_of_range );
+            REQUIRE( !viewCache.destroy(view) );
+        }
+    }
+
+    viewCache.destroy();
+    imageCache.destroy();
+    vmaDestroyAllocator(allocator);
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 2: Build framebuffers from a render pass and its images" )
+{
+    auto window = createWindow(1024,768);
+
+    VmaAllocatorCreateInfo ai = {};
+    ai.instance       = window->getInstance();
+    ai.physicalDevice = window->getPhysicalDevice();
+    ai.device         = window->getDevice();
+    VmaAllocator allocator = VK_NULL_HANDLE;
+    vmaCreateAllocator(&ai, &allocator);
+
+    gvu::ImageCache       imageCache;
+    gvu::ImageViewCache   viewCache;
+    gvu::RenderPassCache  rpCache;
+    gvu::FramebufferCache fbCache;
+    imageCache.init(window->getDevice(), allocator);
+    viewCache.init(window->getDevice());
+    rpCache.init(window->getDevice());
+    fbCache.init(window->getDevice(), &viewCache);
+
+    imageCache.setImageDestroyedCallback([&](VkImage i)
+    {
+        fbCache.invalidateImage(i);
+    });
+
+    auto rpInfo = gvu::RenderPassCreateInfo::createSimpleRenderPass({{VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL}},
+                                                                    {VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL});
+    auto renderPass = rpCache.create(rpInfo);
+
+    auto color = imageCache.allocateImage(gvu::ImageCreateInfo::image2D(VK_FORMAT_R8G8B8A8_UNORM, {1024,768}, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT));
+    auto depth = imageCache.allocateImage(gvu::ImageCreateInfo::image2D(VK_FORMAT_D32_SFLOAT,     {1024,768}, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT));
+
+    auto fb = fbCache.create(renderPass, rpInfo, {color, depth}, {1024,768});
+
+    REQUIRE( fb != VK_NULL_HANDLE );
+    REQUIRE( fbCache.cacheSize() == 1 );
+    REQUIRE( viewCache.cacheSize() == 2 );
+    REQUIRE( fbCache.getCreateInfo(fb).attachments.size() == 2 );
+    REQUIRE( fbCache.getCreateInfo(fb).renderPass == renderPass );
+
+    THEN("Building the same framebuffer again returns the cached one")
+    {
+        REQUIRE( fbCache.create(renderPass, rpInfo, {color, depth}, {1024,768}) == fb );
+        REQUIRE( viewCache.cacheSize() == 2 );
+    }
+
+    THEN("The number of images must match the render pass")
+    {
+        REQUIRE_THROWS_AS( fbCache.create(renderPass, rpInfo, {color}, {1024,768}), std::invalid_argument );
+    }
+
+    WHEN("One of the images is invalidated")
+    {
+        REQUIRE( fbCache.invalidateImage(depth) == 1 );
+
+        THEN("Its views and the framebuffer are destroyed")
+        {
+            REQUIRE( fbCache.cacheSize() == 0 );
+            REQUIRE( viewCache.cacheSize() == 1 );
+        }
+    }
+
+    WHEN("The render pass is invalidated")
+    {
+        REQUIRE( fbCache.invalidateRenderPass(renderPass) == 1 );
+
+        THEN("The views are kept")
+        {
+            REQUIRE( fbCache.cacheSize() == 0 );
+            REQUIRE( viewCache.cacheSize() == 2 );
+        }
+    }
+
+    WHEN("The image cache destroys a resized render target")
+    {
+        imageCache.setMaxIdleFrames(0);
+        imageCache.returnImage(color);
+        imageCache.nextFrame();
+
+        THEN("The stale views and framebuffers are removed")
+        {
+            REQUIRE( imageCache.freeMemoryCount() == 1 );
+            REQUIRE( fbCache.cacheSize() == 0 );
+            REQUIRE( viewCache.cacheSize() == 1 );
+        }
+    }
+
+    fbCache.destroy();
+    viewCache.destroy();
+    imageCache.destroy();
+    rpCache.destroy();
+    vmaDestroyAllocator(allocator);
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,233 @@
+#include<catch2/catch.hpp>
+#include <fstream>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/RenderPassCache.h>
+#include <gvu/Cache/PipelineLayoutCache.h>
+#include <gvu/Cache/GraphicsPipelineCache.h>
+
+/**
+ * The shader modules, render pass and pipeline layout the
+ * pipelines in these tests are created with.
+ */
+struct PipelineObjects
+{
+    gvu::RenderPassCache     rpCache;
+    gvu::PipelineLayoutCache plCache;
+
+    VkShaderModule   vert_s         = VK_NULL_HANDLE;
+    VkShaderModule   frag_s         = VK_NULL_HANDLE;
+    VkRenderPass     renderPass     = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+    void init(VkDevice device)
+    {
+        rpCache.init(device);
+        plCache.init(device);
+
+        gvu::ShaderModuleCreateInfo s_ci1(CMAKE_SOURCE_DIR "/share/shaders/model_attributes_MVP.vert.spv");
+        gvu::ShaderModuleCreateInfo s_ci2(CMAKE_SOURCE_DIR "/share/shaders/model_attributes_MVP.frag.spv");
+
+        auto _createShader = [device](auto & C)
+        {
+            VkShaderModule mod = VK_NULL_HANDLE;
+            auto res = vkCreateShaderModule(device, &C, nullptr, &mod);
+            assert(res == VK_SUCCESS);
+            (void)res;
+            return mod;
+        };
+
+        vert_s = s_ci1.create(_createShader);
+        frag_s = s_ci2.create(_createShader);
+
+        renderPass = rpCache.create( gvu::RenderPassCreateInfo::createSimpleRenderPass( {{VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}},
+                                                                                        {VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL}) );
+
+        gvu::PipelineLayoutCreateInfo pci;
+        pci.pushConstantRanges.push_back(VkPushConstantRange{VK_SHADER_STAGE_VERTEX_BIT,0,128});
+        pipelineLayout = plCache.create(pci);
+    }
+
+    template<typename createInfo_t>
+    void apply(createInfo_t & gci) const
+    {
+        gci.setVertexInputs({VK_FORMAT_R32G32B32_SFLOAT,VK_FORMAT_R32G32B32_SFLOAT,VK_FORMAT_R8G8B8A8_UNORM});
+        gci.vertexShader   = vert_s;
+        gci.fragmentShader = frag_s;
+        gci.renderPass     = renderPass;
+        gci.pipelineLayout = pipelineLayout;
+        gci.dynamicStates  = {VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_VIEWPORT};
+    }
+
+    void destroy(VkDevice device)
+    {
+        vkDestroyShaderModule(device, vert_s, nullptr);
+        vkDestroyShaderModule(device, frag_s, nullptr);
+
+        plCache.destroy();
+        rpCache.destroy();
+    }
+};
+
+SCENARIO( " Scenario 1: Create pipelines using the GraphicsPipelineCache" )
+{
+    auto window = createWindow(1024,768);
+
+    PipelineObjects objects;
+    objects.init(window->getDevice());
+
+    gvu::GraphicsPipelineCreateInfo gci;
+    objects.apply(gci);
+
+    auto cacheFile = guv::fs::temp_directory_path() / "gvu_unit_pipeline_cache.bin";
+    guv::fs::remove(cacheFile);
+
+    gvu::GraphicsPipelineCache cache;
+    cache.init(window->getDevice(), window->getPhysicalDevice(), cacheFile);
+
+    REQUIRE( cache.getPipelineCache() != VK_NULL_HANDLE );
+    REQUIRE( !cache.loadedFromDisk() );
+
+    auto p1 = cache.create(gci);
+    auto p2 = cache.create(gci);
+
+    REQUIRE( p1 != VK_NULL_HANDLE );
+    REQUIRE( p1 == p2 );
+    REQUIRE( cache.missCount() == 1 );
+    REQUIRE( cache.hitCount() == 1 );
+
+    auto gci2 = gci;
+    gci2.enableDepthTest = true;
+    auto p3 = cache.create(gci2);
+    REQUIRE( p3 != p1 );
+    REQUIRE( cache.missCount() == 2 );
+    REQUIRE( cache.hitCount() == 1 );
+    REQUIRE( cache.cacheSize() == 2 );
+    REQUIRE( cache.getCreateInfo(p3) == gci2 );
+
+    // destroying writes the cache to disk
+    cache.destroy();
+    REQUIRE( guv::fs::exists(cacheFile) );
+
+    THEN("The pipeline cache is loaded the next time")
+    {
+        gvu::GraphicsPipelineCache cache2;
+        cache2.init(window->getDevice(), window->getPhysicalDevice(), cacheFile);
+        REQUIRE( cache2.loadedFromDisk() );
+        REQUIRE( cache2.cacheSize() == 0 );
+        cache2.destroy();
+    }
+    THEN("A cache file from a different device is ignored")
+    {
+        {
+            std::ofstream out(cacheFile, std::ios::binary | std::ios::trunc);
+            std::vector<char> garbage(64, 0x7f);
+            out.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+        }
+        gvu::GraphicsPipelineCache cache2;
+        cache2.init(window->getDevice(), window->getPhysicalDevice(), cacheFile);
+        REQUIRE( !cache2.loadedFromDisk() );
+        REQUIRE( cache2.getPipelineCache() != VK_NULL_HANDLE );
+        cache2.destroy();
+    }
+
+    guv::fs::remove(cacheFile);
+
+    objects.destroy(window->getDevice());
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 2: Create pipelines using the InlineGraphicsPipelineCache" )
+{
+    auto window = createWindow(1024,768);
+
+    PipelineObjects objects;
+    objects.init(window->getDevice());
+
+    gvu::InlineGraphicsPipelineCreateInfo gci;
+    objects.apply(gci);
+
+    {
+        // only generates the VkGraphicsPipelineCreateInfo, no pipeline is created
+        auto gci3 = gci;
+        gci3.outputColorTargets = 3;
+        gci3.create([](VkGraphicsPipelineCreateInfo & info)
+        {
+            REQUIRE( info.pVertexInputState->vertexAttributeDescriptionCount == 3 );
+            REQUIRE( info.pVertexInputState->vertexBindingDescriptionCount == 3 );
+            REQUIRE( info.pColorBlendState->attachmentCount == 3 );
+            REQUIRE( info.pDynamicState->dynamicStateCount == 2 );
+            REQUIRE( info.stageCount == 2 );
+        });
+    }
+
+    gvu::InlineGraphicsPipelineCache cache;
+    cache.init(window->getDevice(), window->getPhysicalDevice());
+
+    auto p1 = cache.create(gci);
+    auto gci2 = gci;
+    REQUIRE( gci2 == gci );
+    REQUIRE( cache.create(gci2) == p1 );
+
+    gci2.dynamicStates.push_back(VK_DYNAMIC_STATE_LINE_WIDTH);
+    REQUIRE( !(gci2 == gci) );
+    REQUIRE( cache.create(gci2) != p1 );
+    REQUIRE( cache.hitCount() == 1 );
+    REQUIRE( cache.missCount() == 2 );
+
+    THEN("Too many targets throws")
+    {
+        gci2.outputColorTargets = gvu::InlineGraphicsPipelineCreateInfo::maxColorTargets + 1;
+        REQUIRE_THROWS( cache.create(gci2) );
+        REQUIRE( cache.cacheSize() == 2 );
+    }
+
+    cache.destroy();
+    objects.destroy(window->getDevice());
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 3: Validate pipeline cache headers" )
+{
+    VkPhysicalDeviceProperties props = {};
+    props.vendorID = 0x1002;
+    props.deviceID = 0x73bf;
+    for(uint32_t i=0;i<VK_UUID_SIZE;i++)
+        props.pipelineCacheUUID[i] = static_cast<uint8_t>(i);
+
+    std::vector<uint8_t> data(16 + VK_UUID_SIZE + 8, 0);
+    uint32_t header[4] = {16 + VK_UUID_SIZE, VK_PIPELINE_CACHE_HEADER_VERSION_ONE, props.vendorID, props.deviceID};
+    std::memcpy(data.data(), header, sizeof(header));
+    std::memcpy(data.data() + 16, props.pipelineCacheUUID, VK_UUID_SIZE);
+
+    REQUIRE( gvu::GraphicsPipelineCache::isCompatible(data, props) );
+
+    WHEN("The data is truncated")
+    {
+        data.resize(20);
+        REQUIRE( !gvu::GraphicsPipelineCache::isCompatible(data, props) );
+    }
+    WHEN("The vendor is different")
+    {
+        props.vendorID = 0x10de;
+        REQUIRE( !gvu::GraphicsPipelineCache::isCompatible(data, props) );
+    }
+    WHEN("The device is different")
+    {
+        props.deviceID = 0x1234;
+        REQUIRE( !gvu::GraphicsPipelineCache::isCompatible(data, props) );
+    }
+    WHEN("The driver UUID is different")
+    {
+        props.pipelineCacheUUID[3] = 0xff;
+        REQUIRE( !gvu::GraphicsPipelineCache::isCompatible(data, props) );
+    }
+}
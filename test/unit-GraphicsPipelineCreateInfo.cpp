@@ -108,3 +108,43 @@ SCENARIO( " Scenario 1: Create a Sampler" )
 
 }
 
+
+SCENARIO( " Scenario 2: Specialization constants are part of the key" )
+{
+    gvu::InlineGraphicsPipelineCreateInfo A;
+    A.vertexShader   = reinterpret_cast<VkShaderModule>(uintptr_t(0x100));
+    A.fragmentShader = reinterpret_cast<VkShaderModule>(uintptr_t(0x200));
+
+    auto B = A;
+    B.fragmentSpecialization.set(0, true);
+
+    REQUIRE( !(A == B) );
+    REQUIRE( A.hash() != B.hash() );
+
+    WHEN("The same constant is set on a different stage")
+    {
+        auto C = A;
+        C.vertexSpecialization.set(0, true);
+
+        THEN("The create infos are different")
+        {
+            REQUIRE( !(B == C) );
+            REQUIRE( B.hash() != C.hash() );
+        }
+    }
+
+    THEN("Only the specialized stage has a VkSpecializationInfo")
+    {
+        B.create([](VkGraphicsPipelineCreateInfo const & info)
+        {
+            REQUIRE( info.stageCount == 2 );
+            REQUIRE( info.pStages[0].stage == VK_SHADER_STAGE_VERTEX_BIT );
+            REQUIRE( info.pStages[0].pSpecializationInfo == nullptr );
+            REQUIRE( info.pStages[1].stage == VK_SHADER_STAGE_FRAGMENT_BIT );
+            REQUIRE( info.pStages[1].pSpecializationInfo != nullptr );
+            REQUIRE( info.pStages[1].pSpecializationInfo->mapEntryCount == 1 );
+            REQUIRE( info.pStages[1].pSpecializationInfo->dataSize == sizeof(VkBool32) );
+            return 0;
+        });
+    }
+}
@@ -0,0 +1,218 @@
+#include<catch2/catch.hpp>
+
+#define VMA_IMPLEMENTATION
+#include <vk_mem_alloc.h>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/ImageCache.h>
+
+static VmaAllocator createAllocator(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device)
+{
+    VmaAllocatorCreateInfo ai = {};
+    ai.instance       = instance;
+    ai.physicalDevice = physicalDevice;
+    ai.device         = device;
+
+    VmaAllocator allocator = VK_NULL_HANDLE;
+    vmaCreateAllocator(&ai, &allocator);
+    return allocator;
+}
+
+SCENARIO( " Scenario 1: Recycle returned images" )
+{
+    auto window = createWindow(1024,768);
+    auto allocator = createAllocator(window->getInstance(), window->getPhysicalDevice(), window->getDevice());
+
+    gvu::ImageCache cache;
+    cache.init(window->getDevice(), allocator);
+
+    auto info = gvu::ImageCreateInfo::image2D(VK_FORMAT_R8G8B8A8_UNORM, {1024,768}, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+    info.seal();
+
+    auto img = cache.allocateImage(info);
+    REQUIRE( img != VK_NULL_HANDLE );
+    REQUIRE( cache.getCreateInfo(img) == info );
+    REQUIRE( cache.allocationCount() == 1 );
+
+    WHEN("The image is returned and allocated again")
+    {
+        cache.returnImage(img);
+        REQUIRE( cache.freeImageCount() == 1 );
+
+        auto img2 = cache.allocateImage(info);
+
+        THEN("The same image is returned without allocating")
+        {
+            REQUIRE( img2 == img );
+            REQUIRE( cache.hitCount() == 1 );
+            REQUIRE( cache.freeImageCount() == 0 );
+            REQUIRE( cache.allocationCount() == 1 );
+        }
+    }
+
+    WHEN("An image with a different usage is allocated")
+    {
+        cache.returnImage(img);
+
+        auto info2  = info;
+        info2.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
+
+        auto img2 = cache.allocateImage(info2);
+
+        THEN("The returned image is not used")
+        {
+            REQUIRE( img2 != img );
+            REQUIRE( cache.imageCount() == 2 );
+        }
+    }
+
+    WHEN("A returned image is not used for more than maxIdleFrames")
+    {
+        cache.setMaxIdleFrames(2);
+        cache.returnImage(img);
+        cache.nextFrame();
+        cache.nextFrame();
+        REQUIRE( cache.freeImageCount() == 1 );
+        cache.nextFrame();
+
+        THEN("The image is destroyed but its memory is kept")
+        {
+            REQUIRE( cache.freeImageCount() == 0 );
+            REQUIRE( cache.imageCount() == 0 );
+            REQUIRE( cache.freeMemoryCount() == 1 );
+        }
+    }
+
+    cache.destroy();
+    vmaDestroyAllocator(allocator);
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 2: Reuse memory when render targets are resized" )
+{
+    auto window = createWindow(1024,768);
+    auto allocator = createAllocator(window->getInstance(), window->getPhysicalDevice(), window->getDevice());
+
+    gvu::ImageCache cache;
+    cache.init(window->getDevice(), allocator);
+    cache.setMaxIdleFrames(0);
+
+    auto img = cache.allocateImage(gvu::ImageCreateInfo::image2D(VK_FORMAT_R8G8B8A8_UNORM, {1024,768}, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT));
+    cache.returnImage(img);
+    cache.nextFrame();
+    REQUIRE( cache.freeMemoryCount() == 1 );
+
+    WHEN("A slightly smaller render target is allocated")
+    {
+        auto img2 = cache.allocateImage(gvu::ImageCreateInfo::image2D(VK_FORMAT_R8G8B8A8_UNORM, {1000,700}, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT));
+
+        THEN("The recycled memory is used")
+        {
+            REQUIRE( img2 != VK_NULL_HANDLE );
+            REQUIRE( cache.freeMemoryCount() == 0 );
+            REQUIRE( cache.allocationCount() == 1 );
+        }
+    }
+
+    WHEN("A much smaller render target is allocated")
+    {
+        cache.allocateImage(gvu::ImageCreateInfo::image2D(VK_FORMAT_R8G8B8A8_UNORM, {256,256}, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT));
+
+        THEN("New memory is allocated rather than wasting the large block")
+        {
+            REQUIRE( cache.freeMemoryCount() == 1 );
+            REQUIRE( cache.allocationCount() == 2 );
+        }
+    }
+
+    cache.destroy();
+    vmaDestroyAllocator(allocator);
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 3: Alias the memory of transient attachments" )
+{
+    auto window = createWindow(1024,768);
+    auto allocator = createAllocator(window->getInstance(), window->getPhysicalDevice(), window->getDevice());
+
+    gvu::ImageCache cache;
+    cache.init(window->getDevice(), allocator);
+
+    auto info = gvu::ImageCreateInfo::image2D(VK_FORMAT_R16G16B16A16_SFLOAT, {1024,768}, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+    info.seal();
+
+    // a post process chain: pass 0 writes A, pass 1 reads A and writes B,
+    // pass 2 reads B and writes C
+    auto A = cache.acquireTransientImage(info, 0, 1);
+    auto B = cache.acquireTransientImage(info, 1, 2);
+    auto C = cache.acquireTransientImage(info, 2, 3);
+
+    THEN("Images used by the same pass get different memory")
+    {
+        REQUIRE( A != B );
+        REQUIRE( cache.getAllocation(A) != cache.getAllocation(B) );
+        REQUIRE( cache.getAllocation(B) != cache.getAllocation(C) );
+    }
+
+    THEN("Images which are never used at the same time share memory")
+    {
+        REQUIRE( cache.getAllocation(A) == cache.getAllocation(C) );
+        REQUIRE( cache.allocationCount() == 2 );
+    }
+
+    THEN("Transient images cannot be returned")
+    {
+        REQUIRE_THROWS_AS( cache.returnImage(A), std::invalid_argument );
+    }
+
+    WHEN("The same images are acquired the next frame")
+    {
+        cache.nextFrame();
+        auto A2 = cache.acquireTransientImage(info, 0, 1);
+        auto B2 = cache.acquireTransientImage(info, 1, 2);
+        auto C2 = cache.acquireTransientImage(info, 2, 3);
+
+        THEN("The same handles are returned")
+        {
+            REQUIRE( A2 == A );
+            REQUIRE( B2 == B );
+            REQUIRE( C2 == C );
+            REQUIRE( cache.imageCount() == 3 );
+        }
+    }
+
+    WHEN("The transient images are released on resize")
+    {
+        cache.releaseTransientImages();
+        REQUIRE( cache.imageCount() == 0 );
+        REQUIRE( cache.freeMemoryCount() == 2 );
+
+        auto info2 = gvu::ImageCreateInfo::image2D(VK_FORMAT_R16G16B16A16_SFLOAT, {1000,700}, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+        cache.nextFrame();
+        cache.acquireTransientImage(info2, 0, 1);
+        cache.acquireTransientImage(info2, 1, 2);
+        cache.acquireTransientImage(info2, 2, 3);
+
+        THEN("The new images reuse the old memory")
+        {
+            REQUIRE( cache.allocationCount() == 2 );
+            REQUIRE( cache.freeMemoryCount() == 0 );
+        }
+    }
+
+    cache.destroy();
+    vmaDestroyAllocator(allocator);
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
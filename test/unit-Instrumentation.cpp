@@ -0,0 +1,162 @@
+#include<catch2/catch.hpp>
+
+// must be defined before any gvu header
+#if !defined(GVU_ENABLE_INSTRUMENTATION)
+#define GVU_ENABLE_INSTRUMENTATION
+#endif
+
+#include <string>
+#include <vector>
+#include "unit_helpers.h"
+#include <gvu/Cache/SamplerCache.h>
+#include <gvu/Cache/DescriptorSetLayoutCache.h>
+#include <gvu/Managers/CommandPoolManager.h>
+#include <gvu/Managers/FrameDescriptorAllocator.h>
+
+SCENARIO( " Scenario 1: Histograms bucket durations by powers of two" )
+{
+    gvu::instrumentation::Histogram H;
+
+    H.record(0);
+    H.record(1);
+    H.record(1000);
+    H.record(1500);
+
+    REQUIRE( H.count() == 4 );
+    REQUIRE( H.totalNs() == 2501 );
+    REQUIRE( H.maxNs() == 1500 );
+    REQUIRE( H.bucket(0) == 1 );
+    REQUIRE( H.bucket(1) == 1 );
+    // 1000 is in [512, 1024) and 1500 is in [1024, 2048)
+    REQUIRE( H.bucket(10) == 1 );
+    REQUIRE( H.bucket(11) == 1 );
+
+    REQUIRE( H.percentile(0.5) == 2 );
+    REQUIRE( H.percentile(1.0) == 2048 );
+
+    H.reset();
+    REQUIRE( H.count() == 0 );
+    REQUIRE( H.percentile(0.5) == 0 );
+}
+
+SCENARIO( " Scenario 2: Count the hits and misses of a cache" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::SamplerCache cache;
+    cache.init(window->getDevice());
+
+    gvu::SamplerCreateInfo A;
+    gvu::SamplerCreateInfo B;
+    B.mipLodBias = 1.0f;
+
+    cache.create(A);
+    cache.create(A);
+    cache.create(A);
+    cache.create(B);
+
+    REQUIRE( cache.stats().hits.get() == 2 );
+    REQUIRE( cache.stats().misses.get() == 2 );
+    REQUIRE( cache.stats().pendingWaits.get() == 0 );
+    REQUIRE( cache.stats().createTime.count() == 2 );
+
+    cache.stats().reset();
+    REQUIRE( cache.stats().hits.get() == 0 );
+
+    cache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+namespace
+{
+struct ScopeLog
+{
+    std::vector<std::string> events;
+};
+
+void scopeBegin(char const * name, void * user)
+{
+    static_cast<ScopeLog*>(user)->events.push_back(std::string("begin ") + name);
+}
+void scopeEnd(char const * name, void * user)
+{
+    static_cast<ScopeLog*>(user)->events.push_back(std::string("end ") + name);
+}
+}
+
+SCENARIO( " Scenario 3: Record the fence waits and report the scopes" )
+{
+    auto window = createWindow(1024,768);
+
+    auto & G = gvu::instrumentation::globalStats();
+    G.reset();
+
+    ScopeLog log;
+    gvu::instrumentation::setScopeCallbacks(&scopeBegin, &scopeEnd, &log);
+
+    gvu::CommandPoolManager cpm;
+    cpm.init(window->getDevice(), window->getPhysicalDevice(), window->getGraphicsQueue());
+
+    {
+        auto fence = cpm.beginRecording([](VkCommandBuffer){}, true);
+        fence->wait();
+    }
+
+    // beginRecording, the explicit wait and the wait of the destructor
+    REQUIRE( G.beginRecording.count() == 1 );
+    REQUIRE( G.fenceWait.count() == 2 );
+    REQUIRE( log.events.size() == 6 );
+    REQUIRE( log.events[0] == "begin gvu::CommandPoolManager::beginRecording" );
+    REQUIRE( log.events[1] == "end gvu::CommandPoolManager::beginRecording" );
+    REQUIRE( log.events[2] == "begin gvu::ScopedFence::wait" );
+
+    gvu::instrumentation::setScopeCallbacks(nullptr, nullptr);
+    cpm.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 4: Count descriptor allocations and pool churn" )
+{
+    auto window = createWindow(1024,768);
+
+    auto & G = gvu::instrumentation::globalStats();
+    G.reset();
+
+    gvu::DescriptorSetLayoutCache dlayoutCache;
+    dlayoutCache.init(window->getDevice());
+
+    gvu::DescriptorSetLayoutCreateInfo dci;
+    dci.bindings.emplace_back(VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT,nullptr});
+    auto layout = dlayoutCache.create(dci);
+
+    gvu::FrameDescriptorAllocator alloc;
+    alloc.init(window->getDevice(), &dlayoutCache, layout, 2, 8);
+
+    alloc.beginFrame(0);
+    std::vector<VkDescriptorSet> sets(20);
+    alloc.allocateDescriptorSets(sets.data(), 20);
+
+    REQUIRE( G.descriptorSetsAllocated.get() == 20 );
+    REQUIRE( G.descriptorPoolsCreated.get() == 3 );
+
+    alloc.beginFrame(2);
+    REQUIRE( G.descriptorPoolsReset.get() == 3 );
+
+    alloc.destroy();
+    REQUIRE( G.descriptorPoolsDestroyed.get() == 3 );
+
+    dlayoutCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
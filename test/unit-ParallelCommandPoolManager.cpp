@@ -0,0 +1,81 @@
+#include<catch2/catch.hpp>
+#include <set>
+#include <thread>
+
+#include "unit_helpers.h"
+#include <gvu/Managers/ParallelCommandPoolManager.h>
+
+SCENARIO( " Scenario 1: Allocate command buffers from multiple threads" )
+{
+    auto window = createWindow(1024,768);
+
+    constexpr uint32_t threadCount = 4;
+
+    gvu::ParallelCommandPoolManager pools;
+    pools.init(window->getDevice(), window->getPhysicalDevice(), VK_QUEUE_GRAPHICS_BIT, threadCount, 2);
+
+    REQUIRE( pools.threadCount() == threadCount );
+    REQUIRE( pools.frameCount() == 2 );
+
+    std::set<VkCommandPool> uniquePools;
+    for(uint32_t t=0; t < threadCount; t++)
+        uniquePools.insert(pools.getCommandPool(t));
+    REQUIRE( uniquePools.size() == threadCount );
+
+    pools.beginFrame(0);
+
+    std::vector< std::vector<VkCommandBuffer> > recorded(threadCount);
+    std::vector< std::thread > threads;
+    for(uint32_t t=0; t < threadCount; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            auto & R = recorded[t];
+            R.push_back(pools.allocateCommandBuffer(t, VK_COMMAND_BUFFER_LEVEL_PRIMARY));
+            R.resize(11);
+            pools.allocateCommandBuffers(t, VK_COMMAND_BUFFER_LEVEL_SECONDARY, R.data() + 1, 10);
+        });
+    }
+    for(auto & t : threads)
+        t.join();
+
+    std::set<VkCommandBuffer> unique;
+    for(auto & R : recorded)
+        unique.insert(R.begin(), R.end());
+    REQUIRE( unique.size() == threadCount * 11 );
+    REQUIRE( pools.allocatedCommandBufferCount(0, 0) == 11 );
+
+    WHEN("The frame is started again")
+    {
+        pools.beginFrame(2);
+        REQUIRE( pools.currentFrame() == 0 );
+
+        THEN("The command buffers are reused")
+        {
+            auto cmd = pools.allocateCommandBuffer(0, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+            REQUIRE( cmd == recorded[0][0] );
+            REQUIRE( pools.allocatedCommandBufferCount(0, 0) == 11 );
+        }
+    }
+
+    WHEN("The next frame is started")
+    {
+        pools.beginFrame(1);
+
+        THEN("It uses its own pools")
+        {
+            pools.allocateCommandBuffer(0);
+            REQUIRE( pools.allocatedCommandBufferCount(0, 1) == 1 );
+            REQUIRE( pools.allocatedCommandBufferCount(0, 0) == 11 );
+        }
+    }
+
+    REQUIRE_THROWS_AS( pools.allocateCommandBuffer(threadCount), std::out_of_range );
+
+    pools.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,109 @@
+#include<catch2/catch.hpp>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/RenderPassCache.h>
+#include <gvu/PipelineBuilder.h>
+
+SCENARIO( " Scenario 1: Build a pipeline from shader modules in one call" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::RenderPassCache          rpCache;
+    gvu::ShaderModuleCache        smCache;
+    gvu::DescriptorSetLayoutCache slCache;
+    gvu::PipelineLayoutCache      plCache;
+    gvu::GraphicsPipelineCache    gpCache;
+
+    rpCache.init(window->getDevice());
+    smCache.init(window->getDevice());
+    slCache.init(window->getDevice());
+    plCache.init(window->getDevice());
+    gpCache.init(window->getDevice(), window->getPhysicalDevice());
+
+    gvu::ShaderModuleCreateInfo vert(CMAKE_SOURCE_DIR "/share/shaders/pbr.vert.spv");
+    gvu::ShaderModuleCreateInfo frag(CMAKE_SOURCE_DIR "/share/shaders/pbr.frag.spv");
+
+    gvu::GraphicsPipelineCreateInfo state;
+    state.renderPass    = rpCache.create( gvu::RenderPassCreateInfo::createSimpleRenderPass( {{VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}},
+                                                                                             {VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL}) );
+    state.dynamicStates = {VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_VIEWPORT};
+    state.seal();
+
+    gvu::PipelineBuilder builder;
+    builder.init(&smCache, &slCache, &plCache, &gpCache);
+
+    auto P = builder.build({&vert, nullptr, nullptr, &frag}, state);
+
+    REQUIRE( P.pipeline != VK_NULL_HANDLE );
+    REQUIRE( P.pipelineLayout != VK_NULL_HANDLE );
+    REQUIRE( !P.setLayouts.empty() );
+    REQUIRE( smCache.cacheSize() == 2 );
+    REQUIRE( plCache.cacheSize() == 1 );
+    REQUIRE( gpCache.cacheSize() == 1 );
+
+    THEN("The pipeline uses the reflected vertex inputs")
+    {
+        auto ci = gpCache.getCreateInfo(P.pipeline);
+        REQUIRE( ci.pipelineLayout == P.pipelineLayout );
+        REQUIRE( !ci.inputVertexAttributes.empty() );
+        REQUIRE( ci.inputVertexAttributes.size() == ci.inputBindings.size() );
+    }
+
+    WHEN("The same material is built again")
+    {
+        auto P2 = builder.build({&vert, nullptr, nullptr, &frag}, state);
+
+        THEN("The memoized pipeline is returned without touching the caches")
+        {
+            REQUIRE( P2.pipeline == P.pipeline );
+            REQUIRE( builder.lookupCount() == 2 );
+            REQUIRE( builder.pipelineCount() == 1 );
+            REQUIRE( gpCache.hitCount() == 0 );
+        }
+    }
+
+    WHEN("The same shaders are built with a different state")
+    {
+        auto state2 = state;
+        state2.enableDepthTest = true;
+        state2.seal();
+
+        auto P2 = builder.build({&vert, nullptr, nullptr, &frag}, state2);
+
+        THEN("The layouts are reused and a new pipeline is created")
+        {
+            REQUIRE( P2.pipeline != P.pipeline );
+            REQUIRE( P2.pipelineLayout == P.pipelineLayout );
+            REQUIRE( builder.layoutCount() == 1 );
+            REQUIRE( builder.pipelineCount() == 2 );
+            REQUIRE( gpCache.cacheSize() == 2 );
+        }
+    }
+
+    WHEN("The pipeline is evicted from the pipeline cache")
+    {
+        gpCache.nextFrame();
+        REQUIRE( gpCache.evictUnused(0) == 1 );
+
+        auto P2 = builder.build({&vert, nullptr, nullptr, &frag}, state);
+
+        THEN("The builder creates it again")
+        {
+            REQUIRE( P2.pipeline != VK_NULL_HANDLE );
+            REQUIRE( gpCache.touch(P2.pipeline) );
+            REQUIRE( gpCache.cacheSize() == 1 );
+            REQUIRE( gpCache.missCount() == 2 );
+        }
+    }
+
+    gpCache.destroy();
+    plCache.destroy();
+    slCache.destroy();
+    smCache.destroy();
+    rpCache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
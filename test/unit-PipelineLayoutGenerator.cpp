@@ -62,6 +62,21 @@ SCENARIO( " Scenario 1: Create a Sampler" )
     // Test creating a different object
     //--------------------------------------------------------------
 
+    // generate an update template for each set
+    gvu::DescriptorUpdateTemplateCache tCache;
+    tCache.init(window->getDevice());
+
+    auto templates = C.createUpdateTemplates(dlCache, tCache);
+    REQUIRE(templates.size() == 3);
+    REQUIRE(tCache.cacheSize() == 3);
+    REQUIRE(dlCache.cacheSize() == 3);
+
+    auto decl = generator.generateDescriptorStructDeclaration(0, "Set0");
+    REQUIRE(decl.find("struct Set0") == 0);
+    REQUIRE(decl.find("binding 0, offset 0") != std::string::npos);
+
+    tCache.destroy();
+
 
     //--------------------------------------------------------------
 
@@ -51,3 +51,61 @@ SCENARIO( " Scenario 1: Create a Sampler" )
 
 }
 
+
+SCENARIO( " Scenario 2: Sealed create infos" )
+{
+    auto window = createWindow(1024,768);
+
+    using CacheType = gvu::RenderPassCache;
+
+    CacheType cache;
+    cache.init(window->getDevice());
+
+    auto ci = CacheType::createInfo_type::createSimpleRenderPass( {{VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}});
+    auto h  = ci.hash();
+
+    REQUIRE( !ci.isSealed() );
+    ci.seal();
+    REQUIRE( ci.isSealed() );
+    REQUIRE( ci.hash() == h );
+
+    auto obj1 = cache.create(ci);
+
+    THEN("Sealed and unsealed keys find the same object")
+    {
+        auto ci2 = CacheType::createInfo_type::createSimpleRenderPass( {{VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}});
+        REQUIRE( cache.create(ci2) == obj1 );
+        REQUIRE( cache.create(ci)  == obj1 );
+        REQUIRE( cache.cacheSize() == 1 );
+    }
+    THEN("Copies of a sealed key are not sealed")
+    {
+        auto stored = cache.getCreateInfo(obj1);
+        REQUIRE( !stored.isSealed() );
+
+        auto copy = ci;
+        REQUIRE( !copy.isSealed() );
+        REQUIRE( copy.hash() == h );
+
+        // a modified copy is looked up with its new hash
+        stored.attachments[0].format = VK_FORMAT_R8G8B8A8_SRGB;
+        auto obj2 = cache.create(stored);
+        REQUIRE( obj2 != obj1 );
+        REQUIRE( cache.create(stored) == obj2 );
+        REQUIRE( cache.cacheSize() == 2 );
+    }
+    THEN("Unsealing recomputes the hash")
+    {
+        ci.attachments[0].format = VK_FORMAT_R8G8B8A8_SRGB;
+        ci.unseal();
+        REQUIRE( ci.hash() != h );
+        REQUIRE( cache.create(ci) != obj1 );
+    }
+
+    cache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
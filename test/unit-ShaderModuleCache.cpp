@@ -0,0 +1,79 @@
+#include<catch2/catch.hpp>
+#include <fstream>
+
+#include "unit_helpers.h"
+#include <gvu/Cache/ShaderModuleCache.h>
+
+namespace
+{
+void writeFile(guv::fs::path const & p, std::vector<uint32_t> const & words, size_t extraBytes = 0)
+{
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<char const*>(words.data()), static_cast<std::streamsize>(words.size()*sizeof(uint32_t)));
+    for(size_t i=0;i<extraBytes;i++)
+        out.put(0);
+}
+}
+
+SCENARIO( " Scenario 1: Create shader modules using the ShaderModuleCache" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::ShaderModuleCache cache;
+    cache.init(window->getDevice());
+
+    auto dir = guv::fs::temp_directory_path();
+    auto pathA  = dir / "gvu_unit_shader_a.spv";
+    auto pathA2 = dir / "gvu_unit_shader_a_copy.spv";
+    auto pathB  = dir / "gvu_unit_shader_b.spv";
+
+    std::vector<uint32_t> codeA = {0x07230203, 0x00010000, 0, 1, 0};
+    std::vector<uint32_t> codeB = {0x07230203, 0x00010000, 0, 2, 0};
+
+    writeFile(pathA,  codeA);
+    writeFile(pathA2, codeA);
+    writeFile(pathB,  codeB);
+
+    gvu::ShaderModuleCreateInfo a(pathA);
+    REQUIRE( a.code == codeA );
+    REQUIRE( a.isSealed() );
+
+    auto m1 = cache.create(a);
+    REQUIRE( m1 != VK_NULL_HANDLE );
+
+    THEN("The same code from a different file returns the same module")
+    {
+        REQUIRE( cache.create(gvu::ShaderModuleCreateInfo(pathA2)) == m1 );
+        REQUIRE( cache.cacheSize() == 1 );
+    }
+    THEN("Code loaded from memory returns the same module")
+    {
+        gvu::ShaderModuleCreateInfo m;
+        m.setCode(codeA.data(), codeA.size());
+        REQUIRE( cache.create(m) == m1 );
+    }
+    THEN("Different code returns a different module")
+    {
+        REQUIRE( cache.create(gvu::ShaderModuleCreateInfo(pathB)) != m1 );
+        REQUIRE( cache.cacheSize() == 2 );
+    }
+    THEN("Invalid files throw")
+    {
+        auto pathBad = dir / "gvu_unit_shader_bad.spv";
+        writeFile(pathBad, codeA, 2);
+        REQUIRE_THROWS( gvu::ShaderModuleCreateInfo(pathBad) );
+        REQUIRE_THROWS( gvu::ShaderModuleCreateInfo(dir / "gvu_unit_shader_does_not_exist.spv") );
+        guv::fs::remove(pathBad);
+    }
+
+    guv::fs::remove(pathA);
+    guv::fs::remove(pathA2);
+    guv::fs::remove(pathB);
+
+    cache.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,132 @@
+#include<catch2/catch.hpp>
+
+#include "unit_helpers.h"
+#include <gvu/ShaderReflection.h>
+#include <gvu/spirvPipelineReflector.h>
+
+static bool sameReflection(gvu::ShaderReflection const & A, gvu::ShaderReflection const & B)
+{
+    auto sameBytes = [](auto const & a, auto const & b)
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0);
+    };
+    return A.hash == B.hash
+        && A.stage == B.stage
+        && A.workgroupSize == B.workgroupSize
+        && A.workgroupSizeSpecIds == B.workgroupSizeSpecIds
+        && sameBytes(A.bindings, B.bindings)
+        && sameBytes(A.inputs, B.inputs)
+        && sameBytes(A.outputs, B.outputs)
+        && sameBytes(A.pushConstants, B.pushConstants)
+        && sameBytes(A.specializationConstants, B.specializationConstants)
+        && A.names == B.names;
+}
+
+SCENARIO( " Scenario 1: Serialize a ShaderReflection" )
+{
+    gvu::ShaderModuleCreateInfo vert(CMAKE_SOURCE_DIR "/share/shaders/pbr.vert.spv");
+
+    auto R = gvu::ShaderReflection::reflect(vert.code);
+    REQUIRE( R.hash == gvu::ShaderReflection::hashCode(vert.code.data(), vert.code.size()) );
+
+    auto blob = R.serialize();
+
+    WHEN("The blob is deserialized")
+    {
+        gvu::ShaderReflection D;
+        REQUIRE( D.deserialize(blob.data(), blob.size()) == blob.size() );
+
+        THEN("It is identical to the original")
+        {
+            REQUIRE( sameReflection(R, D) );
+        }
+    }
+
+    THEN("Truncated data throws")
+    {
+        gvu::ShaderReflection D;
+        REQUIRE_THROWS_AS( D.deserialize(blob.data(), blob.size() - 1), std::runtime_error );
+    }
+
+    THEN("Corrupt data throws")
+    {
+        gvu::ShaderReflection D;
+        blob.back() ^= 0xFF;
+        REQUIRE_THROWS_AS( D.deserialize(blob.data(), blob.size()), std::runtime_error );
+        REQUIRE( D.bindings.empty() );
+    }
+
+    THEN("A corrupt count throws without allocating")
+    {
+        // the binding count follows the magic, version, hash, stage and
+        // workgroup size fields of the header
+        uint32_t count = 0xFFFFFFFF;
+        std::memcpy(blob.data() + 44, &count, sizeof(count));
+
+        gvu::ShaderReflection D;
+        REQUIRE_THROWS_AS( D.deserialize(blob.data(), blob.size()), std::runtime_error );
+    }
+}
+
+SCENARIO( " Scenario 2: Reflect shaders through a ShaderReflectionCache" )
+{
+    gvu::ShaderModuleCreateInfo vert(CMAKE_SOURCE_DIR "/share/shaders/pbr.vert.spv");
+    gvu::ShaderModuleCreateInfo frag(CMAKE_SOURCE_DIR "/share/shaders/pbr.frag.spv");
+
+    gvu::ShaderReflectionCache cache;
+
+    gvu::spirvPipelineReflector A;
+    A.addSPIRVCode(vert.code, VK_SHADER_STAGE_VERTEX_BIT,   cache);
+    A.addSPIRVCode(frag.code, VK_SHADER_STAGE_FRAGMENT_BIT, cache);
+    REQUIRE( cache.size() == 2 );
+    REQUIRE( cache.misses() == 2 );
+
+    THEN("The same code is only reflected once")
+    {
+        cache.get(vert.code);
+        REQUIRE( cache.misses() == 2 );
+    }
+
+    WHEN("The cache is serialized and loaded into a new cache")
+    {
+        gvu::ShaderReflectionCache warm;
+        auto blob = cache.serialize();
+        REQUIRE( warm.deserialize(blob.data(), blob.size()) );
+        REQUIRE( warm.size() == 2 );
+
+        gvu::spirvPipelineReflector B;
+        B.addSPIRVCode(vert.code, VK_SHADER_STAGE_VERTEX_BIT,   warm);
+        B.addSPIRVCode(frag.code, VK_SHADER_STAGE_FRAGMENT_BIT, warm);
+
+        THEN("spirv-cross is not used and the pipeline layout is the same")
+        {
+            REQUIRE( warm.misses() == 0 );
+
+            auto CA = A.generateCombinedPipelineLayoutCreateInfo();
+            auto CB = B.generateCombinedPipelineLayoutCreateInfo();
+            REQUIRE( CA.setLayoutInfos.size() == CB.setLayoutInfos.size() );
+            for(size_t i=0; i < CA.setLayoutInfos.size(); i++)
+                REQUIRE( CA.setLayoutInfos[i] == CB.setLayoutInfos[i] );
+            REQUIRE( CA.pushConstantRanges.size() == CB.pushConstantRanges.size() );
+            REQUIRE( A.vertex.inputAttributes.size() == B.vertex.inputAttributes.size() );
+        }
+    }
+
+    THEN("Invalid data is rejected")
+    {
+        gvu::ShaderReflectionCache bad;
+        std::vector<uint8_t> blob = {1,0,0,0, 1,2,3};
+        REQUIRE( !bad.deserialize(blob.data(), blob.size()) );
+        REQUIRE( bad.size() == 0 );
+    }
+
+    THEN("A corrupt reflection count is rejected")
+    {
+        gvu::ShaderReflectionCache bad;
+        auto blob = cache.serialize();
+        uint32_t count = 0xFFFFFFFF;
+        std::memcpy(blob.data(), &count, sizeof(count));
+        REQUIRE( !bad.deserialize(blob.data(), blob.size()) );
+        REQUIRE( bad.size() == 0 );
+    }
+}
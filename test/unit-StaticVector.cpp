@@ -0,0 +1,44 @@
+#include<catch2/catch.hpp>
+
+#include <gvu/StaticVector.h>
+
+SCENARIO( " Scenario 1: StaticVector behaves like a vector with a fixed capacity" )
+{
+    gvu::StaticVector<uint32_t, 4> v = {1, 2};
+
+    REQUIRE( v.size() == 2 );
+    REQUIRE( v.capacity() == 4 );
+    REQUIRE( v[1] == 2 );
+
+    v.push_back(3);
+    v.emplace_back(4u);
+    REQUIRE( v.size() == 4 );
+    REQUIRE( v.back() == 4 );
+
+    uint32_t sum = 0;
+    for(auto x : v)
+        sum += x;
+    REQUIRE( sum == 10 );
+
+    THEN("Exceeding the capacity throws")
+    {
+        REQUIRE_THROWS_AS( v.push_back(5), std::length_error );
+        REQUIRE_THROWS_AS( v.resize(5), std::length_error );
+        REQUIRE( v.size() == 4 );
+    }
+    THEN("Copies are independent")
+    {
+        auto w = v;
+        w[0] = 100;
+        REQUIRE( v[0] == 1 );
+        REQUIRE( w.size() == 4 );
+    }
+    THEN("It can be cleared and resized")
+    {
+        v.clear();
+        REQUIRE( v.empty() );
+        v.resize(3, 7);
+        REQUIRE( v.size() == 3 );
+        REQUIRE( v[2] == 7 );
+    }
+}
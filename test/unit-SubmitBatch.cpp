@@ -0,0 +1,80 @@
+#include<catch2/catch.hpp>
+
+#include "unit_helpers.h"
+#include <gvu/Managers/CommandPoolManager.h>
+#include <gvu/Managers/SubmitBatch.h>
+
+SCENARIO( " Scenario 1: Submit multiple command buffers in a single batch" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::CommandPoolManager cpm;
+    cpm.init(window->getDevice(), window->getPhysicalDevice(), window->getGraphicsQueue());
+
+    std::vector<VkCommandBuffer> cmds;
+    for(int i=0; i < 3; i++)
+    {
+        auto cmd = cpm.allocateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+        vkEndCommandBuffer(cmd);
+        cmds.push_back(cmd);
+    }
+
+    gvu::SubmitBatch batch;
+    REQUIRE( batch.empty() );
+    REQUIRE( batch.submitCount() == 0 );
+
+    batch.addCommandBuffer(cmds[0]);
+    batch.addCommandBuffer(cmds[1]);
+
+    THEN("Starting a new submit info only happens once something has been added")
+    {
+        batch.nextSubmit();
+        batch.nextSubmit();
+        REQUIRE( batch.submitCount() == 1 );
+
+        batch.addCommandBuffer(cmds[2]);
+        REQUIRE( batch.submitCount() == 2 );
+        REQUIRE( batch.commandBufferCount() == 3 );
+    }
+
+    WHEN("The batch is submitted through the CommandPoolManager")
+    {
+        bool finished = false;
+        auto id = cpm.submitBatchAsync(batch, window->getGraphicsQueue(), [&]()
+        {
+            for(auto c : cmds)
+                cpm.recycle(VK_NULL_HANDLE, c);
+            finished = true;
+        });
+
+        THEN("The batch is cleared and completes as a single submission")
+        {
+            REQUIRE( batch.empty() );
+            REQUIRE( cpm.inFlightCount() == 1 );
+
+            vkQueueWaitIdle(window->getGraphicsQueue());
+
+            REQUIRE( cpm.collect() == 1 );
+            REQUIRE( cpm.poll(id) );
+            REQUIRE( finished );
+            REQUIRE( cpm.freeCommandBufferCount() == 3 );
+        }
+    }
+
+    WHEN("The batch is cleared")
+    {
+        batch.clear();
+        THEN("Flushing does not submit anything")
+        {
+            REQUIRE( batch.flush(window->getGraphicsQueue()) == VK_SUCCESS );
+            REQUIRE( batch.empty() );
+        }
+    }
+
+    cpm.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,147 @@
+#include<catch2/catch.hpp>
+
+#include "unit_helpers.h"
+#include <gvu/Managers/TimelineTracker.h>
+#include <gvu/Managers/CommandPoolManager.h>
+
+static void hostSignal(VkDevice device, VkSemaphore s, uint64_t value)
+{
+    VkSemaphoreSignalInfo si = {};
+    si.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+    si.semaphore = s;
+    si.value     = value;
+    vkSignalSemaphore(device, &si);
+}
+
+SCENARIO( " Scenario 1: Defer work until the timeline reaches a value" )
+{
+    auto window = createWindow(1024,768);
+    auto device = window->getDevice();
+
+    gvu::TimelineTracker T;
+    T.init(device);
+
+    auto v1 = T.nextValue();
+    auto v2 = T.nextValue();
+    REQUIRE( v1 == 1 );
+    REQUIRE( v2 == 2 );
+    REQUIRE( T.lastSubmittedValue() == 2 );
+
+    std::vector<uint64_t> order;
+    T.onComplete(v2, [&](){ order.push_back(2); });
+    T.onComplete(v1, [&](){ order.push_back(1); });
+    REQUIRE( T.pendingCount() == 2 );
+
+    WHEN("The first value is signalled")
+    {
+        hostSignal(device, T.getSemaphore(), v1);
+        REQUIRE( T.update() == v1 );
+
+        THEN("Only the first deferred function is called")
+        {
+            REQUIRE( order == std::vector<uint64_t>{1} );
+            REQUIRE( T.isComplete(v1) );
+            REQUIRE( !T.isComplete(v2) );
+        }
+
+        THEN("Work deferred on a completed value runs right away")
+        {
+            bool called = false;
+            T.onComplete(v1, [&](){ called = true; });
+            REQUIRE( called );
+        }
+    }
+
+    WHEN("Both values are signalled")
+    {
+        hostSignal(device, T.getSemaphore(), v2);
+        T.update();
+
+        THEN("The deferred functions are called in value order")
+        {
+            REQUIRE( order == std::vector<uint64_t>({1,2}) );
+            REQUIRE( T.pendingCount() == 0 );
+        }
+    }
+
+    // a timeline semaphore cannot be signalled with a value it has
+    // already reached, so only signal what the WHEN branch did not
+    uint64_t current = 0;
+    vkGetSemaphoreCounterValue(device, T.getSemaphore(), &current);
+    if(current < T.lastSubmittedValue())
+        hostSignal(device, T.getSemaphore(), T.lastSubmittedValue());
+    T.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 2: Recycle command buffers with a TimelineTracker" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::TimelineTracker T;
+    T.init(window->getDevice());
+
+    gvu::CommandPoolManager cpm;
+    cpm.init(window->getDevice(), window->getPhysicalDevice(), window->getGraphicsQueue());
+
+    auto value = cpm.beginRecording([](VkCommandBuffer){}, T);
+    REQUIRE( value == 1 );
+    REQUIRE( cpm.freeCommandBufferCount() == 0 );
+
+    T.wait(value);
+
+    REQUIRE( T.isComplete(value) );
+    REQUIRE( cpm.freeCommandBufferCount() == 1 );
+
+    T.destroy();
+    cpm.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 3: Only submitted values are waited for" )
+{
+    auto window = createWindow(1024,768);
+
+    gvu::TimelineTracker T;
+    T.init(window->getDevice());
+
+    WHEN("A value is signalled by a batch which is never submitted")
+    {
+        gvu::SubmitBatch batch;
+        auto v = T.signal(batch);
+        batch.clear();
+
+        THEN("It is not counted as submitted")
+        {
+            REQUIRE( v == 1 );
+            REQUIRE( T.lastSubmittedValue() == 0 );
+        }
+
+        THEN("The next submit signals a later value")
+        {
+            auto v2 = T.submit(batch, window->getGraphicsQueue());
+            REQUIRE( v2 == 2 );
+            REQUIRE( T.lastSubmittedValue() == 2 );
+
+            T.wait(v2);
+            REQUIRE( T.isComplete(v2) );
+        }
+    }
+
+    // destroy() waits for lastSubmittedValue(), so it
+    // must not hang on the value which was never submitted
+    T.destroy();
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
@@ -0,0 +1,261 @@
+#include<catch2/catch.hpp>
+
+#include "unit_helpers.h"
+#include <gvu/Managers/UploadManager.h>
+
+struct TestBuffer
+{
+    VkBuffer       buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+};
+
+static TestBuffer createDeviceBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size)
+{
+    TestBuffer B;
+
+    VkBufferCreateInfo ci = {};
+    ci.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    ci.size        = size;
+    ci.usage       = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    vkCreateBuffer(device, &ci, nullptr, &B.buffer);
+
+    VkMemoryRequirements req;
+    vkGetBufferMemoryRequirements(device, B.buffer, &req);
+
+    VkMemoryAllocateInfo ai = {};
+    ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    ai.allocationSize  = req.size;
+    ai.memoryTypeIndex = gvu::UploadManager::findMemoryType(physicalDevice, req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    vkAllocateMemory(device, &ai, nullptr, &B.memory);
+    vkBindBufferMemory(device, B.buffer, B.memory, 0);
+    return B;
+}
+
+struct TestImage
+{
+    VkImage        image  = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+};
+
+static TestImage createDeviceImage(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat format, VkExtent3D extent, uint32_t mipLevels)
+{
+    TestImage I;
+
+    VkImageCreateInfo ci = {};
+    ci.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    ci.imageType     = VK_IMAGE_TYPE_2D;
+    ci.format        = format;
+    ci.extent        = extent;
+    ci.mipLevels     = mipLevels;
+    ci.arrayLayers   = 1;
+    ci.samples       = VK_SAMPLE_COUNT_1_BIT;
+    ci.tiling        = VK_IMAGE_TILING_OPTIMAL;
+    ci.usage         = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    ci.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+    ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    vkCreateImage(device, &ci, nullptr, &I.image);
+
+    VkMemoryRequirements req;
+    vkGetImageMemoryRequirements(device, I.image, &req);
+
+    VkMemoryAllocateInfo ai = {};
+    ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    ai.allocationSize  = req.size;
+    ai.memoryTypeIndex = gvu::UploadManager::findMemoryType(physicalDevice, req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    vkAllocateMemory(device, &ai, nullptr, &I.memory);
+    vkBindImageMemory(device, I.image, I.memory, 0);
+    return I;
+}
+
+SCENARIO( " Scenario 1: Upload buffer data through the staging ring" )
+{
+    auto window = createWindow(1024,768);
+    auto device = window->getDevice();
+
+    auto family = gvu::CommandPoolManager::getQueueFamilyIndex(VK_QUEUE_GRAPHICS_BIT, window->getPhysicalDevice());
+
+    gvu::UploadManager U;
+    U.init(device, window->getPhysicalDevice(), window->getGraphicsQueue(), family, family, 1024);
+
+    REQUIRE( !U.requiresOwnershipTransfer() );
+    REQUIRE( U.stagingSize() == 1024 );
+
+    auto dst = createDeviceBuffer(device, window->getPhysicalDevice(), 4096);
+
+    std::vector<uint8_t> data(600, 0xAB);
+
+    REQUIRE( U.flush() == 0 );
+
+    U.uploadBuffer(dst.buffer, 0, data.data(), 100);
+    U.uploadBuffer(dst.buffer, 100, data.data(), 100);
+    REQUIRE( U.stagingUsed() == 212 ); // the second upload is aligned to 16 bytes
+
+    auto token = U.flush();
+    REQUIRE( token == 1 );
+    REQUIRE( U.lastToken() == 1 );
+
+    U.wait(token);
+    REQUIRE( U.isComplete(token) );
+
+    WHEN("The flush is collected")
+    {
+        REQUIRE( U.collect() == 1 );
+        THEN("The staging memory is free")
+        {
+            REQUIRE( U.stagingUsed() == 0 );
+            REQUIRE( U.inFlightCount() == 0 );
+        }
+    }
+
+    WHEN("An upload does not fit in the rest of the ring")
+    {
+        U.uploadBuffer(dst.buffer, 0, data.data(), 600);
+        U.uploadBuffer(dst.buffer, 0, data.data(), 600);
+
+        THEN("The completed uploads are retired to make room")
+        {
+            REQUIRE( U.lastToken() == 2 );
+            REQUIRE( U.stagingUsed() == 600 );
+            REQUIRE( U.flush() == 3 );
+        }
+    }
+
+    THEN("An upload larger than the ring throws")
+    {
+        std::vector<uint8_t> big(2048);
+        REQUIRE_THROWS_AS( U.uploadBuffer(dst.buffer, 0, big.data(), big.size()), std::length_error );
+    }
+
+    THEN("Mapping an empty upload throws")
+    {
+        REQUIRE_THROWS_AS( U.mapBufferUpload(dst.buffer, 0, 0), std::invalid_argument );
+    }
+
+    U.destroy();
+
+    vkDestroyBuffer(device, dst.buffer, nullptr);
+    vkFreeMemory(device, dst.memory, nullptr);
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 2: Upload several regions and mip levels of an image" )
+{
+    auto window = createWindow(1024,768);
+    auto device = window->getDevice();
+
+    auto family = gvu::CommandPoolManager::getQueueFamilyIndex(VK_QUEUE_GRAPHICS_BIT, window->getPhysicalDevice());
+
+    gvu::UploadManager U;
+    U.init(device, window->getPhysicalDevice(), window->getGraphicsQueue(), family, family, 4096);
+
+    auto format = VK_FORMAT_R8G8B8A8_UNORM;
+    auto dst    = createDeviceImage(device, window->getPhysicalDevice(), format, {8,8,1}, 2);
+
+    std::vector<uint8_t> pixels(8*8*4, 0xCD);
+
+    // the top and bottom half of mip 0 share one set of layout transitions
+    U.uploadImage(dst.image, format, {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1}, {0,0,0}, {8,4,1}, pixels.data(), 8*4*4);
+    U.uploadImage(dst.image, format, {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1}, {0,4,0}, {8,4,1}, pixels.data(), 8*4*4);
+    U.uploadImage(dst.image, format, {VK_IMAGE_ASPECT_COLOR_BIT, 1, 0, 1}, {0,0,0}, {4,4,1}, pixels.data(), 4*4*4);
+    REQUIRE( U.stagingUsed() == 8*4*4 + 8*4*4 + 4*4*4 );
+
+    THEN("A pending subresource cannot be given a different final layout")
+    {
+        REQUIRE_THROWS_AS( U.uploadImage(dst.image, format, {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1}, {0,0,0}, {8,4,1}, pixels.data(), 8*4*4, VK_IMAGE_LAYOUT_GENERAL),
+                           std::invalid_argument );
+    }
+
+    WHEN("The uploads are flushed")
+    {
+        auto token = U.flush();
+        U.wait(token);
+
+        THEN("They complete as a single flush")
+        {
+            REQUIRE( U.isComplete(token) );
+            REQUIRE( U.collect() == 1 );
+            REQUIRE( U.pendingAcquireCount() == 0 );
+        }
+    }
+
+    U.destroy();
+
+    vkDestroyImage(device, dst.image, nullptr);
+    vkFreeMemory(device, dst.memory, nullptr);
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 3: Release uploaded resources to another queue family" )
+{
+    auto window = createWindow(1024,768);
+    auto device = window->getDevice();
+
+    auto family = gvu::CommandPoolManager::getQueueFamilyIndex(VK_QUEUE_GRAPHICS_BIT, window->getPhysicalDevice());
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(window->getPhysicalDevice(), &familyCount, nullptr);
+    if(familyCount < 2)
+    {
+        WARN("The device only has one queue family");
+    }
+    else
+    {
+        auto otherFamily = family == 0 ? 1u : 0u;
+
+        gvu::UploadManager U;
+        U.init(device, window->getPhysicalDevice(), window->getGraphicsQueue(), family, otherFamily, 4096);
+        REQUIRE( U.requiresOwnershipTransfer() );
+
+        auto format = VK_FORMAT_R8G8B8A8_UNORM;
+        auto img    = createDeviceImage(device, window->getPhysicalDevice(), format, {8,8,1}, 1);
+        auto buf    = createDeviceBuffer(device, window->getPhysicalDevice(), 256);
+
+        std::vector<uint8_t> data(8*8*4, 0xEF);
+
+        U.uploadBuffer(buf.buffer, 0, data.data(), 256);
+        U.uploadImage(img.image, format, {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1}, {0,0,0}, {8,4,1}, data.data(), 8*4*4);
+        U.uploadImage(img.image, format, {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1}, {0,4,0}, {8,4,1}, data.data(), 8*4*4);
+
+        auto token = U.flush();
+
+        THEN("One acquire barrier is pending per resource range")
+        {
+            REQUIRE( U.pendingAcquireCount() == 2 );
+        }
+
+        U.wait(token);
+        U.destroy();
+
+        vkDestroyImage(device, img.image, nullptr);
+        vkFreeMemory(device, img.memory, nullptr);
+        vkDestroyBuffer(device, buf.buffer, nullptr);
+        vkFreeMemory(device, buf.memory, nullptr);
+    }
+
+    window->destroy();
+    window.reset();
+
+    SDL_Quit();
+}
+
+SCENARIO( " Scenario 4: Image staging offsets are aligned to the texel size" )
+{
+    REQUIRE( gvu::UploadManager::getImageCopyAlignment(VK_FORMAT_R8_UNORM)            == 4 );
+    REQUIRE( gvu::UploadManager::getImageCopyAlignment(VK_FORMAT_R8G8B8A8_UNORM)      == 4 );
+    REQUIRE( gvu::UploadManager::getImageCopyAlignment(VK_FORMAT_R8G8B8_UNORM)        == 12 );
+    REQUIRE( gvu::UploadManager::getImageCopyAlignment(VK_FORMAT_R16G16B16_SFLOAT)    == 12 );
+    REQUIRE( gvu::UploadManager::getImageCopyAlignment(VK_FORMAT_R32G32B32_SFLOAT)    == 12 );
+    REQUIRE( gvu::UploadManager::getImageCopyAlignment(VK_FORMAT_R64G64B64_SFLOAT)    == 24 );
+    REQUIRE( gvu::UploadManager::getImageCopyAlignment(VK_FORMAT_R32G32B32A32_SFLOAT) == 16 );
+    REQUIRE( gvu::UploadManager::getImageCopyAlignment(VK_FORMAT_BC1_RGB_UNORM_BLOCK) == 8 );
+    REQUIRE_THROWS_AS( gvu::UploadManager::getImageCopyAlignment(VK_FORMAT_UNDEFINED), std::invalid_argument );
+}